@@ -0,0 +1,449 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "IO/BinaryMapParser.h"
+#include "IO/ByteBuffer.h"
+#include "IO/MapParser.h"
+#include "IO/MapWriter.h"
+#include "Model/Brush.h"
+#include "Model/BrushRebuildScope.h"
+#include "Model/BrushGeometry.h"
+#include "Model/Entity.h"
+#include "Model/Face.h"
+#include "Model/Map.h"
+#include "Model/Octree.h"
+#include "Model/Picker.h"
+#include "Utility/Console.h"
+#include "Utility/List.h"
+#include "Utility/String.h"
+#include "Utility/VecMath.h"
+
+#include <wx/init.h>
+#include <wx/stopwatch.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <vector>
+
+using namespace TrenchBroom;
+using namespace TrenchBroom::VecMath;
+
+namespace Benchmark {
+    class Input {
+    public:
+        String name;
+        String data;
+
+        Input(const String& i_name, const String& i_data) :
+        name(i_name),
+        data(i_data) {}
+    };
+
+    typedef std::vector<Input> InputList;
+
+    class Result {
+    private:
+        StringStream m_json;
+        bool m_first;
+    public:
+        Result(const String& name) :
+        m_first(true) {
+            m_json << "{";
+            add("input", name);
+        }
+
+        inline void add(const String& key, const String& value) {
+            separate(key);
+            m_json << "\"";
+            for (size_t i = 0; i < value.size(); i++) {
+                if (value[i] == '"' || value[i] == '\\')
+                    m_json << '\\';
+                m_json << value[i];
+            }
+            m_json << "\"";
+        }
+
+        inline void add(const String& key, const double value) {
+            separate(key);
+            // a run that is too fast to be timed yields inf or nan, neither of which is valid JSON
+            if (value != value || std::abs(value) == std::numeric_limits<double>::infinity())
+                m_json << "null";
+            else
+                m_json << value;
+        }
+
+        inline void add(const String& key, const size_t value) {
+            separate(key);
+            m_json << value;
+        }
+
+        inline void separate(const String& key) {
+            if (!m_first)
+                m_json << ", ";
+            m_json << "\"" << key << "\": ";
+            m_first = false;
+        }
+
+        inline String str() const {
+            return m_json.str() + "}";
+        }
+    };
+
+    class Timer {
+    private:
+        wxStopWatch m_watch;
+    public:
+        inline void start() {
+            m_watch.Start();
+        }
+
+        inline double seconds() const {
+            return m_watch.TimeInMicro().ToDouble() / 1000000.0;
+        }
+    };
+
+    static const BBoxf WorldBounds(Vec3f(-16384.0f, -16384.0f, -16384.0f), Vec3f(16384.0f, 16384.0f, 16384.0f));
+
+    // Appends an upright prism with the given number of sides. The face points are ordered so that the plane
+    // normals point out of the brush.
+    void appendPrism(StringStream& str, const Vec3f& center, const float radius, const float height, const size_t sides, const String& texture) {
+        std::vector<Vec3f> corners;
+        for (size_t i = 0; i < sides; i++) {
+            const float angle = 2.0f * Math<float>::Pi * (static_cast<float>(i) + 0.5f) / static_cast<float>(sides);
+            corners.push_back(Vec3f(Math<float>::round(center.x() + radius * std::cos(angle)),
+                                    Math<float>::round(center.y() + radius * std::sin(angle)),
+                                    center.z()));
+        }
+
+        const float top = center.z() + height;
+        str << "{\n";
+        for (size_t i = 0; i < sides; i++) {
+            const Vec3f& p0 = corners[i];
+            const Vec3f& p2 = corners[(i + 1) % sides];
+            str << "( " << p0.x() << " " << p0.y() << " " << p0.z() << " ) ";
+            str << "( " << p0.x() << " " << p0.y() << " " << top << " ) ";
+            str << "( " << p2.x() << " " << p2.y() << " " << p2.z() << " ) ";
+            str << texture << " 0 0 0 1 1\n";
+        }
+        str << "( 0 0 " << top << " ) ( 0 1 " << top << " ) ( 1 0 " << top << " ) " << texture << " 0 0 0 1 1\n";
+        str << "( 0 0 " << center.z() << " ) ( 1 0 " << center.z() << " ) ( 0 1 " << center.z() << " ) " << texture << " 0 0 0 1 1\n";
+        str << "}\n";
+    }
+
+    Input syntheticMap(const String& name, const size_t countX, const size_t countY, const size_t countZ, const size_t sides, const size_t lights) {
+        StringStream str;
+        str << "{\n\"classname\" \"worldspawn\"\n";
+        for (size_t x = 0; x < countX; x++) {
+            for (size_t y = 0; y < countY; y++) {
+                for (size_t z = 0; z < countZ; z++) {
+                    const Vec3f center(128.0f * x, 128.0f * y, 128.0f * z);
+                    appendPrism(str, center, 48.0f, 96.0f, sides, (x + y + z) % 2 == 0 ? "metal1_1" : "*water0");
+                }
+            }
+        }
+        str << "}\n";
+
+        for (size_t i = 0; i < lights; i++) {
+            const Vec3f origin(128.0f * (i % countX) + 64.0f, 128.0f * ((i / countX) % countY) + 64.0f, 112.0f);
+            str << "{\n\"classname\" \"light\"\n\"origin\" \"" << origin.x() << " " << origin.y() << " " << origin.z() << "\"\n}\n";
+        }
+
+        return Input(name, str.str());
+    }
+
+    bool loadFile(const String& path, String& data) {
+        std::ifstream stream(path.c_str(), std::ios::in | std::ios::binary);
+        if (!stream.is_open())
+            return false;
+        StringStream buffer;
+        buffer << stream.rdbuf();
+        data = buffer.str();
+        return true;
+    }
+
+    Model::BrushList allBrushes(const Model::Map& map) {
+        Model::BrushList result;
+        const Model::EntityList& entities = map.entities();
+        Model::EntityList::const_iterator it, end;
+        for (it = entities.begin(), end = entities.end(); it != end; ++it) {
+            const Model::BrushList& brushes = (*it)->brushes();
+            result.insert(result.end(), brushes.begin(), brushes.end());
+        }
+        return result;
+    }
+
+    size_t vertexCount(const Model::EntityList& entities) {
+        size_t count = 0;
+        for (size_t i = 0; i < entities.size(); i++) {
+            const Model::BrushList& brushes = entities[i]->brushes();
+            for (size_t j = 0; j < brushes.size(); j++)
+                count += brushes[j]->vertices().size();
+        }
+        return count;
+    }
+
+    void parse(const Input& input, Model::Map& map, Utility::Console& console) {
+        IO::MapParser parser(input.data, console);
+        parser.parseMap(map, NULL);
+    }
+
+    String run(const Input& input, const size_t iterations, const size_t rayCount) {
+        Utility::Console console;
+        Result result(input.name);
+        Timer timer;
+        double best;
+
+        // parsing
+        best = std::numeric_limits<double>::max();
+        for (size_t i = 0; i < iterations; i++) {
+            Model::Map map(WorldBounds, false);
+            timer.start();
+            parse(input, map, console);
+            best = std::min(best, timer.seconds());
+        }
+
+        Model::Map map(WorldBounds, false);
+        parse(input, map, console);
+        const Model::BrushList brushes = allBrushes(map);
+        size_t faceCount = 0;
+        for (size_t i = 0; i < brushes.size(); i++)
+            faceCount += brushes[i]->faces().size();
+
+        result.add("bytes", input.data.size());
+        result.add("entities", map.entities().size());
+        result.add("brushes", brushes.size());
+        result.add("faces", faceCount);
+        result.add("parseSeconds", best);
+        result.add("parseMegabytesPerSecond", input.data.size() / best / (1024.0 * 1024.0));
+        result.add("parseBrushesPerSecond", brushes.size() / best);
+
+        // writing
+        IO::MapWriter writer;
+        size_t written = 0;
+        best = std::numeric_limits<double>::max();
+        for (size_t i = 0; i < iterations; i++) {
+            std::stringstream stream;
+            timer.start();
+            writer.writeToStream(map, stream);
+            best = std::min(best, timer.seconds());
+            written = static_cast<size_t>(stream.tellp());
+        }
+        result.add("writeSeconds", best);
+        result.add("writeMegabytesPerSecond", written / best / (1024.0 * 1024.0));
+
+        // geometry
+        best = std::numeric_limits<double>::max();
+        for (size_t i = 0; i < iterations; i++) {
+            timer.start();
+            for (size_t j = 0; j < brushes.size(); j++)
+                brushes[j]->rebuildGeometry();
+            best = std::min(best, timer.seconds());
+        }
+        result.add("rebuildGeometrySeconds", best);
+        result.add("rebuildGeometryBrushesPerSecond", brushes.size() / best);
+
+        best = std::numeric_limits<double>::max();
+        for (size_t i = 0; i < iterations; i++) {
+            timer.start();
+            {
+                Model::BrushRebuildScope rebuildScope(map);
+                for (size_t j = 0; j < brushes.size(); j++)
+                    brushes[j]->rebuildGeometry();
+                rebuildScope.rebuild();
+            }
+            best = std::min(best, timer.seconds());
+        }
+        result.add("batchedRebuildGeometrySeconds", best);
+
+        // octree
+        best = std::numeric_limits<double>::max();
+        for (size_t i = 0; i < iterations; i++) {
+            Model::Octree octree(map);
+            timer.start();
+            octree.loadMap();
+            best = std::min(best, timer.seconds());
+        }
+        result.add("octreeBuildSeconds", best);
+
+        // picking, with rays from random points in the map bounds
+        if (!brushes.empty()) {
+            BBoxf bounds = brushes.front()->bounds();
+            for (size_t i = 1; i < brushes.size(); i++)
+                bounds.mergeWith(brushes[i]->bounds());
+
+            std::srand(1);
+            std::vector<Rayf> rays;
+            for (size_t i = 0; i < rayCount; i++) {
+                Vec3f origin, direction;
+                for (size_t j = 0; j < 3; j++) {
+                    const float r = static_cast<float>(std::rand()) / RAND_MAX;
+                    origin[j] = bounds.min[j] + r * (bounds.max[j] - bounds.min[j]);
+                    direction[j] = static_cast<float>(std::rand()) / RAND_MAX - 0.5f;
+                }
+                if (direction.null())
+                    direction = Vec3f::PosX;
+                rays.push_back(Rayf(origin, direction.normalized()));
+            }
+
+            Model::Octree octree(map);
+            octree.loadMap();
+            Model::Picker picker(octree);
+
+            best = std::numeric_limits<double>::max();
+            for (size_t i = 0; i < iterations; i++) {
+                timer.start();
+                for (size_t j = 0; j < rays.size(); j++)
+                    delete picker.pick(rays[j]);
+                best = std::min(best, timer.seconds());
+            }
+            result.add("pickRays", rays.size());
+            result.add("pickMicrosecondsPerRay", best * 1000000.0 / rays.size());
+        }
+
+        // copy and paste of all brushes through the text and the binary clipboard formats, including the geometry
+        // of the pasted brushes
+        if (!brushes.empty()) {
+            const Model::EntityList noEntities;
+            StringStream textStream;
+            IO::ByteBuffer binary;
+            writer.writeObjectsToStream(noEntities, brushes, textStream);
+            writer.writeObjectsToBuffer(noEntities, brushes, binary);
+            const String text = textStream.str();
+
+            size_t textVertices = 0;
+            best = std::numeric_limits<double>::max();
+            for (size_t i = 0; i < iterations; i++) {
+                Model::EntityList entities;
+                timer.start();
+                IO::MapParser parser(text, console);
+                parser.parseEntities(WorldBounds, false, entities);
+                textVertices = vertexCount(entities);
+                best = std::min(best, timer.seconds());
+                Utility::deleteAll(entities);
+            }
+            result.add("pasteTextSeconds", best);
+
+            size_t binaryVertices = 0;
+            best = std::numeric_limits<double>::max();
+            for (size_t i = 0; i < iterations; i++) {
+                Model::EntityList entities;
+                timer.start();
+                IO::BinaryMapParser parser(binary.get(), binary.size());
+                parser.parseEntities(WorldBounds, false, entities);
+                binaryVertices = vertexCount(entities);
+                best = std::min(best, timer.seconds());
+                Utility::deleteAll(entities);
+            }
+            result.add("pasteBinarySeconds", best);
+            result.add("pasteBinaryBytes", binary.size());
+            result.add("pasteVerticesMatch", static_cast<size_t>(textVertices == binaryVertices ? 1 : 0));
+        }
+
+        // vertex moves, on copies of the brushes so that every iteration starts from the same geometry
+        best = std::numeric_limits<double>::max();
+        size_t moveCount = 0;
+        for (size_t i = 0; i < iterations; i++) {
+            Model::BrushList copies;
+            std::vector<Vec3f::List> vertices;
+            std::vector<Vec3f> deltas;
+            for (size_t j = 0; j < brushes.size(); j++) {
+                const Model::Brush& brush = *brushes[j];
+                const Vec3f& vertex = brush.vertices().front()->position;
+                const Vec3f delta = ((brush.center() - vertex) / 4.0f).rounded();
+                if (!delta.null() && brush.canMoveVertices(Vec3f::List(1, vertex), delta)) {
+                    copies.push_back(new Model::Brush(WorldBounds, false, brush));
+                    vertices.push_back(Vec3f::List(1, vertex));
+                    deltas.push_back(delta);
+                }
+            }
+
+            timer.start();
+            for (size_t j = 0; j < copies.size(); j++)
+                copies[j]->moveVertices(vertices[j], deltas[j]);
+            best = std::min(best, timer.seconds());
+            moveCount = copies.size();
+
+            for (size_t j = 0; j < copies.size(); j++)
+                delete copies[j];
+        }
+        result.add("moveVerticesMoves", moveCount);
+        if (moveCount > 0)
+            result.add("moveVerticesPerSecond", moveCount / best);
+
+        return result.str();
+    }
+}
+
+int main(int argc, const char* argv[]) {
+    // the console writes its log file from a thread
+    wxInitializer initializer;
+    if (!initializer) {
+        std::cerr << "Could not initialize wxWidgets" << std::endl;
+        return 1;
+    }
+
+    size_t iterations = 3;
+    size_t rayCount = 1000;
+    bool synthetic = true;
+    Benchmark::InputList inputs;
+
+    for (int i = 1; i < argc; i++) {
+        const String arg = argv[i];
+        if (arg == "--iterations" && i + 1 < argc) {
+            iterations = static_cast<size_t>(std::max(1, std::atoi(argv[++i])));
+        } else if (arg == "--rays" && i + 1 < argc) {
+            rayCount = static_cast<size_t>(std::max(1, std::atoi(argv[++i])));
+        } else if (arg == "--no-synthetic") {
+            synthetic = false;
+        } else if (arg == "--double-precision-planes") {
+            Model::BrushGeometry::doublePrecisionPlanes = true;
+        } else {
+            String data;
+            if (!Benchmark::loadFile(arg, data)) {
+                std::cerr << "Could not open file " << arg << std::endl;
+                return 1;
+            }
+            inputs.push_back(Benchmark::Input(arg, data));
+        }
+    }
+
+    if (synthetic) {
+        inputs.insert(inputs.begin(), Benchmark::syntheticMap("synthetic:cylinders", 16, 16, 4, 12, 128));
+        inputs.insert(inputs.begin(), Benchmark::syntheticMap("synthetic:boxes", 24, 24, 4, 4, 256));
+    }
+
+    std::cout << "{\"iterations\": " << iterations;
+    std::cout << ", \"doublePrecisionPlanes\": " << (Model::BrushGeometry::doublePrecisionPlanes ? "true" : "false");
+    std::cout << ", \"results\": [";
+    for (size_t i = 0; i < inputs.size(); i++) {
+        if (i > 0)
+            std::cout << ",";
+        std::cout << "\n  " << Benchmark::run(inputs[i], iterations, rayCount);
+        std::cout.flush();
+    }
+    std::cout << "\n]}" << std::endl;
+
+    return 0;
+}
@@ -39,6 +39,17 @@ namespace TrenchBroom {
             return homeDirectory;
         }
 
+        String LinuxFileManager::cacheDirectory() {
+            char* cacheHome = std::getenv("XDG_CACHE_HOME");
+            if (cacheHome != NULL && *cacheHome != 0)
+                return appendPath(cacheHome, "TrenchBroom");
+
+            char* homeDirectory = std::getenv("HOME");
+            if (homeDirectory == NULL)
+                return "";
+            return appendPath(homeDirectory, ".cache/TrenchBroom");
+        }
+
         String LinuxFileManager::resourceDirectory() {
             return appendPath(appDirectory(), "Resources");
         }
@@ -29,6 +29,7 @@ namespace TrenchBroom {
             String appDirectory();
         public:
             String logDirectory();
+            String cacheDirectory();
             String resourceDirectory();
             String resolveFontPath(const String& fontName);
         };
@@ -21,6 +21,7 @@
 
 #include "CoreFoundation/CoreFoundation.h"
 
+#include <cstdlib>
 #include <fstream>
 
 namespace TrenchBroom {
@@ -44,6 +45,13 @@ namespace TrenchBroom {
             return result.str();
         }
 
+        String MacFileManager::cacheDirectory() {
+            char* homeDirectory = std::getenv("HOME");
+            if (homeDirectory == NULL)
+                return "";
+            return appendPath(homeDirectory, "Library/Caches/TrenchBroom");
+        }
+
         String MacFileManager::resourceDirectory() {
             CFBundleRef mainBundle = CFBundleGetMainBundle ();
             CFURLRef resourcePathUrl = CFBundleCopyResourcesDirectoryURL(mainBundle);
@@ -20,6 +20,8 @@
 #include "Autosaver.h"
 
 #include "IO/FileManager.h"
+#include "IO/IOException.h"
+#include "IO/MapSnapshot.h"
 #include "IO/MapWriter.h"
 #include "Model/MapDocument.h"
 #include "Utility/Console.h"
@@ -27,6 +29,9 @@
 #include <algorithm>
 #include <cassert>
 #include <cstdlib>
+#include <fstream>
+
+#include <wx/stopwatch.h>
 
 namespace TrenchBroom {
     namespace Controller {
@@ -48,6 +53,46 @@ namespace TrenchBroom {
             return backupNo1 < backupNo2;
         }
         
+        wxThread::ExitCode AutosaveWorker::Entry() {
+            save();
+            return (wxThread::ExitCode)0;
+        }
+        
+        AutosaveWorker::AutosaveWorker(IO::MapSnapshot* snapshot, const String& backupPath, const String& indexPath, unsigned int backupNo) :
+        wxThread(wxTHREAD_JOINABLE),
+        m_snapshot(snapshot),
+        m_backupPath(backupPath),
+        m_indexPath(indexPath),
+        m_backupNo(backupNo),
+        m_time(0.0f) {
+            assert(m_snapshot != NULL);
+        }
+        
+        AutosaveWorker::~AutosaveWorker() {
+            delete m_snapshot;
+            m_snapshot = NULL;
+        }
+        
+        void AutosaveWorker::save() {
+            wxStopWatch watch;
+            try {
+                IO::MapWriter mapWriter;
+                mapWriter.writeToFileAtPath(*m_snapshot, m_backupPath);
+                
+                IO::FileManager fileManager;
+                const String tempIndexPath = m_indexPath + ".tmp";
+                std::fstream stream(tempIndexPath.c_str(), std::ios::out | std::ios::trunc);
+                stream << m_backupNo << "\n";
+                stream.close();
+                
+                if (stream.fail() || !fileManager.moveFile(tempIndexPath, m_indexPath, true))
+                    m_error = "Cannot write autosave index " + m_indexPath;
+            } catch (IO::IOException& e) {
+                m_error = e.what();
+            }
+            m_time = watch.Time() / 1000.0f;
+        }
+        
         String Autosaver::backupName(const String& mapBasename, unsigned int backupNo) {
             std::stringstream sstream;
             sstream << mapBasename;
@@ -70,7 +115,51 @@ namespace TrenchBroom {
             return true;
         }
         
-        void Autosaver::autosave() {
+        unsigned int Autosaver::readLastBackupNo(const String& autosavePath, const String& indexPath, const String& mapBasename) {
+            std::fstream stream(indexPath.c_str(), std::ios::in);
+            unsigned int backupNo = 0;
+            if (stream.is_open() && (stream >> backupNo))
+                return backupNo;
+            
+            // there is no index yet, so continue after the highest existing backup no
+            IO::FileManager fileManager;
+            StringList contents = fileManager.directoryContents(autosavePath, "map");
+            for (size_t i = 0; i < contents.size(); i++) {
+                const String& filename = contents[i];
+                String basename = fileManager.deleteExtension(filename);
+                unsigned int no;
+                if (isBackupName(basename, mapBasename, no))
+                    backupNo = (std::max)(backupNo, no);
+            }
+            return backupNo;
+        }
+        
+        void Autosaver::finishAutosave(const AutosaveWorker& worker) {
+            if (worker.error().empty()) {
+                // a failed backup is retried in the same slot of the ring
+                m_lastBackupNo = worker.backupNo();
+                m_document.console().debug("Autosaved to %s in %f seconds", worker.backupPath().c_str(), worker.time());
+            } else {
+                m_document.console().error("Autosave failed: %s", worker.error().c_str());
+            }
+        }
+        
+        bool Autosaver::collectWorker(bool wait) {
+            if (m_worker == NULL)
+                return true;
+            if (!wait && m_worker->IsAlive())
+                return false;
+            
+            m_worker->Wait();
+            finishAutosave(*m_worker);
+            delete m_worker;
+            m_worker = NULL;
+            return true;
+        }
+        
+        void Autosaver::autosave(bool background) {
+            assert(m_worker == NULL);
+            
             const String mapPath = m_document.GetFilename().ToStdString();
             if (mapPath.empty())
                 return;
@@ -93,74 +182,32 @@ namespace TrenchBroom {
                 return;
             }
             
-            // collect the actual backup files and determine the highest backup no
-            StringList contents = fileManager.directoryContents(autosavePath, "map");
-            StringList backups;
-            
-            unsigned int highestBackupNo = 0;
-            for (size_t i = 0; i < contents.size(); i++) {
-                const String& filename = contents[i];
-                String basename = fileManager.deleteExtension(filename);
-                unsigned int backupNo;
-                if (isBackupName(basename, mapBasename, backupNo)) {
-                    highestBackupNo = (std::max)(highestBackupNo, backupNo);
-                    backups.push_back(filename);
-                }
+            const String indexPath = fileManager.appendPath(autosavePath, mapBasename + ".autosave");
+            if (mapPath != m_indexedMapPath) {
+                m_lastBackupNo = readLastBackupNo(autosavePath, indexPath, mapBasename);
+                m_indexedMapPath = mapPath;
             }
             
-            if (!backups.empty()) {
-                // sort the backups by their backup nos in ascending order
-                std::sort(backups.begin(), backups.end(), compareByBackupNo);
-                
-                // remove the oldest backups until backups.size() == m_maxBackups - 1
-                while (backups.size() > m_maxBackups - 1) {
-                    const String filePath = fileManager.appendPath(autosavePath, backups.front());
-                    if (!fileManager.deleteFile(filePath)) {
-                        m_document.console().error("Cannot delete file %s", filePath.c_str());
-                        return;
-                    } else {
-                        m_document.console().debug("Deleted file %s", filePath.c_str());
-                    }
-                    
-                    backups.erase(backups.begin());
-                }
+            // the backups form a ring, the index file records which one was written last
+            const unsigned int backupNo = m_lastBackupNo % m_maxBackups + 1;
+            const String backupFilePath = fileManager.appendPath(autosavePath, backupName(mapBasename, backupNo));
+            
+            IO::MapSnapshot* snapshot = new IO::MapSnapshot(m_document.map());
+            if (background) {
+                m_worker = new AutosaveWorker(snapshot, backupFilePath, indexPath, backupNo);
+                if (m_worker->Create() == wxTHREAD_NO_ERROR && m_worker->Run() == wxTHREAD_NO_ERROR)
+                    return;
                 
-                // reorganize the backups and close gaps in the numbering
-                for (unsigned int i = 0; i < backups.size(); i++) {
-                    const String& filename = backups[i];
-                    const String backupFilename = backupName(mapBasename, i + 1);
-                    
-                    if (filename != backupFilename) {
-                        const String filePath = fileManager.appendPath(autosavePath, filename);
-                        const String backupFilePath = fileManager.appendPath(autosavePath, backupFilename);
-                        if (fileManager.exists(backupFilePath)) {
-                            m_document.console().error("Cannot move file %s to %s because a file exists at that path", filePath.c_str(), backupFilePath.c_str());
-                            return;
-                        }
-                        
-                        if (!fileManager.moveFile(filePath, backupFilePath, false)) {
-                            m_document.console().error("Cannot move file %s to %s", filePath.c_str(), backupFilePath.c_str());
-                            return;
-                        } else {
-                            m_document.console().debug("Moved file %s to %s", filePath.c_str(), backupFilePath.c_str());
-                        }
-                    }
-                }
-
-                highestBackupNo = static_cast<unsigned int>(backups.size());
+                // write the backup on this thread instead
+                m_worker->save();
+                finishAutosave(*m_worker);
+                delete m_worker;
+                m_worker = NULL;
+            } else {
+                AutosaveWorker worker(snapshot, backupFilePath, indexPath, backupNo);
+                worker.save();
+                finishAutosave(worker);
             }
-            
-            assert(highestBackupNo == static_cast<unsigned int>(backups.size()));
-            assert(highestBackupNo < m_maxBackups);
-            
-            // save the backup
-            const String backupFilename = backupName(mapBasename, highestBackupNo + 1);
-            const String backupFilePath = fileManager.appendPath(autosavePath, backupFilename);
-            
-            wxStopWatch watch;
-            IO::MapWriter mapWriter;
-            mapWriter.writeToFileAtPath(m_document.map(), backupFilePath, true);
-            m_document.console().debug("Autosaved to %s in %f seconds", backupFilePath.c_str(), watch.Time() / 1000.0f);
         }
         
         Autosaver::Autosaver(Model::MapDocument& document, time_t saveInterval, time_t idleInterval, unsigned int maxBackups) :
@@ -170,13 +217,22 @@ namespace TrenchBroom {
         m_maxBackups(maxBackups),
         m_lastSaveTime(time(NULL)),
         m_lastModificationTime(0),
-        m_dirty(false) {}
+        m_dirty(false),
+        m_lastBackupNo(0),
+        m_worker(NULL) {
+            assert(m_maxBackups > 0);
+        }
 
         Autosaver::~Autosaver() {
-            autosave();
+            collectWorker(true);
+            autosave(false);
         }
 
         void Autosaver::triggerAutosave() {
+            // don't block while the previous backup is still being written
+            if (!collectWorker(false))
+                return;
+            
             time_t currentTime = time(NULL);
             IO::FileManager fileManager;
             if (fileManager.exists(m_document.GetFilename().ToStdString()) &&
@@ -185,7 +241,7 @@ namespace TrenchBroom {
                 currentTime - m_lastModificationTime >= m_idleInterval &&
                 currentTime - m_lastSaveTime >= m_saveInterval) {
                 
-                autosave();
+                autosave(true);
                 m_lastSaveTime = currentTime;
                 m_dirty = false;
             }
@@ -24,7 +24,13 @@
 
 #include <ctime>
 
+#include <wx/thread.h>
+
 namespace TrenchBroom {
+    namespace IO {
+        class MapSnapshot;
+    }
+    
     namespace Model {
         class MapDocument;
     }
@@ -33,6 +39,39 @@ namespace TrenchBroom {
         unsigned int backupNoOfFile(const String& path);
         bool compareByBackupNo(const String& file1, const String& file2);
 
+        class AutosaveWorker : public wxThread {
+        private:
+            IO::MapSnapshot* m_snapshot;
+            String m_backupPath;
+            String m_indexPath;
+            unsigned int m_backupNo;
+            String m_error;
+            float m_time;
+            
+            ExitCode Entry();
+        public:
+            AutosaveWorker(IO::MapSnapshot* snapshot, const String& backupPath, const String& indexPath, unsigned int backupNo);
+            ~AutosaveWorker();
+            
+            void save();
+            
+            inline const String& backupPath() const {
+                return m_backupPath;
+            }
+            
+            inline unsigned int backupNo() const {
+                return m_backupNo;
+            }
+            
+            inline const String& error() const {
+                return m_error;
+            }
+            
+            inline float time() const {
+                return m_time;
+            }
+        };
+        
         class Autosaver {
         protected:
             Model::MapDocument& m_document;
@@ -44,9 +83,16 @@ namespace TrenchBroom {
             time_t m_lastModificationTime;
             bool m_dirty;
             
+            String m_indexedMapPath;
+            unsigned int m_lastBackupNo;
+            AutosaveWorker* m_worker;
+            
             String backupName(const String& mapBasename, unsigned int backupNo);
             bool isBackupName(const String& basename, const String& mapBasename, unsigned int& backupNo);
-            void autosave();
+            unsigned int readLastBackupNo(const String& autosavePath, const String& indexPath, const String& mapBasename);
+            void finishAutosave(const AutosaveWorker& worker);
+            bool collectWorker(bool wait);
+            void autosave(bool background);
         public:
             Autosaver(Model::MapDocument& document, time_t saveInterval = 10 * 60, time_t idleInterval = 3, unsigned int maxBackups = 30);
             ~Autosaver();
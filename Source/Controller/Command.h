@@ -53,7 +53,8 @@ namespace TrenchBroom {
                 ClipToolChange,
                 MoveVerticesToolChange,
                 ViewFilterChange,
-                PreferenceChange
+                PreferenceChange,
+                EntityModelsLoaded
             } Type;
             
             typedef enum {
@@ -104,7 +104,7 @@ namespace TrenchBroom {
                 Model::Entity& entity = **entityIt;
                 entity.setProperty(key(), m_newValue);
                 if (m_definitionChanged)
-                    entity.setDefinition(definitionManager.definition(m_newValue));
+                    entity.setDefinition(definitionManager.definition(entity.classnameId()));
             }
         }
 
@@ -132,11 +132,7 @@ namespace TrenchBroom {
             Model::EntityList::const_iterator entityIt, entityEnd;
             for (entityIt = m_entities.begin(), entityEnd = m_entities.end(); entityIt != entityEnd; ++entityIt) {
                 Model::Entity& entity = **entityIt;
-                const String* classname = entity.classname();
-                if (classname != NULL)
-                    entity.setDefinition(definitionManager.definition(*classname));
-                else
-                    entity.setDefinition(NULL);
+                entity.setDefinition(definitionManager.definition(entity.classnameId()));
             }
         }
 
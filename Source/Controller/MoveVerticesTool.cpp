@@ -549,6 +549,10 @@ namespace TrenchBroom {
                         const Controller::PreferenceChangeEvent& preferenceChangeEvent = static_cast<const Controller::PreferenceChangeEvent&>(command);
                         if (preferenceChangeEvent.isPreferenceChanged(Preferences::RendererInstancingMode))
                             m_handleManager.recreateRenderers();
+                        if (preferenceChangeEvent.isPreferenceChanged(Preferences::GeometryDoublePrecisionPlanes)) {
+                            m_handleManager.clear();
+                            m_handleManager.add(document().editStateManager().selectedBrushes());
+                        }
                         break;
                     }
                     default:
@@ -20,6 +20,7 @@
 #include "RebuildBrushGeometryCommand.h"
 
 #include "Model/Brush.h"
+#include "Model/BrushRebuildScope.h"
 
 #include <cassert>
 
@@ -29,10 +30,14 @@ namespace TrenchBroom {
             makeSnapshots(m_brushes);
             document().brushesWillChange(m_brushes);
             
-            Model::BrushList::const_iterator it, end;
-            for (it = m_brushes.begin(), end = m_brushes.end(); it != end; ++it) {
-                Model::Brush& brush = **it;
-                brush.rebuildGeometry();
+            {
+                Model::BrushRebuildScope rebuildScope(document().map());
+                Model::BrushList::const_iterator it, end;
+                for (it = m_brushes.begin(), end = m_brushes.end(); it != end; ++it) {
+                    Model::Brush& brush = **it;
+                    brush.rebuildGeometry();
+                }
+                rebuildScope.rebuild();
             }
             document().brushesDidChange(m_brushes);
             return true;
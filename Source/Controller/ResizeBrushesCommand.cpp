@@ -20,6 +20,7 @@
 #include "ResizeBrushesCommand.h"
 
 #include "Model/Brush.h"
+#include "Model/BrushRebuildScope.h"
 #include "Model/Face.h"
 
 namespace TrenchBroom {
@@ -35,10 +36,14 @@ namespace TrenchBroom {
             
             document().brushesWillChange(m_brushes);
             
-            for (faceIt = m_faces.begin(), faceEnd = m_faces.end(); faceIt != faceEnd; ++faceIt) {
-                Model::Face& face = **faceIt;
-                Model::Brush& brush = *face.brush();
-                brush.moveBoundary(face, m_delta, m_lockTextures);
+            {
+                Model::BrushRebuildScope rebuildScope(document().map());
+                for (faceIt = m_faces.begin(), faceEnd = m_faces.end(); faceIt != faceEnd; ++faceIt) {
+                    Model::Face& face = **faceIt;
+                    Model::Brush& brush = *face.brush();
+                    brush.moveBoundary(face, m_delta, m_lockTextures);
+                }
+                rebuildScope.rebuild();
             }
             
             document().brushesDidChange(m_brushes);
@@ -49,12 +54,16 @@ namespace TrenchBroom {
             document().brushesWillChange(m_brushes);
             Model::FaceList::const_iterator faceIt, faceEnd;
 
-            for (faceIt = m_faces.begin(), faceEnd = m_faces.end(); faceIt != faceEnd; ++faceIt) {
-                Model::Face& face = **faceIt;
-                Model::Brush& brush = *face.brush();
-                
-                assert(brush.canMoveBoundary(face, -m_delta));
-                brush.moveBoundary(face, -m_delta, m_lockTextures);
+            {
+                Model::BrushRebuildScope rebuildScope(document().map());
+                for (faceIt = m_faces.begin(), faceEnd = m_faces.end(); faceIt != faceEnd; ++faceIt) {
+                    Model::Face& face = **faceIt;
+                    Model::Brush& brush = *face.brush();
+                    
+                    assert(brush.canMoveBoundary(face, -m_delta));
+                    brush.moveBoundary(face, -m_delta, m_lockTextures);
+                }
+                rebuildScope.rebuild();
             }
             
             document().brushesDidChange(m_brushes);
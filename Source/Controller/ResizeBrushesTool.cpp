@@ -182,6 +182,7 @@ namespace TrenchBroom {
             
             m_dragOrigin = hit->hitPoint();
             m_totalDelta = Vec3f::Null;
+            m_deniedDelta = Vec3f::Null;
             m_faces = dragFaces(hit->dragFace());
             
             beginCommandGroup(wxT("Resize Brush"));
@@ -215,11 +216,18 @@ namespace TrenchBroom {
 
             if (faceDelta.null())
                 return true;
+            
+            // the brushes haven't changed since this delta was denied, so it would be denied again
+            if (faceDelta.equals(m_deniedDelta))
+                return true;
 
             ResizeBrushesCommand* command = ResizeBrushesCommand::resizeBrushes(document(), m_faces, faceDelta, document().textureLock());
             if (submitCommand(command)) {
                 m_totalDelta += faceDelta;
                 m_dragOrigin += faceDelta;
+                m_deniedDelta = Vec3f::Null;
+            } else {
+                m_deniedDelta = faceDelta;
             }
             return true;
         }
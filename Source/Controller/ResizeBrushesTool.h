@@ -59,6 +59,7 @@ namespace TrenchBroom {
             Model::SelectedFilter m_filter;
             Model::FaceList m_faces;
             Vec3f m_totalDelta;
+            Vec3f m_deniedDelta;
 
             Vec3f m_dragOrigin;
             
@@ -20,6 +20,7 @@
 #include "SnapVerticesCommand.h"
 
 #include "Model/Brush.h"
+#include "Model/BrushRebuildScope.h"
 #include "Utility/Grid.h"
 
 namespace TrenchBroom {
@@ -29,13 +30,17 @@ namespace TrenchBroom {
             makeSnapshots(m_brushes);
             document().brushesWillChange(m_brushes);
             
-            Model::BrushList::const_iterator it, end;
-            for (it = m_brushes.begin(), end = m_brushes.end(); it != end; ++it) {
-                Model::Brush& brush = **it;
-                if (m_snapTo == 0)
-                    brush.correct(0.01f);
-                else
-                    brush.snap(m_snapTo);
+            {
+                Model::BrushRebuildScope rebuildScope(document().map());
+                Model::BrushList::const_iterator it, end;
+                for (it = m_brushes.begin(), end = m_brushes.end(); it != end; ++it) {
+                    Model::Brush& brush = **it;
+                    if (m_snapTo == 0)
+                        brush.correct(0.01f);
+                    else
+                        brush.snap(m_snapTo);
+                }
+                rebuildScope.rebuild();
             }
             
             document().brushesDidChange(m_brushes);
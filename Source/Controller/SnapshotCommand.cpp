@@ -20,6 +20,7 @@
 #include "SnapshotCommand.h"
 
 #include "Model/Brush.h"
+#include "Model/BrushRebuildScope.h"
 #include "Model/Entity.h"
 #include "Model/EntityDefinitionManager.h"
 #include "Model/Face.h"
@@ -72,7 +73,7 @@ namespace TrenchBroom {
             m_yScale = face.yScale();
             m_rotation = face.rotation();
             m_texture = face.texture();
-            m_textureName = face.textureName();
+            m_textureNameId = face.textureNameId();
         }
         
         unsigned int FaceSnapshot::faceId() {
@@ -87,7 +88,7 @@ namespace TrenchBroom {
             face.setYScale(m_yScale);
             face.setTexture(m_texture);
             if (m_texture == NULL)
-                face.setTextureName(m_textureName);
+                face.setTextureNameId(m_textureNameId);
         }
         
         void SnapshotCommand::makeSnapshots(const Model::EntityList& entities) {
@@ -124,20 +125,20 @@ namespace TrenchBroom {
                 EntitySnapshot& snapshot = *m_entities[entity.uniqueId()];
                 snapshot.restore(entity);
                 
-                const Model::PropertyValue* classname = entity.classname();
-                if (classname != NULL)
-                    entity.setDefinition(definitionManager.definition(*classname));
+                entity.setDefinition(definitionManager.definition(entity.classnameId()));
             }
         }
         
         void SnapshotCommand::restoreSnapshots(const Model::BrushList& brushes) {
             assert(m_brushes.size() == brushes.size());
             
+            Model::BrushRebuildScope rebuildScope(document().map());
             for (unsigned int i = 0; i < brushes.size(); i++) {
                 Model::Brush& brush = *brushes[i];
                 BrushSnapshot& snapshot = *m_brushes[brush.uniqueId()];
                 snapshot.restore(brush);
             }
+            rebuildScope.rebuild();
         }
         
         void SnapshotCommand::restoreSnapshots(const Model::FaceList& faces) {
@@ -26,6 +26,7 @@
 #include "Model/EntityProperty.h"
 #include "Model/EntityTypes.h"
 #include "Model/FaceTypes.h"
+#include "Model/TextureNameTable.h"
 #include "Utility/String.h"
 
 
@@ -68,7 +69,7 @@ namespace TrenchBroom {
             float m_yScale;
             float m_rotation;
             Model::Texture* m_texture;
-            String m_textureName;
+            Model::TextureNameTable::IdType m_textureNameId;
         public:
             FaceSnapshot(const Model::Face& face);
             unsigned int faceId();
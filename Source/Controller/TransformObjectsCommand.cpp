@@ -20,6 +20,7 @@
 #include "TransformObjectsCommand.h"
 
 #include "Model/Brush.h"
+#include "Model/BrushRebuildScope.h"
 #include "Model/Entity.h"
 #include "Model/MapDocument.h"
 #include "Utility/Console.h"
@@ -45,10 +46,14 @@ namespace TrenchBroom {
                 makeSnapshots(m_brushes);
                 document().brushesWillChange(m_brushes);
                 
-                Model::BrushList::const_iterator brushIt, brushEnd;
-                for (brushIt = m_brushes.begin(), brushEnd = m_brushes.end(); brushIt != brushEnd; ++brushIt) {
-                    Model::Brush& brush = **brushIt;
-                    brush.transform(m_pointTransform, m_vectorTransform, m_lockTextures, m_invertOrientation);
+                {
+                    Model::BrushRebuildScope rebuildScope(document().map());
+                    Model::BrushList::const_iterator brushIt, brushEnd;
+                    for (brushIt = m_brushes.begin(), brushEnd = m_brushes.end(); brushIt != brushEnd; ++brushIt) {
+                        Model::Brush& brush = **brushIt;
+                        brush.transform(m_pointTransform, m_vectorTransform, m_lockTextures, m_invertOrientation);
+                    }
+                    rebuildScope.rebuild();
                 }
                 document().brushesDidChange(m_brushes);
             }
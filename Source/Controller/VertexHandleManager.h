@@ -84,9 +84,9 @@ namespace TrenchBroom {
             bool m_recreateRenderers;
             
             template <typename Element>
-            inline bool removeHandle(const Vec3f& position, Element& element, std::map<Vec3f, std::vector<Element*>, Vec3f::LexicographicOrder >& map) {
+            inline bool removeHandle(const Vec3f& position, Element& element, Model::VertexHandleMap<Element>& map) {
                 typedef std::vector<Element*> List;
-                typedef std::map<Vec3f, List, Vec3f::LexicographicOrder> Map;
+                typedef Model::VertexHandleMap<Element> Map;
                 
                 typename Map::iterator mapIt = map.find(position);
                 if (mapIt == map.end())
@@ -104,9 +104,9 @@ namespace TrenchBroom {
             }
             
             template <typename Element>
-            inline size_t moveHandle(const Vec3f& position, std::map<Vec3f, std::vector<Element*>, Vec3f::LexicographicOrder >& from, std::map<Vec3f, std::vector<Element*>, Vec3f::LexicographicOrder >& to) {
+            inline size_t moveHandle(const Vec3f& position, Model::VertexHandleMap<Element>& from, Model::VertexHandleMap<Element>& to) {
                 typedef std::vector<Element*> List;
-                typedef std::map<Vec3f, List, Vec3f::LexicographicOrder> Map;
+                typedef Model::VertexHandleMap<Element> Map;
                 
                 typename Map::iterator mapIt = from.find(position);
                 if (mapIt == from.end())
@@ -136,6 +136,24 @@ namespace TrenchBroom {
                 return NULL;
             }
             
+            template <typename Element>
+            inline void pickHandles(const Rayf& ray, const Model::VertexHandleMap<Element>& map, Model::HitType::Type type, Model::PickResult& pickResult) const {
+                Preferences::PreferenceManager& prefs = Preferences::PreferenceManager::preferences();
+                float handleRadius = prefs.getFloat(Preferences::HandleRadius);
+                float scalingFactor = prefs.getFloat(Preferences::HandleScalingFactor);
+                float maxDistance = prefs.getFloat(Preferences::MaximumHandleDistance);
+                
+                Vec3f::List candidates;
+                map.findCandidates(ray, maxDistance, 2.0f * handleRadius * scalingFactor * maxDistance, candidates);
+                
+                Vec3f::List::const_iterator it, end;
+                for (it = candidates.begin(), end = candidates.end(); it != end; ++it) {
+                    Model::VertexHandleHit* hit = pickHandle(ray, *it, type);
+                    if (hit != NULL)
+                        pickResult.add(hit);
+                }
+            }
+            
             void createRenderers();
             void destroyRenderers();
         public:
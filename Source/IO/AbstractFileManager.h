@@ -25,6 +25,7 @@
 #include "Utility/String.h"
 
 #include <cassert>
+#include <ctime>
 
 namespace TrenchBroom {
     namespace IO {
@@ -57,6 +58,18 @@ namespace TrenchBroom {
             }
         };
         
+        // A range of another mapped file which is kept open as long as the range is in use.
+        class MappedFileView : public MappedFile {
+        private:
+            MappedFile::Ptr m_file;
+        public:
+            MappedFileView(MappedFile::Ptr file, char* begin, char* end) :
+            MappedFile(begin, end),
+            m_file(file) {
+                assert(m_begin >= m_file->begin() && m_end <= m_file->end());
+            }
+        };
+        
 #ifndef _WIN32
         class PosixMappedFile : public MappedFile {
         private:
@@ -77,6 +90,7 @@ namespace TrenchBroom {
             bool makeDirectory(const String& path);
             bool deleteFile(const String& path);
             bool moveFile(const String& sourcePath, const String& destPath, bool overwrite);
+            time_t modificationTime(const String& path);
             char pathSeparator();
             StringList directoryContents(const String& path, String extension = "", bool directories = true, bool files = true);
             bool resolveRelativePath(const String& relativePath, const StringList& rootPaths, String& absolutePath);
@@ -97,6 +111,7 @@ namespace TrenchBroom {
             String deleteExtension(const String& path);
             
             virtual String logDirectory() = 0;
+            virtual String cacheDirectory() = 0;
             virtual String resourceDirectory() = 0;
             virtual String resolveFontPath(const String& fontName) = 0;
             
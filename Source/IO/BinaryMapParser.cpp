@@ -0,0 +1,302 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BinaryMapParser.h"
+
+#include "Model/Brush.h"
+#include "Model/BrushGeometry.h"
+#include "Model/Entity.h"
+#include "Model/Face.h"
+#include "Model/Texture.h"
+#include "Utility/List.h"
+
+namespace TrenchBroom {
+    namespace IO {
+        const unsigned int BinaryMapParser::Magic = 0x424D4254; // "TBMB"
+        const unsigned int BinaryMapParser::Version = 1;
+        const float BinaryMapParser::VertexEpsilon = 0.1f;
+
+        bool BinaryMapParser::read(String& str) {
+            unsigned int length;
+            if (!read(length) || m_buffer.remaining() < length)
+                return false;
+            str.resize(length);
+            for (unsigned int i = 0; i < length; i++)
+                m_buffer >> str[i];
+            return true;
+        }
+
+        bool BinaryMapParser::read(Vec3f& vec) {
+            float x, y, z;
+            if (!read(x) || !read(y) || !read(z))
+                return false;
+            vec = Vec3f(x, y, z);
+            return true;
+        }
+
+        bool BinaryMapParser::readCount(unsigned int& count, size_t minElementSize) {
+            if (!read(count))
+                return false;
+            return static_cast<size_t>(count) <= m_buffer.remaining() / minElementSize;
+        }
+
+        bool BinaryMapParser::readHeader(Contents contents) {
+            m_buffer.reset();
+            unsigned int magic, version, actualContents;
+            if (!read(magic) || !read(version) || !read(actualContents))
+                return false;
+            return magic == Magic && version == Version && actualContents == static_cast<unsigned int>(contents);
+        }
+
+        Model::Face* BinaryMapParser::parseFace(const BBoxf& worldBounds, bool forceIntegerFacePoints) {
+            Vec3f p1, p2, p3;
+            String textureName;
+            float xOffset, yOffset, rotation, xScale, yScale;
+            if (!read(p1) || !read(p2) || !read(p3) ||
+                !read(textureName) ||
+                !read(xOffset) || !read(yOffset) || !read(rotation) || !read(xScale) || !read(yScale))
+                return NULL;
+
+            if (crossed(p3 - p1, p2 - p1).null())
+                return NULL;
+
+            if (textureName == Model::Texture::Empty)
+                textureName = "";
+
+            Model::Face* face = new Model::Face(worldBounds, forceIntegerFacePoints, p1, p2, p3, textureName);
+            face->setXOffset(xOffset);
+            face->setYOffset(yOffset);
+            face->setRotation(rotation);
+            face->setXScale(xScale);
+            face->setYScale(yScale);
+            return face;
+        }
+
+        Model::BrushGeometry* BinaryMapParser::createGeometry(const Model::FaceList& faces, const Vec3f::List& positions, const IndexList& edgeIndices, const std::vector<IndexList>& sideEdgeIndices) {
+            Model::VertexList vertices;
+            Model::EdgeList edges;
+            Model::SideList sides;
+
+            for (size_t i = 0; i < positions.size(); i++) {
+                Model::Vertex* vertex = new Model::Vertex();
+                vertex->position = positions[i];
+                vertices.push_back(vertex);
+            }
+
+            for (size_t i = 0; i < faces.size(); i++) {
+                Model::Side* side = new Model::Side();
+                side->face = faces[i];
+                sides.push_back(side);
+            }
+
+            bool valid = true;
+            for (size_t i = 0; i < edgeIndices.size() && valid; i += 4) {
+                const unsigned int start = edgeIndices[i];
+                const unsigned int end = edgeIndices[i + 1];
+                const unsigned int left = edgeIndices[i + 2];
+                const unsigned int right = edgeIndices[i + 3];
+                valid = (start < vertices.size() && end < vertices.size() && start != end &&
+                         left < sides.size() && right < sides.size() && left != right);
+                if (valid)
+                    edges.push_back(new Model::Edge(vertices[start], vertices[end], sides[left], sides[right]));
+            }
+
+            for (size_t i = 0; i < sides.size() && valid; i++) {
+                Model::Side& side = *sides[i];
+                const IndexList& indices = sideEdgeIndices[i];
+                valid = indices.size() >= 3;
+                for (size_t j = 0; j < indices.size() && valid; j++) {
+                    valid = indices[j] < edges.size();
+                    if (valid) {
+                        Model::Edge* edge = edges[indices[j]];
+                        Model::Vertex* start = edge->startVertex(&side);
+                        valid = (start != NULL && (side.edges.empty() || side.edges.back()->endVertex(&side) == start) &&
+                                 side.face->boundary().pointStatus(start->position, VertexEpsilon) == PointStatus::PSInside);
+                        if (valid) {
+                            side.edges.push_back(edge);
+                            side.vertices.push_back(start);
+                        }
+                    }
+                }
+                valid = valid && side.edges.back()->endVertex(&side) == side.vertices.front();
+            }
+
+            if (!valid) {
+                Utility::deleteAll(sides);
+                Utility::deleteAll(edges);
+                Utility::deleteAll(vertices);
+                return NULL;
+            }
+
+            return new Model::BrushGeometry(vertices, edges, sides);
+        }
+
+        bool BinaryMapParser::parseGeometry(const Model::FaceList& faces, Model::BrushGeometry*& geometry) {
+            geometry = NULL;
+
+            unsigned int vertexCount;
+            if (!readCount(vertexCount, 3 * sizeof(float)))
+                return false;
+            Vec3f::List positions(vertexCount);
+            for (unsigned int i = 0; i < vertexCount; i++)
+                if (!read(positions[i]))
+                    return false;
+
+            unsigned int edgeCount;
+            if (!readCount(edgeCount, 4 * sizeof(unsigned int)))
+                return false;
+            IndexList edgeIndices(4 * static_cast<size_t>(edgeCount));
+            for (size_t i = 0; i < edgeIndices.size(); i++)
+                if (!read(edgeIndices[i]))
+                    return false;
+
+            std::vector<IndexList> sideEdgeIndices(faces.size());
+            for (size_t i = 0; i < faces.size(); i++) {
+                unsigned int sideEdgeCount;
+                if (!readCount(sideEdgeCount, sizeof(unsigned int)))
+                    return false;
+                IndexList& indices = sideEdgeIndices[i];
+                indices.resize(sideEdgeCount);
+                for (unsigned int j = 0; j < sideEdgeCount; j++)
+                    if (!read(indices[j]))
+                        return false;
+            }
+
+            geometry = createGeometry(faces, positions, edgeIndices, sideEdgeIndices);
+            return true;
+        }
+
+        Model::Brush* BinaryMapParser::parseBrush(const BBoxf& worldBounds, bool forceIntegerFacePoints) {
+            unsigned char sourceForceIntegerFacePoints;
+            unsigned int faceCount;
+            if (!read(sourceForceIntegerFacePoints) || !readCount(faceCount, 14 * sizeof(float)))
+                return NULL;
+
+            Model::FaceList faces;
+            for (unsigned int i = 0; i < faceCount; i++) {
+                Model::Face* face = parseFace(worldBounds, forceIntegerFacePoints);
+                if (face == NULL) {
+                    Utility::deleteAll(faces);
+                    return NULL;
+                }
+                faces.push_back(face);
+            }
+
+            unsigned char hasTopology;
+            if (!read(hasTopology)) {
+                Utility::deleteAll(faces);
+                return NULL;
+            }
+
+            // an invalid topology is skipped, and the geometry is rebuilt from the faces instead
+            Model::BrushGeometry* geometry = NULL;
+            if (hasTopology != 0) {
+                if (!parseGeometry(faces, geometry)) {
+                    Utility::deleteAll(faces);
+                    return NULL;
+                }
+
+                // rounding the face points changes the planes, so the topology no longer matches
+                if (geometry != NULL && forceIntegerFacePoints && sourceForceIntegerFacePoints == 0) {
+                    delete geometry;
+                    geometry = NULL;
+                }
+            }
+
+            try {
+                if (geometry != NULL)
+                    return new Model::Brush(worldBounds, forceIntegerFacePoints, faces, geometry);
+                return new Model::Brush(worldBounds, forceIntegerFacePoints, faces);
+            } catch (Model::GeometryException&) {
+                Utility::deleteAll(faces);
+                return NULL;
+            }
+        }
+
+        Model::Entity* BinaryMapParser::parseEntity(const BBoxf& worldBounds, bool forceIntegerFacePoints) {
+            unsigned int propertyCount;
+            if (!readCount(propertyCount, 2 * sizeof(unsigned int)))
+                return NULL;
+
+            Model::Entity* entity = new Model::Entity(worldBounds);
+            for (unsigned int i = 0; i < propertyCount; i++) {
+                String key, value;
+                if (!read(key) || !read(value)) {
+                    delete entity;
+                    return NULL;
+                }
+                entity->setProperty(key, value);
+            }
+
+            unsigned int brushCount;
+            if (!readCount(brushCount, 2)) {
+                delete entity;
+                return NULL;
+            }
+
+            for (unsigned int i = 0; i < brushCount; i++) {
+                Model::Brush* brush = parseBrush(worldBounds, forceIntegerFacePoints);
+                if (brush == NULL) {
+                    delete entity;
+                    return NULL;
+                }
+                entity->addBrush(*brush);
+            }
+
+            return entity;
+        }
+
+        BinaryMapParser::BinaryMapParser(const char* data, size_t size) :
+        m_buffer(data, size) {}
+
+        bool BinaryMapParser::parseEntities(const BBoxf& worldBounds, bool forceIntegerFacePoints, Model::EntityList& entities) {
+            unsigned int entityCount;
+            if (!readHeader(ObjectContents) || !readCount(entityCount, 2 * sizeof(unsigned int)))
+                return false;
+
+            size_t oldSize = entities.size();
+            for (unsigned int i = 0; i < entityCount; i++) {
+                Model::Entity* entity = parseEntity(worldBounds, forceIntegerFacePoints);
+                if (entity == NULL) {
+                    Utility::deleteAll(entities, oldSize);
+                    return false;
+                }
+                entities.push_back(entity);
+            }
+            return entities.size() > oldSize;
+        }
+
+        bool BinaryMapParser::parseFaces(const BBoxf& worldBounds, bool forceIntegerFacePoints, Model::FaceList& faces) {
+            unsigned int faceCount;
+            if (!readHeader(FaceContents) || !readCount(faceCount, 14 * sizeof(float)))
+                return false;
+
+            size_t oldSize = faces.size();
+            for (unsigned int i = 0; i < faceCount; i++) {
+                Model::Face* face = parseFace(worldBounds, forceIntegerFacePoints);
+                if (face == NULL) {
+                    Utility::deleteAll(faces, oldSize);
+                    return false;
+                }
+                faces.push_back(face);
+            }
+            return faces.size() > oldSize;
+        }
+    }
+}
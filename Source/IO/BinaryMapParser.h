@@ -0,0 +1,92 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __TrenchBroom__BinaryMapParser__
+#define __TrenchBroom__BinaryMapParser__
+
+#include "IO/ByteBuffer.h"
+#include "Model/BrushTypes.h"
+#include "Model/EntityTypes.h"
+#include "Model/FaceTypes.h"
+#include "Utility/String.h"
+#include "Utility/VecMath.h"
+
+#include <vector>
+
+using namespace TrenchBroom::VecMath;
+
+namespace TrenchBroom {
+    namespace Model {
+        class Brush;
+        class BrushGeometry;
+        class Entity;
+        class Face;
+    }
+
+    namespace IO {
+        // Reads the binary clipboard format written by MapWriter::writeObjectsToBuffer and
+        // MapWriter::writeFacesToBuffer. Brushes carry their topology, so their geometry need not be rebuilt unless the
+        // topology is invalid.
+        class BinaryMapParser {
+        public:
+            static const unsigned int Magic;
+            static const unsigned int Version;
+
+            typedef enum {
+                FaceContents = 0,
+                ObjectContents = 1
+            } Contents;
+        private:
+            typedef std::vector<unsigned int> IndexList;
+
+            // the distance within which a vertex lies on the plane of a face, as when building brush geometry
+            static const float VertexEpsilon;
+
+            ByteBuffer m_buffer;
+
+            template <typename T>
+            inline bool read(T& value) {
+                if (m_buffer.remaining() < sizeof(T))
+                    return false;
+                m_buffer >> value;
+                return true;
+            }
+
+            bool read(String& str);
+            bool read(Vec3f& vec);
+            bool readCount(unsigned int& count, size_t minElementSize);
+            bool readHeader(Contents contents);
+
+            Model::Face* parseFace(const BBoxf& worldBounds, bool forceIntegerFacePoints);
+            // returns NULL if the topology is inconsistent or if a vertex is not on the plane of one of its faces
+            Model::BrushGeometry* createGeometry(const Model::FaceList& faces, const Vec3f::List& positions, const IndexList& edgeIndices, const std::vector<IndexList>& sideEdgeIndices);
+            // returns false if the topology cannot be read, and sets the geometry to NULL if it is invalid
+            bool parseGeometry(const Model::FaceList& faces, Model::BrushGeometry*& geometry);
+            Model::Brush* parseBrush(const BBoxf& worldBounds, bool forceIntegerFacePoints);
+            Model::Entity* parseEntity(const BBoxf& worldBounds, bool forceIntegerFacePoints);
+        public:
+            BinaryMapParser(const char* data, size_t size);
+
+            bool parseEntities(const BBoxf& worldBounds, bool forceIntegerFacePoints, Model::EntityList& entities);
+            bool parseFaces(const BBoxf& worldBounds, bool forceIntegerFacePoints, Model::FaceList& faces);
+        };
+    }
+}
+
+#endif /* defined(__TrenchBroom__BinaryMapParser__) */
@@ -22,6 +22,7 @@
 
 #include <cassert>
 #include <iostream>
+#include <string>
 #include <vector>
 
 namespace TrenchBroom {
@@ -38,6 +39,10 @@ namespace TrenchBroom {
             m_buffer(size),
             m_index(0) {}
 
+            ByteBuffer(const char* data, size_t size) :
+            m_buffer(data, data + size),
+            m_index(0) {}
+
             template <typename T>
             inline void operator<<(const T& value) {
                 union coercion { T value; char data[sizeof(T)]; };
@@ -60,6 +65,24 @@ namespace TrenchBroom {
                 m_index += sizeof(T);
             }
 
+            // strings are stored as their length followed by their characters
+            inline void operator<<(const std::string& str) {
+                *this << static_cast<unsigned int>(str.size());
+                m_buffer.insert(m_buffer.end(), str.begin(), str.end());
+            }
+
+            inline void operator>>(std::string& str) {
+                unsigned int length = 0;
+                *this >> length;
+                assert(m_index + length <= size());
+                str.assign(m_buffer.begin() + m_index, m_buffer.begin() + m_index + length);
+                m_index += length;
+            }
+
+            inline size_t remaining() const {
+                return size() - m_index;
+            }
+
             inline void reset() {
                 m_index = 0;
             }
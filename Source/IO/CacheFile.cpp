@@ -0,0 +1,111 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "CacheFile.h"
+
+#include <cassert>
+
+namespace TrenchBroom {
+    namespace IO {
+        String readString(char*& cursor, const char* end) {
+            const size_t length = static_cast<size_t>(readValue<unsigned int>(cursor, end));
+            if (static_cast<size_t>(end - cursor) < length)
+                throw IOException::unexpectedEof();
+            const String result(cursor, length);
+            cursor += length;
+            return result;
+        }
+
+        void writeString(std::ostream& stream, const String& str) {
+            writeValue(stream, static_cast<unsigned int>(str.size()));
+            stream.write(str.data(), static_cast<std::streamsize>(str.size()));
+        }
+
+        CacheFile::CacheFile(const String& prefix, const String& name) {
+            FileManager fileManager;
+            const String cacheDirectory = fileManager.cacheDirectory();
+            if (cacheDirectory.empty())
+                return;
+
+            // FNV-1a
+            unsigned int hash = 2166136261u;
+            for (size_t i = 0; i < name.size(); i++) {
+                hash ^= static_cast<unsigned int>(static_cast<unsigned char>(name[i]));
+                hash *= 16777619u;
+            }
+
+            StringStream fileName;
+            fileName << prefix << "-" << std::hex << hash << ".cache";
+            m_path = fileManager.appendPath(cacheDirectory, fileName.str());
+            m_tempPath = m_path + ".tmp";
+        }
+
+        CacheFile::~CacheFile() {
+            if (m_stream.is_open()) {
+                m_stream.close();
+                FileManager fileManager;
+                fileManager.deleteFile(m_tempPath);
+            }
+        }
+
+        MappedFile::Ptr CacheFile::map() const {
+            FileManager fileManager;
+            if (m_path.empty() || !fileManager.exists(m_path))
+                return MappedFile::Ptr();
+            return fileManager.mapFile(m_path);
+        }
+
+        bool CacheFile::open() {
+            assert(!m_stream.is_open());
+            if (m_path.empty())
+                return false;
+
+            FileManager fileManager;
+            const String cacheDirectory = fileManager.deleteLastPathComponent(m_path);
+            if (!fileManager.exists(cacheDirectory)) {
+                const String parentDirectory = fileManager.deleteLastPathComponent(cacheDirectory);
+                if (!fileManager.exists(parentDirectory))
+                    fileManager.makeDirectory(parentDirectory);
+                if (!fileManager.makeDirectory(cacheDirectory))
+                    return false;
+            }
+
+            m_stream.open(m_tempPath.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+            return m_stream.is_open();
+        }
+
+        std::ostream& CacheFile::stream() {
+            assert(m_stream.is_open());
+            return m_stream;
+        }
+
+        bool CacheFile::commit() {
+            assert(m_stream.is_open());
+
+            // the buffered data is only flushed here, so a failed write may only show now
+            m_stream.close();
+            FileManager fileManager;
+            if (m_stream.fail() || !fileManager.moveFile(m_tempPath, m_path, true)) {
+                fileManager.deleteFile(m_tempPath);
+                return false;
+            }
+            return true;
+        }
+    }
+}
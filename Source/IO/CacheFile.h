@@ -0,0 +1,77 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __TrenchBroom__CacheFile__
+#define __TrenchBroom__CacheFile__
+
+#include "IO/FileManager.h"
+#include "IO/IOException.h"
+#include "IO/IOUtils.h"
+#include "Utility/String.h"
+
+#include <fstream>
+
+namespace TrenchBroom {
+    namespace IO {
+        // Bounds checked reads from a mapped cache file, they throw an IOException at the end of the file.
+        template <typename T>
+        inline T readValue(char*& cursor, const char* end) {
+            if (static_cast<size_t>(end - cursor) < sizeof(T))
+                throw IOException::unexpectedEof();
+            return read<T>(cursor);
+        }
+
+        String readString(char*& cursor, const char* end);
+
+        template <typename T>
+        inline void writeValue(std::ostream& stream, const T& value) {
+            stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+        }
+
+        void writeString(std::ostream& stream, const String& str);
+
+        // A binary file in the cache directory, named after a prefix and a hash of the given name. It is written
+        // to a temporary file that only replaces the cache file once it has been written completely, so a failed
+        // write leaves the previous cache file intact.
+        class CacheFile {
+        private:
+            String m_path;
+            String m_tempPath;
+            std::ofstream m_stream;
+
+            // prevent copying
+            CacheFile(const CacheFile& other);
+            void operator= (const CacheFile& other);
+        public:
+            CacheFile(const String& prefix, const String& name);
+            ~CacheFile();
+
+            // returns a null pointer if there is no cache directory or no cache file
+            MappedFile::Ptr map() const;
+
+            // creates the cache directory if necessary and opens the temporary file for writing
+            bool open();
+            std::ostream& stream();
+            // returns false and deletes the temporary file if anything could not be written
+            bool commit();
+        };
+    }
+}
+
+#endif /* defined(__TrenchBroom__CacheFile__) */
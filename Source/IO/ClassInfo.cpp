@@ -42,7 +42,7 @@ namespace TrenchBroom {
                         Model::PropertyDefinition::Map::iterator classPropertyIt = classInfo.properties.find(baseclassProperty->name());
                         if (classPropertyIt != classInfo.properties.end()) {
                             // the class already has a definition for this property, attempt merging them
-                            mergeProperties(baseclassProperty.get(), classPropertyIt->second.get());
+                            mergeProperties(baseclassProperty.get(), classPropertyIt->second);
                         } else {
                             // the class doesn't have a definition for this property, add the base class property
                             classInfo.properties[baseclassProperty->name()] = baseclassProperty;
@@ -58,15 +58,19 @@ namespace TrenchBroom {
             }
         }
 
-        void ClassInfo::mergeProperties(const Model::PropertyDefinition* baseclassProperty, Model::PropertyDefinition* classProperty) {
+        void ClassInfo::mergeProperties(const Model::PropertyDefinition* baseclassProperty, Model::PropertyDefinition::Ptr& classProperty) {
             // for now, only merge spawnflags
             if (baseclassProperty->type() == Model::PropertyDefinition::FlagsProperty &&
                 classProperty->type() == Model::PropertyDefinition::FlagsProperty &&
                 baseclassProperty->name() == Model::Entity::SpawnFlagsKey &&
                 classProperty->name() == Model::Entity::SpawnFlagsKey) {
                 
+                // the property may have been inherited from another base class, which must not be modified
+                if (!classProperty.unique())
+                    classProperty = Model::PropertyDefinition::Ptr(new Model::FlagsPropertyDefinition(static_cast<const Model::FlagsPropertyDefinition&>(*classProperty)));
+                
                 const Model::FlagsPropertyDefinition* baseclassFlags = static_cast<const Model::FlagsPropertyDefinition*>(baseclassProperty);
-                Model::FlagsPropertyDefinition* classFlags = static_cast<Model::FlagsPropertyDefinition*>(classProperty);
+                Model::FlagsPropertyDefinition* classFlags = static_cast<Model::FlagsPropertyDefinition*>(classProperty.get());
                 
                 for (int i = 0; i < 24; i++) {
                     const Model::FlagsPropertyOption* baseclassFlag = baseclassFlags->option(static_cast<int>(1 << i));
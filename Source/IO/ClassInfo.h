@@ -70,7 +70,7 @@ namespace TrenchBroom {
 
             static void resolveBaseClasses(const Map& baseClasses, const StringList& classnames, ClassInfo& classInfo);
         private:
-            static void mergeProperties(const Model::PropertyDefinition* baseclassProperty, Model::PropertyDefinition* classProperty);
+            static void mergeProperties(const Model::PropertyDefinition* baseclassProperty, Model::PropertyDefinition::Ptr& classProperty);
         };
     }
 }
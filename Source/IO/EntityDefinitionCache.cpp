@@ -0,0 +1,333 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "EntityDefinitionCache.h"
+
+#include "IO/CacheFile.h"
+#include "IO/IOException.h"
+#include "Model/EntityDefinition.h"
+#include "Model/PropertyDefinition.h"
+#include "Utility/List.h"
+
+#include <cassert>
+
+namespace TrenchBroom {
+    namespace IO {
+        const String EntityDefinitionCache::FilePrefix = "EntityDefinitions";
+
+        static Color readColor(char*& cursor, const char* end) {
+            Color color;
+            for (size_t i = 0; i < 4; i++)
+                color[i] = readValue<float>(cursor, end);
+            return color;
+        }
+
+        static Vec3f readVec(char*& cursor, const char* end) {
+            Vec3f vec;
+            for (size_t i = 0; i < 3; i++)
+                vec[i] = readValue<float>(cursor, end);
+            return vec;
+        }
+
+        static void writeColor(std::ostream& stream, const Color& color) {
+            for (size_t i = 0; i < 4; i++)
+                writeValue(stream, color[i]);
+        }
+
+        static void writeVec(std::ostream& stream, const Vec3f& vec) {
+            for (size_t i = 0; i < 3; i++)
+                writeValue(stream, vec[i]);
+        }
+
+        // time_t may be 32 or 64 bits wide, so it is stored as two 32 bit words, low word first
+        static bool readModificationTime(char*& cursor, const char* end, const time_t modificationTime) {
+            const unsigned int low = readValue<unsigned int>(cursor, end);
+            const unsigned int high = readValue<unsigned int>(cursor, end);
+            return low == static_cast<unsigned int>(modificationTime & 0xFFFFFFFF) &&
+                   high == static_cast<unsigned int>((modificationTime >> 16) >> 16);
+        }
+
+        static void writeModificationTime(std::ostream& stream, const time_t modificationTime) {
+            writeValue(stream, static_cast<unsigned int>(modificationTime & 0xFFFFFFFF));
+            writeValue(stream, static_cast<unsigned int>((modificationTime >> 16) >> 16));
+        }
+
+        static Model::PropertyDefinition::Ptr readPropertyDefinition(char*& cursor, const char* end) {
+            const unsigned char type = readValue<unsigned char>(cursor, end);
+            const String name = readString(cursor, end);
+            const String description = readString(cursor, end);
+
+            switch (type) {
+                case Model::PropertyDefinition::TargetSourceProperty:
+                case Model::PropertyDefinition::TargetDestinationProperty:
+                    return Model::PropertyDefinition::Ptr(new Model::PropertyDefinition(name, static_cast<Model::PropertyDefinition::Type>(type), description));
+                case Model::PropertyDefinition::StringProperty: {
+                    const String defaultValue = readString(cursor, end);
+                    return Model::PropertyDefinition::Ptr(new Model::StringPropertyDefinition(name, description, defaultValue));
+                }
+                case Model::PropertyDefinition::IntegerProperty: {
+                    const int defaultValue = readValue<int>(cursor, end);
+                    return Model::PropertyDefinition::Ptr(new Model::IntegerPropertyDefinition(name, description, defaultValue));
+                }
+                case Model::PropertyDefinition::FloatProperty: {
+                    const float defaultValue = readValue<float>(cursor, end);
+                    return Model::PropertyDefinition::Ptr(new Model::FloatPropertyDefinition(name, description, defaultValue));
+                }
+                case Model::PropertyDefinition::ChoiceProperty: {
+                    const int defaultValue = readValue<int>(cursor, end);
+                    Model::ChoicePropertyDefinition* definition = new Model::ChoicePropertyDefinition(name, description, defaultValue);
+                    Model::PropertyDefinition::Ptr result(definition);
+
+                    const unsigned int optionCount = readValue<unsigned int>(cursor, end);
+                    for (unsigned int i = 0; i < optionCount; i++) {
+                        const String value = readString(cursor, end);
+                        const String optionDescription = readString(cursor, end);
+                        definition->addOption(value, optionDescription);
+                    }
+                    return result;
+                }
+                case Model::PropertyDefinition::FlagsProperty: {
+                    Model::FlagsPropertyDefinition* definition = new Model::FlagsPropertyDefinition(name, description);
+                    Model::PropertyDefinition::Ptr result(definition);
+
+                    const unsigned int optionCount = readValue<unsigned int>(cursor, end);
+                    for (unsigned int i = 0; i < optionCount; i++) {
+                        const int value = readValue<int>(cursor, end);
+                        const String optionDescription = readString(cursor, end);
+                        const bool isDefault = readValue<unsigned char>(cursor, end) != 0;
+                        definition->addOption(value, optionDescription, isDefault);
+                    }
+                    return result;
+                }
+                default:
+                    throw IOException("Unknown property definition type %i", static_cast<int>(type));
+            }
+        }
+
+        static void writePropertyDefinition(std::ostream& stream, const Model::PropertyDefinition& definition) {
+            writeValue(stream, static_cast<unsigned char>(definition.type()));
+            writeString(stream, definition.name());
+            writeString(stream, definition.description());
+
+            switch (definition.type()) {
+                case Model::PropertyDefinition::TargetSourceProperty:
+                case Model::PropertyDefinition::TargetDestinationProperty:
+                    break;
+                case Model::PropertyDefinition::StringProperty:
+                    writeString(stream, definition.defaultPropertyValue());
+                    break;
+                case Model::PropertyDefinition::IntegerProperty:
+                    writeValue(stream, static_cast<const Model::IntegerPropertyDefinition&>(definition).defaultValue());
+                    break;
+                case Model::PropertyDefinition::FloatProperty:
+                    writeValue(stream, static_cast<const Model::FloatPropertyDefinition&>(definition).defaultValue());
+                    break;
+                case Model::PropertyDefinition::ChoiceProperty: {
+                    const Model::ChoicePropertyDefinition& choiceDefinition = static_cast<const Model::ChoicePropertyDefinition&>(definition);
+                    writeValue(stream, choiceDefinition.defaultValue());
+
+                    const Model::ChoicePropertyOption::List& options = choiceDefinition.options();
+                    writeValue(stream, static_cast<unsigned int>(options.size()));
+                    Model::ChoicePropertyOption::List::const_iterator it, end;
+                    for (it = options.begin(), end = options.end(); it != end; ++it) {
+                        writeString(stream, it->value());
+                        writeString(stream, it->description());
+                    }
+                    break;
+                }
+                case Model::PropertyDefinition::FlagsProperty: {
+                    const Model::FlagsPropertyDefinition& flagsDefinition = static_cast<const Model::FlagsPropertyDefinition&>(definition);
+
+                    const Model::FlagsPropertyOption::List& options = flagsDefinition.options();
+                    writeValue(stream, static_cast<unsigned int>(options.size()));
+                    Model::FlagsPropertyOption::List::const_iterator it, end;
+                    for (it = options.begin(), end = options.end(); it != end; ++it) {
+                        writeValue(stream, it->value());
+                        writeString(stream, it->description());
+                        writeValue(stream, static_cast<unsigned char>(it->isDefault() ? 1 : 0));
+                    }
+                    break;
+                }
+            }
+        }
+
+        static Model::ModelDefinition::Ptr readModelDefinition(char*& cursor, const char* end) {
+            const String name = readString(cursor, end);
+            const unsigned int skinIndex = readValue<unsigned int>(cursor, end);
+            const unsigned int frameIndex = readValue<unsigned int>(cursor, end);
+
+            // 0 means that the model has no evaluator, otherwise the evaluator type + 1
+            const unsigned char evaluator = readValue<unsigned char>(cursor, end);
+            if (evaluator == 0)
+                return Model::ModelDefinition::Ptr(new Model::ModelDefinition(name, skinIndex, frameIndex));
+
+            const Model::PropertyKey propertyKey = readString(cursor, end);
+            switch (evaluator - 1) {
+                case Model::ModelDefinitionEvaluator::PropertyEvaluator: {
+                    const Model::PropertyValue propertyValue = readString(cursor, end);
+                    return Model::ModelDefinition::Ptr(new Model::ModelDefinition(name, skinIndex, frameIndex, propertyKey, propertyValue));
+                }
+                case Model::ModelDefinitionEvaluator::FlagEvaluator: {
+                    const int flagValue = readValue<int>(cursor, end);
+                    return Model::ModelDefinition::Ptr(new Model::ModelDefinition(name, skinIndex, frameIndex, propertyKey, flagValue));
+                }
+                default:
+                    throw IOException("Unknown model definition evaluator type %i", static_cast<int>(evaluator));
+            }
+        }
+
+        static bool writeModelDefinition(std::ostream& stream, const Model::ModelDefinition& definition) {
+            writeString(stream, definition.name());
+            writeValue(stream, definition.skinIndex());
+            writeValue(stream, definition.frameIndex());
+
+            const Model::ModelDefinitionEvaluator* evaluator = definition.evaluator();
+            if (evaluator == NULL) {
+                writeValue(stream, static_cast<unsigned char>(0));
+                return true;
+            }
+
+            writeValue(stream, static_cast<unsigned char>(evaluator->type() + 1));
+            switch (evaluator->type()) {
+                case Model::ModelDefinitionEvaluator::PropertyEvaluator: {
+                    const Model::ModelDefinitionPropertyEvaluator* propertyEvaluator = static_cast<const Model::ModelDefinitionPropertyEvaluator*>(evaluator);
+                    writeString(stream, propertyEvaluator->propertyKey());
+                    writeString(stream, propertyEvaluator->propertyValue());
+                    return true;
+                }
+                case Model::ModelDefinitionEvaluator::FlagEvaluator: {
+                    const Model::ModelDefinitionFlagEvaluator* flagEvaluator = static_cast<const Model::ModelDefinitionFlagEvaluator*>(evaluator);
+                    writeString(stream, flagEvaluator->propertyKey());
+                    writeValue(stream, flagEvaluator->flagValue());
+                    return true;
+                }
+                default:
+                    return false;
+            }
+        }
+
+        static Model::EntityDefinition* readEntityDefinition(char*& cursor, const char* end) {
+            const unsigned char type = readValue<unsigned char>(cursor, end);
+            const String name = readString(cursor, end);
+            const Color color = readColor(cursor, end);
+            const String description = readString(cursor, end);
+
+            Model::PropertyDefinition::List propertyDefinitions;
+            const unsigned int propertyCount = readValue<unsigned int>(cursor, end);
+            for (unsigned int i = 0; i < propertyCount; i++)
+                propertyDefinitions.push_back(readPropertyDefinition(cursor, end));
+
+            if (type == Model::EntityDefinition::BrushEntity)
+                return new Model::BrushEntityDefinition(name, color, description, propertyDefinitions);
+            if (type != Model::EntityDefinition::PointEntity)
+                throw IOException("Unknown entity definition type %i", static_cast<int>(type));
+
+            const Vec3f min = readVec(cursor, end);
+            const Vec3f max = readVec(cursor, end);
+
+            Model::ModelDefinition::List modelDefinitions;
+            const unsigned int modelCount = readValue<unsigned int>(cursor, end);
+            for (unsigned int i = 0; i < modelCount; i++)
+                modelDefinitions.push_back(readModelDefinition(cursor, end));
+
+            return new Model::PointEntityDefinition(name, color, BBoxf(min, max), description, propertyDefinitions, modelDefinitions);
+        }
+
+        static bool writeEntityDefinition(std::ostream& stream, const Model::EntityDefinition& definition) {
+            writeValue(stream, static_cast<unsigned char>(definition.type()));
+            writeString(stream, definition.name());
+            writeColor(stream, definition.color());
+            writeString(stream, definition.description());
+
+            const Model::PropertyDefinition::List& propertyDefinitions = definition.propertyDefinitions();
+            writeValue(stream, static_cast<unsigned int>(propertyDefinitions.size()));
+            Model::PropertyDefinition::List::const_iterator propertyIt, propertyEnd;
+            for (propertyIt = propertyDefinitions.begin(), propertyEnd = propertyDefinitions.end(); propertyIt != propertyEnd; ++propertyIt)
+                writePropertyDefinition(stream, **propertyIt);
+
+            if (definition.type() == Model::EntityDefinition::BrushEntity)
+                return true;
+
+            const Model::PointEntityDefinition& pointDefinition = static_cast<const Model::PointEntityDefinition&>(definition);
+            writeVec(stream, pointDefinition.bounds().min);
+            writeVec(stream, pointDefinition.bounds().max);
+
+            const Model::ModelDefinition::List& modelDefinitions = pointDefinition.modelDefinitions();
+            writeValue(stream, static_cast<unsigned int>(modelDefinitions.size()));
+            Model::ModelDefinition::List::const_iterator modelIt, modelEnd;
+            for (modelIt = modelDefinitions.begin(), modelEnd = modelDefinitions.end(); modelIt != modelEnd; ++modelIt)
+                if (!writeModelDefinition(stream, **modelIt))
+                    return false;
+            return true;
+        }
+
+        bool EntityDefinitionCache::read(const String& path, const time_t modificationTime, const Color& defaultColor, Model::EntityDefinitionList& result) {
+            CacheFile cacheFile(FilePrefix, path);
+            MappedFile::Ptr file = cacheFile.map();
+            if (file.get() == NULL)
+                return false;
+
+            Model::EntityDefinitionList definitions;
+            try {
+                char* cursor = file->begin();
+                const char* end = file->end();
+
+                if (readValue<unsigned int>(cursor, end) != Version)
+                    return false;
+                if (!readModificationTime(cursor, end, modificationTime))
+                    return false;
+                if (readColor(cursor, end) != defaultColor)
+                    return false;
+                // the file name is only a hash of the path
+                if (readString(cursor, end) != path)
+                    return false;
+
+                const unsigned int count = readValue<unsigned int>(cursor, end);
+                definitions.reserve(count);
+                for (unsigned int i = 0; i < count; i++)
+                    definitions.push_back(readEntityDefinition(cursor, end));
+            } catch (IOException&) {
+                Utility::deleteAll(definitions);
+                return false;
+            }
+
+            result.insert(result.end(), definitions.begin(), definitions.end());
+            return true;
+        }
+
+        void EntityDefinitionCache::write(const String& path, const time_t modificationTime, const Color& defaultColor, const Model::EntityDefinitionList& definitions) {
+            CacheFile cacheFile(FilePrefix, path);
+            if (!cacheFile.open())
+                return;
+
+            std::ostream& stream = cacheFile.stream();
+            writeValue(stream, static_cast<unsigned int>(Version));
+            writeModificationTime(stream, modificationTime);
+            writeColor(stream, defaultColor);
+            writeString(stream, path);
+
+            writeValue(stream, static_cast<unsigned int>(definitions.size()));
+            Model::EntityDefinitionList::const_iterator it, end;
+            for (it = definitions.begin(), end = definitions.end(); it != end; ++it)
+                if (!writeEntityDefinition(stream, **it))
+                    return;
+            cacheFile.commit();
+        }
+    }
+}
@@ -0,0 +1,44 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __TrenchBroom__EntityDefinitionCache__
+#define __TrenchBroom__EntityDefinitionCache__
+
+#include "Model/EntityDefinitionTypes.h"
+#include "Utility/Color.h"
+#include "Utility/String.h"
+
+#include <ctime>
+
+namespace TrenchBroom {
+    namespace IO {
+        // Stores parsed entity definitions in a binary file in the cache directory, keyed by the path and the
+        // modification time of the definition file, so that unchanged definition files are not parsed again.
+        class EntityDefinitionCache {
+        private:
+            static const unsigned int Version = 1;
+            static const String FilePrefix;
+        public:
+            bool read(const String& path, time_t modificationTime, const Color& defaultColor, Model::EntityDefinitionList& result);
+            void write(const String& path, time_t modificationTime, const Color& defaultColor, const Model::EntityDefinitionList& definitions);
+        };
+    }
+}
+
+#endif /* defined(__TrenchBroom__EntityDefinitionCache__) */
@@ -0,0 +1,93 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "EntityThumbnailCache.h"
+
+#include "IO/CacheFile.h"
+#include "IO/IOException.h"
+
+namespace TrenchBroom {
+    namespace IO {
+        const String EntityThumbnailCache::FilePrefix = "EntityThumbnails";
+
+        bool EntityThumbnailCache::read(const String& name, const String& key, ThumbnailMap& result) {
+            CacheFile cacheFile(FilePrefix, name);
+            MappedFile::Ptr file = cacheFile.map();
+            if (file.get() == NULL)
+                return false;
+
+            ThumbnailMap thumbnails;
+            try {
+                char* cursor = file->begin();
+                const char* end = file->end();
+
+                if (readValue<unsigned int>(cursor, end) != Version)
+                    return false;
+                // the file name is only a hash of the name
+                if (readString(cursor, end) != name)
+                    return false;
+                if (readString(cursor, end) != key)
+                    return false;
+
+                const unsigned int count = readValue<unsigned int>(cursor, end);
+                for (unsigned int i = 0; i < count; i++) {
+                    const String thumbnailKey = readString(cursor, end);
+                    Thumbnail& thumbnail = thumbnails[thumbnailKey];
+                    thumbnail.width = readValue<unsigned int>(cursor, end);
+                    thumbnail.height = readValue<unsigned int>(cursor, end);
+
+                    const size_t size = static_cast<size_t>(thumbnail.width) * thumbnail.height * 4;
+                    if (static_cast<size_t>(end - cursor) < size)
+                        throw IOException::unexpectedEof();
+                    thumbnail.pixels.resize(size);
+                    if (size > 0)
+                        readBytes(cursor, &thumbnail.pixels[0], size);
+                }
+            } catch (IOException&) {
+                return false;
+            }
+
+            result.swap(thumbnails);
+            return true;
+        }
+
+        void EntityThumbnailCache::write(const String& name, const String& key, const ThumbnailMap& thumbnails) {
+            CacheFile cacheFile(FilePrefix, name);
+            if (!cacheFile.open())
+                return;
+
+            std::ostream& stream = cacheFile.stream();
+            writeValue(stream, static_cast<unsigned int>(Version));
+            writeString(stream, name);
+            writeString(stream, key);
+
+            writeValue(stream, static_cast<unsigned int>(thumbnails.size()));
+            ThumbnailMap::const_iterator it, end;
+            for (it = thumbnails.begin(), end = thumbnails.end(); it != end; ++it) {
+                const Thumbnail& thumbnail = it->second;
+                writeString(stream, it->first);
+                writeValue(stream, thumbnail.width);
+                writeValue(stream, thumbnail.height);
+                if (!thumbnail.pixels.empty())
+                    stream.write(reinterpret_cast<const char*>(&thumbnail.pixels[0]), static_cast<std::streamsize>(thumbnail.pixels.size()));
+            }
+            cacheFile.commit();
+        }
+    }
+}
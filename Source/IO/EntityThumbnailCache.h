@@ -0,0 +1,54 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __TrenchBroom__EntityThumbnailCache__
+#define __TrenchBroom__EntityThumbnailCache__
+
+#include "Utility/String.h"
+
+#include <map>
+#include <vector>
+
+namespace TrenchBroom {
+    namespace IO {
+        // Stores the rendered thumbnails of the entity browser in a binary file in the cache directory. All
+        // thumbnails of one file share a key that describes what they depend on, e.g. the palette and the
+        // modification time of the game files, and each thumbnail is keyed by the definition it shows.
+        class EntityThumbnailCache {
+        public:
+            struct Thumbnail {
+                unsigned int width;
+                unsigned int height;
+                std::vector<unsigned char> pixels; // RGBA, rows from bottom to top
+
+                Thumbnail() : width(0), height(0) {}
+            };
+
+            typedef std::map<String, Thumbnail> ThumbnailMap;
+        private:
+            static const unsigned int Version = 1;
+            static const String FilePrefix;
+        public:
+            bool read(const String& name, const String& key, ThumbnailMap& result);
+            void write(const String& name, const String& key, const ThumbnailMap& thumbnails);
+        };
+    }
+}
+
+#endif /* defined(__TrenchBroom__EntityThumbnailCache__) */
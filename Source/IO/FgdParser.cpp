@@ -19,10 +19,74 @@
 
 #include "FgdParser.h"
 
+#include <algorithm>
+#include <cctype>
+
 using namespace TrenchBroom::IO::FgdTokenType;
 
 namespace TrenchBroom {
     namespace IO {
+        static bool startsWithClassType(const char* begin, const char* end, const String& typeName) {
+            if (static_cast<size_t>(end - begin) <= typeName.size())
+                return false;
+            for (size_t i = 0; i < typeName.size(); i++)
+                if (std::tolower(begin[i]) != std::tolower(typeName[i]))
+                    return false;
+            const char c = begin[typeName.size()];
+            return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '=';
+        }
+
+        static void addClassBlock(char* begin, char* end, const size_t line, FgdClassBlock::List& blocks) {
+            const bool independent = startsWithClassType(begin, end, "@PointClass") || startsWithClassType(begin, end, "@SolidClass");
+            blocks.push_back(FgdClassBlock(begin, end, line, independent));
+        }
+
+        static void splitClassBlocks(char* begin, char* end, FgdClassBlock::List& blocks) {
+            // a block starts at every @ that is not within brackets, quoted strings or comments
+            char* blockBegin = begin;
+            size_t blockLine = 1;
+            size_t line = 1;
+            size_t depth = 0;
+
+            for (char* c = begin; c < end; ++c) {
+                switch (*c) {
+                    case '\n':
+                        line++;
+                        break;
+                    case '"':
+                        while (c + 1 < end && *++c != '"')
+                            if (*c == '\n')
+                                line++;
+                        break;
+                    case '/':
+                        if (c + 1 < end && *(c + 1) == '/')
+                            while (c + 1 < end && *(c + 1) != '\n')
+                                ++c;
+                        break;
+                    case '[':
+                        depth++;
+                        break;
+                    case ']':
+                        if (depth > 0)
+                            depth--;
+                        break;
+                    case '@':
+                        if (depth == 0) {
+                            if (c > blockBegin)
+                                addClassBlock(blockBegin, c, blockLine, blocks);
+                            blockBegin = c;
+                            blockLine = line;
+                        }
+                        break;
+                    default:
+                        break;
+                }
+            }
+
+            if (end > blockBegin)
+                addClassBlock(blockBegin, end, blockLine, blocks);
+        }
+
         Token FgdTokenEmitter::doEmit(Tokenizer& tokenizer) {
             while (!tokenizer.eof()) {
                 size_t line = tokenizer.line();
@@ -569,5 +633,101 @@ namespace TrenchBroom {
                 throw ParserException(token.line(), token.column(), "Unknown entity definition class " + typeName);
             }
         }
+
+        void FgdParser::parseDefinitions(char* begin, char* end, const Color& defaultEntityColor, Model::EntityDefinitionList& result) {
+            FgdClassBlock::List blocks;
+            splitClassBlocks(begin, end, blocks);
+
+            // base classes must be known before any class that refers to them is parsed
+            ClassInfo::Map baseClasses;
+            size_t independentCount = 0;
+            FgdClassBlock::List::iterator blockIt, blockEnd;
+            for (blockIt = blocks.begin(), blockEnd = blocks.end(); blockIt != blockEnd; ++blockIt) {
+                FgdClassBlock& block = *blockIt;
+                if (block.independent)
+                    independentCount++;
+                else
+                    FgdBlockParser::parseBlock(block, defaultEntityColor, baseClasses);
+            }
+
+            size_t nextBlock = 0;
+            wxCriticalSection lock;
+            const int cpuCount = wxThread::GetCPUCount();
+            size_t threadCount = 1;
+            if (cpuCount > 1)
+                threadCount = std::min(static_cast<size_t>(cpuCount), std::max(independentCount / MinBlocksPerThread, threadCount));
+
+            std::vector<FgdBlockParser*> workers;
+            for (size_t i = 1; i < threadCount; i++) {
+                FgdBlockParser* worker = new FgdBlockParser(blocks, nextBlock, lock, defaultEntityColor, baseClasses);
+                if (worker->Create() == wxTHREAD_NO_ERROR && worker->Run() == wxTHREAD_NO_ERROR)
+                    workers.push_back(worker);
+                else
+                    delete worker;
+            }
+
+            FgdBlockParser parser(blocks, nextBlock, lock, defaultEntityColor, baseClasses);
+            parser.parse();
+
+            for (size_t i = 0; i < workers.size(); i++) {
+                workers[i]->Wait();
+                delete workers[i];
+            }
+
+            Model::EntityDefinitionList definitions;
+            String error;
+            for (blockIt = blocks.begin(), blockEnd = blocks.end(); blockIt != blockEnd; ++blockIt) {
+                FgdClassBlock& block = *blockIt;
+                if (error.empty() && !block.error.empty())
+                    error = block.error;
+                definitions.insert(definitions.end(), block.definitions.begin(), block.definitions.end());
+            }
+
+            if (!error.empty()) {
+                Utility::deleteAll(definitions);
+                throw ParserException(error);
+            }
+
+            result.insert(result.end(), definitions.begin(), definitions.end());
+        }
+
+        wxThread::ExitCode FgdBlockParser::Entry() {
+            parse();
+            return (wxThread::ExitCode)0;
+        }
+
+        FgdBlockParser::FgdBlockParser(FgdClassBlock::List& blocks, size_t& nextBlock, wxCriticalSection& lock, const Color& defaultEntityColor, ClassInfo::Map& baseClasses) :
+        wxThread(wxTHREAD_JOINABLE),
+        m_blocks(blocks),
+        m_nextBlock(nextBlock),
+        m_lock(lock),
+        m_defaultEntityColor(defaultEntityColor),
+        m_baseClasses(baseClasses) {}
+
+        void FgdBlockParser::parse() {
+            while (true) {
+                size_t index;
+                {
+                    wxCriticalSectionLocker locker(m_lock);
+                    while (m_nextBlock < m_blocks.size() && !m_blocks[m_nextBlock].independent)
+                        m_nextBlock++;
+                    if (m_nextBlock == m_blocks.size())
+                        return;
+                    index = m_nextBlock++;
+                }
+                parseBlock(m_blocks[index], m_defaultEntityColor, m_baseClasses);
+            }
+        }
+
+        void FgdBlockParser::parseBlock(FgdClassBlock& block, const Color& defaultEntityColor, ClassInfo::Map& baseClasses) {
+            try {
+                FgdParser parser(block.begin, block.end, defaultEntityColor, &baseClasses, block.line);
+                Model::EntityDefinition* definition = NULL;
+                while ((definition = parser.nextDefinition()) != NULL)
+                    block.definitions.push_back(definition);
+            } catch (ParserException& e) {
+                block.error = e.what();
+            }
+        }
     }
 }
@@ -23,6 +23,7 @@
 #include "IO/ClassInfo.h"
 #include "IO/StreamTokenizer.h"
 #include "Model/EntityDefinition.h"
+#include "Model/EntityDefinitionTypes.h"
 #include "Model/PropertyDefinition.h"
 #include "Utility/Color.h"
 #include "Utility/List.h"
@@ -30,6 +31,9 @@
 
 #include <iostream>
 #include <map>
+#include <vector>
+
+#include <wx/thread.h>
 
 using namespace TrenchBroom::VecMath;
 
@@ -65,9 +69,12 @@ namespace TrenchBroom {
 
         class FgdParser {
         protected:
+            static const size_t MinBlocksPerThread = 32;
+            
             Color m_defaultEntityColor;
             StreamTokenizer<FgdTokenEmitter> m_tokenizer;
-            ClassInfo::Map m_baseClasses;
+            ClassInfo::Map m_ownBaseClasses;
+            ClassInfo::Map& m_baseClasses;
             
             String typeNames(unsigned int types);
             inline void expect(unsigned int types, Token& token) {
@@ -95,11 +102,54 @@ namespace TrenchBroom {
             Model::EntityDefinition* parsePointClass();
             void parseBaseClass();
         public:
-            FgdParser(char* begin, char* end, const Color& defaultEntityColor) :
-            m_defaultEntityColor(defaultEntityColor), 
-            m_tokenizer(begin, end) {}
+            // Parses the given range on its own. If baseClasses is given, base classes are resolved against and
+            // added to it instead of a map owned by this parser, and firstLine is the line number of begin in the
+            // file for error messages.
+            FgdParser(char* begin, char* end, const Color& defaultEntityColor, ClassInfo::Map* baseClasses = NULL, size_t firstLine = 1) :
+            m_defaultEntityColor(defaultEntityColor),
+            m_tokenizer(begin, end, firstLine),
+            m_baseClasses(baseClasses != NULL ? *baseClasses : m_ownBaseClasses) {}
             
             Model::EntityDefinition* nextDefinition();
+            
+            // Splits the file into its class blocks. Base classes are parsed first and in order, the point and solid
+            // classes are then parsed in parallel. The definitions are returned in file order.
+            static void parseDefinitions(char* begin, char* end, const Color& defaultEntityColor, Model::EntityDefinitionList& result);
+        };
+        
+        struct FgdClassBlock {
+            typedef std::vector<FgdClassBlock> List;
+            
+            char* begin;
+            char* end;
+            size_t line;
+            bool independent;
+            Model::EntityDefinitionList definitions;
+            String error;
+            
+            FgdClassBlock(char* i_begin, char* i_end, const size_t i_line, const bool i_independent) :
+            begin(i_begin),
+            end(i_end),
+            line(i_line),
+            independent(i_independent) {}
+        };
+        
+        class FgdBlockParser : public wxThread {
+        private:
+            FgdClassBlock::List& m_blocks;
+            size_t& m_nextBlock;
+            wxCriticalSection& m_lock;
+            Color m_defaultEntityColor;
+            ClassInfo::Map& m_baseClasses;
+            
+            ExitCode Entry();
+        public:
+            FgdBlockParser(FgdClassBlock::List& blocks, size_t& nextBlock, wxCriticalSection& lock, const Color& defaultEntityColor, ClassInfo::Map& baseClasses);
+            
+            // parses the independent blocks until none are left, the base classes must not be modified meanwhile
+            void parse();
+            
+            static void parseBlock(FgdClassBlock& block, const Color& defaultEntityColor, ClassInfo::Map& baseClasses);
         };
     }
 }
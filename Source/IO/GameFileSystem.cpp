@@ -0,0 +1,245 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "GameFileSystem.h"
+
+#include "IO/Pak.h"
+#include "Utility/List.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cctype>
+
+#include <wx/thread.h>
+
+namespace TrenchBroom {
+    namespace IO {
+        String GameFileSystem::normalizeName(const String& name) {
+            String result = name;
+            for (size_t i = 0; i < result.size(); i++) {
+                if (result[i] == '\\')
+                    result[i] = '/';
+                else
+                    result[i] = static_cast<char>(std::tolower(static_cast<unsigned char>(result[i])));
+            }
+            return result;
+        }
+
+        size_t GameFileSystem::hash(const String& name) {
+            size_t hash = 2166136261u;
+            for (size_t i = 0; i < name.size(); i++) {
+                hash ^= static_cast<unsigned char>(name[i]);
+                hash *= 16777619u;
+            }
+            return hash;
+        }
+
+        size_t GameFileSystem::findSlot(const String& name, const size_t hash) const {
+            const size_t mask = m_slots.size() - 1;
+            size_t slot = hash & mask;
+            while (m_slots[slot] != 0) {
+                const Entry& entry = m_entries[m_slots[slot] - 1];
+                if (entry.hash == hash && entry.name == name)
+                    return slot;
+                slot = (slot + 1) & mask;
+            }
+            return slot;
+        }
+
+        void GameFileSystem::rehash(const size_t slotCount) {
+            SlotList slots(slotCount, 0);
+            const size_t mask = slotCount - 1;
+            for (size_t i = 0; i < m_entries.size(); i++) {
+                size_t slot = m_entries[i].hash & mask;
+                while (slots[slot] != 0)
+                    slot = (slot + 1) & mask;
+                slots[slot] = i + 1;
+            }
+            m_slots.swap(slots);
+        }
+
+        GameFileSystem::Entry* GameFileSystem::insert(const String& name, const size_t rank) {
+            if (2 * (m_entries.size() + 1) > m_slots.size())
+                rehash(2 * m_slots.size());
+
+            const size_t nameHash = hash(name);
+            const size_t slot = findSlot(name, nameHash);
+            if (m_slots[slot] != 0) {
+                Entry& entry = m_entries[m_slots[slot] - 1];
+                if (entry.rank > rank)
+                    return NULL;
+                entry.rank = rank;
+                entry.path.clear();
+                entry.data = MappedFile::Ptr();
+                return &entry;
+            }
+
+            m_entries.push_back(Entry(name, nameHash, rank));
+            m_slots[slot] = m_entries.size();
+            return &m_entries.back();
+        }
+
+        void GameFileSystem::mountPaks(FileManager& fileManager, const String& searchPath, const size_t rank) {
+            StringList pakNames = fileManager.directoryContents(searchPath, "pak", false, true);
+            std::sort(pakNames.begin(), pakNames.end());
+
+            StringList::const_iterator it, end;
+            for (it = pakNames.begin(), end = pakNames.end(); it != end; ++it) {
+                const String pakPath = fileManager.appendPath(searchPath, *it);
+                MappedFile::Ptr file = fileManager.mapFile(pakPath);
+                if (file.get() == NULL)
+                    continue;
+
+                m_pakFiles.push_back(file);
+                m_modificationTimes[pakPath] = fileManager.modificationTime(pakPath);
+
+                const Pak pak(pakPath, file);
+                const Pak::PakDirectory& directory = pak.directory();
+                Pak::PakDirectory::const_iterator entryIt, entryEnd;
+                for (entryIt = directory.begin(), entryEnd = directory.end(); entryIt != entryEnd; ++entryIt) {
+                    Entry* entry = insert(normalizeName(entryIt->first), rank);
+                    if (entry != NULL)
+                        entry->data = entryIt->second.data();
+                }
+            }
+        }
+
+        void GameFileSystem::indexDirectory(const String& directory) {
+            if (!m_indexedDirectories.insert(directory).second)
+                return;
+
+            FileManager fileManager;
+            const StringList components = directory.empty() ? StringList() : Utility::split(directory, '/');
+            for (size_t i = 0; i < m_searchPaths.size(); i++) {
+                // the directories on disk may differ in case from the normalized name
+                String path = m_searchPaths[i];
+                bool found = true;
+                for (size_t j = 0; j < components.size() && found; j++) {
+                    m_modificationTimes[path] = fileManager.modificationTime(path);
+                    const StringList subDirectories = fileManager.directoryContents(path, "", true, false);
+                    found = false;
+                    for (size_t k = 0; k < subDirectories.size() && !found; k++) {
+                        if (normalizeName(subDirectories[k]) == components[j]) {
+                            path = fileManager.appendPath(path, subDirectories[k]);
+                            found = true;
+                        }
+                    }
+                }
+                if (!found)
+                    continue;
+
+                m_modificationTimes[path] = fileManager.modificationTime(path);
+                const String prefix = directory.empty() ? "" : directory + "/";
+                const StringList files = fileManager.directoryContents(path, "", false, true);
+                StringList::const_iterator it, end;
+                for (it = files.begin(), end = files.end(); it != end; ++it) {
+                    Entry* entry = insert(prefix + normalizeName(*it), 2 * i + 1);
+                    if (entry != NULL)
+                        entry->path = fileManager.appendPath(path, *it);
+                }
+            }
+        }
+
+        GameFileSystem::GameFileSystem(const StringList& searchPaths) :
+        m_slots(1024, 0) {
+            FileManager fileManager;
+            StringList::const_iterator it, end;
+            for (it = searchPaths.begin(), end = searchPaths.end(); it != end; ++it) {
+                const String& searchPath = *it;
+                if (fileManager.isDirectory(searchPath)) {
+                    mountPaks(fileManager, searchPath, 2 * m_searchPaths.size());
+                    m_searchPaths.push_back(searchPath);
+                }
+            }
+        }
+
+        MappedFile::Ptr GameFileSystem::findFile(const String& name) {
+            const String normalizedName = normalizeName(name);
+            const size_t separator = normalizedName.rfind('/');
+            indexDirectory(separator == String::npos ? "" : normalizedName.substr(0, separator));
+
+            const size_t slot = findSlot(normalizedName, hash(normalizedName));
+            if (m_slots[slot] == 0)
+                return MappedFile::Ptr();
+
+            const Entry& entry = m_entries[m_slots[slot] - 1];
+            if (entry.data.get() != NULL)
+                return entry.data;
+
+            FileManager fileManager;
+            return fileManager.mapFile(entry.path);
+        }
+
+        bool GameFileSystem::stale() const {
+            FileManager fileManager;
+            ModificationTimeMap::const_iterator it, end;
+            for (it = m_modificationTimes.begin(), end = m_modificationTimes.end(); it != end; ++it)
+                if (fileManager.modificationTime(it->first) != it->second)
+                    return true;
+            return false;
+        }
+
+        time_t GameFileSystem::modificationTime() const {
+            time_t result = 0;
+            ModificationTimeMap::const_iterator it, end;
+            for (it = m_modificationTimes.begin(), end = m_modificationTimes.end(); it != end; ++it)
+                result = std::max(result, it->second);
+            return result;
+        }
+
+        GameFileSystemManager* GameFileSystemManager::sharedManager = NULL;
+
+        GameFileSystemManager::GameFileSystemManager() :
+        m_lastCheck(std::time(NULL)) {}
+
+        GameFileSystemManager::~GameFileSystemManager() {
+            FileSystemMap::iterator it, end;
+            for (it = m_fileSystems.begin(), end = m_fileSystems.end(); it != end; ++it)
+                delete it->second;
+            m_fileSystems.clear();
+        }
+
+        GameFileSystem& GameFileSystemManager::fileSystem(const StringList& searchPaths) {
+            assert(wxThread::IsMain());
+
+            const time_t now = std::time(NULL);
+            if (now - m_lastCheck >= CheckInterval) {
+                FileSystemMap::iterator it = m_fileSystems.begin();
+                while (it != m_fileSystems.end()) {
+                    if (it->second->stale()) {
+                        delete it->second;
+                        m_fileSystems.erase(it++);
+                    } else {
+                        ++it;
+                    }
+                }
+                m_lastCheck = now;
+            }
+
+            const String key = Utility::join(searchPaths, "\n");
+            FileSystemMap::iterator it = m_fileSystems.find(key);
+            if (it != m_fileSystems.end())
+                return *it->second;
+
+            GameFileSystem* fileSystem = new GameFileSystem(searchPaths);
+            m_fileSystems[key] = fileSystem;
+            return *fileSystem;
+        }
+    }
+}
@@ -0,0 +1,104 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __TrenchBroom__GameFileSystem__
+#define __TrenchBroom__GameFileSystem__
+
+#include "IO/FileManager.h"
+#include "Utility/String.h"
+
+#include <ctime>
+#include <map>
+#include <set>
+#include <vector>
+
+namespace TrenchBroom {
+    namespace IO {
+        // Indexes the PAK entries and loose files of a list of search paths in a single hash table keyed by the lower
+        // case path of the file relative to its search path. Later search paths override earlier ones, and within a
+        // search path, loose files override PAK entries and PAK files override those that precede them by name.
+        // PAK directories are read when the file system is created, but a directory of loose files is only listed
+        // the first time a file in it is looked up. Like GameFileSystemManager, this is not synchronized and must
+        // only be used on the main thread.
+        class GameFileSystem {
+        private:
+            struct Entry {
+                String name;
+                size_t hash;
+                size_t rank;
+                String path;
+                MappedFile::Ptr data;
+
+                Entry(const String& i_name, const size_t i_hash, const size_t i_rank) :
+                name(i_name),
+                hash(i_hash),
+                rank(i_rank) {}
+            };
+
+            typedef std::vector<Entry> EntryList;
+            typedef std::vector<size_t> SlotList;
+            // one entry per path, so that indexing a directory again replaces its time
+            typedef std::map<String, time_t> ModificationTimeMap;
+            typedef std::vector<MappedFile::Ptr> MappedFileList;
+
+            StringList m_searchPaths;
+            EntryList m_entries;
+            SlotList m_slots; // open addressing, stores index + 1 so that 0 marks a free slot
+            std::set<String> m_indexedDirectories;
+            MappedFileList m_pakFiles;
+            ModificationTimeMap m_modificationTimes;
+
+            static String normalizeName(const String& name);
+            static size_t hash(const String& name);
+            size_t findSlot(const String& name, const size_t hash) const;
+            void rehash(size_t slotCount);
+            // entries of a lower rank do not replace those of a higher rank
+            Entry* insert(const String& name, size_t rank);
+
+            void mountPaks(FileManager& fileManager, const String& searchPath, size_t rank);
+            void indexDirectory(const String& directory);
+        public:
+            GameFileSystem(const StringList& searchPaths);
+
+            MappedFile::Ptr findFile(const String& name);
+            bool stale() const;
+            // the latest modification time of the mounted PAK files and of the directories indexed so far
+            time_t modificationTime() const;
+        };
+
+        // Must only be used on the main thread.
+        class GameFileSystemManager {
+        private:
+            typedef std::map<String, GameFileSystem*> FileSystemMap;
+            static const time_t CheckInterval = 2;
+
+            FileSystemMap m_fileSystems;
+            time_t m_lastCheck;
+        public:
+            static GameFileSystemManager* sharedManager;
+
+            GameFileSystemManager();
+            ~GameFileSystemManager();
+
+            GameFileSystem& fileSystem(const StringList& searchPaths);
+        };
+    }
+}
+
+#endif /* defined(__TrenchBroom__GameFileSystem__) */
@@ -21,8 +21,8 @@
 #define TrenchBroom_IOUtils_h
 
 #include "IO/FileManager.h"
+#include "IO/GameFileSystem.h"
 #include "IO/IOTypes.h"
-#include "IO/Pak.h"
 #include "Utility/String.h"
 #include "Utility/VecMath.h"
 
@@ -40,23 +40,7 @@ using namespace TrenchBroom::VecMath;
 namespace TrenchBroom {
     namespace IO {
         inline MappedFile::Ptr findGameFile(const String& filePath, const StringList& searchPaths) {
-            MappedFile::Ptr mappedFile;
-            FileManager fileManager;
-
-            StringList::const_reverse_iterator pathIt, pathEnd;
-            for (pathIt = searchPaths.rbegin(), pathEnd = searchPaths.rend(); pathIt != pathEnd; ++pathIt) {
-                const String& searchPath = *pathIt;
-                const String path = fileManager.appendPath(searchPath, filePath);
-                MappedFile::Ptr file;
-                if (fileManager.exists(path) && !fileManager.isDirectory(path))
-                    file = fileManager.mapFile(path);
-                else
-                    file = PakManager::sharedManager->entry(filePath, searchPath);
-                if (file.get() != NULL)
-                    return file;
-            }
-
-            return mappedFile;
+            return GameFileSystemManager::sharedManager->fileSystem(searchPaths).findFile(filePath);
         }
 
         template <typename T>
@@ -20,6 +20,7 @@
 #include "MapParser.h"
 
 #include "Model/Brush.h"
+#include "Model/BrushRebuildScope.h"
 #include "Model/Entity.h"
 #include "Model/Face.h"
 #include "Model/Map.h"
@@ -28,8 +29,119 @@
 #include "Utility/List.h"
 #include "Utility/ProgressIndicator.h"
 
+#include <algorithm>
+
 namespace TrenchBroom {
     namespace IO {
+        static const char* skipWhitespace(const char* c, const char* end) {
+            while (c < end && (*c == ' ' || *c == '\t' || *c == '\r' || *c == '\n'))
+                ++c;
+            return c;
+        }
+
+        static void endBrushBlock(MapBrushBlock& block, const char* end, const size_t line) {
+            block.end = end;
+            block.endLine = line;
+        }
+
+        static void endEntityBlock(MapEntityBlock& block, const char* end, const size_t line, const size_t brushCount) {
+            block.end = end;
+            block.endLine = line;
+            block.brushCount = brushCount - block.firstBrush;
+        }
+
+        void MapParser::splitEntityBlocks(const char* begin, const char* end, MapEntityBlock::List& entities, MapBrushBlock::List& brushes) {
+            // Tracks the brace depth outside of quoted strings and comments. Within an entity, a brace followed by a
+            // quoted string starts the next entity, and within a brush, a brace followed by an opening parenthesis
+            // starts the next brush, so that a missing closing brace only affects the object that lacks it.
+            size_t line = 1;
+            size_t depth = 0;
+
+            for (const char* c = begin; c < end; ++c) {
+                switch (*c) {
+                    case '\n':
+                        line++;
+                        break;
+                    case '"':
+                        while (c + 1 < end && *++c != '"')
+                            if (*c == '\n')
+                                line++;
+                        break;
+                    case '/':
+                        if (c + 1 < end && *(c + 1) == '/') {
+                            if (c + 2 < end && *(c + 2) == '/') {
+                                c += 2; // TB comments are tokenized
+                            } else {
+                                while (c + 1 < end && *(c + 1) != '\n')
+                                    ++c;
+                            }
+                        }
+                        break;
+                    case '{': {
+                        if (depth == 0) {
+                            entities.push_back(MapEntityBlock(c, line, brushes.size()));
+                            depth = 1;
+                            break;
+                        }
+
+                        const char* next = skipWhitespace(c + 1, end);
+                        if (next < end && *next == '"') {
+                            if (depth == 2)
+                                endBrushBlock(brushes.back(), c, line);
+                            endEntityBlock(entities.back(), c, line, brushes.size());
+                            entities.push_back(MapEntityBlock(c, line, brushes.size()));
+                            depth = 1;
+                        } else if (depth == 1) {
+                            brushes.push_back(MapBrushBlock(c, line));
+                            depth = 2;
+                        } else if (next < end && *next == '(') {
+                            endBrushBlock(brushes.back(), c, line);
+                            brushes.push_back(MapBrushBlock(c, line));
+                        }
+                        // otherwise, it is the prefix of an alpha-mask texture name
+                        break;
+                    }
+                    case '}':
+                        if (depth == 2) {
+                            endBrushBlock(brushes.back(), c + 1, line);
+                            depth = 1;
+                        } else if (depth == 1) {
+                            endEntityBlock(entities.back(), c + 1, line, brushes.size());
+                            entities.back().closed = true;
+                            depth = 0;
+                        }
+                        break;
+                    default:
+                        break;
+                }
+            }
+
+            if (depth == 2)
+                endBrushBlock(brushes.back(), end, line);
+            if (depth > 0)
+                endEntityBlock(entities.back(), end, line, brushes.size());
+        }
+
+        static void parseEntityBlockProperties(MapEntityBlock& block, const MapBrushBlock::List& brushes, Utility::Console& console) {
+            // the properties are found in the gaps between the brushes
+            const char* gapBegin = block.begin;
+            size_t gapLine = block.line;
+            try {
+                for (size_t i = block.firstBrush; i < block.firstBrush + block.brushCount; i++) {
+                    const MapBrushBlock& brush = brushes[i];
+                    MapParser parser(gapBegin, brush.begin, console, gapLine);
+                    parser.parseProperties(block.properties);
+                    gapBegin = brush.end;
+                    gapLine = brush.endLine;
+                }
+
+                MapParser parser(gapBegin, block.end, console, gapLine);
+                parser.parseProperties(block.properties);
+            } catch (MapParserException& e) {
+                block.error = e.what();
+            }
+        }
+
         Token MapTokenEmitter::doEmit(Tokenizer& tokenizer) {
             while (!tokenizer.eof()) {
                 size_t line = tokenizer.line();
@@ -190,35 +302,134 @@ namespace TrenchBroom {
             return entity;
         }
 
-        MapParser::MapParser(const char* begin, const char* end, Utility::Console& console) :
+        MapParser::MapParser(const char* begin, const char* end, Utility::Console& console, const size_t firstLine) :
         m_console(console),
-        m_tokenizer(begin, end),
+        m_begin(begin),
+        m_end(end),
+        m_tokenizer(begin, end, firstLine),
         m_format(Undefined),
-        m_size(static_cast<size_t>(end - begin)) {
+        m_size(static_cast<size_t>(end - begin)),
+        m_valveFormatReported(false) {
             assert(end >= begin);
         }
 
         MapParser::MapParser(const String& str, Utility::Console& console) :
         m_console(console),
+        m_begin(str.c_str()),
+        m_end(str.c_str() + str.size()),
         m_tokenizer(str.c_str(), str.c_str() + str.size()),
         m_format(Undefined),
-        m_size(str.size()) {}
+        m_size(str.size()),
+        m_valveFormatReported(false) {}
 
         void MapParser::parseMap(Model::Map& map, Utility::ProgressIndicator* indicator) {
-            Model::Entity* entity = NULL;
-            
             if (indicator != NULL) indicator->reset(static_cast<int>(m_size));
+
+            MapEntityBlock::List entities;
+            MapBrushBlock::List brushes;
+            splitEntityBlocks(m_begin, m_end, entities, brushes);
+
+            size_t nextBlock = 0;
+            wxCriticalSection lock;
+            const int cpuCount = wxThread::GetCPUCount();
+            size_t threadCount = 1;
+            if (cpuCount > 1)
+                threadCount = std::min(static_cast<size_t>(cpuCount), std::max(brushes.size() / MinBlocksPerThread, threadCount));
+
+            std::vector<MapBrushBlockParser*> workers;
+            for (size_t i = 1; i < threadCount; i++) {
+                MapBrushBlockParser* worker = new MapBrushBlockParser(brushes, nextBlock, lock, m_console);
+                if (worker->Create() == wxTHREAD_NO_ERROR && worker->Run() == wxTHREAD_NO_ERROR)
+                    workers.push_back(worker);
+                else
+                    delete worker;
+            }
+
+            // the properties are parsed while the workers tokenize the brushes
+            MapEntityBlock::List::iterator entityIt, entityEnd;
+            for (entityIt = entities.begin(), entityEnd = entities.end(); entityIt != entityEnd; ++entityIt)
+                parseEntityBlockProperties(*entityIt, brushes, m_console);
+
+            MapBrushBlockParser parser(brushes, nextBlock, lock, m_console);
+            parser.parse();
+
+            for (size_t i = 0; i < workers.size(); i++) {
+                workers[i]->Wait();
+                delete workers[i];
+            }
+
+            // the geometries of the brushes are built at once on several threads when all entities have been created
+            Model::BrushRebuildScope rebuildScope(map);
+            const BBoxf& worldBounds = map.worldBounds();
+            FacePointFormat facePointFormat = Unknown;
+            for (entityIt = entities.begin(), entityEnd = entities.end(); entityIt != entityEnd; ++entityIt) {
+                const MapEntityBlock& block = *entityIt;
+                if (!block.error.empty()) {
+                    m_console.warn("Skipping entity at line %i: %s", block.line, block.error.c_str());
+                    continue;
+                }
+                if (!block.closed)
+                    m_console.warn("Missing closing brace for entity at line %i", block.line);
+
+                Model::Entity* entity = new Model::Entity(worldBounds);
+                Model::PropertyList::const_iterator propertyIt, propertyEnd;
+                for (propertyIt = block.properties.begin(), propertyEnd = block.properties.end(); propertyIt != propertyEnd; ++propertyIt) {
+                    const Model::Property& property = *propertyIt;
+                    entity->setProperty(property.key(), property.value());
+                    if (facePointFormat == Unknown && property.key() == Model::Entity::FacePointFormatKey)
+                        facePointFormat = property.value() == "1" ? Integer : Float;
+                }
+
+                if (facePointFormat == Unknown) {
+                    m_console.info("Assuming floating point plane coordinates");
+                    facePointFormat = Float;
+                }
+
+                for (size_t i = block.firstBrush; i < block.firstBrush + block.brushCount; i++) {
+                    MapBrushBlock& brushBlock = brushes[i];
+                    if (!brushBlock.error.empty()) {
+                        m_console.warn("Skipping brush at line %i: %s", brushBlock.line, brushBlock.error.c_str());
+                    } else {
+                        Model::Brush* brush = createBrush(worldBounds, facePointFormat == Integer, brushBlock.record, rebuildScope);
+                        entity->addBrush(*brush);
+                    }
+                    MapFaceRecord::List().swap(brushBlock.record.faces);
+                }
+
+                entity->setFilePosition(block.line, block.endLine - block.line);
+                map.addEntity(*entity);
+
+                if (indicator != NULL)
+                    indicator->update(static_cast<int>(block.end - m_begin));
+            }
+
+            if (facePointFormat == Integer)
+                map.setForceIntegerFacePoints(true);
+
+            // the brushes whose geometry could not be built are removed below
             try {
-                FacePointFormat facePointFormat = Unknown;
-                while ((entity = parseEntity(map.worldBounds(), facePointFormat, indicator)) != NULL)
-                    map.addEntity(*entity);
-                
-                if (facePointFormat == Integer)
-                    map.setForceIntegerFacePoints(true);
-            } catch (MapParserException& e) {
-                m_console.error(e.what());
+                rebuildScope.rebuild();
+            } catch (Model::GeometryException&) {
             }
-            
+
+            const Model::EntityList& mapEntities = map.entities();
+            Model::EntityList::const_iterator mapEntityIt, mapEntityEnd;
+            for (mapEntityIt = mapEntities.begin(), mapEntityEnd = mapEntities.end(); mapEntityIt != mapEntityEnd; ++mapEntityIt) {
+                Model::Entity& entity = **mapEntityIt;
+                const Model::BrushList entityBrushes = entity.brushes();
+                Model::BrushList::const_iterator brushIt, brushEnd;
+                for (brushIt = entityBrushes.begin(), brushEnd = entityBrushes.end(); brushIt != brushEnd; ++brushIt) {
+                    Model::Brush* brush = *brushIt;
+                    if (!brush->hasGeometry()) {
+                        m_console.warn("Invalid brush at line %i", brush->fileLine());
+                        entity.removeBrush(*brush);
+                        delete brush;
+                    } else if (!brush->closed()) {
+                        m_console.warn("Non-closed brush at line %i", brush->fileLine());
+                    }
+                }
+            }
+
             if (indicator != NULL)
                 indicator->update(static_cast<int>(m_size));
         }
@@ -229,173 +440,276 @@ namespace TrenchBroom {
         }
         
         Model::Brush* MapParser::parseBrush(const BBoxf& worldBounds, bool forceIntegerFacePoints, Utility::ProgressIndicator* indicator) {
-            Token token = m_tokenizer.nextToken();
-            if (token.type() == TokenType::Eof)
+            MapBrushRecord record;
+            if (!parseBrushRecord(record))
                 return NULL;
             
-            expect(TokenType::OBrace | TokenType::CBrace, token);
-            if (token.type() == TokenType::CBrace)
+            if (indicator != NULL) indicator->update(static_cast<int>(record.endPosition));
+            return createBrush(worldBounds, forceIntegerFacePoints, record);
+        }
+        
+        Model::Face* MapParser::parseFace(const BBoxf& worldBounds, bool forceIntegerFacePoints) {
+            MapFaceRecord record;
+            if (!parseFaceRecord(record))
                 return NULL;
-            
-            const size_t firstLine = token.line();
-            Model::FaceList faces;
-            
-            while ((token = m_tokenizer.nextToken()).type() != TokenType::Eof) {
-                switch (token.type()) {
-                    case TokenType::OParenthesis: {
-                        m_tokenizer.pushToken(token);
-                        Model::Face* face = parseFace(worldBounds, forceIntegerFacePoints);
-                        if (face != NULL)
-                            faces.push_back(face);
-                        break;
-                    }
-                    case TokenType::CBrace: {
-                        if (indicator != NULL) indicator->update(static_cast<int>(token.position()));
-                        
-                        try {
-                            Model::Brush* brush = new Model::Brush(worldBounds, forceIntegerFacePoints, faces);
-                            brush->setFilePosition(firstLine, token.line() - firstLine);
-                            if (!brush->closed())
-                                m_console.warn("Non-closed brush at line %i", firstLine);
-                            return brush;
-                        } catch (Model::GeometryException&) {
-                            m_console.warn("Invalid brush at line %i", firstLine);
-                            Utility::deleteAll(faces);
-                            return NULL;
-                        }
-                    }
-                    default: {
-                        Utility::deleteAll(faces);
-                        throw MapParserException(token, TokenType::OParenthesis | TokenType::CParenthesis);
-                    }
-                }
+            return createFace(worldBounds, forceIntegerFacePoints, record);
+        }
+        
+        bool MapParser::parseEntities(const BBoxf& worldBounds, bool forceIntegerFacePoints, Model::EntityList& entities) {
+            size_t oldSize = entities.size();
+            try {
+                Model::Entity* entity = NULL;
+                while ((entity = parseEntity(worldBounds, forceIntegerFacePoints, NULL)) != NULL)
+                    entities.push_back(entity);
+                return !entities.empty();
+            } catch (MapParserException&) {
+                Utility::deleteAll(entities, oldSize);
+                m_tokenizer.reset();
+                return false;
             }
-            
-            return NULL;
         }
         
-        Model::Face* MapParser::parseFace(const BBoxf& worldBounds, bool forceIntegerFacePoints) {
-            Vec3f p1, p2, p3;
-            float xOffset, yOffset, rotation, xScale, yScale;
+        bool MapParser::parseBrushes(const BBoxf& worldBounds, bool forceIntegerFacePoints, Model::BrushList& brushes) {
+            size_t oldSize = brushes.size();
+            try {
+                Model::Brush* brush = NULL;
+                while ((brush = parseBrush(worldBounds, forceIntegerFacePoints, NULL)) != NULL)
+                    brushes.push_back(brush);
+                return !brushes.empty();
+            } catch (MapParserException&) {
+                Utility::deleteAll(brushes, oldSize);
+                m_tokenizer.reset();
+                return false;
+            }
+        }
+        
+        bool MapParser::parseFaces(const BBoxf& worldBounds, bool forceIntegerFacePoints, Model::FaceList& faces) {
+            size_t oldSize = faces.size();
+            try {
+                Model::Face* face = NULL;
+                while ((face = parseFace(worldBounds, forceIntegerFacePoints)) != NULL)
+                    faces.push_back(face);
+                return !faces.empty();
+            } catch (MapParserException&) {
+                Utility::deleteAll(faces, oldSize);
+                m_tokenizer.reset();
+                return false;
+            }
+        }
+
+        bool MapParser::parseFaceRecord(MapFaceRecord& record) {
             Token token = m_tokenizer.nextToken();
             if (token.type() == TokenType::Eof)
-                return NULL;
+                return false;
             
             expect(TokenType::OParenthesis, token);
-            p1 = parseVector().corrected();
+            record.points[0] = parseVector().corrected();
             expect(TokenType::CParenthesis, token = m_tokenizer.nextToken());
             expect(TokenType::OParenthesis, token = m_tokenizer.nextToken());
-            p2 = parseVector().corrected();
+            record.points[1] = parseVector().corrected();
             expect(TokenType::CParenthesis, token = m_tokenizer.nextToken());
             expect(TokenType::OParenthesis, token = m_tokenizer.nextToken());
-            p3 = parseVector().corrected();
+            record.points[2] = parseVector().corrected();
             expect(TokenType::CParenthesis, token = m_tokenizer.nextToken());
 		
-            String textureName;
             token = m_tokenizer.nextToken();
             if (token.type() == TokenType::OBrace) { // Alpha-mask textures start with a { character, which will be its own token
                 expect(TokenType::String, token = m_tokenizer.nextToken());
-                textureName = "{" + token.data();
+                record.textureName = "{" + token.data();
             } else {
                 expect(TokenType::String, token);
-                textureName = token.data();
+                record.textureName = token.data();
             }
             
             token = m_tokenizer.nextToken();
             if (m_format == Undefined) {
                 expect(TokenType::Integer | TokenType::Decimal | TokenType::OBracket, token);
                 m_format = token.type() == TokenType::OBracket ? Valve : Standard;
-                if (m_format == Valve)
-                    m_console.warn("Loading unsupported map Valve 220 map format");
             }
             
             if (m_format == Standard) {
                 expect(TokenType::Integer | TokenType::Decimal, token);
-                xOffset = token.toFloat();
+                record.xOffset = token.toFloat();
                 expect(TokenType::Integer | TokenType::Decimal, token = m_tokenizer.nextToken());
-                yOffset = token.toFloat();
+                record.yOffset = token.toFloat();
             } else { // Valve 220 format
                 expect(TokenType::OBracket, token);
                 expect(TokenType::Integer | TokenType::Decimal, token = m_tokenizer.nextToken()); // X texture axis x
                 expect(TokenType::Integer | TokenType::Decimal, token = m_tokenizer.nextToken()); // X texture axis y
                 expect(TokenType::Integer | TokenType::Decimal, token = m_tokenizer.nextToken()); // X texture axis z
                 expect(TokenType::Integer | TokenType::Decimal, token = m_tokenizer.nextToken()); // X texture axis offset
-                xOffset = token.toFloat();
+                record.xOffset = token.toFloat();
                 expect(TokenType::CBracket, token = m_tokenizer.nextToken());
                 expect(TokenType::OBracket, token = m_tokenizer.nextToken());
                 expect(TokenType::Integer | TokenType::Decimal, token = m_tokenizer.nextToken()); // Y texture axis x
                 expect(TokenType::Integer | TokenType::Decimal, token = m_tokenizer.nextToken()); // Y texture axis y
                 expect(TokenType::Integer | TokenType::Decimal, token = m_tokenizer.nextToken()); // Y texture axis z
                 expect(TokenType::Integer | TokenType::Decimal, token = m_tokenizer.nextToken()); // Y texture axis offset
-                yOffset = token.toFloat();
+                record.yOffset = token.toFloat();
                 expect(TokenType::CBracket, token = m_tokenizer.nextToken());
             }
             
             expect(TokenType::Integer | TokenType::Decimal, token = m_tokenizer.nextToken());
-            rotation = token.toFloat();
+            record.rotation = token.toFloat();
             expect(TokenType::Integer | TokenType::Decimal, token = m_tokenizer.nextToken());
-            xScale = token.toFloat();
+            record.xScale = token.toFloat();
             expect(TokenType::Integer | TokenType::Decimal, token = m_tokenizer.nextToken());
-            yScale = token.toFloat();
+            record.yScale = token.toFloat();
+            record.line = token.line();
+            record.valveFormat = m_format == Valve;
+            
+            return true;
+        }
+
+        bool MapParser::parseBrushRecord(MapBrushRecord& record) {
+            Token token = m_tokenizer.nextToken();
+            if (token.type() == TokenType::Eof)
+                return false;
+            
+            expect(TokenType::OBrace | TokenType::CBrace, token);
+            if (token.type() == TokenType::CBrace)
+                return false;
+            
+            record.firstLine = token.line();
+            record.faces.clear();
             
+            while ((token = m_tokenizer.nextToken()).type() != TokenType::Eof) {
+                switch (token.type()) {
+                    case TokenType::OParenthesis: {
+                        m_tokenizer.pushToken(token);
+                        record.faces.push_back(MapFaceRecord());
+                        parseFaceRecord(record.faces.back());
+                        break;
+                    }
+                    case TokenType::CBrace: {
+                        record.lineCount = token.line() - record.firstLine;
+                        record.endPosition = token.position();
+                        return true;
+                    }
+                    default:
+                        throw MapParserException(token, TokenType::OParenthesis | TokenType::CBrace);
+                }
+            }
+            
+            throw MapParserException();
+        }
+
+        void MapParser::parseProperties(Model::PropertyList& properties) {
+            Token token;
+            while ((token = m_tokenizer.nextToken()).type() != TokenType::Eof) {
+                switch (token.type()) {
+                    case TokenType::String: {
+                        const String key = token.data();
+                        expect(TokenType::String, token = m_tokenizer.nextToken());
+                        properties.push_back(Model::Property(key, token.data()));
+                        break;
+                    }
+                    case TokenType::OBrace:
+                    case TokenType::CBrace:
+                        // the braces that delimit the entity
+                        break;
+                    default:
+                        throw MapParserException(token, TokenType::String | TokenType::OBrace | TokenType::CBrace);
+                }
+            }
+        }
+
+        Model::Face* MapParser::createFace(const BBoxf& worldBounds, bool forceIntegerFacePoints, const MapFaceRecord& record) {
+            if (record.valveFormat && !m_valveFormatReported) {
+                m_console.warn("Loading unsupported map Valve 220 map format");
+                m_valveFormatReported = true;
+            }
+            
+            const Vec3f& p1 = record.points[0];
+            const Vec3f& p2 = record.points[1];
+            const Vec3f& p3 = record.points[2];
             if (crossed(p3 - p1, p2 - p1).null()) {
-                m_console.warn("Skipping face with colinear points in line %i", token.line());
+                m_console.warn("Skipping face with colinear points in line %i", record.line);
                 return NULL;
             }
             
-            if (textureName == Model::Texture::Empty)
-                textureName = "";
+            const String textureName = record.textureName == Model::Texture::Empty ? "" : record.textureName;
             
             Model::Face* face = new Model::Face(worldBounds, forceIntegerFacePoints, p1, p2, p3, textureName);
-            face->setXOffset(xOffset);
-            face->setYOffset(yOffset);
-            face->setRotation(rotation);
-            face->setXScale(xScale);
-            face->setYScale(yScale);
-            face->setFilePosition(token.line());
+            face->setXOffset(record.xOffset);
+            face->setYOffset(record.yOffset);
+            face->setRotation(record.rotation);
+            face->setXScale(record.xScale);
+            face->setYScale(record.yScale);
+            face->setFilePosition(record.line);
             
             return face;
         }
-        
-        bool MapParser::parseEntities(const BBoxf& worldBounds, bool forceIntegerFacePoints, Model::EntityList& entities) {
-            size_t oldSize = entities.size();
-            try {
-                Model::Entity* entity = NULL;
-                while ((entity = parseEntity(worldBounds, forceIntegerFacePoints, NULL)) != NULL)
-                    entities.push_back(entity);
-                return !entities.empty();
-            } catch (MapParserException&) {
-                Utility::deleteAll(entities, oldSize);
-                m_tokenizer.reset();
-                return false;
+
+        void MapParser::createFaces(const BBoxf& worldBounds, bool forceIntegerFacePoints, const MapBrushRecord& record, Model::FaceList& faces) {
+            faces.reserve(record.faces.size());
+            
+            MapFaceRecord::List::const_iterator it, end;
+            for (it = record.faces.begin(), end = record.faces.end(); it != end; ++it) {
+                Model::Face* face = createFace(worldBounds, forceIntegerFacePoints, *it);
+                if (face != NULL)
+                    faces.push_back(face);
             }
         }
-        
-        bool MapParser::parseBrushes(const BBoxf& worldBounds, bool forceIntegerFacePoints, Model::BrushList& brushes) {
-            size_t oldSize = brushes.size();
+
+        Model::Brush* MapParser::createBrush(const BBoxf& worldBounds, bool forceIntegerFacePoints, const MapBrushRecord& record) {
+            Model::FaceList faces;
+            createFaces(worldBounds, forceIntegerFacePoints, record, faces);
+            
             try {
-                Model::Brush* brush = NULL;
-                while ((brush = parseBrush(worldBounds, forceIntegerFacePoints, NULL)) != NULL)
-                    brushes.push_back(brush);
-                return !brushes.empty();
-            } catch (MapParserException&) {
-                Utility::deleteAll(brushes, oldSize);
-                m_tokenizer.reset();
-                return false;
+                Model::Brush* brush = new Model::Brush(worldBounds, forceIntegerFacePoints, faces);
+                brush->setFilePosition(record.firstLine, record.lineCount);
+                if (!brush->closed())
+                    m_console.warn("Non-closed brush at line %i", record.firstLine);
+                return brush;
+            } catch (Model::GeometryException&) {
+                m_console.warn("Invalid brush at line %i", record.firstLine);
+                Utility::deleteAll(faces);
+                return NULL;
             }
         }
-        
-        bool MapParser::parseFaces(const BBoxf& worldBounds, bool forceIntegerFacePoints, Model::FaceList& faces) {
-            size_t oldSize = faces.size();
+
+        Model::Brush* MapParser::createBrush(const BBoxf& worldBounds, bool forceIntegerFacePoints, const MapBrushRecord& record, Model::BrushRebuildScope& rebuildScope) {
+            Model::FaceList faces;
+            createFaces(worldBounds, forceIntegerFacePoints, record, faces);
+
+            Model::Brush* brush = new Model::Brush(worldBounds, forceIntegerFacePoints, faces, rebuildScope);
+            brush->setFilePosition(record.firstLine, record.lineCount);
+            return brush;
+        }
+
+        wxThread::ExitCode MapBrushBlockParser::Entry() {
+            parse();
+            return (wxThread::ExitCode)0;
+        }
+
+        MapBrushBlockParser::MapBrushBlockParser(MapBrushBlock::List& blocks, size_t& nextBlock, wxCriticalSection& lock, Utility::Console& console) :
+        wxThread(wxTHREAD_JOINABLE),
+        m_blocks(blocks),
+        m_nextBlock(nextBlock),
+        m_lock(lock),
+        m_console(console) {}
+
+        void MapBrushBlockParser::parse() {
+            while (true) {
+                size_t index;
+                {
+                    wxCriticalSectionLocker locker(m_lock);
+                    if (m_nextBlock == m_blocks.size())
+                        return;
+                    index = m_nextBlock++;
+                }
+                parseBlock(m_blocks[index], m_console);
+            }
+        }
+
+        void MapBrushBlockParser::parseBlock(MapBrushBlock& block, Utility::Console& console) {
             try {
-                Model::Face* face = NULL;
-                while ((face = parseFace(worldBounds, forceIntegerFacePoints)) != NULL)
-                    faces.push_back(face);
-                return !faces.empty();
-            } catch (MapParserException&) {
-                Utility::deleteAll(faces, oldSize);
-                m_tokenizer.reset();
-                return false;
+                MapParser parser(block.begin, block.end, console, block.line);
+                if (!parser.parseBrushRecord(block.record))
+                    throw MapParserException();
+            } catch (MapParserException& e) {
+                block.error = e.what();
             }
         }
     }
@@ -23,6 +23,7 @@
 #include "IO/ByteBuffer.h"
 #include "IO/StreamTokenizer.h"
 #include "Model/BrushTypes.h"
+#include "Model/EntityProperty.h"
 #include "Model/EntityTypes.h"
 #include "Model/FaceTypes.h"
 #include "Utility/MessageException.h"
@@ -31,12 +32,15 @@
 #include <memory>
 #include <vector>
 
+#include <wx/thread.h>
+
 using namespace TrenchBroom::VecMath;
 
 namespace TrenchBroom {
     namespace Model {
         class Brush;
         class BrushGeometry;
+        class BrushRebuildScope;
         class Entity;
         class Face;
         class Map;
@@ -126,6 +130,68 @@ namespace TrenchBroom {
             MapParserException(const Token& token, unsigned int expectedType) : MessageException(buildMessage(token, expectedType)) {}
         };
 
+        // the tokens of a face, created into a face on the main thread because the texture name table is not thread safe
+        struct MapFaceRecord {
+            typedef std::vector<MapFaceRecord> List;
+
+            Vec3f points[3];
+            String textureName;
+            float xOffset;
+            float yOffset;
+            float rotation;
+            float xScale;
+            float yScale;
+            size_t line;
+            bool valveFormat;
+        };
+
+        struct MapBrushRecord {
+            MapFaceRecord::List faces;
+            size_t firstLine;
+            size_t lineCount;
+            size_t endPosition;
+        };
+
+        struct MapBrushBlock {
+            typedef std::vector<MapBrushBlock> List;
+
+            const char* begin;
+            const char* end;
+            size_t line;
+            size_t endLine;
+            MapBrushRecord record;
+            String error;
+
+            MapBrushBlock(const char* i_begin, const size_t i_line) :
+            begin(i_begin),
+            end(i_begin),
+            line(i_line),
+            endLine(i_line) {}
+        };
+
+        struct MapEntityBlock {
+            typedef std::vector<MapEntityBlock> List;
+
+            const char* begin;
+            const char* end;
+            size_t line;
+            size_t endLine;
+            size_t firstBrush;
+            size_t brushCount;
+            bool closed;
+            Model::PropertyList properties;
+            String error;
+
+            MapEntityBlock(const char* i_begin, const size_t i_line, const size_t i_firstBrush) :
+            begin(i_begin),
+            end(i_begin),
+            line(i_line),
+            endLine(i_line),
+            firstBrush(i_firstBrush),
+            brushCount(0),
+            closed(false) {}
+        };
+
         class MapParser {
         private:
             enum MapFormat {
@@ -139,11 +205,16 @@ namespace TrenchBroom {
                 Float,
                 Unknown
             };
+
+            static const size_t MinBlocksPerThread = 32;
             
             Utility::Console& m_console;
+            const char* m_begin;
+            const char* m_end;
             StreamTokenizer<MapTokenEmitter> m_tokenizer;
             MapFormat m_format;
             size_t m_size;
+            bool m_valveFormatReported;
 
             inline void expect(unsigned int expectedType, const Token& actualToken) const {
                 if ((actualToken.type() & expectedType) == 0)
@@ -153,10 +224,17 @@ namespace TrenchBroom {
             Vec3f parseVector();
 
             Model::Entity* parseEntity(const BBoxf& worldBounds, FacePointFormat& facePointFormat, Utility::ProgressIndicator* indicator);
+            void createFaces(const BBoxf& worldBounds, bool forceIntegerFacePoints, const MapBrushRecord& record, Model::FaceList& faces);
         public:
-            MapParser(const char* begin, const char* end, Utility::Console& console);
+            MapParser(const char* begin, const char* end, Utility::Console& console, const size_t firstLine = 1);
             MapParser(const String& str, Utility::Console& console);
+
+            // Finds the entity and brush blocks of a file by tracking the braces outside of quoted strings and comments.
+            static void splitEntityBlocks(const char* begin, const char* end, MapEntityBlock::List& entities, MapBrushBlock::List& brushes);
             
+            // Splits the file into its entity and brush blocks. The brushes are tokenized and their geometries are built
+            // in parallel, but all objects are created on the calling thread. Malformed entities and brushes are
+            // reported and skipped.
             void parseMap(Model::Map& map, Utility::ProgressIndicator* indicator);
             Model::Entity* parseEntity(const BBoxf& worldBounds, bool forceIntegerFacePoints, Utility::ProgressIndicator* indicator);
             Model::Brush* parseBrush(const BBoxf& worldBounds, bool forceIntegerFacePoints, Utility::ProgressIndicator* indicator);
@@ -165,8 +243,34 @@ namespace TrenchBroom {
             bool parseEntities(const BBoxf& worldBounds, bool forceIntegerFacePoints, Model::EntityList& entities);
             bool parseBrushes(const BBoxf& worldBounds, bool forceIntegerFacePoints, Model::BrushList& brushes);
             bool parseFaces(const BBoxf& worldBounds, bool forceIntegerFacePoints, Model::FaceList& faces);
+
+            // these only read tokens and never write to the console, so they can be used from any thread
+            bool parseFaceRecord(MapFaceRecord& record);
+            bool parseBrushRecord(MapBrushRecord& record);
+            void parseProperties(Model::PropertyList& properties);
+
+            Model::Face* createFace(const BBoxf& worldBounds, bool forceIntegerFacePoints, const MapFaceRecord& record);
+            Model::Brush* createBrush(const BBoxf& worldBounds, bool forceIntegerFacePoints, const MapBrushRecord& record);
+            // the geometry of the returned brush is built by the given scope
+            Model::Brush* createBrush(const BBoxf& worldBounds, bool forceIntegerFacePoints, const MapBrushRecord& record, Model::BrushRebuildScope& rebuildScope);
         };
 
+        class MapBrushBlockParser : public wxThread {
+        private:
+            MapBrushBlock::List& m_blocks;
+            size_t& m_nextBlock;
+            wxCriticalSection& m_lock;
+            Utility::Console& m_console;
+
+            ExitCode Entry();
+        public:
+            MapBrushBlockParser(MapBrushBlock::List& blocks, size_t& nextBlock, wxCriticalSection& lock, Utility::Console& console);
+
+            // parses the blocks until none are left
+            void parse();
+
+            static void parseBlock(MapBrushBlock& block, Utility::Console& console);
+        };
     }
 }
 
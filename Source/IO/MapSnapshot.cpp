@@ -0,0 +1,64 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "MapSnapshot.h"
+
+#include "Model/Brush.h"
+#include "Model/Entity.h"
+#include "Model/Face.h"
+#include "Model/Map.h"
+#include "Model/Texture.h"
+
+namespace TrenchBroom {
+    namespace IO {
+        MapSnapshot::FaceSnapshot::FaceSnapshot(const Model::Face& face) :
+        textureName(Utility::isBlank(face.textureName()) ? Model::Texture::Empty : face.textureName()),
+        xOffset(face.xOffset()),
+        yOffset(face.yOffset()),
+        rotation(face.rotation()),
+        xScale(face.xScale()),
+        yScale(face.yScale()) {
+            for (size_t i = 0; i < 3; i++)
+                points[i] = face.point(i);
+        }
+
+        MapSnapshot::MapSnapshot(const Model::Map& map) {
+            const Model::EntityList& entities = map.entities();
+            m_entities.resize(entities.size());
+
+            for (size_t i = 0; i < entities.size(); i++) {
+                const Model::Entity& entity = *entities[i];
+                EntitySnapshot& entitySnapshot = m_entities[i];
+                entitySnapshot.properties = entity.properties();
+
+                const Model::BrushList& brushes = entity.brushes();
+                entitySnapshot.brushes.resize(brushes.size());
+                for (size_t j = 0; j < brushes.size(); j++) {
+                    const Model::FaceList& faces = brushes[j]->faces();
+                    FaceSnapshotList& faceSnapshots = entitySnapshot.brushes[j].faces;
+                    faceSnapshots.reserve(faces.size());
+
+                    Model::FaceList::const_iterator faceIt, faceEnd;
+                    for (faceIt = faces.begin(), faceEnd = faces.end(); faceIt != faceEnd; ++faceIt)
+                        faceSnapshots.push_back(FaceSnapshot(**faceIt));
+                }
+            }
+        }
+    }
+}
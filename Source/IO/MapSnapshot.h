@@ -0,0 +1,83 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __TrenchBroom__MapSnapshot__
+#define __TrenchBroom__MapSnapshot__
+
+#include "Model/EntityProperty.h"
+#include "Utility/String.h"
+#include "Utility/VecMath.h"
+
+#include <vector>
+
+using namespace TrenchBroom::VecMath;
+
+namespace TrenchBroom {
+    namespace Model {
+        class Brush;
+        class Entity;
+        class Face;
+        class Map;
+    }
+
+    namespace IO {
+        // An immutable copy of everything MapWriter needs, so that a map can be written without touching the
+        // document, e.g. from a worker thread. Taking the snapshot is still a full copy on the calling thread;
+        // only the formatting and the file I/O are moved off it.
+        class MapSnapshot {
+        public:
+            struct FaceSnapshot {
+                Vec3f points[3];
+                String textureName;
+                float xOffset;
+                float yOffset;
+                float rotation;
+                float xScale;
+                float yScale;
+
+                FaceSnapshot(const Model::Face& face);
+            };
+
+            typedef std::vector<FaceSnapshot> FaceSnapshotList;
+
+            struct BrushSnapshot {
+                FaceSnapshotList faces;
+            };
+
+            typedef std::vector<BrushSnapshot> BrushSnapshotList;
+
+            struct EntitySnapshot {
+                Model::PropertyList properties;
+                BrushSnapshotList brushes;
+            };
+
+            typedef std::vector<EntitySnapshot> EntitySnapshotList;
+        private:
+            EntitySnapshotList m_entities;
+        public:
+            MapSnapshot(const Model::Map& map);
+
+            inline const EntitySnapshotList& entities() const {
+                return m_entities;
+            }
+        };
+    }
+}
+
+#endif /* defined(__TrenchBroom__MapSnapshot__) */
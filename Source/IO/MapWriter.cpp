@@ -26,34 +26,51 @@
 #include "Model/EntityDefinition.h"
 #include "Model/Face.h"
 #include "Model/Map.h"
+#include "IO/BinaryMapParser.h"
+#include "IO/ByteBuffer.h"
 #include "IO/FileManager.h"
 #include "IO/IOException.h"
 
 #include <cassert>
 #include <fstream>
 #include <limits>
+#include <map>
 
 namespace TrenchBroom {
     namespace IO {
-        size_t MapWriter::writeFace(Model::Face& face, const size_t lineNumber, FILE* stream) {
-            const String textureName = Utility::isBlank(face.textureName()) ? Model::Texture::Empty : face.textureName();
-
+        void MapWriter::writeFace(const MapSnapshot::FaceSnapshot& face, FILE* stream) {
             std::fprintf(stream, FaceFormat.c_str(),
-                    face.point(0).x(),
-                    face.point(0).y(),
-                    face.point(0).z(),
-                    face.point(1).x(),
-                    face.point(1).y(),
-                    face.point(1).z(),
-                    face.point(2).x(),
-                    face.point(2).y(),
-                    face.point(2).z(),
-                    textureName.c_str(),
-                    face.xOffset(),
-                    face.yOffset(),
-                    face.rotation(),
-                    face.xScale(),
-                    face.yScale());
+                    face.points[0].x(),
+                    face.points[0].y(),
+                    face.points[0].z(),
+                    face.points[1].x(),
+                    face.points[1].y(),
+                    face.points[1].z(),
+                    face.points[2].x(),
+                    face.points[2].y(),
+                    face.points[2].z(),
+                    face.textureName.c_str(),
+                    face.xOffset,
+                    face.yOffset,
+                    face.rotation,
+                    face.xScale,
+                    face.yScale);
+        }
+        
+        size_t MapWriter::writeEntityHeader(const Model::PropertyList& properties, FILE* stream) {
+            size_t lineCount = 0;
+            std::fprintf(stream, "{\n"); lineCount++;
+            
+            Model::PropertyList::const_iterator it, end;
+            for (it = properties.begin(), end = properties.end(); it != end; ++it) {
+                const Model::Property& property = *it;
+                std::fprintf(stream, "\"%s\" \"%s\"\n", property.key().c_str(), property.value().c_str()); lineCount++;
+            }
+            return lineCount;
+        }
+        
+        size_t MapWriter::writeFace(Model::Face& face, const size_t lineNumber, FILE* stream) {
+            writeFace(MapSnapshot::FaceSnapshot(face), stream);
             face.setFilePosition(lineNumber);
             return 1;
         }
@@ -71,26 +88,13 @@ namespace TrenchBroom {
             return lineCount;
         }
         
-        size_t MapWriter::writeEntityHeader(Model::Entity& entity, FILE* stream) {
-            size_t lineCount = 0;
-            std::fprintf(stream, "{\n"); lineCount++;
-            
-            const Model::PropertyList& properties = entity.properties();
-            Model::PropertyList::const_iterator it, end;
-            for (it = properties.begin(), end = properties.end(); it != end; ++it) {
-                const Model::Property& property = *it;
-                std::fprintf(stream, "\"%s\" \"%s\"\n", property.key().c_str(), property.value().c_str()); lineCount++;
-            }
-            return lineCount;
-        }
-        
         size_t MapWriter::writeEntityFooter(FILE* stream) {
             std::fprintf(stream, "}\n");
             return 1;
         }
         
         size_t MapWriter::writeEntity(Model::Entity& entity, const size_t lineNumber, FILE* stream) {
-            size_t lineCount = writeEntityHeader(entity, stream);
+            size_t lineCount = writeEntityHeader(entity.properties(), stream);
             const Model::BrushList& brushes = entity.brushes();
             for (unsigned int i = 0; i < brushes.size(); i++)
                 lineCount += writeBrush(*brushes[i], lineNumber + lineCount, stream);
@@ -99,6 +103,25 @@ namespace TrenchBroom {
             return lineCount;
         }
 
+        void MapWriter::writeSnapshot(const MapSnapshot& snapshot, FILE* stream) {
+            const MapSnapshot::EntitySnapshotList& entities = snapshot.entities();
+            MapSnapshot::EntitySnapshotList::const_iterator entityIt, entityEnd;
+            for (entityIt = entities.begin(), entityEnd = entities.end(); entityIt != entityEnd; ++entityIt) {
+                const MapSnapshot::EntitySnapshot& entity = *entityIt;
+                writeEntityHeader(entity.properties, stream);
+
+                MapSnapshot::BrushSnapshotList::const_iterator brushIt, brushEnd;
+                for (brushIt = entity.brushes.begin(), brushEnd = entity.brushes.end(); brushIt != brushEnd; ++brushIt) {
+                    std::fprintf(stream, "{\n");
+                    MapSnapshot::FaceSnapshotList::const_iterator faceIt, faceEnd;
+                    for (faceIt = brushIt->faces.begin(), faceEnd = brushIt->faces.end(); faceIt != faceEnd; ++faceIt)
+                        writeFace(*faceIt, stream);
+                    std::fprintf(stream, "}\n");
+                }
+                writeEntityFooter(stream);
+            }
+        }
+
         void MapWriter::writeFace(const Model::Face& face, std::ostream& stream) {
             const String textureName = Utility::isBlank(face.textureName()) ? Model::Texture::Empty : face.textureName();
             
@@ -160,6 +183,93 @@ namespace TrenchBroom {
             writeEntityFooter(stream);
         }
 
+        void MapWriter::writeFace(const Model::Face& face, ByteBuffer& buffer) {
+            for (size_t i = 0; i < 3; i++) {
+                const Vec3f& point = face.point(i);
+                buffer << point.x();
+                buffer << point.y();
+                buffer << point.z();
+            }
+            buffer << face.textureName();
+            buffer << face.xOffset();
+            buffer << face.yOffset();
+            buffer << face.rotation();
+            buffer << face.xScale();
+            buffer << face.yScale();
+        }
+        
+        void MapWriter::writeBrush(const Model::Brush& brush, ByteBuffer& buffer) {
+            const Model::FaceList& faces = brush.faces();
+            buffer << static_cast<unsigned char>(brush.forceIntegerFacePoints() ? 1 : 0);
+            buffer << static_cast<unsigned int>(faces.size());
+            
+            Model::FaceList::const_iterator faceIt, faceEnd;
+            for (faceIt = faces.begin(), faceEnd = faces.end(); faceIt != faceEnd; ++faceIt)
+                writeFace(**faceIt, buffer);
+            
+            // the topology lets the parser skip rebuilding the geometry, but it can only be restored if every side
+            // belongs to one of the faces
+            if (!brush.closed()) {
+                buffer << static_cast<unsigned char>(0);
+                return;
+            }
+            buffer << static_cast<unsigned char>(1);
+            
+            typedef std::map<const Model::Vertex*, unsigned int> VertexIndexMap;
+            typedef std::map<const Model::Edge*, unsigned int> EdgeIndexMap;
+            typedef std::map<const Model::Side*, unsigned int> SideIndexMap;
+            VertexIndexMap vertexIndices;
+            EdgeIndexMap edgeIndices;
+            SideIndexMap sideIndices;
+            
+            const Model::VertexList& vertices = brush.vertices();
+            buffer << static_cast<unsigned int>(vertices.size());
+            for (unsigned int i = 0; i < vertices.size(); i++) {
+                const Vec3f& position = vertices[i]->position;
+                buffer << position.x();
+                buffer << position.y();
+                buffer << position.z();
+                vertexIndices[vertices[i]] = i;
+            }
+            
+            for (unsigned int i = 0; i < faces.size(); i++)
+                sideIndices[faces[i]->side()] = i;
+            
+            const Model::EdgeList& edges = brush.edges();
+            buffer << static_cast<unsigned int>(edges.size());
+            for (unsigned int i = 0; i < edges.size(); i++) {
+                const Model::Edge& edge = *edges[i];
+                buffer << vertexIndices[edge.start];
+                buffer << vertexIndices[edge.end];
+                buffer << sideIndices[edge.left];
+                buffer << sideIndices[edge.right];
+                edgeIndices[&edge] = i;
+            }
+            
+            for (faceIt = faces.begin(), faceEnd = faces.end(); faceIt != faceEnd; ++faceIt) {
+                const Model::EdgeList& sideEdges = (*faceIt)->side()->edges;
+                buffer << static_cast<unsigned int>(sideEdges.size());
+                for (unsigned int i = 0; i < sideEdges.size(); i++)
+                    buffer << edgeIndices[sideEdges[i]];
+            }
+        }
+        
+        void MapWriter::writeEntity(const Model::Entity& entity, const Model::BrushList& brushes, ByteBuffer& buffer) {
+            const Model::PropertyList& properties = entity.properties();
+            buffer << static_cast<unsigned int>(properties.size());
+            
+            Model::PropertyList::const_iterator propertyIt, propertyEnd;
+            for (propertyIt = properties.begin(), propertyEnd = properties.end(); propertyIt != propertyEnd; ++propertyIt) {
+                buffer << propertyIt->key();
+                buffer << propertyIt->value();
+            }
+            
+            buffer << static_cast<unsigned int>(brushes.size());
+            Model::BrushList::const_iterator brushIt, brushEnd;
+            for (brushIt = brushes.begin(), brushEnd = brushes.end(); brushIt != brushEnd; ++brushIt)
+                writeBrush(**brushIt, buffer);
+        }
+        
         MapWriter::MapWriter() {
             StringStream str;
             str <<
@@ -236,6 +346,54 @@ namespace TrenchBroom {
                 writeFace(*faces[i], stream);
         }
 
+        void MapWriter::writeObjectsToBuffer(const Model::EntityList& pointEntities, const Model::BrushList& brushes, ByteBuffer& buffer) {
+            Model::Entity* worldspawn = NULL;
+            
+            // group the brushes by their containing entities like writeObjectsToStream does
+            typedef std::map<Model::Entity*, Model::BrushList> EntityBrushMap;
+            EntityBrushMap entityToBrushes;
+            
+            Model::BrushList::const_iterator brushIt, brushEnd;
+            for (brushIt = brushes.begin(), brushEnd = brushes.end(); brushIt != brushEnd; ++brushIt) {
+                Model::Brush& brush = **brushIt;
+                Model::Entity& entity = *brush.entity();
+                entityToBrushes[&entity].push_back(&brush);
+                if (entity.worldspawn())
+                    worldspawn = &entity;
+            }
+            
+            buffer << BinaryMapParser::Magic;
+            buffer << BinaryMapParser::Version;
+            buffer << static_cast<unsigned int>(BinaryMapParser::ObjectContents);
+            buffer << static_cast<unsigned int>(pointEntities.size() + entityToBrushes.size());
+            
+            if (worldspawn != NULL)
+                writeEntity(*worldspawn, entityToBrushes[worldspawn], buffer);
+            
+            Model::EntityList::const_iterator entityIt, entityEnd;
+            for (entityIt = pointEntities.begin(), entityEnd = pointEntities.end(); entityIt != entityEnd; ++entityIt) {
+                Model::Entity& entity = **entityIt;
+                writeEntity(entity, entity.brushes(), buffer);
+            }
+            
+            EntityBrushMap::iterator it, end;
+            for (it = entityToBrushes.begin(), end = entityToBrushes.end(); it != end; ++it) {
+                if (it->first != worldspawn)
+                    writeEntity(*it->first, it->second, buffer);
+            }
+        }
+        
+        void MapWriter::writeFacesToBuffer(const Model::FaceList& faces, ByteBuffer& buffer) {
+            buffer << BinaryMapParser::Magic;
+            buffer << BinaryMapParser::Version;
+            buffer << static_cast<unsigned int>(BinaryMapParser::FaceContents);
+            buffer << static_cast<unsigned int>(faces.size());
+            
+            Model::FaceList::const_iterator it, end;
+            for (it = faces.begin(), end = faces.end(); it != end; ++it)
+                writeFace(**it, buffer);
+        }
+        
         void MapWriter::writeToStream(const Model::Map& map, std::ostream& stream) {
             assert(stream.good());
             stream.unsetf(std::ios::floatfield);
@@ -245,6 +403,19 @@ namespace TrenchBroom {
                 writeEntity(*entities[i], stream);
         }
         
+        void MapWriter::closeAndReplace(FILE* stream, const String& tempPath, const String& path) {
+            bool success = ferror(stream) == 0;
+            // the buffered contents are only flushed here, e.g. when the disk is full
+            if (fclose(stream) != 0)
+                success = false;
+            
+            FileManager fileManager;
+            if (!success || !fileManager.moveFile(tempPath, path, true)) {
+                fileManager.deleteFile(tempPath);
+                throw IOException("Unable to write file %s", path.c_str());
+            }
+        }
+        
         void MapWriter::writeToFileAtPath(Model::Map& map, const String& path, bool overwrite) {
             FileManager fileManager;
             if (fileManager.exists(path) && !overwrite)
@@ -254,16 +425,27 @@ namespace TrenchBroom {
             if (!fileManager.exists(directoryPath))
                 fileManager.makeDirectory(directoryPath);
             
-            FILE* stream = fopen(path.c_str(), "w");
+            const String tempPath = path + ".tmp";
+            FILE* stream = fopen(tempPath.c_str(), "w");
             if (stream == NULL)
-                throw IOException::openError(path);
+                throw IOException::openError(tempPath);
             // std::fstream stream(path.c_str(), std::ios::out | std::ios::trunc);
 
             size_t lineNumber = 1;
             const Model::EntityList& entities = map.entities();
             for (unsigned int i = 0; i < entities.size(); i++)
                 lineNumber += writeEntity(*entities[i], lineNumber, stream);
-            fclose(stream);
+            closeAndReplace(stream, tempPath, path);
+        }
+        
+        void MapWriter::writeToFileAtPath(const MapSnapshot& snapshot, const String& path) {
+            const String tempPath = path + ".tmp";
+            FILE* stream = fopen(tempPath.c_str(), "w");
+            if (stream == NULL)
+                throw IOException::openError(tempPath);
+            
+            writeSnapshot(snapshot, stream);
+            closeAndReplace(stream, tempPath, path);
         }
     }
 }
@@ -20,6 +20,7 @@
 #ifndef TrenchBroom_MapWriter_h
 #define TrenchBroom_MapWriter_h
 
+#include "IO/MapSnapshot.h"
 #include "Model/EntityTypes.h"
 #include "Model/BrushTypes.h"
 #include "Model/FaceTypes.h"
@@ -43,28 +44,45 @@ namespace TrenchBroom {
     }
     
     namespace IO {
+        class ByteBuffer;
+
         class MapWriter {
         private:
             static const int FloatPrecision = 100;
             String FaceFormat;
         protected:
+            // the document and its snapshots are formatted by the same functions
+            void writeFace(const MapSnapshot::FaceSnapshot& face, FILE* stream);
+            size_t writeEntityHeader(const Model::PropertyList& properties, FILE* stream);
+
             size_t writeFace(Model::Face& face, const size_t lineNumber, FILE* stream);
             size_t writeBrush(Model::Brush& brush, const size_t lineNumber, FILE* stream);
-            size_t writeEntityHeader(Model::Entity& entity, FILE* stream);
             size_t writeEntityFooter(FILE* stream);
             size_t writeEntity(Model::Entity& entity, const size_t lineNumber, FILE* stream);
+            void writeSnapshot(const MapSnapshot& snapshot, FILE* stream);
             
             void writeFace(const Model::Face& face, std::ostream& stream);
             void writeBrush(const Model::Brush& brush, std::ostream& stream);
             void writeEntityHeader(const Model::Entity& entity, std::ostream& stream);
             void writeEntityFooter(std::ostream& stream);
             void writeEntity(const Model::Entity& entity, std::ostream& stream);
+            
+            void writeFace(const Model::Face& face, ByteBuffer& buffer);
+            void writeBrush(const Model::Brush& brush, ByteBuffer& buffer);
+            void writeEntity(const Model::Entity& entity, const Model::BrushList& brushes, ByteBuffer& buffer);
+            
+            // closes the stream and replaces the file at the given path only if the whole file was written
+            void closeAndReplace(FILE* stream, const String& tempPath, const String& path);
         public:
             MapWriter();
             void writeObjectsToStream(const Model::EntityList& pointEntities, const Model::BrushList& brushes, std::ostream& stream);
             void writeFacesToStream(const Model::FaceList& faces, std::ostream& stream);
+            // writes the binary clipboard format read by BinaryMapParser
+            void writeObjectsToBuffer(const Model::EntityList& pointEntities, const Model::BrushList& brushes, ByteBuffer& buffer);
+            void writeFacesToBuffer(const Model::FaceList& faces, ByteBuffer& buffer);
             void writeToStream(const Model::Map& map, std::ostream& stream);
             void writeToFileAtPath(Model::Map& map, const String& path, bool overwrite);
+            void writeToFileAtPath(const MapSnapshot& snapshot, const String& path);
         };
     }
 }
@@ -25,7 +25,6 @@
 #include "Utility/String.h"
 
 #include <map>
-#include <vector>
 
 #ifdef _MSC_VER
 #include <cstdint>
@@ -49,9 +48,9 @@ namespace TrenchBroom {
         public:
             PakEntry() {}
 
-            PakEntry(const String& name, char* begin, char* end) :
+            PakEntry(const String& name, MappedFile::Ptr file, char* begin, char* end) :
             m_name(name),
-            m_view(MappedFile::Ptr(new MappedFile(begin, end))) {}
+            m_view(MappedFile::Ptr(new MappedFileView(file, begin, end))) {}
 
             inline const String& name() const {
                 return m_name;
@@ -63,9 +62,9 @@ namespace TrenchBroom {
         };
 
         class Pak {
-        private:
+        public:
             typedef std::map<String, PakEntry> PakDirectory;
-
+        private:
             String m_path;
             MappedFile::Ptr m_file;
             PakDirectory m_directory;
@@ -76,27 +75,11 @@ namespace TrenchBroom {
                 return m_path;
             }
 
-            MappedFile::Ptr entry(const String& name);
-        };
-
-        class ComparePaksByPath {
-        public:
-            inline bool operator() (const Pak& left, const Pak& right) const {
-                return left.path() < right.path();
+            inline const PakDirectory& directory() const {
+                return m_directory;
             }
-        };
-
-        class PakManager {
-        private:
-            typedef std::vector<Pak> PakList;
-            typedef std::map<String, PakList> PakMap;
 
-            PakMap m_paks;
-            bool findPaks(const String& path, PakList& result);
-        public:
-            static PakManager* sharedManager;
-
-            MappedFile::Ptr entry(const String& name, const String& searchPath);
+            MappedFile::Ptr entry(const String& name);
         };
     }
 }
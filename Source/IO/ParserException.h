@@ -34,6 +34,7 @@ namespace TrenchBroom {
             }
         public:
             ParserException(size_t line, size_t column, const String& message) throw() : MessageException(buildMessage(line, column, message)) {}
+            ParserException(const String& message) throw() : MessageException(message) {}
         };
     }
 }
@@ -109,6 +109,7 @@ namespace TrenchBroom {
             const char* m_begin;
             const char* m_end;
             const char* m_cur;
+            size_t m_firstLine;
             size_t m_line;
             size_t m_column;
             size_t m_lastColumn;
@@ -123,11 +124,12 @@ namespace TrenchBroom {
                 return token;
             }
         public:
-            StreamTokenizer(const char* begin, const char* end) :
+            StreamTokenizer(const char* begin, const char* end, const size_t firstLine = 1) :
             m_begin(begin),
             m_end(end),
             m_cur(begin),
-            m_line(1),
+            m_firstLine(firstLine),
+            m_line(firstLine),
             m_column(1),
             m_lastColumn(0) {}
 
@@ -221,7 +223,7 @@ namespace TrenchBroom {
             }
 
             inline void reset() {
-                m_line = 1;
+                m_line = m_firstLine;
                 m_column = 1;
                 m_cur = m_begin;
             }
@@ -144,10 +144,11 @@ namespace TrenchBroom {
             Utility::deleteAll(m_triangles);
         }
 
-        Alias::Alias(const String& name, char* begin, char* end) :
+        Alias::Alias(const String& name, IO::MappedFile::Ptr file) :
         m_name(name) {
             using namespace IO;
             
+            char* begin = file->begin();
             char* cursor = begin + AliasLayout::HeaderScale;
             Vec3f scale = readVec3f(cursor);
             Vec3f origin = readVec3f(cursor);
@@ -242,9 +243,13 @@ namespace TrenchBroom {
 
         AliasManager* AliasManager::sharedManager = NULL;
 
+        static String aliasKey(const String& name, const StringList& paths) {
+            return Utility::join(paths, ",") + ":" + name;
+        }
+
         Alias const * const AliasManager::alias(const String& name, const StringList& paths, Utility::Console& console) {
             String pathList = Utility::join(paths, ",");
-            String key = pathList + ":" + name;
+            String key = aliasKey(name, paths);
 
             AliasMap::iterator it = m_aliases.find(key);
             if (it != m_aliases.end())
@@ -254,7 +259,7 @@ namespace TrenchBroom {
 
             IO::MappedFile::Ptr file = IO::findGameFile(name, paths);
             if (file.get() != NULL) {
-                Alias* alias = new Alias(name, file->begin(), file->end());
+                Alias* alias = new Alias(name, file);
                 m_aliases[key] = alias;
                 return alias;
             }
@@ -263,9 +268,49 @@ namespace TrenchBroom {
             return NULL;
         }
 
-        AliasManager::AliasManager() {}
+        bool AliasManager::loadAlias(const String& name, const StringList& paths, Utility::Console& console) {
+            String key = aliasKey(name, paths);
+            if (m_aliases.count(key) > 0 || m_loader->loading(key))
+                return true;
+            
+            console.info("Loading '%s' (searching %s)", name.c_str(), Utility::join(paths, ",").c_str());
+            
+            IO::MappedFile::Ptr file = IO::findGameFile(name, paths);
+            if (file.get() == NULL) {
+                console.warn("Unable to find MDL '%s'", name.c_str());
+                return false;
+            }
+            
+            if (!m_loader->load(key, name, file))
+                m_aliases[key] = new Alias(name, file);
+            return true;
+        }
+        
+        bool AliasManager::loading(const String& name, const StringList& paths) {
+            return m_loader->loading(aliasKey(name, paths));
+        }
+        
+        void AliasManager::collectLoadedAliases(Utility::Console& console) {
+            EntityModelLoader<Alias>::ResultList results;
+            m_loader->collect(results);
+            
+            EntityModelLoader<Alias>::ResultList::const_iterator it, end;
+            for (it = results.begin(), end = results.end(); it != end; ++it) {
+                // the model may have been loaded synchronously in the meantime; a model that failed to parse is
+                // cached as NULL so that it is not parsed again
+                if (!m_aliases.insert(AliasMap::value_type(it->key, it->model)).second)
+                    delete it->model;
+                else if (it->model == NULL)
+                    console.warn("Unable to load MDL '%s'", it->name.c_str());
+            }
+        }
+
+        AliasManager::AliasManager() :
+        m_loader(new EntityModelLoader<Alias>()) {}
 
         AliasManager::~AliasManager() {
+            delete m_loader;
+            m_loader = NULL;
             AliasMap::iterator it, end;
             for (it = m_aliases.begin(), end = m_aliases.end(); it != end; ++it)
                 delete it->second;
@@ -21,6 +21,7 @@
 #define TrenchBroom_Alias_h
 
 #include "IO/Pak.h"
+#include "Model/EntityModelLoader.h"
 #include "Utility/Console.h"
 #include "Utility/String.h"
 #include "Utility/VecMath.h"
@@ -222,7 +223,7 @@ namespace TrenchBroom {
             Vec3f unpackFrameVertex(const AliasPackedFrameVertex& packedVertex, const Vec3f& origin, const Vec3f& size);
             AliasSingleFrame* readFrame(char*& cursor, const Vec3f& origin, const Vec3f& scale, unsigned int skinWidth, unsigned int skinHeight, const AliasSkinVertexList& vertices, const AliasSkinTriangleList& triangles);
         public:
-            Alias(const String& name, char* begin, char* end);
+            Alias(const String& name, IO::MappedFile::Ptr file);
             ~Alias();
             
             inline const String& name() const {
@@ -252,11 +253,17 @@ namespace TrenchBroom {
             typedef std::map<String, Alias*> AliasMap;
             
             AliasMap m_aliases;
+            EntityModelLoader<Alias>* m_loader;
         public:
             static AliasManager* sharedManager;
             AliasManager();
             ~AliasManager();
             Alias const * const alias(const String& name, const StringList& paths, Utility::Console& console);
+            
+            // Queues the model for parsing on the loader thread. Returns false if the model could not be found.
+            bool loadAlias(const String& name, const StringList& paths, Utility::Console& console);
+            bool loading(const String& name, const StringList& paths);
+            void collectLoadedAliases(Utility::Console& console);
         };
     }
 }
@@ -19,23 +19,58 @@
 
 #include "Brush.h"
 
+#include "Model/BrushRebuildScope.h"
 #include "Model/Entity.h"
 #include "Model/Face.h"
 #include "Model/Filter.h"
+#include "Model/Map.h"
 #include "Model/Picker.h"
 #include "Model/Texture.h"
 #include "Utility/List.h"
+#include "Utility/Profiler.h"
 
 #include <algorithm>
 
 namespace TrenchBroom {
     namespace Model {
+        static void clipPolygon(Vec3f::List& polygon, const Planef& plane) {
+            Vec3f::List result;
+            for (size_t i = 0; i < polygon.size(); i++) {
+                const Vec3f& start = polygon[i];
+                const Vec3f& end = polygon[(i + 1) % polygon.size()];
+                // vertices on the plane are classified like in BrushGeometry so that they are kept consistently
+                const PointStatus::Type startStatus = plane.pointStatus(start);
+                const PointStatus::Type endStatus = plane.pointStatus(end);
+                
+                if (startStatus != PointStatus::PSAbove)
+                    result.push_back(start);
+                if ((startStatus == PointStatus::PSBelow && endStatus == PointStatus::PSAbove) ||
+                    (startStatus == PointStatus::PSAbove && endStatus == PointStatus::PSBelow)) {
+                    const float startDist = plane.pointDistance(start);
+                    const float endDist = plane.pointDistance(end);
+                    result.push_back(start + (end - start) * (startDist / (startDist - endDist)));
+                }
+            }
+            polygon.swap(result);
+        }
+        
         void Brush::init() {
             m_entity = NULL;
+            m_rebuildScope = NULL;
             setEditState(EditState::Default);
             m_selectedFaceCount = 0;
+            m_contentTypes = 0;
+            m_contentTypesValid = false;
             m_needsRebuild = false;
         }
+        
+        void Brush::updateContentTypes() const {
+            m_contentTypes = ~0u;
+            FaceList::const_iterator it, end;
+            for (it = m_faces.begin(), end = m_faces.end(); it != end; ++it)
+                m_contentTypes &= (1u << (*it)->contentType());
+            m_contentTypesValid = true;
+        }
 
         Brush::Brush(const BBoxf& worldBounds, bool forceIntegerFacePoints, const FaceList& faces) :
         MapObject(),
@@ -54,6 +89,46 @@ namespace TrenchBroom {
             rebuildGeometry();
         }
 
+        Brush::Brush(const BBoxf& worldBounds, bool forceIntegerFacePoints, const FaceList& faces, BrushGeometry* geometry) :
+        MapObject(),
+        m_geometry(geometry),
+        m_worldBounds(worldBounds),
+        m_forceIntegerFacePoints(forceIntegerFacePoints) {
+            assert(m_geometry != NULL);
+            init();
+
+            FaceList::const_iterator it, end;
+            for (it = faces.begin(), end = faces.end(); it != end; ++it) {
+                Face* face = *it;
+                face->setBrush(this);
+                m_faces.push_back(face);
+            }
+
+            m_geometry->restoreFaceSides();
+            for (it = m_faces.begin(), end = m_faces.end(); it != end; ++it) {
+                Face* face = *it;
+                face->invalidateTexAxes();
+                face->invalidateVertexCache();
+            }
+        }
+
+        Brush::Brush(const BBoxf& worldBounds, bool forceIntegerFacePoints, const FaceList& faces, BrushRebuildScope& rebuildScope) :
+        MapObject(),
+        m_geometry(NULL),
+        m_worldBounds(worldBounds),
+        m_forceIntegerFacePoints(forceIntegerFacePoints) {
+            init();
+
+            FaceList::const_iterator it, end;
+            for (it = faces.begin(), end = faces.end(); it != end; ++it) {
+                Face* face = *it;
+                face->setBrush(this);
+                m_faces.push_back(face);
+            }
+
+            rebuildScope.defer(*this);
+        }
+
         Brush::Brush(const BBoxf& worldBounds, bool forceIntegerFacePoints, const Brush& brushTemplate) :
         MapObject(),
         m_geometry(NULL),
@@ -133,9 +208,10 @@ namespace TrenchBroom {
         }
 
         Brush::~Brush() {
+            if (m_rebuildScope != NULL)
+                m_rebuildScope->remove(*this);
             setEntity(NULL);
-            delete m_geometry;
-            m_geometry = NULL;
+            deleteGeometry();
             Utility::deleteAll(m_faces);
         }
 
@@ -177,11 +253,9 @@ namespace TrenchBroom {
                     m_entity->decSelectedBrushCount();
                 else if (hidden())
                     m_entity->decHiddenBrushCount();
-                if (entity == NULL && m_geometry != NULL) {
-                    delete m_geometry;
-                    m_geometry = NULL;
-                }
-            } else if (entity != NULL && m_geometry == NULL) {
+                if (entity == NULL)
+                    deleteGeometry();
+            } else if (entity != NULL && m_geometry == NULL && m_rebuildScope == NULL) {
                 rebuildGeometry();
             }
 
@@ -221,8 +295,18 @@ namespace TrenchBroom {
             rebuildGeometry();
         }
 
-        void Brush::rebuildGeometry() {
-            delete m_geometry;
+        void Brush::buildGeometry() {
+            PROFILE_SCOPE("Brush::buildGeometry");
+            FaceSet droppedFaces;
+            createGeometry(droppedFaces);
+            finishGeometry(droppedFaces);
+
+            if (m_entity != NULL)
+                m_entity->invalidateGeometry();
+        }
+
+        void Brush::createGeometry(FaceSet& droppedFaces) {
+            deleteGeometry();
             m_geometry = new BrushGeometry(m_worldBounds);
 
             // sort the faces by the weight of their plane normals like QBSP does
@@ -230,11 +314,12 @@ namespace TrenchBroom {
             std::sort(sortedFaces.begin(), sortedFaces.end(), Model::Face::WeightOrder(Planef::WeightOrder(true)));
             std::sort(sortedFaces.begin(), sortedFaces.end(), Model::Face::WeightOrder(Planef::WeightOrder(false)));
 
-            FaceSet droppedFaces;
             bool success = m_geometry->addFaces(sortedFaces, droppedFaces);
             assert(success);
+        }
 
-            for (FaceSet::iterator it = droppedFaces.begin(); it != droppedFaces.end(); ++it) {
+        void Brush::finishGeometry(const FaceSet& droppedFaces) {
+            for (FaceSet::const_iterator it = droppedFaces.begin(); it != droppedFaces.end(); ++it) {
                 Face* face = *it;
                 face->setBrush(NULL);
                 m_faces.erase(std::remove(m_faces.begin(), m_faces.end(), face), m_faces.end());
@@ -246,9 +331,34 @@ namespace TrenchBroom {
                 face->invalidateTexAxes();
                 face->invalidateVertexCache();
             }
+        }
 
-            if (m_entity != NULL)
-                m_entity->invalidateGeometry();
+        void Brush::validateGeometry() {
+            if (m_geometry == NULL)
+                buildGeometry();
+        }
+
+        void Brush::deleteGeometry() {
+            if (m_geometry == NULL)
+                return;
+
+            FaceList::const_iterator it, end;
+            for (it = m_faces.begin(), end = m_faces.end(); it != end; ++it)
+                (*it)->setSide(NULL);
+            delete m_geometry;
+            m_geometry = NULL;
+        }
+
+        void Brush::rebuildGeometry() {
+            Map* map = m_entity != NULL ? m_entity->map() : NULL;
+            BrushRebuildScope* rebuildScope = map != NULL ? map->rebuildScope() : NULL;
+            if (rebuildScope != NULL) {
+                rebuildScope->defer(*this);
+                deleteGeometry();
+                return;
+            }
+
+            buildGeometry();
         }
 
         void Brush::transform(const Mat4f& pointTransform, const Mat4f& vectorTransform, const bool lockTextures, const bool invertOrientation) {
@@ -266,7 +376,10 @@ namespace TrenchBroom {
                 face.setBrush(this);
                 m_faces.push_back(&face);
                 rebuildGeometry();
-                return !m_faces.empty() && closed();
+                if (m_faces.empty())
+                    return false;
+                validateGeometry();
+                return closed();
             } catch (GeometryException&) {
                 return false;
             }
@@ -276,6 +389,7 @@ namespace TrenchBroom {
             FaceSet newFaces;
             FaceSet droppedFaces;
 
+            validateGeometry();
             m_geometry->correct(newFaces, droppedFaces, epsilon);
 
             for (FaceSet::iterator it = droppedFaces.begin(); it != droppedFaces.end(); ++it) {
@@ -298,6 +412,7 @@ namespace TrenchBroom {
             FaceSet newFaces;
             FaceSet droppedFaces;
 
+            validateGeometry();
             m_geometry->snap(newFaces, droppedFaces, snapTo);
 
             for (FaceSet::iterator it = droppedFaces.begin(); it != droppedFaces.end(); ++it) {
@@ -316,31 +431,70 @@ namespace TrenchBroom {
             rebuildGeometry();
         }
 
-        bool Brush::canMoveBoundary(const Face& face, const Vec3f& delta) const {
-
-            const Mat4f pointTransform = translationMatrix(delta);
-            BrushGeometry testGeometry(m_worldBounds);
-
-            Face testFace(face);
-            testFace.transform(pointTransform, Mat4f::Identity, false, false);
-
-            FaceSet droppedFaces;
-            FaceList::const_iterator it, end;
-            for (it = m_faces.begin(), end = m_faces.end(); it != end; ++it) {
-                Face* otherFace = *it;
-                if (otherFace != &face)
-                    testGeometry.addFace(*otherFace, droppedFaces);
+        bool Brush::canMoveBoundaryInward(const Face& face, const Planef& boundary) const {
+            // the brush only shrinks, so every other face must keep at least one of its vertices
+            FaceList::const_iterator faceIt, faceEnd;
+            for (faceIt = m_faces.begin(), faceEnd = m_faces.end(); faceIt != faceEnd; ++faceIt) {
+                const Face& otherFace = **faceIt;
+                if (&otherFace == &face)
+                    continue;
+                
+                bool keep = false;
+                const VertexList& vertices = otherFace.vertices();
+                VertexList::const_iterator vertexIt, vertexEnd;
+                for (vertexIt = vertices.begin(), vertexEnd = vertices.end(); vertexIt != vertexEnd && !keep; ++vertexIt) {
+                    const Vertex& vertex = **vertexIt;
+                    keep = boundary.pointStatus(vertex.position, 0.1f) == PointStatus::PSBelow;
+                }
+                if (!keep)
+                    return false;
             }
-
-            BrushGeometry::CutResult result = testGeometry.addFace(testFace, droppedFaces);
-            bool inWorldBounds = m_worldBounds.contains(testGeometry.bounds);
-
-            m_geometry->restoreFaceSides();
-
-            return inWorldBounds && result == BrushGeometry::Split && droppedFaces.empty();
+            return true;
+        }
+        
+        bool Brush::canMoveBoundaryOutward(const Face& face, const Planef& boundary) const {
+            // the brush only grows, so no other face can be dropped, but the moved face must still be part of
+            // the brush and its new vertices must remain within the world bounds
+            const Vec3f u = crossed(boundary.normal, boundary.normal.thirdAxis(true)).normalized();
+            const Vec3f v = crossed(boundary.normal, u);
+            const Vec3f worldCenter = m_worldBounds.center();
+            const Vec3f center = worldCenter - boundary.normal * boundary.pointDistance(worldCenter);
+            const float size = m_worldBounds.size().length();
+            
+            Vec3f::List polygon;
+            polygon.push_back(center + size * (-u - v));
+            polygon.push_back(center + size * ( u - v));
+            polygon.push_back(center + size * ( u + v));
+            polygon.push_back(center + size * (-u + v));
+            
+            FaceList::const_iterator faceIt, faceEnd;
+            for (faceIt = m_faces.begin(), faceEnd = m_faces.end(); faceIt != faceEnd && polygon.size() >= 3; ++faceIt) {
+                const Face& otherFace = **faceIt;
+                if (&otherFace != &face)
+                    clipPolygon(polygon, otherFace.boundary());
+            }
+            
+            if (polygon.size() < 3)
+                return false;
+            
+            const BBoxf worldBounds = m_worldBounds.expanded(Math<float>::AlmostZero);
+            Vec3f::List::const_iterator it, end;
+            for (it = polygon.begin(), end = polygon.end(); it != end; ++it)
+                if (!worldBounds.contains(*it))
+                    return false;
+            return true;
+        }
+        
+        bool Brush::canMoveBoundary(const Face& face, const Vec3f& delta) const {
+            const Planef& boundary = face.boundary();
+            const float distance = delta.dot(boundary.normal);
+            if (distance < 0.0f)
+                return canMoveBoundaryInward(face, Planef(boundary.normal, boundary.distance + distance));
+            return canMoveBoundaryOutward(face, Planef(boundary.normal, boundary.distance + distance));
         }
 
         void Brush::moveBoundary(Face& face, const Vec3f& delta, bool lockTexture) {
+            validateGeometry();
             assert(canMoveBoundary(face, delta));
 
             const Mat4f pointTransform = translationMatrix(delta);
@@ -349,6 +503,7 @@ namespace TrenchBroom {
         }
 
         bool Brush::canMoveVertices(const Vec3f::List& vertexPositions, const Vec3f& delta) const {
+            assert(m_geometry != NULL);
             return m_geometry->canMoveVertices(m_worldBounds, vertexPositions, delta);
         }
 
@@ -356,6 +511,7 @@ namespace TrenchBroom {
             FaceSet newFaces;
             FaceSet droppedFaces;
 
+            validateGeometry();
             const Vec3f::List newVertexPositions = m_geometry->moveVertices(m_worldBounds, vertexPositions, delta, newFaces, droppedFaces);
 
             for (FaceSet::iterator it = droppedFaces.begin(); it != droppedFaces.end(); ++it) {
@@ -383,6 +539,7 @@ namespace TrenchBroom {
         }
 
         bool Brush::canMoveEdges(const EdgeInfoList& edgeInfos, const Vec3f& delta) const {
+            assert(m_geometry != NULL);
             return m_geometry->canMoveEdges(m_worldBounds, edgeInfos, delta);
         }
 
@@ -390,6 +547,7 @@ namespace TrenchBroom {
             FaceSet newFaces;
             FaceSet droppedFaces;
 
+            validateGeometry();
             const EdgeInfoList newEdgeInfos = m_geometry->moveEdges(m_worldBounds, edgeInfos, delta, newFaces, droppedFaces);
 
             for (FaceSet::iterator it = droppedFaces.begin(); it != droppedFaces.end(); ++it) {
@@ -417,6 +575,7 @@ namespace TrenchBroom {
         }
 
         bool Brush::canMoveFaces(const FaceInfoList& faceInfos, const Vec3f& delta) const {
+            assert(m_geometry != NULL);
             return m_geometry->canMoveFaces(m_worldBounds, faceInfos, delta);
         }
 
@@ -424,6 +583,7 @@ namespace TrenchBroom {
             FaceSet newFaces;
             FaceSet droppedFaces;
 
+            validateGeometry();
             const FaceInfoList newFaceInfos = m_geometry->moveFaces(m_worldBounds, faceInfos, delta, newFaces, droppedFaces);
 
             for (FaceSet::iterator it = droppedFaces.begin(); it != droppedFaces.end(); ++it) {
@@ -451,6 +611,7 @@ namespace TrenchBroom {
         }
 
         bool Brush::canSplitEdge(const EdgeInfo& edge, const Vec3f& delta) const {
+            assert(m_geometry != NULL);
             return m_geometry->canSplitEdge(m_worldBounds, edge, delta);
         }
 
@@ -458,6 +619,7 @@ namespace TrenchBroom {
             FaceSet newFaces;
             FaceSet droppedFaces;
 
+            validateGeometry();
             Vec3f newVertexPosition = m_geometry->splitEdge(m_worldBounds, edge, delta, newFaces, droppedFaces);
 
             for (FaceSet::iterator it = droppedFaces.begin(); it != droppedFaces.end(); ++it) {
@@ -485,6 +647,7 @@ namespace TrenchBroom {
         }
 
         bool Brush::canSplitFace(const FaceInfo& faceInfo, const Vec3f& delta) const {
+            assert(m_geometry != NULL);
             return m_geometry->canSplitFace(m_worldBounds, faceInfo, delta);
         }
 
@@ -492,6 +655,7 @@ namespace TrenchBroom {
             FaceSet newFaces;
             FaceSet droppedFaces;
 
+            validateGeometry();
             Vec3f newVertexPosition = m_geometry->splitFace(m_worldBounds, faceInfo, delta, newFaces, droppedFaces);
 
             for (FaceSet::iterator it = droppedFaces.begin(); it != droppedFaces.end(); ++it) {
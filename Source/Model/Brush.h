@@ -29,6 +29,7 @@
 #include "Utility/VecMath.h"
 
 #include <algorithm>
+#include <cassert>
 #include <iterator>
 #include <vector>
 
@@ -36,17 +37,27 @@ using namespace TrenchBroom::VecMath;
 
 namespace TrenchBroom {
     namespace Model {
+        class BrushRebuildScope;
         class Entity;
         class Face;
         class Texture;
 
         class Brush : public MapObject, public Utility::Allocator<Brush> {
+        private:
+            friend class BrushRebuildScope;
+            friend class BrushGeometryBuilder;
         protected:
             class Entity* m_entity;
             FaceList m_faces;
             BrushGeometry* m_geometry;
+            // set while the rebuild of the geometry is deferred
+            BrushRebuildScope* m_rebuildScope;
 
             unsigned int m_selectedFaceCount;
+            
+            // bit n is set if every face has content type n, see Face::ContentType
+            mutable unsigned int m_contentTypes;
+            mutable bool m_contentTypesValid;
 
             const BBoxf& m_worldBounds;
             bool m_forceIntegerFacePoints;
@@ -55,8 +66,24 @@ namespace TrenchBroom {
             bool m_needsRebuild;
             
             void init();
+            void buildGeometry();
+            // builds the geometry if a rebuild scope deferred it
+            void validateGeometry();
+            // creating the geometry does not touch any state shared with other brushes, finishing it deletes the
+            // dropped faces
+            void createGeometry(FaceSet& droppedFaces);
+            void finishGeometry(const FaceSet& droppedFaces);
+            void deleteGeometry();
+            bool canMoveBoundaryInward(const Face& face, const Planef& boundary) const;
+            bool canMoveBoundaryOutward(const Face& face, const Planef& boundary) const;
+            void updateContentTypes() const;
         public:
             Brush(const BBoxf& worldBounds, bool forceIntegerFacePoints, const FaceList& faces);
+            // takes ownership of the given geometry, which must have been built from the given faces and whose sides
+            // must refer to them
+            Brush(const BBoxf& worldBounds, bool forceIntegerFacePoints, const FaceList& faces, BrushGeometry* geometry);
+            // leaves building the geometry to the given scope, the brush must not be accessed before it is built
+            Brush(const BBoxf& worldBounds, bool forceIntegerFacePoints, const FaceList& faces, BrushRebuildScope& rebuildScope);
             Brush(const BBoxf& worldBounds, bool forceIntegerFacePoints, const Brush& brushTemplate);
             Brush(const BBoxf& worldBounds, bool forceIntegerFacePoints, const BBoxf& brushBounds, Texture* texture);
             ~Brush();
@@ -89,6 +116,17 @@ namespace TrenchBroom {
             inline void decSelectedFaceCount() {
                 m_selectedFaceCount--;
             }
+            
+            inline unsigned int contentTypes() const {
+                if (!m_contentTypesValid)
+                    updateContentTypes();
+                return m_contentTypes;
+            }
+            
+            inline void invalidateContentTypes() {
+                m_contentTypesValid = false;
+                invalidateFilterMatch();
+            }
 
             virtual EditState::Type setEditState(EditState::Type editState);
 
@@ -110,19 +148,28 @@ namespace TrenchBroom {
                 m_needsRebuild = needsRebuild;
             }
             
+            // false while a rebuild scope defers the geometry or if it could not be built
+            inline bool hasGeometry() const {
+                return m_geometry != NULL;
+            }
+            
             inline const Vec3f& center() const {
+                assert(m_geometry != NULL);
                 return m_geometry->center;
             }
 
             inline const BBoxf& bounds() const {
+                assert(m_geometry != NULL);
                 return m_geometry->bounds;
             }
 
             inline const VertexList& vertices() const {
+                assert(m_geometry != NULL);
                 return m_geometry->vertices;
             }
 
             inline const FaceList incidentFaces(const Vertex& vertex) const {
+                assert(m_geometry != NULL);
                 const SideList sides = m_geometry->incidentSides(&vertex);
                 FaceList result;
                 result.reserve(sides.size());
@@ -137,10 +184,12 @@ namespace TrenchBroom {
             }
 
             inline const EdgeList& edges() const {
+                assert(m_geometry != NULL);
                 return m_geometry->edges;
             }
 
             inline bool closed() const {
+                assert(m_geometry != NULL);
                 return m_geometry->closed();
             }
 
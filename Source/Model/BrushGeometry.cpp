@@ -21,12 +21,141 @@
 
 #include "Model/Face.h"
 #include "Utility/List.h"
+#include "Utility/Predicates.h"
 
+#include <algorithm>
 #include <map>
 #include <cstdio>
 
 namespace TrenchBroom {
     namespace Model {
+        // only used with double precision planes, where distances are computed from the face points
+        static double normalLength(const Face& face) {
+            if (!BrushGeometry::doublePrecisionPlanes)
+                return 1.0;
+            return Predicates::normalLength(face.point(0), face.point(1), face.point(2));
+        }
+
+        static double pointDistance(const Face& face, const double normalLength, const Vec3f& point) {
+            if (BrushGeometry::doublePrecisionPlanes)
+                return Predicates::orientation(face.point(0), face.point(1), face.point(2), point) / normalLength;
+            return face.boundary().pointDistance(point);
+        }
+
+        // points within the epsilon of the plane lie on it, this is only used to find faces that duplicate other faces
+        static PointStatus::Type pointStatus(const Face& face, const double normalLength, const Vec3f& point, const float epsilon = Math<float>::PointStatusEpsilon) {
+            if (!BrushGeometry::doublePrecisionPlanes)
+                return face.boundary().pointStatus(point, epsilon);
+
+            const double distance = pointDistance(face, normalLength, point);
+            if (distance > static_cast<double>(epsilon))
+                return PointStatus::PSAbove;
+            if (distance < -static_cast<double>(epsilon))
+                return PointStatus::PSBelow;
+            return PointStatus::PSInside;
+        }
+
+        // with double precision planes, vertices are classified by the exact sign of their orientation, otherwise,
+        // vertices close to the plane lie on it
+        static PointStatus::Type vertexStatus(const Face& face, const Vec3f& point) {
+            if (!BrushGeometry::doublePrecisionPlanes)
+                return face.boundary().pointStatus(point, 0.1f);
+
+            const int sign = Predicates::orientationSign(face.point(0), face.point(1), face.point(2), point);
+            if (sign > 0)
+                return PointStatus::PSAbove;
+            if (sign < 0)
+                return PointStatus::PSBelow;
+            return PointStatus::PSInside;
+        }
+
+        static Vec3f splitPosition(const Face& face, const double normalLength, const Vec3f& start, const Vec3f& end) {
+            // Do exactly what QBSP is doing:
+            const Planef& plane = face.boundary();
+            const double startDist = pointDistance(face, normalLength, start);
+            const double endDist = pointDistance(face, normalLength, end);
+
+            // with double precision planes, the distances of vertices very close to the plane may contradict their
+            // exact signs, the split vertex then coincides with one of them
+            double dot = 0.0;
+            if (startDist != endDist)
+                dot = std::max(0.0, std::min(1.0, startDist / (startDist - endDist)));
+
+            Vec3f position;
+            for (unsigned int i = 0; i < 3; i++) {
+                if (plane.normal[i] == 1.0f)
+                    position[i] = plane.distance;
+                else if (plane.normal[i] == -1.0f)
+                    position[i] = -plane.distance;
+                else {
+                    const double startPos = start[i];
+                    const double endPos = end[i];
+                    position[i] = static_cast<float>(startPos + dot * (endPos - startPos));
+                }
+            }
+
+            // cheat a little bit?, just like QBSP
+            position.correct();
+            return position;
+        }
+
+        /*
+         With double precision planes, an edge whose vertices lie on different sides of the plane is not split if the
+         split vertex would coincide with one of them once rounded to float. The plane then passes so close to that
+         vertex that it is treated as lying on the plane.
+         */
+        static void markVerticesOnPlane(const EdgeList& edges, const Face& face, const double normalLength) {
+            bool changed = true;
+            while (changed) {
+                changed = false;
+                EdgeList::const_iterator it, end;
+                for (it = edges.begin(), end = edges.end(); it != end; ++it) {
+                    Edge& edge = **it;
+                    if (edge.start->mark == Vertex::Undecided || edge.end->mark == Vertex::Undecided ||
+                        edge.start->mark == edge.end->mark)
+                        continue;
+
+                    const Vec3f position = splitPosition(face, normalLength, edge.start->position, edge.end->position);
+                    if (position == edge.start->position) {
+                        edge.start->mark = Vertex::Undecided;
+                        changed = true;
+                    } else if (position == edge.end->position) {
+                        edge.end->mark = Vertex::Undecided;
+                        changed = true;
+                    }
+                }
+            }
+        }
+
+        /*
+         Returns the fraction of the movement from start to end at which it crosses the plane through the given points,
+         or 1 if it does not cross the plane. A movement that starts on the plane does not cross it. With double
+         precision planes, the sides are decided by the exact signs of the orientations, otherwise, points within
+         MoveVertexEpsilon of the plane lie on it.
+         */
+        static float crossingFraction(const Vec3f& point1, const Vec3f& point2, const Vec3f& point3, const Planef& plane, const Vec3f& start, const Vec3f& end) {
+            static const float MoveVertexEpsilon = 0.001f;
+
+            int startSign, endSign;
+            float startDot, endDot;
+            if (BrushGeometry::doublePrecisionPlanes) {
+                startSign = Predicates::orientationSign(point1, point2, point3, start);
+                endSign = Predicates::orientationSign(point1, point2, point3, end);
+                startDot = static_cast<float>(Predicates::pointDistance(point1, point2, point3, start));
+                endDot = static_cast<float>(Predicates::pointDistance(point1, point2, point3, end));
+            } else {
+                startDot = start.dot(plane.normal) - plane.distance;
+                endDot = end.dot(plane.normal) - plane.distance;
+                startSign = std::abs(startDot) < MoveVertexEpsilon ? 0 : (startDot > 0.0f ? 1 : -1);
+                endSign = endDot > 0.0f ? 1 : -1;
+            }
+
+            const float distance = std::abs(startDot) + std::abs(endDot);
+            if (startSign == 0 || (startSign > 0) == (endSign > 0) || distance == 0.0f)
+                return 1.0f;
+            return std::abs(startDot) / distance;
+        }
+
         SideList Vertex::incidentSides(const EdgeList& edges) const {
             SideList result;
 
@@ -83,29 +212,9 @@ namespace TrenchBroom {
                 mark = Undecided;
         }
 
-        Vertex* Edge::split(const Planef& plane) {
-            // Do exactly what QBSP is doing:
-            const double startDist = plane.pointDistance(start->position);
-            const double endDist = plane.pointDistance(end->position);
-
-            assert(startDist != endDist);
-            const double dot = startDist / (startDist - endDist);
-
+        Vertex* Edge::split(const Face& face) {
             Vertex* newVertex = new Vertex();
-            for (unsigned int i = 0; i < 3; i++) {
-                if (plane.normal[i] == 1.0f)
-                    newVertex->position[i] = plane.distance;
-                else if (plane.normal[i] == -1.0f)
-                    newVertex->position[i] = -plane.distance;
-                else {
-                    const double startPos = start->position[i];
-                    const double endPos = end->position[i];
-                    newVertex->position[i] = static_cast<float>(startPos + dot * (endPos - startPos));
-                }
-            }
-
-            // cheat a little bit?, just like QBSP
-            newVertex->position.correct();
+            newVertex->position = splitPosition(face, normalLength(face), start->position, end->position);
             
             if (start->mark == Vertex::Drop)
                 start = newVertex;
@@ -764,7 +873,7 @@ namespace TrenchBroom {
                 float minFrac = 1.0f;
                 for (size_t i = 0; i < affectedSides.size(); i++) {
                     Planef plane;
-                    float startDot, endDot, frac;
+                    float frac;
 
                     Side* side = affectedSides[i];
                     Side* next = affectedSides[succ(i, affectedSides.size())];
@@ -802,16 +911,9 @@ namespace TrenchBroom {
                         return MoveVertexResult(MoveVertexResult::VertexUnchanged, vertex);
                     }
 
-                    startDot = start.dot(plane.normal) - plane.distance;
-                    endDot = end.dot(plane.normal) - plane.distance;
-
-                    if (std::abs(startDot) >= 0.001f || std::abs(endDot) >= 0.001f) {
-                        if ((startDot > 0.0f) != (endDot >  0.0f)) {
-                            frac = std::abs(startDot) < 0.001f ? 1.0f : std::abs(startDot) / (std::abs(startDot) + std::abs(endDot));
-                            if (frac > lastFrac && frac < minFrac)
-                                minFrac = frac;
-                        }
-                    }
+                    frac = crossingFraction(p1, p2, p3, plane, start, end);
+                    if (frac > lastFrac && frac < minFrac)
+                        minFrac = frac;
 
                     /*
                      Second, we consider the boundary plane of the one neighbour to side which is not incident to the
@@ -843,16 +945,9 @@ namespace TrenchBroom {
                         return MoveVertexResult(MoveVertexResult::VertexUnchanged, vertex);
                     }
 
-                    startDot = start.dot(plane.normal) - plane.distance;
-                    endDot = end.dot(plane.normal) - plane.distance;
-
-                    if (std::abs(startDot) >= 0.001f || std::abs(endDot) >= 0.001f) {
-                        if ((startDot > 0.0f) != (endDot >  0.0f)) {
-                            frac = std::abs(startDot) < 0.001f ? 1.0f : std::abs(startDot) / (std::abs(startDot) + std::abs(endDot));
-                            if (frac > lastFrac && frac < minFrac)
-                                minFrac = frac;
-                        }
-                    }
+                    frac = crossingFraction(b1, b2, b3, plane, start, end);
+                    if (frac > lastFrac && frac < minFrac)
+                        minFrac = frac;
                 }
 
                 assert(minFrac > lastFrac);
@@ -1182,6 +1277,8 @@ namespace TrenchBroom {
             return true;
         }
 
+        bool BrushGeometry::doublePrecisionPlanes = false;
+
         BrushGeometry::BrushGeometry(const BBoxf& i_bounds) {
             Vertex* lfd = new Vertex(i_bounds.min.x(), i_bounds.min.y(), i_bounds.min.z());
             Vertex* lfu = new Vertex(i_bounds.min.x(), i_bounds.min.y(), i_bounds.max.z());
@@ -1299,10 +1396,11 @@ namespace TrenchBroom {
                 const Side& side = *sides[i];
                 if (side.face != NULL) {
                     const Face& previousFace = *side.face;
+                    const double previousLength = normalLength(previousFace);
                     unsigned int onPrevious = 0;
                     for (size_t j = 0; j < 3; j++) {
                         const Vec3f& point = face.point(j);
-                        if (previousFace.boundary().pointStatus(point) == PointStatus::PSInside)
+                        if (pointStatus(previousFace, previousLength, point) == PointStatus::PSInside)
                             onPrevious++;
                     }
                     if (onPrevious == 3)
@@ -1310,26 +1408,32 @@ namespace TrenchBroom {
                 }
             }
             
-            Planef boundary = face.boundary();
+            const double length = normalLength(face);
+            // mark vertices
+            for (size_t i = 0; i < vertices.size(); i++) {
+                Vertex& vertex = *vertices[i];
+                PointStatus::Type vs = vertexStatus(face, vertex.position);
+                if (vs == PointStatus::PSAbove)
+                    vertex.mark = Vertex::Drop;
+                else if (vs == PointStatus::PSBelow)
+                    vertex.mark  = Vertex::Keep;
+                else
+                    vertex.mark = Vertex::Undecided;
+            }
+
+            if (doublePrecisionPlanes)
+                markVerticesOnPlane(edges, face, length);
 
             unsigned int keep = 0;
             unsigned int drop = 0;
             unsigned int undecided = 0;
-
-            // mark vertices
             for (size_t i = 0; i < vertices.size(); i++) {
-                Vertex& vertex = *vertices[i];
-                PointStatus::Type vs = boundary.pointStatus(vertex.position, 0.1f);
-                if (vs == PointStatus::PSAbove) {
-                    vertex.mark = Vertex::Drop;
+                if (vertices[i]->mark == Vertex::Drop)
                     drop++;
-                } else if (vs == PointStatus::PSBelow) {
-                    vertex.mark  = Vertex::Keep;
+                else if (vertices[i]->mark == Vertex::Keep)
                     keep++;
-                } else {
-                    vertex.mark = Vertex::Undecided;
+                else
                     undecided++;
-                }
             }
 
             if (keep + undecided == vertices.size())
@@ -1343,7 +1447,7 @@ namespace TrenchBroom {
                 Edge& edge = *edges[i];
                 edge.updateMark();
                 if (edge.mark == Edge::Split) {
-                    Vertex* vertex = edge.split(boundary);
+                    Vertex* vertex = edge.split(face);
                     vertices.push_back(vertex);
                 }
             }
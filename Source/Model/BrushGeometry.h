@@ -33,7 +33,31 @@ using namespace TrenchBroom::VecMath;
 
 namespace TrenchBroom {
     namespace Model {
-        class Vertex : public Utility::Allocator<Vertex> {
+        class BrushRebuildScope;
+
+        // Vertices, edges, sides and faces are allocated on several threads while a BrushRebuildScope builds the
+        // deferred geometries, the pools are only locked while it does so.
+        class GeometryAllocatorLock {
+        private:
+            friend class BrushRebuildScope;
+
+            static bool enabled;
+
+            static void enter();
+            static void leave();
+        public:
+            static inline void lock() {
+                if (enabled)
+                    enter();
+            }
+
+            static inline void unlock() {
+                if (enabled)
+                    leave();
+            }
+        };
+
+        class Vertex : public Utility::Allocator<Vertex, 64, 256, GeometryAllocatorLock> {
         public:
             enum Mark {
                 Drop,
@@ -62,7 +86,7 @@ namespace TrenchBroom {
 
         class Side;
 
-        class Edge : public Utility::Allocator<Edge> {
+        class Edge : public Utility::Allocator<Edge, 64, 256, GeometryAllocatorLock> {
         public:
             enum Mark {
                 Drop,
@@ -169,7 +193,7 @@ namespace TrenchBroom {
 
             void updateMark();
 
-            Vertex* split(const Planef& plane);
+            Vertex* split(const Face& face);
 
             inline void flip() {
                 std::swap(left, right);
@@ -228,7 +252,7 @@ namespace TrenchBroom {
 
         class Face;
 
-        class Side : public Utility::Allocator<Side> {
+        class Side : public Utility::Allocator<Side, 64, 256, GeometryAllocatorLock> {
         public:
             enum Mark {
                 Keep,
@@ -331,6 +355,10 @@ namespace TrenchBroom {
             void copy(const BrushGeometry& original);
             bool sanityCheck();
         public:
+            // if set, vertices are classified by the exact sign of their orientation to the planes through the face
+            // points instead of against the rounded float planes of the faces with an epsilon
+            static bool doublePrecisionPlanes;
+
             VertexList vertices;
             EdgeList edges;
             SideList sides;
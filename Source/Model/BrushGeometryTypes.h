@@ -22,6 +22,7 @@
 
 #include "Model/BrushTypes.h"
 #include "Model/FaceTypes.h"
+#include "Model/VertexHandleMap.h"
 #include "Utility/VecMath.h"
 
 #include <map>
@@ -103,9 +104,9 @@ namespace TrenchBroom {
         typedef std::vector<EdgeInfo> EdgeInfoList;
         typedef std::vector<FaceInfo> FaceInfoList;
 
-        typedef std::map<Vec3f, Model::BrushList, Vec3f::LexicographicOrder> VertexToBrushesMap;
-        typedef std::map<Vec3f, Model::EdgeList, Vec3f::LexicographicOrder> VertexToEdgesMap;
-        typedef std::map<Vec3f, Model::FaceList, Vec3f::LexicographicOrder> VertexToFacesMap;
+        typedef VertexHandleMap<Brush> VertexToBrushesMap;
+        typedef VertexHandleMap<Edge> VertexToEdgesMap;
+        typedef VertexHandleMap<Face> VertexToFacesMap;
 
         typedef std::map<Model::Brush*, Model::EdgeInfoList> BrushEdgesMap;
         typedef std::pair<Model::Brush*, Model::EdgeInfoList> BrushEdgesMapEntry;
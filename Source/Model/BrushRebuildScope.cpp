@@ -0,0 +1,211 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BrushRebuildScope.h"
+
+#include "Model/Brush.h"
+#include "Model/BrushGeometry.h"
+#include "Model/Entity.h"
+#include "Model/EntityTypes.h"
+#include "Model/FaceTypes.h"
+#include "Model/Map.h"
+#include "Model/MapExceptions.h"
+#include "Utility/String.h"
+
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+#include <wx/thread.h>
+
+namespace TrenchBroom {
+    namespace Model {
+        bool GeometryAllocatorLock::enabled = false;
+
+        static wxCriticalSection& allocatorSection() {
+            static wxCriticalSection section;
+            return section;
+        }
+
+        void GeometryAllocatorLock::enter() {
+            allocatorSection().Enter();
+        }
+
+        void GeometryAllocatorLock::leave() {
+            allocatorSection().Leave();
+        }
+
+        class BrushGeometryBuilder : public wxThread {
+        public:
+            struct Result {
+                FaceSet droppedFaces;
+                bool failed;
+
+                Result() : failed(false) {}
+            };
+
+            typedef std::vector<Result> ResultList;
+        private:
+            const BrushList& m_brushes;
+            ResultList& m_results;
+            size_t& m_nextBrush;
+            wxCriticalSection& m_lock;
+
+            ExitCode Entry() {
+                build();
+                return (wxThread::ExitCode)0;
+            }
+        public:
+            BrushGeometryBuilder(const BrushList& brushes, ResultList& results, size_t& nextBrush, wxCriticalSection& lock) :
+            wxThread(wxTHREAD_JOINABLE),
+            m_brushes(brushes),
+            m_results(results),
+            m_nextBrush(nextBrush),
+            m_lock(lock) {}
+
+            // builds the geometries until none are left
+            void build() {
+                while (true) {
+                    size_t index;
+                    {
+                        wxCriticalSectionLocker locker(m_lock);
+                        if (m_nextBrush == m_brushes.size())
+                            return;
+                        index = m_nextBrush++;
+                    }
+
+                    Brush& brush = *m_brushes[index];
+                    Result& result = m_results[index];
+                    try {
+                        brush.createGeometry(result.droppedFaces);
+                    } catch (GeometryException&) {
+                        brush.deleteGeometry();
+                        result.droppedFaces.clear();
+                        result.failed = true;
+                    }
+                }
+            }
+        };
+
+        size_t BrushRebuildScope::build() {
+            // a brush whose geometry was built because it was accessed within the scope is skipped
+            BrushList brushes;
+            brushes.reserve(m_brushes.size());
+            for (size_t i = 0; i < m_brushes.size(); i++) {
+                Brush& brush = *m_brushes[i];
+                brush.m_rebuildScope = NULL;
+                if (brush.m_geometry == NULL)
+                    brushes.push_back(&brush);
+            }
+            m_brushes.clear();
+
+            if (brushes.empty())
+                return 0;
+
+            BrushGeometryBuilder::ResultList results(brushes.size());
+            size_t nextBrush = 0;
+            wxCriticalSection lock;
+
+            const int cpuCount = wxThread::GetCPUCount();
+            size_t threadCount = 1;
+            if (cpuCount > 1)
+                threadCount = std::min(static_cast<size_t>(cpuCount), std::max(brushes.size() / MinBrushesPerThread, threadCount));
+
+            // the section is created here so that the workers do not race to create it
+            if (threadCount > 1) {
+                allocatorSection();
+                GeometryAllocatorLock::enabled = true;
+            }
+
+            std::vector<BrushGeometryBuilder*> workers;
+            for (size_t i = 1; i < threadCount; i++) {
+                BrushGeometryBuilder* worker = new BrushGeometryBuilder(brushes, results, nextBrush, lock);
+                if (worker->Create() == wxTHREAD_NO_ERROR && worker->Run() == wxTHREAD_NO_ERROR)
+                    workers.push_back(worker);
+                else
+                    delete worker;
+            }
+
+            BrushGeometryBuilder builder(brushes, results, nextBrush, lock);
+            builder.build();
+
+            for (size_t i = 0; i < workers.size(); i++) {
+                workers[i]->Wait();
+                delete workers[i];
+            }
+
+            GeometryAllocatorLock::enabled = false;
+
+            // deleting faces changes the usage counts of their textures, so this happens here
+            size_t failed = 0;
+            EntitySet entities;
+            for (size_t i = 0; i < brushes.size(); i++) {
+                Brush& brush = *brushes[i];
+                if (results[i].failed)
+                    failed++;
+                else
+                    brush.finishGeometry(results[i].droppedFaces);
+                if (brush.entity() != NULL)
+                    entities.insert(brush.entity());
+            }
+
+            EntitySet::const_iterator it, end;
+            for (it = entities.begin(), end = entities.end(); it != end; ++it)
+                (*it)->invalidateGeometry();
+            return failed;
+        }
+
+        BrushRebuildScope::BrushRebuildScope(Map& map) :
+        m_map(map),
+        m_outermost(map.rebuildScope() == NULL) {
+            if (m_outermost)
+                m_map.setRebuildScope(this);
+        }
+
+        BrushRebuildScope::~BrushRebuildScope() {
+            build();
+            if (m_outermost)
+                m_map.setRebuildScope(NULL);
+        }
+
+        void BrushRebuildScope::rebuild() {
+            const size_t failed = build();
+            if (failed > 0) {
+                StringStream message;
+                message << "Could not build the geometry of " << failed << (failed == 1 ? " brush" : " brushes");
+                throw GeometryException(message);
+            }
+        }
+
+        void BrushRebuildScope::defer(Brush& brush) {
+            assert(m_outermost);
+            if (brush.m_rebuildScope == this)
+                return;
+            assert(brush.m_rebuildScope == NULL);
+            brush.m_rebuildScope = this;
+            m_brushes.push_back(&brush);
+        }
+
+        void BrushRebuildScope::remove(Brush& brush) {
+            assert(brush.m_rebuildScope == this);
+            m_brushes.erase(std::remove(m_brushes.begin(), m_brushes.end(), &brush), m_brushes.end());
+            brush.m_rebuildScope = NULL;
+        }
+    }
+}
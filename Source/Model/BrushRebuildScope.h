@@ -0,0 +1,63 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __TrenchBroom__BrushRebuildScope__
+#define __TrenchBroom__BrushRebuildScope__
+
+#include "Model/BrushTypes.h"
+
+namespace TrenchBroom {
+    namespace Model {
+        class Map;
+
+        // While a scope exists for a map, the brushes of that map whose geometry must be rebuilt only drop their
+        // current geometry. rebuild then builds the geometries of all of these brushes that have not been accessed in
+        // the meantime at once on several threads, and invalidates each affected entity once. A scope that is created
+        // while another one exists for the same map leaves the brushes to the outer scope. The brushes must outlive
+        // the scope, and scopes must only be used on the main thread.
+        class BrushRebuildScope {
+        private:
+            static const size_t MinBrushesPerThread = 32;
+
+            Map& m_map;
+            bool m_outermost;
+            BrushList m_brushes;
+
+            // prevent copying
+            BrushRebuildScope(const BrushRebuildScope& other);
+            void operator= (const BrushRebuildScope& other);
+
+            // returns the number of brushes whose geometry could not be built
+            size_t build();
+        public:
+            BrushRebuildScope(Map& map);
+            // builds the geometries that were deferred after the last call to rebuild, ignoring any failures
+            ~BrushRebuildScope();
+
+            // throws a GeometryException if the geometry of any deferred brush could not be built, those brushes
+            // are left without geometry
+            void rebuild();
+
+            void defer(Brush& brush);
+            void remove(Brush& brush);
+        };
+    }
+}
+
+#endif /* defined(__TrenchBroom__BrushRebuildScope__) */
@@ -34,8 +34,8 @@ namespace TrenchBroom {
         m_width(width),
         m_height(height) {}
 
+        // the image points into the mapped file of the BSP
         BspTexture::~BspTexture() {
-            delete[] m_image;
             m_image = NULL;
         }
 
@@ -75,9 +75,7 @@ namespace TrenchBroom {
                 unsigned int height = readUnsignedInt<uint32_t>(cursor);
                 unsigned int mip0Offset = readUnsignedInt<uint32_t>(cursor);
 
-                unsigned char* mip0 = new unsigned char[width * height];
-                cursor = base + textureOffset + mip0Offset;
-                readBytes(cursor, mip0, width * height);
+                const unsigned char* mip0 = reinterpret_cast<const unsigned char*>(base + textureOffset + mip0Offset);
 
                 BspTexture* texture = new BspTexture(textureName, mip0, width, height);
                 m_textures[i] = texture;
@@ -151,10 +149,12 @@ namespace TrenchBroom {
             }
         }
 
-        Bsp::Bsp(const String& name, char* begin, char* end) :
-        m_name(name) {
+        Bsp::Bsp(const String& name, IO::MappedFile::Ptr file) :
+        m_name(name),
+        m_file(file) {
             using namespace IO;
             
+            char* begin = m_file->begin();
             char* cursor = begin;
             readInt<int32_t>(cursor); // version
             cursor = begin + BspLayout::DirTexturesAddress;
@@ -285,9 +285,13 @@ namespace TrenchBroom {
 
         BspManager* BspManager::sharedManager = NULL;
 
+        static String bspKey(const String& name, const StringList& paths) {
+            return Utility::join(paths, ",") + ":" + name;
+        }
+
         const Bsp* BspManager::bsp(const String& name, const StringList& paths, Utility::Console& console) {
             String pathList = Utility::join(paths, ",");
-            String key = pathList + ":" + name;
+            String key = bspKey(name, paths);
 
             BspMap::iterator it = m_bsps.find(key);
             if (it != m_bsps.end())
@@ -297,7 +301,7 @@ namespace TrenchBroom {
 
             IO::MappedFile::Ptr file = IO::findGameFile(name, paths);
             if (file.get() != NULL) {
-                Bsp* bsp = new Bsp(name, file->begin(), file->end());
+                Bsp* bsp = new Bsp(name, file);
                 m_bsps[key] = bsp;
                 return bsp;
             }
@@ -306,9 +310,49 @@ namespace TrenchBroom {
             return NULL;
         }
 
-        BspManager::BspManager() {}
+        bool BspManager::loadBsp(const String& name, const StringList& paths, Utility::Console& console) {
+            String key = bspKey(name, paths);
+            if (m_bsps.count(key) > 0 || m_loader->loading(key))
+                return true;
+            
+            console.info("Loading '%s' (searching %s)", name.c_str(), Utility::join(paths, ",").c_str());
+            
+            IO::MappedFile::Ptr file = IO::findGameFile(name, paths);
+            if (file.get() == NULL) {
+                console.warn("Unable to find BSP '%s'", name.c_str());
+                return false;
+            }
+            
+            if (!m_loader->load(key, name, file))
+                m_bsps[key] = new Bsp(name, file);
+            return true;
+        }
+        
+        bool BspManager::loading(const String& name, const StringList& paths) {
+            return m_loader->loading(bspKey(name, paths));
+        }
+        
+        void BspManager::collectLoadedBsps(Utility::Console& console) {
+            EntityModelLoader<Bsp>::ResultList results;
+            m_loader->collect(results);
+            
+            EntityModelLoader<Bsp>::ResultList::const_iterator it, end;
+            for (it = results.begin(), end = results.end(); it != end; ++it) {
+                // the model may have been loaded synchronously in the meantime; a model that failed to parse is
+                // cached as NULL so that it is not parsed again
+                if (!m_bsps.insert(BspMap::value_type(it->key, it->model)).second)
+                    delete it->model;
+                else if (it->model == NULL)
+                    console.warn("Unable to load BSP '%s'", it->name.c_str());
+            }
+        }
+
+        BspManager::BspManager() :
+        m_loader(new EntityModelLoader<Bsp>()) {}
 
         BspManager::~BspManager() {
+            delete m_loader;
+            m_loader = NULL;
             BspMap::iterator it, end;
             for (it = m_bsps.begin(), end = m_bsps.end(); it != end; ++it)
                 delete it->second;
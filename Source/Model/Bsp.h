@@ -21,6 +21,7 @@
 #define TrenchBroom_Bsp_h
 
 #include "IO/Pak.h"
+#include "Model/EntityModelLoader.h"
 #include "Utility/Console.h"
 #include "Utility/VecMath.h"
 
@@ -186,6 +187,7 @@ namespace TrenchBroom {
             typedef std::vector<int> BspFaceEdgeIndexList;
 
             String m_name;
+            IO::MappedFile::Ptr m_file;
             BspModelList m_models;
             BspTextureList m_textures;
             BspTextureInfoList m_textureInfos;
@@ -197,7 +199,7 @@ namespace TrenchBroom {
             void readFaces(char*& cursor, unsigned int count, BspFaceInfoList& faces);
             void readFaceEdges(char*& cursor, unsigned int count, BspFaceEdgeIndexList& indices);
         public:
-            Bsp(const String& name, char* begin, char* end);
+            Bsp(const String& name, IO::MappedFile::Ptr file);
             ~Bsp();
             
             inline const BspModelList& models() const {
@@ -210,6 +212,7 @@ namespace TrenchBroom {
             typedef std::map<String, Bsp*> BspMap;
             
             BspMap m_bsps;
+            EntityModelLoader<Bsp>* m_loader;
         public:
             static BspManager* sharedManager;
             
@@ -217,6 +220,11 @@ namespace TrenchBroom {
             ~BspManager();
 
             const Bsp* bsp(const String& name, const StringList& paths, Utility::Console& console);
+            
+            // Queues the model for parsing on the loader thread. Returns false if the model could not be found.
+            bool loadBsp(const String& name, const StringList& paths, Utility::Console& console);
+            bool loading(const String& name, const StringList& paths);
+            void collectLoadedBsps(Utility::Console& console);
         };
     }
 }
@@ -0,0 +1,74 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ClassnameTable.h"
+
+namespace TrenchBroom {
+    namespace Model {
+        size_t ClassnameTable::hash(const String& name) {
+            // FNV-1a
+            size_t hash = 2166136261u;
+            for (size_t i = 0; i < name.size(); i++) {
+                hash ^= static_cast<size_t>(static_cast<unsigned char>(name[i]));
+                hash *= 16777619u;
+            }
+            return hash;
+        }
+
+        void ClassnameTable::rehash(const size_t slotCount) {
+            SlotList slots(slotCount, 0);
+            const size_t mask = slotCount - 1;
+            for (size_t i = 0; i < m_entries.size(); i++) {
+                size_t slot = m_entries[i].hash & mask;
+                while (slots[slot] != 0)
+                    slot = (slot + 1) & mask;
+                slots[slot] = static_cast<IdType>(i + 1);
+            }
+            m_slots.swap(slots);
+        }
+
+        ClassnameTable::ClassnameTable() :
+        m_slots(256, 0) {
+            const IdType noId = intern("");
+            assert(noId == NoClassname);
+        }
+
+        ClassnameTable::IdType ClassnameTable::intern(const String& name) {
+            if (2 * (m_entries.size() + 1) > m_slots.size())
+                rehash(2 * m_slots.size());
+
+            const size_t nameHash = hash(name);
+            const size_t mask = m_slots.size() - 1;
+
+            size_t slot = nameHash & mask;
+            while (m_slots[slot] != 0) {
+                const IdType id = m_slots[slot] - 1;
+                const Entry& entry = m_entries[id];
+                if (entry.hash == nameHash && entry.name == name)
+                    return id;
+                slot = (slot + 1) & mask;
+            }
+
+            const IdType newId = static_cast<IdType>(m_entries.size());
+            m_entries.push_back(Entry(name, nameHash));
+            m_slots[slot] = newId + 1;
+            return newId;
+        }
+    }
+}
@@ -0,0 +1,77 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __TrenchBroom__ClassnameTable__
+#define __TrenchBroom__ClassnameTable__
+
+#include "Utility/String.h"
+
+#include <cassert>
+#include <deque>
+#include <vector>
+
+namespace TrenchBroom {
+    namespace Model {
+        // Interns entity classnames so that entities can be bound to their definitions by a small integer ID. The
+        // table is not synchronized and must only be modified from the main thread.
+        class ClassnameTable {
+        public:
+            typedef unsigned int IdType;
+            static const IdType NoClassname = 0;
+        private:
+            struct Entry {
+                String name;
+                size_t hash;
+
+                Entry(const String& i_name, const size_t i_hash) :
+                name(i_name),
+                hash(i_hash) {}
+            };
+
+            typedef std::deque<Entry> EntryList;
+            typedef std::vector<IdType> SlotList;
+
+            EntryList m_entries;
+            SlotList m_slots; // open addressing, stores ID + 1 so that 0 marks a free slot
+
+            static size_t hash(const String& name);
+            void rehash(size_t slotCount);
+
+            ClassnameTable();
+        public:
+            inline static ClassnameTable& table() {
+                static ClassnameTable table;
+                return table;
+            }
+
+            IdType intern(const String& name);
+
+            inline const String& name(const IdType id) const {
+                assert(id < m_entries.size());
+                return m_entries[id].name;
+            }
+
+            inline size_t size() const {
+                return m_entries.size();
+            }
+        };
+    }
+}
+
+#endif /* defined(__TrenchBroom__ClassnameTable__) */
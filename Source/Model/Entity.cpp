@@ -248,10 +248,12 @@ namespace TrenchBroom {
         void Entity::init() {
             m_map = NULL;
             m_worldspawn = false;
+            m_classnameId = ClassnameTable::NoClassname;
             m_definition = NULL;
             setEditState(EditState::Default);
             m_selectedBrushCount = 0;
             m_hiddenBrushCount = 0;
+            m_linkRevision = 0;
             setProperty(SpawnFlagsKey, "0");
             invalidateGeometry();
         }
@@ -519,6 +521,7 @@ namespace TrenchBroom {
         void Entity::setProperties(const PropertyList& properties, bool replace) {
             if (replace) {
                 m_propertyStore.clear();
+                m_classnameId = ClassnameTable::NoClassname;
                 setProperty(SpawnFlagsKey, "0");
             }
             PropertyList::const_iterator it, end;
@@ -562,6 +565,7 @@ namespace TrenchBroom {
             
             if (key == ClassnameKey && value != classname()) {
                 m_worldspawn = *value == WorldspawnClassname;
+                m_classnameId = ClassnameTable::table().intern(*value);
                 setDefinition(NULL);
             }
             
@@ -595,6 +599,7 @@ namespace TrenchBroom {
             else
                 m_propertyStore.setPropertyValue(key, *value);
             invalidateGeometry();
+            invalidateFilterMatch();
         }
         
         StringList Entity::linkTargetnames() const {
@@ -21,6 +21,7 @@
 #define __TrenchBroom__Entity__
 
 #include "Model/BrushTypes.h"
+#include "Model/ClassnameTable.h"
 #include "Model/EditState.h"
 #include "Model/EntityTypes.h"
 #include "Model/MapObject.h"
@@ -77,6 +78,7 @@ namespace TrenchBroom {
             PropertyStore m_propertyStore;
             BrushList m_brushes;
             bool m_worldspawn;
+            ClassnameTable::IdType m_classnameId;
 
             EntityDefinition* m_definition;
 
@@ -93,6 +95,7 @@ namespace TrenchBroom {
             EntityList m_linkSources;
             EntityList m_killTargets;
             EntityList m_killSources;
+            unsigned int m_linkRevision;
 
             void addLinkTarget(Entity& entity);
             void removeLinkTarget(Entity& entity);
@@ -194,6 +197,15 @@ namespace TrenchBroom {
                 return m_killSources;
             }
 
+            // the map revision at which the outgoing links of this entity last changed
+            inline unsigned int linkRevision() const {
+                return m_linkRevision;
+            }
+
+            inline void setLinkRevision(const unsigned int linkRevision) {
+                m_linkRevision = linkRevision;
+            }
+
             inline const PropertyValue* classname() const {
                 return propertyForKey(ClassnameKey);
             }
@@ -205,6 +217,10 @@ namespace TrenchBroom {
                 return NoClassnameValue;
             }
 
+            inline ClassnameTable::IdType classnameId() const {
+                return m_classnameId;
+            }
+
             inline bool worldspawn() const {
                 return m_worldspawn;
             }
@@ -19,6 +19,7 @@
 
 #include "EntityDefinitionManager.h"
 
+#include "IO/EntityDefinitionCache.h"
 #include "IO/FileManager.h"
 #include "IO/DefParser.h"
 #include "IO/FgdParser.h"
@@ -59,11 +60,18 @@ namespace TrenchBroom {
         void EntityDefinitionManager::load(const String& path) {
             Preferences::PreferenceManager& prefs = Preferences::PreferenceManager::preferences();
             const Color& defaultColor = prefs.getColor(Preferences::EntityBoundsColor);
-            EntityDefinitionMap newDefinitions;
+            EntityDefinitionList definitions;
             
             IO::FileManager fileManager;
-            IO::MappedFile::Ptr file = fileManager.mapFile(path);
-            if (file.get() != NULL) {
+            IO::EntityDefinitionCache cache;
+            const time_t modificationTime = fileManager.modificationTime(path);
+            if (!cache.read(path, modificationTime, defaultColor, definitions)) {
+                IO::MappedFile::Ptr file = fileManager.mapFile(path);
+                if (file.get() == NULL) {
+                    m_console.error("Unable to open entity definition file %s", path.c_str());
+                    return;
+                }
+                
                 try {
                     const String extension = fileManager.pathExtension(path);
                     if (Utility::equalsString(extension, "def", false)) {
@@ -71,29 +79,41 @@ namespace TrenchBroom {
                         
                         EntityDefinition* definition = NULL;
                         while ((definition = parser.nextDefinition()) != NULL)
-                            Utility::insertOrReplace(newDefinitions, definition->name(), definition);
+                            definitions.push_back(definition);
                     } else if (Utility::equalsString(extension, "fgd", false)) {
-                        IO::FgdParser parser(file->begin(), file->end(), defaultColor);
-                        
-                        EntityDefinition* definition = NULL;
-                        while ((definition = parser.nextDefinition()) != NULL)
-                            Utility::insertOrReplace(newDefinitions, definition->name(), definition);
+                        IO::FgdParser::parseDefinitions(file->begin(), file->end(), defaultColor, definitions);
                     }
-                    
-                    clear();
-                    m_entityDefinitions = newDefinitions;
-                    m_path = path;
                 } catch (IO::ParserException& e) {
-                    Utility::deleteAll(newDefinitions);
+                    Utility::deleteAll(definitions);
                     m_console.error(e.what());
+                    return;
                 }
-            } else {
-                m_console.error("Unable to open entity definition file %s", path.c_str());
+                
+                cache.write(path, modificationTime, defaultColor, definitions);
+            }
+            
+            EntityDefinitionMap newDefinitions;
+            EntityDefinitionList::const_iterator it, end;
+            for (it = definitions.begin(), end = definitions.end(); it != end; ++it)
+                Utility::insertOrReplace(newDefinitions, (*it)->name(), *it);
+            
+            clear();
+            m_entityDefinitions = newDefinitions;
+            m_path = path;
+            
+            ClassnameTable& classnames = ClassnameTable::table();
+            EntityDefinitionMap::const_iterator definitionIt, definitionEnd;
+            for (definitionIt = m_entityDefinitions.begin(), definitionEnd = m_entityDefinitions.end(); definitionIt != definitionEnd; ++definitionIt) {
+                const ClassnameTable::IdType classnameId = classnames.intern(definitionIt->first);
+                if (classnameId >= m_definitionsByClassnameId.size())
+                    m_definitionsByClassnameId.resize(classnameId + 1, NULL);
+                m_definitionsByClassnameId[classnameId] = definitionIt->second;
             }
         }
         
         void EntityDefinitionManager::clear() {
             Utility::deleteAll(m_entityDefinitions);
+            m_definitionsByClassnameId.clear();
         }
 
         EntityDefinition* EntityDefinitionManager::definition(const String& name) {
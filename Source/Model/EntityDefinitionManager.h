@@ -19,6 +19,7 @@
 #ifndef __TrenchBroom__EntityDefinitionManager__
 #define __TrenchBroom__EntityDefinitionManager__
 
+#include "Model/ClassnameTable.h"
 #include "Model/EntityDefinitionTypes.h"
 #include "Model/EntityDefinition.h"
 #include "Utility/String.h"
@@ -70,6 +71,7 @@ namespace TrenchBroom {
             Utility::Console& m_console;
             String m_path;
             EntityDefinitionMap m_entityDefinitions;
+            EntityDefinitionList m_definitionsByClassnameId;
         public:
             EntityDefinitionManager(Utility::Console& console);
             ~EntityDefinitionManager();
@@ -80,6 +82,13 @@ namespace TrenchBroom {
             void clear();
             
             EntityDefinition* definition(const String& name);
+            
+            inline EntityDefinition* definition(const ClassnameTable::IdType classnameId) const {
+                if (classnameId < m_definitionsByClassnameId.size())
+                    return m_definitionsByClassnameId[classnameId];
+                return NULL;
+            }
+            
             EntityDefinitionList definitions(EntityDefinition::Type type, SortOrder order = Name);
             EntityDefinitionGroups groups(EntityDefinition::Type type, SortOrder order = Name);
         };
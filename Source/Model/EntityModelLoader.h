@@ -0,0 +1,163 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_EntityModelLoader_h
+#define TrenchBroom_EntityModelLoader_h
+
+#include "IO/AbstractFileManager.h"
+#include "Utility/String.h"
+
+#include <wx/thread.h>
+#include <wx/utils.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace TrenchBroom {
+    namespace Model {
+        // Parses models from their mapped files on a background thread. The files must be found on the main thread
+        // because the game file system is not thread safe. Finished models are kept until they are collected, models
+        // that could not be parsed are collected as NULL.
+        template <class T>
+        class EntityModelLoader : public wxThread {
+        public:
+            struct Result {
+                String key;
+                String name;
+                T* model;
+                
+                Result(const String& i_key, const String& i_name, T* i_model) :
+                key(i_key),
+                name(i_name),
+                model(i_model) {}
+            };
+            
+            typedef std::vector<Result> ResultList;
+        private:
+            struct Request {
+                String key;
+                String name;
+                IO::MappedFile::Ptr file;
+                
+                Request() {}
+                
+                Request(const String& i_key, const String& i_name, IO::MappedFile::Ptr i_file) :
+                key(i_key),
+                name(i_name),
+                file(i_file) {}
+            };
+            
+            typedef std::vector<Request> RequestList;
+            
+            wxMutex m_mutex;
+            wxCondition m_condition;
+            RequestList m_requests;
+            ResultList m_results;
+            StringList m_keys;
+            bool m_running;
+            
+            ExitCode Entry() {
+                while (!TestDestroy()) {
+                    Request request;
+                    {
+                        wxMutexLocker lock(m_mutex);
+                        if (m_requests.empty()) {
+                            m_condition.WaitTimeout(100);
+                            continue;
+                        }
+                        
+                        request = m_requests.front();
+                        m_requests.erase(m_requests.begin());
+                    }
+                    
+                    // an exception must not escape the thread
+                    T* model = NULL;
+                    try {
+                        model = new T(request.name, request.file);
+                    } catch (...) {
+                        model = NULL;
+                    }
+                    
+                    {
+                        wxMutexLocker lock(m_mutex);
+                        m_results.push_back(Result(request.key, request.name, model));
+                    }
+                    
+                    // the main thread collects the result when it becomes idle
+                    wxWakeUpIdle();
+                }
+                return (ExitCode)0;
+            }
+        public:
+            EntityModelLoader() :
+            wxThread(wxTHREAD_JOINABLE),
+            m_condition(m_mutex),
+            m_running(false) {
+                m_running = Create() == wxTHREAD_NO_ERROR && Run() == wxTHREAD_NO_ERROR;
+            }
+            
+            ~EntityModelLoader() {
+                stop();
+                
+                typename ResultList::const_iterator it, end;
+                for (it = m_results.begin(), end = m_results.end(); it != end; ++it)
+                    delete it->model;
+                m_results.clear();
+            }
+            
+            // returns false if the loader thread could not be started
+            bool load(const String& key, const String& name, IO::MappedFile::Ptr file) {
+                if (!m_running)
+                    return false;
+                
+                wxMutexLocker lock(m_mutex);
+                if (std::find(m_keys.begin(), m_keys.end(), key) == m_keys.end()) {
+                    m_keys.push_back(key);
+                    m_requests.push_back(Request(key, name, file));
+                    m_condition.Signal();
+                }
+                return true;
+            }
+            
+            // whether the model with the given key is queued, being parsed or waiting to be collected
+            bool loading(const String& key) {
+                wxMutexLocker lock(m_mutex);
+                return std::find(m_keys.begin(), m_keys.end(), key) != m_keys.end();
+            }
+            
+            void collect(ResultList& results) {
+                wxMutexLocker lock(m_mutex);
+                typename ResultList::const_iterator it, end;
+                for (it = m_results.begin(), end = m_results.end(); it != end; ++it)
+                    m_keys.erase(std::find(m_keys.begin(), m_keys.end(), it->key));
+                results.insert(results.end(), m_results.begin(), m_results.end());
+                m_results.clear();
+            }
+            
+            void stop() {
+                if (m_running) {
+                    Delete();
+                    m_running = false;
+                }
+            }
+        };
+    }
+}
+
+#endif
@@ -148,6 +148,7 @@ namespace TrenchBroom {
             m_xScale = 1.0f;
             m_yScale = 1.0f;
             m_brush = NULL;
+            m_textureNameId = TextureNameTable::EmptyName;
             m_texture = NULL;
             m_filePosition = 0;
             m_selected = false;
@@ -208,27 +209,17 @@ namespace TrenchBroom {
             unsigned int width = m_texture != NULL ? m_texture->width() : 1;
             unsigned int height = m_texture != NULL ? m_texture->height() : 1;
             
-            size_t vertexCount = m_side->vertices.size();
-            m_vertexCache.resize(3 * (vertexCount - 2));
-            
-            Vec2f texCoords;
-            size_t j = 0;
-            for (size_t i = 1; i < vertexCount - 1; i++) {
-                m_vertexCache[j++] = Renderer::FaceVertex(m_side->vertices[0]->position,
-                                                          m_boundary.normal,
-                                                          Vec2f((m_side->vertices[0]->position.dot(m_scaledTexAxisX) + m_xOffset) / width,
-                                                                (m_side->vertices[0]->position.dot(m_scaledTexAxisY) + m_yOffset) / height)
-                                                          );
-                m_vertexCache[j++] = Renderer::FaceVertex(m_side->vertices[i]->position,
-                                                          m_boundary.normal,
-                                                          Vec2f((m_side->vertices[i]->position.dot(m_scaledTexAxisX) + m_xOffset) / width,
-                                                                (m_side->vertices[i]->position.dot(m_scaledTexAxisY) + m_yOffset) / height)
-                                                          );
-                m_vertexCache[j++] = Renderer::FaceVertex(m_side->vertices[i+1]->position,
-                                                          m_boundary.normal,
-                                                          Vec2f((m_side->vertices[i+1]->position.dot(m_scaledTexAxisX) + m_xOffset) / width,
-                                                                (m_side->vertices[i+1]->position.dot(m_scaledTexAxisY) + m_yOffset) / height)
-                                                          );
+            const size_t vertexCount = m_side->vertices.size();
+            m_vertexCache.resize(vertexCount);
+            
+            // the vertices are rendered as a triangle fan
+            for (size_t i = 0; i < vertexCount; i++) {
+                const Vec3f& position = m_side->vertices[i]->position;
+                m_vertexCache[i] = Renderer::FaceVertex(position,
+                                                        m_boundary.normal,
+                                                        Vec2f((position.dot(m_scaledTexAxisX) + m_xOffset) / width,
+                                                              (position.dot(m_scaledTexAxisY) + m_yOffset) / height)
+                                                        );
             }
             
             m_vertexCacheValid = true;
@@ -372,25 +363,29 @@ namespace TrenchBroom {
         }
         
         void Face::updateContentType() {
-            if (!m_textureName.empty()) {
-                if (m_textureName[0] == '*')
+            const String& textureName = this->textureName();
+            if (!textureName.empty()) {
+                if (textureName[0] == '*')
                     m_contentType = CTLiquid;
-                else if (Utility::containsString(m_textureName, "clip", false))
+                else if (Utility::containsString(textureName, "clip", false))
                     m_contentType = CTClip;
-                else if (Utility::containsString(m_textureName, "skip", false))
+                else if (Utility::containsString(textureName, "skip", false))
                     m_contentType = CTSkip;
-                else if (Utility::containsString(m_textureName, "hint", false))
+                else if (Utility::containsString(textureName, "hint", false))
                     m_contentType = CTHint;
-                else if (Utility::containsString(m_textureName, "trigger", false))
+                else if (Utility::containsString(textureName, "trigger", false))
                     m_contentType = CTTrigger;
                 else
                     m_contentType = CTDefault;
             } else {
                 m_contentType = CTDefault;
             }
+            
+            if (m_brush != NULL)
+                m_brush->invalidateContentTypes();
         }
 
-        Face::Face(const BBoxf& worldBounds, bool forceIntegerFacePoints, const Vec3f& point1, const Vec3f& point2, const Vec3f& point3, const String& textureName) : m_worldBounds(worldBounds), m_textureName(textureName) {
+        Face::Face(const BBoxf& worldBounds, bool forceIntegerFacePoints, const Vec3f& point1, const Vec3f& point2, const Vec3f& point3, const String& textureName) : m_worldBounds(worldBounds) {
             init();
             m_worldBounds = worldBounds;
             m_forceIntegerFacePoints = forceIntegerFacePoints;
@@ -416,7 +411,7 @@ namespace TrenchBroom {
         m_boundary(face.boundary()),
         m_worldBounds(face.worldBounds()),
         m_forceIntegerFacePoints(face.forceIntegerFacePoints()),
-        m_textureName(face.textureName()),
+        m_textureNameId(face.textureNameId()),
         m_texture(face.texture()),
         m_xOffset(face.xOffset()),
         m_yOffset(face.yOffset()),
@@ -480,14 +475,21 @@ namespace TrenchBroom {
             if (brush == m_brush)
                 return;
             
-            if (m_brush != NULL && m_selected)
-                m_brush->decSelectedFaceCount();
+            if (m_brush != NULL) {
+                if (m_selected)
+                    m_brush->decSelectedFaceCount();
+                m_brush->invalidateContentTypes();
+            }
             m_brush = brush;
-            if (m_brush != NULL && m_selected)
-                m_brush->incSelectedFaceCount();
+            if (m_brush != NULL) {
+                if (m_selected)
+                    m_brush->incSelectedFaceCount();
+                m_brush->invalidateContentTypes();
+            }
         }
         
         void Face::updatePointsFromVertices() {
+            assert(m_side != NULL);
             Vec3f v1, v2;
             
             const size_t vertexCount = m_side->vertices.size();
@@ -560,7 +562,7 @@ namespace TrenchBroom {
             
             m_texture = texture;
             if (m_texture != NULL)
-                m_textureName = texture->name();
+                m_textureNameId = texture->nameId();
             
             if (m_texture != NULL)
                 m_texture->incUsageCount();
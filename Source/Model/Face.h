@@ -22,6 +22,7 @@
 
 #include "Model/BrushGeometry.h"
 #include "Model/FaceTypes.h"
+#include "Model/TextureNameTable.h"
 #include "Renderer/FaceVertex.h"
 #include "Utility/Allocator.h"
 #include "Utility/FindPlanePoints.h"
@@ -67,7 +68,7 @@ namespace TrenchBroom {
             static const FindFloatFacePoints Instance;
         };
 
-        class Face : public Utility::Allocator<Face> {
+        class Face : public Utility::Allocator<Face, 64, 256, GeometryAllocatorLock> {
         public:
             enum ContentType {
                 CTLiquid,
@@ -115,7 +116,7 @@ namespace TrenchBroom {
             BBoxf m_worldBounds;
             bool m_forceIntegerFacePoints;
 
-            String m_textureName;
+            TextureNameTable::IdType m_textureNameId;
             Texture* m_texture;
             float m_xOffset;
             float m_yOffset;
@@ -232,11 +233,19 @@ namespace TrenchBroom {
             }
             
             inline const String& textureName() const {
-                return m_textureName;
+                return TextureNameTable::table().name(m_textureNameId);
+            }
+
+            inline TextureNameTable::IdType textureNameId() const {
+                return m_textureNameId;
             }
 
             inline void setTextureName(const String& textureName) {
-                m_textureName = textureName;
+                setTextureNameId(TextureNameTable::table().intern(textureName));
+            }
+
+            inline void setTextureNameId(const TextureNameTable::IdType textureNameId) {
+                m_textureNameId = textureNameId;
                 updateContentType();
             }
 
@@ -310,7 +319,7 @@ namespace TrenchBroom {
                 setXOffset(face.xOffset());
                 setYOffset(face.yOffset());
                 setRotation(face.rotation());
-                setTextureName(face.textureName());
+                setTextureNameId(face.textureNameId());
                 setTexture(face.texture());
             }
 
@@ -94,15 +94,19 @@ namespace TrenchBroom {
 
                 const String& pattern = m_viewOptions.filterPattern();
                 if (!pattern.empty()) {
+                    bool matches = false;
+                    if (entity.filterMatch(m_viewOptions.filterGeneration(), matches))
+                        return matches;
+                    
                     const Model::PropertyList& properties = entity.properties();
                     Model::PropertyList::const_iterator it, end;
-                    for (it = properties.begin(), end = properties.end(); it != end; ++it) {
-                        const Model::Property property = *it;
-                        if (Utility::containsString(property.key(), pattern, false) ||
-                            Utility::containsString(property.value(), pattern, false))
-                            return true;
+                    for (it = properties.begin(), end = properties.end(); it != end && !matches; ++it) {
+                        const Model::Property& property = *it;
+                        matches = (Utility::containsString(property.key(), pattern, false) ||
+                                   Utility::containsString(property.value(), pattern, false));
                     }
-                    return false;
+                    entity.setFilterMatch(m_viewOptions.filterGeneration(), matches);
+                    return matches;
                 }
 
                 return true;
@@ -139,48 +143,33 @@ namespace TrenchBroom {
                             return false;
                     }
                     
+                    unsigned int hiddenContentTypes = 0;
+                    if (!m_viewOptions.showClipBrushes())
+                        hiddenContentTypes |= (1u << Face::CTClip);
+                    if (!m_viewOptions.showSkipBrushes())
+                        hiddenContentTypes |= (1u << Face::CTSkip);
+                    if (!m_viewOptions.showHintBrushes())
+                        hiddenContentTypes |= (1u << Face::CTHint);
+                    if (!m_viewOptions.showLiquidBrushes())
+                        hiddenContentTypes |= (1u << Face::CTLiquid);
+                    if (!m_viewOptions.showTriggerBrushes())
+                        hiddenContentTypes |= (1u << Face::CTTrigger);
+                    if ((brush.contentTypes() & hiddenContentTypes) != 0)
+                        return false;
+                    
+                    if (pattern.empty())
+                        return true;
+                    
+                    bool matches = false;
+                    if (brush.filterMatch(m_viewOptions.filterGeneration(), matches))
+                        return matches;
+                    
                     const Model::FaceList& faces = brush.faces();
-                    unsigned int clipCount = 0;
-                    unsigned int skipCount = 0;
-                    unsigned int hintCount = 0;
-                    unsigned int liquidCount = 0;
-                    unsigned int triggerCount = 0;
-                    bool matches = pattern.empty();
-                    for (unsigned int i = 0; i < faces.size(); i++) {
-                        switch (faces[i]->contentType()) {
-                            case Face::CTLiquid:
-                                liquidCount++;
-                                break;
-                            case Face::CTClip:
-                                clipCount++;
-                                break;
-                            case Face::CTSkip:
-                                skipCount++;
-                                break;
-                            case Face::CTHint:
-                                hintCount++;
-                                break;
-                            case Face::CTTrigger:
-                                triggerCount++;
-                                break;
-                            default:
-                                if (!matches)
-                                    matches = Utility::containsString(faces[i]->textureName(), pattern, false);
-                                break;
-                        }
+                    for (size_t i = 0; i < faces.size() && !matches; i++) {
+                        if (faces[i]->contentType() == Face::CTDefault)
+                            matches = Utility::containsString(faces[i]->textureName(), pattern, false);
                     }
-
-                    if (!m_viewOptions.showClipBrushes() && clipCount == faces.size())
-                        return false;
-                    if (!m_viewOptions.showSkipBrushes() && skipCount == faces.size())
-                        return false;
-                    if (!m_viewOptions.showHintBrushes() && hintCount == faces.size())
-                        return false;
-                    if (!m_viewOptions.showLiquidBrushes() && liquidCount == faces.size())
-                        return false;
-                    if (!m_viewOptions.showTriggerBrushes() && triggerCount == faces.size())
-                        return false;
-
+                    brush.setFilterMatch(m_viewOptions.filterGeneration(), matches);
                     return matches;
                 }
 
@@ -25,6 +25,29 @@
 
 namespace TrenchBroom {
     namespace Model {
+        void Map::touchEntityLinks(Entity& entity) {
+            entity.setLinkRevision(++m_linkRevision);
+        }
+        
+        void Map::touchEntityLinkSources(const String* targetname) {
+            if (targetname != NULL && !targetname->empty()) {
+                typedef TargetnameEntityMap::const_iterator MapIt;
+                MapIt it = m_entitiesWithTarget.find(*targetname);
+                if (it != m_entitiesWithTarget.end()) {
+                    EntitySet::const_iterator entityIt, entityEnd;
+                    for (entityIt = it->second.begin(), entityEnd = it->second.end(); entityIt != entityEnd; ++entityIt)
+                        touchEntityLinks(**entityIt);
+                }
+                
+                it = m_entitiesWithKillTarget.find(*targetname);
+                if (it != m_entitiesWithKillTarget.end()) {
+                    EntitySet::const_iterator entityIt, entityEnd;
+                    for (entityIt = it->second.begin(), entityEnd = it->second.end(); entityIt != entityEnd; ++entityIt)
+                        touchEntityLinks(**entityIt);
+                }
+            }
+        }
+        
         void Map::addEntityTargetname(Entity& entity, const String* targetname) {
             if (targetname != NULL && !targetname->empty())
                 m_entitiesWithTargetname[*targetname].insert(&entity);
@@ -107,7 +130,9 @@ namespace TrenchBroom {
         Map::Map(const BBoxf& worldBounds, bool forceIntegerFacePoints) :
         m_worldBounds(worldBounds),
         m_forceIntegerFacePoints(forceIntegerFacePoints),
-        m_worldspawn(NULL) {}
+        m_worldspawn(NULL),
+        m_linkRevision(0),
+        m_rebuildScope(NULL) {}
 
         Map::~Map() {
             clear();
@@ -135,6 +160,8 @@ namespace TrenchBroom {
                 addEntityTargets(entity);
                 addEntityKillTargets(entity);
                 entity.setMap(this);
+                touchEntityLinks(entity);
+                touchEntityLinkSources(entity.propertyForKey(Entity::TargetnameKey));
             }
         }
         
@@ -142,6 +169,8 @@ namespace TrenchBroom {
             if (entity.worldspawn())
                 m_worldspawn = NULL;
             entity.setMap(NULL);
+            touchEntityLinks(entity);
+            touchEntityLinkSources(entity.propertyForKey(Entity::TargetnameKey));
             removeEntityTargetname(entity, entity.propertyForKey(Entity::TargetnameKey));
             removeEntityTargets(entity);
             removeEntityKillTargets(entity);
@@ -159,6 +188,10 @@ namespace TrenchBroom {
         void Map::updateEntityTargetname(Entity& entity, const String* newTargetname, const String* oldTargetname) {
             removeEntityTargetname(entity, oldTargetname);
             addEntityTargetname(entity, newTargetname);
+            
+            // the sources of both names have gained or lost a target
+            touchEntityLinkSources(oldTargetname);
+            touchEntityLinkSources(newTargetname);
         }
 
         
@@ -173,6 +206,7 @@ namespace TrenchBroom {
         void Map::updateEntityTarget(Entity& entity, const String* newTargetname, const String* oldTargetname) {
             removeEntityTarget(entity, oldTargetname);
             addEntityTarget(entity, newTargetname);
+            touchEntityLinks(entity);
         }
         
         EntityList Map::entitiesWithKillTarget(const String& targetname) const {
@@ -186,6 +220,7 @@ namespace TrenchBroom {
         void Map::updateEntityKillTarget(Entity& entity, const String* newTargetname, const String* oldTargetname) {
             removeEntityKillTarget(entity, oldTargetname);
             addEntityKillTarget(entity, newTargetname);
+            touchEntityLinks(entity);
         }
 
         Entity* Map::worldspawn() {
@@ -204,6 +239,7 @@ namespace TrenchBroom {
             m_entitiesWithKillTarget.clear();
             Utility::deleteAll(m_entities);
             m_worldspawn = NULL;
+            m_linkRevision++;
         }
     }
 }
@@ -29,6 +29,7 @@ using namespace TrenchBroom::VecMath;
 
 namespace TrenchBroom {
     namespace Model {
+        class BrushRebuildScope;
         class Entity;
         
         class Map {
@@ -42,7 +43,12 @@ namespace TrenchBroom {
             TargetnameEntityMap m_entitiesWithTarget;
             TargetnameEntityMap m_entitiesWithKillTarget;
             Entity* m_worldspawn;
+            unsigned int m_linkRevision;
+            BrushRebuildScope* m_rebuildScope;
             
+            void touchEntityLinks(Entity& entity);
+            void touchEntityLinkSources(const String* targetname);
+
             void addEntityTargetname(Entity& entity, const String* targetname);
             void removeEntityTargetname(Entity& entity, const String* targetname);
 
@@ -81,12 +87,26 @@ namespace TrenchBroom {
             EntityList entitiesWithKillTarget(const String& targetname) const;
             void updateEntityKillTarget(Entity& entity, const String* newTargetname, const String* oldTargetname);
             
+            // incremented whenever the links between the entities change
+            inline unsigned int linkRevision() const {
+                return m_linkRevision;
+            }
+            
             inline const EntityList& entities() const {
                 return m_entities;
             }
             
             Entity* worldspawn();
             
+            // the scope that brush geometry rebuilds are deferred to, if any
+            inline BrushRebuildScope* rebuildScope() const {
+                return m_rebuildScope;
+            }
+            
+            inline void setRebuildScope(BrushRebuildScope* rebuildScope) {
+                m_rebuildScope = rebuildScope;
+            }
+            
             void clear();
         };
     }
@@ -27,6 +27,7 @@
 #include "IO/MapWriter.h"
 #include "IO/Wad.h"
 #include "Model/Brush.h"
+#include "Model/BrushRebuildScope.h"
 #include "Model/EditStateManager.h"
 #include "Model/Entity.h"
 #include "Model/EntityDefinitionManager.h"
@@ -158,8 +159,7 @@ namespace TrenchBroom {
                 for (size_t j = 0; j < brushes.size(); j++) {
                     const Model::FaceList& faces = brushes[j]->faces();
                     for (size_t k = 0; k < faces.size(); k++) {
-                        const String& textureName = faces[k]->textureName();
-                        Model::Texture* newTexture = m_textureManager->texture(textureName);
+                        Model::Texture* newTexture = m_textureManager->texture(faces[k]->textureNameId());
                         faces[k]->setTexture(newTexture);
                     }
                 }
@@ -291,12 +291,9 @@ namespace TrenchBroom {
         }
 
         void MapDocument::addEntity(Entity& entity) {
-            const String* classname = entity.classname();
-            if (classname != NULL) {
-                Model::EntityDefinition* definition = m_definitionManager->definition(*classname);
-                if (definition != NULL)
-                    entity.setDefinition(definition);
-            }
+            Model::EntityDefinition* definition = m_definitionManager->definition(entity.classnameId());
+            if (definition != NULL)
+                entity.setDefinition(definition);
             m_map->addEntity(entity);
             m_octree->addObject(entity);
 
@@ -310,7 +307,7 @@ namespace TrenchBroom {
                 FaceList::const_iterator faceIt, faceEnd;
                 for (faceIt = faces.begin(), faceEnd = faces.end(); faceIt != faceEnd; ++faceIt) {
                     Face& face = **faceIt;
-                    face.setTexture(m_textureManager->texture(face.textureName()));
+                    face.setTexture(m_textureManager->texture(face.textureNameId()));
                 }
             }
         }
@@ -360,7 +357,7 @@ namespace TrenchBroom {
             FaceList::const_iterator faceIt, faceEnd;
             for (faceIt = faces.begin(), faceEnd = faces.end(); faceIt != faceEnd; ++faceIt) {
                 Face& face = **faceIt;
-                face.setTexture(m_textureManager->texture(face.textureName()));
+                face.setTexture(m_textureManager->texture(face.textureNameId()));
             }
         }
 
@@ -443,6 +440,26 @@ namespace TrenchBroom {
             UpdateAllViews(NULL, &loadCommand);
         }
 
+        void MapDocument::rebuildBrushGeometries() {
+            BrushList brushes;
+            const EntityList& entities = m_map->entities();
+            EntityList::const_iterator it, end;
+            for (it = entities.begin(), end = entities.end(); it != end; ++it) {
+                const BrushList& entityBrushes = (*it)->brushes();
+                brushes.insert(brushes.end(), entityBrushes.begin(), entityBrushes.end());
+            }
+
+            brushesWillChange(brushes);
+            {
+                BrushRebuildScope rebuildScope(*m_map);
+                BrushList::const_iterator brushIt, brushEnd;
+                for (brushIt = brushes.begin(), brushEnd = brushes.end(); brushIt != brushEnd; ++brushIt)
+                    (*brushIt)->rebuildGeometry();
+                rebuildScope.rebuild();
+            }
+            brushesDidChange(brushes);
+        }
+
         Utility::Console& MapDocument::console() const {
             return *m_console;
         }
@@ -584,11 +601,7 @@ namespace TrenchBroom {
 
             for (unsigned int i = 0; i < entities.size(); i++) {
                 Entity& entity = *entities[i];
-                const PropertyValue* classname = entity.classname();
-                if (classname != NULL) {
-                    EntityDefinition* definition = m_definitionManager->definition(*classname);
-                    entity.setDefinition(definition);
-                }
+                entity.setDefinition(m_definitionManager->definition(entity.classnameId()));
             }
             
             m_octree->loadMap();
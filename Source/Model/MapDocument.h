@@ -114,6 +114,7 @@ namespace TrenchBroom {
             void brushesWillChange(const BrushList& brushes);
             void brushesDidChange(const BrushList& brushes);
             void setForceIntegerCoordinates(bool forceIntegerCoordinates);
+            void rebuildBrushGeometries();
             
             Utility::Console& console() const;
             Renderer::SharedResources& sharedResources() const;
@@ -41,6 +41,9 @@ namespace TrenchBroom {
             
             size_t m_fileFirstLine;
             size_t m_fileLineCount;
+            
+            mutable unsigned int m_filterGeneration;
+            mutable bool m_filterMatches;
         public:
             enum Type {
                 EntityObject,
@@ -51,7 +54,9 @@ namespace TrenchBroom {
             m_editState(EditState::Default),
             m_previouslyLocked(false),
             m_fileFirstLine(0),
-            m_fileLineCount(0) {
+            m_fileLineCount(0),
+            m_filterGeneration(0),
+            m_filterMatches(false) {
                 static unsigned int currentId = 1;
                 m_uniqueId = currentId++;
             }
@@ -96,6 +101,23 @@ namespace TrenchBroom {
                 return m_editState;
             }
             
+            // the result of matching this object against the filter pattern of the given filter generation
+            inline bool filterMatch(unsigned int filterGeneration, bool& matches) const {
+                if (m_filterGeneration != filterGeneration)
+                    return false;
+                matches = m_filterMatches;
+                return true;
+            }
+            
+            inline void setFilterMatch(unsigned int filterGeneration, bool matches) const {
+                m_filterGeneration = filterGeneration;
+                m_filterMatches = matches;
+            }
+            
+            inline void invalidateFilterMatch() const {
+                m_filterGeneration = 0;
+            }
+            
             virtual EditState::Type setEditState(EditState::Type editState) {
                 EditState::Type previous = m_editState;
                 
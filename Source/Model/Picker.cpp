@@ -21,6 +21,7 @@
 #include "Model/Face.h"
 #include "Model/MapObject.h"
 #include "Model/Octree.h"
+#include "Utility/Profiler.h"
 
 #include <algorithm>
 
@@ -114,12 +115,15 @@ namespace TrenchBroom {
         Picker::Picker(Octree& octree) : m_octree(octree) {}
 
         PickResult* Picker::pick(const Rayf& ray) {
+            PROFILE_SCOPE("Picker::pick");
             PickResult* pickResults = new PickResult();
 
             MapObjectList objects = m_octree.intersect(ray);
             for (unsigned int i = 0; i < objects.size(); i++)
                 objects[i]->pick(ray, *pickResults);
 
+            PROFILE_COUNT("Picker candidates", objects.size());
+            PROFILE_COUNT("Picker hits", pickResults->size());
             return pickResults;
         }
 
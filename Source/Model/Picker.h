@@ -127,6 +127,10 @@ namespace TrenchBroom {
             PickResult() : m_sorted(false) {}
             ~PickResult();
             
+            inline size_t size() const {
+                return m_hits.size();
+            }
+
             void add(Hit* hit);
             Hit* first(HitType::Type typeMask, bool ignoreOccluders, Filter& filter);
             HitList hits(HitType::Type typeMask, Filter& filter);
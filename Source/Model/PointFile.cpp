@@ -22,10 +22,142 @@
 #include "Controller/CameraEvent.h"
 #include "IO/FileManager.h"
 
-#include <fstream>
+#include <cmath>
+#include <utility>
 
 namespace TrenchBroom {
     namespace Model {
+        const float PointFile::StepLength = 64.0f;
+        const float PointFile::Tolerance = 1.0f;
+
+        static inline bool isSpace(const char c) {
+            return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+        }
+        
+        static inline bool isDigit(const char c) {
+            return c >= '0' && c <= '9';
+        }
+        
+        // parses a decimal number with an optional exponent, skipping leading whitespace
+        static bool parseFloat(const char*& cur, const char* end, float& result) {
+            while (cur < end && isSpace(*cur))
+                ++cur;
+            
+            const char* start = cur;
+            bool negative = false;
+            if (cur < end && (*cur == '-' || *cur == '+'))
+                negative = *cur++ == '-';
+            
+            double mantissa = 0.0;
+            int exponent = 0;
+            bool digits = false;
+            while (cur < end && isDigit(*cur)) {
+                mantissa = mantissa * 10.0 + (*cur++ - '0');
+                digits = true;
+            }
+            if (cur < end && *cur == '.') {
+                ++cur;
+                while (cur < end && isDigit(*cur)) {
+                    mantissa = mantissa * 10.0 + (*cur++ - '0');
+                    exponent--;
+                    digits = true;
+                }
+            }
+            
+            if (!digits) {
+                cur = start;
+                return false;
+            }
+            
+            if (cur < end && (*cur == 'e' || *cur == 'E')) {
+                const char* mark = cur++;
+                bool negativeExponent = false;
+                if (cur < end && (*cur == '-' || *cur == '+'))
+                    negativeExponent = *cur++ == '-';
+                if (cur < end && isDigit(*cur)) {
+                    int value = 0;
+                    while (cur < end && isDigit(*cur))
+                        value = value * 10 + (*cur++ - '0');
+                    exponent += negativeExponent ? -value : value;
+                } else {
+                    cur = mark;
+                }
+            }
+            
+            if (exponent != 0)
+                mantissa *= std::pow(10.0, exponent);
+            result = static_cast<float>(negative ? -mantissa : mantissa);
+            return true;
+        }
+        
+        static inline float squaredSegmentDistance(const Vec3f& point, const Vec3f& start, const Vec3f& end) {
+            const Vec3f axis = end - start;
+            const Vec3f offset = point - start;
+            const float axisLength2 = axis.lengthSquared();
+            float t = axisLength2 > 0.0f ? offset.dot(axis) / axisLength2 : 0.0f;
+            t = std::max(0.0f, std::min(1.0f, t));
+            return (offset - axis * t).lengthSquared();
+        }
+        
+        // Douglas-Peucker with an explicit stack, measuring the distance to the segments rather than to their lines
+        // so that a trace which doubles back on itself is kept. The trace is split into ranges of bounded length
+        // first so that the whole trace is not scanned at every split.
+        static void simplify(const Vec3f::List& points, const float tolerance, Vec3f::List& result) {
+            static const size_t MaxRangeLength = 1024;
+            result.clear();
+            if (points.size() <= 2) {
+                result = points;
+                return;
+            }
+            
+            typedef std::pair<size_t, size_t> Range;
+            std::vector<bool> keep(points.size(), false);
+            std::vector<bool> split(points.size(), false);
+            std::vector<Range> ranges;
+            keep.front() = true;
+            for (size_t first = 0; first < points.size() - 1; first += MaxRangeLength) {
+                const size_t last = std::min(first + MaxRangeLength, points.size() - 1);
+                keep[last] = true;
+                split[last] = last < points.size() - 1;
+                ranges.push_back(Range(first, last));
+            }
+            
+            const float maxDistance2 = tolerance * tolerance;
+            while (!ranges.empty()) {
+                const Range range = ranges.back();
+                ranges.pop_back();
+                
+                size_t farthest = range.first;
+                float farthestDistance2 = maxDistance2;
+                for (size_t i = range.first + 1; i < range.second; i++) {
+                    const float distance2 = squaredSegmentDistance(points[i], points[range.first], points[range.second]);
+                    if (distance2 > farthestDistance2) {
+                        farthest = i;
+                        farthestDistance2 = distance2;
+                    }
+                }
+                
+                if (farthest != range.first) {
+                    keep[farthest] = true;
+                    if (farthest - range.first > 1)
+                        ranges.push_back(Range(range.first, farthest));
+                    if (range.second - farthest > 1)
+                        ranges.push_back(Range(farthest, range.second));
+                }
+            }
+            
+            // the ends of the ranges are only kept if they are needed, and a trace that returns to a point within the
+            // tolerance must not produce an empty segment
+            size_t next = 0;
+            for (size_t i = 0; i < points.size(); i = next) {
+                for (next = i + 1; next < points.size() && !keep[next]; next++);
+                if (split[i] && squaredSegmentDistance(points[i], result.back(), points[next]) <= maxDistance2)
+                    continue;
+                if (result.empty() || !result.back().equals(points[i]))
+                    result.push_back(points[i]);
+            }
+        }
+        
         String PointFile::path(const String& mapFilePath) {
             IO::FileManager fileManager;
             String mapFileBasePath = fileManager.deleteExtension(mapFilePath);
@@ -33,59 +165,36 @@ namespace TrenchBroom {
         }
 
         void PointFile::load(const String& mapFilePath) {
-            static const float threshold = Math<float>::radians(15.0f);
+            IO::FileManager fileManager;
+            IO::MappedFile::Ptr file = fileManager.mapFile(path(mapFilePath));
             
-            String pointFilePath = path(mapFilePath);
-            std::fstream stream(pointFilePath.c_str(), std::ios_base::in);
-            assert(stream.is_open());
-
             Vec3f::List points;
-            
-            String line;
-            if (!stream.eof()) {
-                std::getline(stream, line);
-                points.push_back(Vec3f(line));
-                Vec3f lastPoint = points.back();
+            if (file.get() != NULL) {
+                const char* cur = file->begin();
+                const char* end = file->end();
+                points.reserve(file->size() / 24);
                 
-                if (!stream.eof()) {
-                    std::getline(stream, line);
-                    Vec3f curPoint(line);
-                    Vec3f refDir = (curPoint - lastPoint).normalized();
-                    
-                    while (!stream.eof()) {
-                        lastPoint = curPoint;
-                        std::getline(stream, line);
-                        curPoint = Vec3f(line);
-                        
-                        Vec3f dir = (curPoint - lastPoint).normalized();
-                        if (std::acos(dir.dot(refDir)) > threshold) {
-                            points.push_back(lastPoint);
-                            refDir = dir;
-                        }
-                    }
-                    
-                    points.push_back(curPoint);
+                Vec3f point;
+                while (parseFloat(cur, end, point[0]) && parseFloat(cur, end, point[1]) && parseFloat(cur, end, point[2])) {
+                    if (points.empty() || !points.back().equals(point))
+                        points.push_back(point);
                 }
             }
             
-            if (points.size() > 1) {
-                for (size_t i = 0; i < points.size() - 1; i++) {
-                    const Vec3f& curPoint = points[i];
-                    const Vec3f& nextPoint = points[i + 1];
-                    const Vec3f dir = (nextPoint - curPoint).normalized();
-                    
-                    m_points.push_back(curPoint);
-                    float dist = (nextPoint - curPoint).length();
-                    unsigned int segments = static_cast<unsigned int>(dist / 64.0f);
-                    for (unsigned int j = 1; j < segments; j++)
-                        m_points.push_back(curPoint + dir * static_cast<float>(j) * 64.0f);
-                }
-                m_points.push_back(points.back());
+            simplify(points, Tolerance, m_points);
+            
+            m_distances.resize(m_points.size());
+            float distance = 0.0f;
+            for (size_t i = 0; i < m_points.size(); i++) {
+                if (i > 0)
+                    distance += m_points[i].distanceTo(m_points[i - 1]);
+                m_distances[i] = distance;
             }
         }
         
         PointFile::PointFile(const String& mapFilePath) :
-        m_current(0) {
+        m_segment(0),
+        m_step(0) {
             assert(exists(mapFilePath));
             load(mapFilePath);
         }
@@ -94,5 +203,32 @@ namespace TrenchBroom {
             IO::FileManager fileManager;
             return fileManager.exists(path(mapFilePath));
         }
+        
+        void PointFile::seek(const float distance) {
+            m_step = 0;
+            if (m_points.size() <= 1 || distance <= 0.0f) {
+                m_segment = 0;
+                return;
+            }
+            if (distance >= length()) {
+                m_segment = m_points.size() - 1;
+                return;
+            }
+            
+            m_segment = static_cast<size_t>(std::upper_bound(m_distances.begin(), m_distances.end(), distance) - m_distances.begin()) - 1;
+            const size_t step = static_cast<size_t>((distance - m_distances[m_segment]) / StepLength);
+            m_step = std::min(step, stepCount(m_segment) - 1);
+        }
+        
+        Vec3f PointFile::pointAtDistance(const float distance) const {
+            assert(!m_points.empty());
+            if (m_points.size() == 1 || distance <= 0.0f)
+                return m_points.front();
+            if (distance >= length())
+                return m_points.back();
+            
+            const size_t segment = static_cast<size_t>(std::upper_bound(m_distances.begin(), m_distances.end(), distance) - m_distances.begin()) - 1;
+            return m_points[segment] + segmentDirection(segment) * (distance - m_distances[segment]);
+        }
     }
 }
@@ -23,56 +23,99 @@
 #include "Utility/String.h"
 #include "Utility/VecMath.h"
 
+#include <algorithm>
 #include <cassert>
+#include <vector>
 
 using namespace TrenchBroom::VecMath;
 
 namespace TrenchBroom {
     namespace Model {
+        // The trace is simplified for display, and navigation steps along it in increments of StepLength, stopping
+        // at every vertex. The stops are not stored, but computed from the cumulative distances of the vertices.
         class PointFile {
         private:
+            static const float StepLength;
+            static const float Tolerance;
+
             Vec3f::List m_points;
-            size_t m_current;
+            std::vector<float> m_distances;
+            size_t m_segment;
+            size_t m_step;
             
             static String path(const String& mapFilePath);
             void load(const String& mapFilePath);
+            
+            inline size_t stepCount(const size_t segment) const {
+                const float length = m_distances[segment + 1] - m_distances[segment];
+                return std::max(static_cast<size_t>(length / StepLength), static_cast<size_t>(1));
+            }
+            
+            inline Vec3f segmentDirection(const size_t segment) const {
+                return (m_points[segment + 1] - m_points[segment]).normalized();
+            }
         public:
             PointFile(const String& mapFilePath);
             static bool exists(const String& mapFilePath);
             
             inline bool hasNextPoint() const {
-                return m_current < m_points.size() - 1;
+                return m_segment + 1 < m_points.size();
             }
             
             inline bool hasPreviousPoint() const {
-                return m_current > 0;
+                return m_segment > 0 || m_step > 0;
             }
             
-            inline const Vec3f::List points() const {
+            inline const Vec3f::List& points() const {
                 return m_points;
             }
-           
-            inline const Vec3f& currentPoint() const {
-                return m_points[m_current];
+            
+            inline float length() const {
+                return m_distances.empty() ? 0.0f : m_distances.back();
             }
             
-            inline const Vec3f& nextPoint() {
+            inline float currentDistance() const {
+                return m_distances[m_segment] + m_step * StepLength;
+            }
+            
+            inline Vec3f currentPoint() const {
+                assert(!m_points.empty());
+                if (m_step == 0)
+                    return m_points[m_segment];
+                return m_points[m_segment] + segmentDirection(m_segment) * (m_step * StepLength);
+            }
+            
+            inline Vec3f nextPoint() {
                 assert(hasNextPoint());
-                return m_points[++m_current];
+                if (++m_step >= stepCount(m_segment)) {
+                    m_segment++;
+                    m_step = 0;
+                }
+                return currentPoint();
             }
             
-            inline const Vec3f& previousPoint() {
+            inline Vec3f previousPoint() {
                 assert(hasPreviousPoint());
-                return m_points[--m_current];
+                if (m_step > 0) {
+                    m_step--;
+                } else {
+                    m_segment--;
+                    m_step = stepCount(m_segment) - 1;
+                }
+                return currentPoint();
             }
             
-            inline const Vec3f direction() const {
+            inline Vec3f direction() const {
                 if (m_points.size() <= 1)
                     return Vec3f::PosX;
-                if (m_current >= m_points.size() - 1)
-                    return (m_points[m_points.size() - 1] - m_points[m_points.size() - 2]).normalized();
-                return (m_points[m_current + 1] - m_points[m_current]).normalized();
+                if (m_segment >= m_points.size() - 1)
+                    return segmentDirection(m_points.size() - 2);
+                return segmentDirection(m_segment);
             }
+            
+            // moves to the last stop at or before the given distance along the trace
+            void seek(float distance);
+            Vec3f pointAtDistance(float distance) const;
         };
     }
 }
@@ -21,6 +21,7 @@
 #define __TrenchBroom__Texture__
 
 #include <GL/glew.h>
+#include "Model/TextureNameTable.h"
 #include "Utility/String.h"
 
 namespace TrenchBroom {
@@ -34,6 +35,7 @@ namespace TrenchBroom {
         protected:
             TextureCollection& m_collection;
             String m_name;
+            TextureNameTable::IdType m_nameId;
             IdType m_uniqueId;
             unsigned int m_width;
             unsigned int m_height;
@@ -43,6 +45,7 @@ namespace TrenchBroom {
             Texture(TextureCollection& collection, const String& name, unsigned int width, unsigned int height) :
             m_collection(collection),
             m_name(name),
+            m_nameId(TextureNameTable::table().intern(name)),
             m_width(width),
             m_height(height),
             m_usageCount(0),
@@ -58,6 +61,10 @@ namespace TrenchBroom {
             inline const String& name() const {
                 return m_name;
             }
+
+            inline TextureNameTable::IdType nameId() const {
+                return m_nameId;
+            }
             
             inline IdType uniqueId() const {
                 return m_uniqueId;
@@ -83,12 +83,14 @@ namespace TrenchBroom {
 
         void TextureManager::reloadTextures() {
             m_collectionMap.clear();
-            m_texturesCaseSensitive.clear();
-            m_texturesCaseInsensitive.clear();
+            m_texturesByNameId.clear();
+            m_texturesByFoldedNameId.clear();
             m_texturesByName.clear();
             m_texturesByUsage.clear();
 
-            typedef std::pair<TextureMap::iterator, bool> InsertResult;
+            const TextureNameTable& names = TextureNameTable::table();
+            m_texturesByNameId.resize(names.size(), NULL);
+            m_texturesByFoldedNameId.resize(names.size(), NULL);
 
             for (size_t i = 0; i < m_collections.size(); i++) {
                 TextureCollection* collection = m_collections[i];
@@ -97,22 +99,22 @@ namespace TrenchBroom {
                     Texture* texture = textures[j];
                     m_collectionMap[texture] = collection;
 
-                    InsertResult result = m_texturesCaseSensitive.insert(TextureMapEntry(texture->name(), texture));
-                    if (!result.second) { // texture with this name already existed
-                        result.first->second->setOverridden(true);
-                        m_texturesCaseSensitive.erase(result.first);
-                        m_texturesCaseSensitive.insert(TextureMapEntry(texture->name(), texture));
-                    }
-                    m_texturesCaseInsensitive[Utility::toLower(texture->name())] = texture;
+                    Texture*& current = m_texturesByNameId[texture->nameId()];
+                    if (current != NULL) // texture with this name already existed
+                        current->setOverridden(true);
+                    current = texture;
+                    m_texturesByFoldedNameId[names.foldedId(texture->nameId())] = texture;
                     texture->setOverridden(false);
                 }
             }
 
-            TextureMap::iterator it, end;
-            for (it = m_texturesCaseSensitive.begin(), end = m_texturesCaseSensitive.end(); it != end; ++it) {
-                Texture* texture = it->second;
-                m_texturesByName.push_back(texture);
-                m_texturesByUsage.push_back(texture);
+            TextureList::const_iterator it, end;
+            for (it = m_texturesByNameId.begin(), end = m_texturesByNameId.end(); it != end; ++it) {
+                Texture* texture = *it;
+                if (texture != NULL) {
+                    m_texturesByName.push_back(texture);
+                    m_texturesByUsage.push_back(texture);
+                }
             }
 
             std::sort(m_texturesByName.begin(), m_texturesByName.end(), CompareTexturesByName());
@@ -157,8 +159,8 @@ namespace TrenchBroom {
         }
 
         void TextureManager::clear() {
-            m_texturesCaseSensitive.clear();
-            m_texturesCaseInsensitive.clear();
+            m_texturesByNameId.clear();
+            m_texturesByFoldedNameId.clear();
             m_texturesByName.clear();
             m_texturesByUsage.clear();
             m_collectionMap.clear();
@@ -113,8 +113,8 @@ namespace TrenchBroom {
             
             TextureCollectionList m_collections;
             TextureCollectionMap m_collectionMap;
-            TextureMap m_texturesCaseSensitive;
-            TextureMap m_texturesCaseInsensitive;
+            TextureList m_texturesByNameId;
+            TextureList m_texturesByFoldedNameId;
             TextureList m_texturesByName;
             mutable TextureList m_texturesByUsage;
             void reloadTextures();
@@ -137,14 +137,20 @@ namespace TrenchBroom {
                 return m_texturesByUsage;
             }
             
-            inline Texture* texture(const std::string& name) {
-                TextureMap::iterator it = m_texturesCaseSensitive.find(name);
-                if (it == m_texturesCaseSensitive.end()) {
-                    it = m_texturesCaseInsensitive.find(Utility::toLower(name));
-                    if (it == m_texturesCaseInsensitive.end())
-                        return NULL;
-                }
-                return it->second;
+            inline Texture* texture(const TextureNameTable::IdType nameId) const {
+                if (nameId < m_texturesByNameId.size() && m_texturesByNameId[nameId] != NULL)
+                    return m_texturesByNameId[nameId];
+                const TextureNameTable::IdType foldedId = TextureNameTable::table().foldedId(nameId);
+                if (foldedId < m_texturesByFoldedNameId.size())
+                    return m_texturesByFoldedNameId[foldedId];
+                return NULL;
+            }
+
+            inline Texture* texture(const String& name) const {
+                TextureNameTable::IdType nameId;
+                if (!TextureNameTable::table().find(name, nameId))
+                    return NULL;
+                return texture(nameId);
             }
             
             inline String wadProperty() const {
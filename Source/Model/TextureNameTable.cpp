@@ -0,0 +1,115 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TextureNameTable.h"
+
+#include <cctype>
+
+namespace TrenchBroom {
+    namespace Model {
+        size_t TextureNameTable::foldedHash(const String& name) {
+            // FNV-1a over the lower case characters
+            size_t hash = 2166136261u;
+            for (size_t i = 0; i < name.size(); i++) {
+                hash ^= static_cast<size_t>(std::tolower(static_cast<unsigned char>(name[i])));
+                hash *= 16777619u;
+            }
+            return hash;
+        }
+
+        bool TextureNameTable::equalsFolded(const String& str1, const String& str2) {
+            if (str1.size() != str2.size())
+                return false;
+            for (size_t i = 0; i < str1.size(); i++)
+                if (std::tolower(static_cast<unsigned char>(str1[i])) != std::tolower(static_cast<unsigned char>(str2[i])))
+                    return false;
+            return true;
+        }
+
+        void TextureNameTable::rehash(const size_t slotCount) {
+            SlotList slots(slotCount, 0);
+            const size_t mask = slotCount - 1;
+            for (size_t i = 0; i < m_entries.size(); i++) {
+                size_t slot = m_entries[i].foldedHash & mask;
+                while (slots[slot] != 0)
+                    slot = (slot + 1) & mask;
+                slots[slot] = static_cast<IdType>(i + 1);
+            }
+            m_slots.swap(slots);
+        }
+
+        TextureNameTable::TextureNameTable() :
+        m_slots(256, 0) {
+            const IdType emptyId = intern("");
+            assert(emptyId == EmptyName);
+        }
+
+        TextureNameTable::IdType TextureNameTable::intern(const String& name) {
+            if (2 * (m_entries.size() + 1) > m_slots.size())
+                rehash(2 * m_slots.size());
+
+            const size_t hash = foldedHash(name);
+            const size_t mask = m_slots.size() - 1;
+            const IdType newId = static_cast<IdType>(m_entries.size());
+            IdType foldedId = newId;
+
+            // all case variants of a name have the same hash and therefore end up in the same probe sequence
+            size_t slot = hash & mask;
+            while (m_slots[slot] != 0) {
+                const IdType id = m_slots[slot] - 1;
+                const Entry& entry = m_entries[id];
+                if (entry.foldedHash == hash) {
+                    if (entry.name == name)
+                        return id;
+                    if (foldedId == newId && equalsFolded(entry.name, name))
+                        foldedId = entry.foldedId;
+                }
+                slot = (slot + 1) & mask;
+            }
+
+            m_entries.push_back(Entry(name, hash, foldedId));
+            m_slots[slot] = newId + 1;
+            return newId;
+        }
+
+        bool TextureNameTable::find(const String& name, IdType& id) const {
+            const size_t hash = foldedHash(name);
+            const size_t mask = m_slots.size() - 1;
+            bool found = false;
+
+            size_t slot = hash & mask;
+            while (m_slots[slot] != 0) {
+                const IdType candidate = m_slots[slot] - 1;
+                const Entry& entry = m_entries[candidate];
+                if (entry.foldedHash == hash) {
+                    if (entry.name == name) {
+                        id = candidate;
+                        return true;
+                    }
+                    if (!found && equalsFolded(entry.name, name)) {
+                        id = candidate;
+                        found = true;
+                    }
+                }
+                slot = (slot + 1) & mask;
+            }
+            return found;
+        }
+    }
+}
@@ -0,0 +1,89 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __TrenchBroom__TextureNameTable__
+#define __TrenchBroom__TextureNameTable__
+
+#include "Utility/String.h"
+
+#include <cassert>
+#include <deque>
+#include <vector>
+
+namespace TrenchBroom {
+    namespace Model {
+        // Interns texture names so that faces and textures can refer to them by a small integer ID. Names that
+        // only differ in case share a folded ID, which is used for case insensitive texture lookups. The table is
+        // not synchronized and must only be modified from the main thread.
+        class TextureNameTable {
+        public:
+            typedef unsigned int IdType;
+            static const IdType EmptyName = 0;
+        private:
+            struct Entry {
+                String name;
+                size_t foldedHash;
+                IdType foldedId;
+
+                Entry(const String& i_name, const size_t i_foldedHash, const IdType i_foldedId) :
+                name(i_name),
+                foldedHash(i_foldedHash),
+                foldedId(i_foldedId) {}
+            };
+
+            // a deque keeps the names in place when the table grows, so references returned by name() stay valid
+            typedef std::deque<Entry> EntryList;
+            typedef std::vector<IdType> SlotList;
+
+            EntryList m_entries;
+            SlotList m_slots; // open addressing, stores ID + 1 so that 0 marks a free slot
+
+            static size_t foldedHash(const String& name);
+            static bool equalsFolded(const String& str1, const String& str2);
+            void rehash(size_t slotCount);
+
+            TextureNameTable();
+        public:
+            inline static TextureNameTable& table() {
+                static TextureNameTable table;
+                return table;
+            }
+
+            IdType intern(const String& name);
+            // looks up a name without interning it; if only a case variant is known, its ID is returned
+            bool find(const String& name, IdType& id) const;
+
+            inline const String& name(const IdType id) const {
+                assert(id < m_entries.size());
+                return m_entries[id].name;
+            }
+
+            inline IdType foldedId(const IdType id) const {
+                assert(id < m_entries.size());
+                return m_entries[id].foldedId;
+            }
+
+            inline size_t size() const {
+                return m_entries.size();
+            }
+        };
+    }
+}
+
+#endif /* defined(__TrenchBroom__TextureNameTable__) */
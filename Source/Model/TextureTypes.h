@@ -31,8 +31,6 @@ namespace TrenchBroom {
         class TextureCollection;
         
         typedef std::vector<Texture*> TextureList;
-        typedef std::map<String, Texture*> TextureMap;
-        typedef std::pair<String, Texture*> TextureMapEntry;
         typedef std::auto_ptr<Texture> TexturePtr;
         typedef std::vector<TextureCollection*> TextureCollectionList;
     }
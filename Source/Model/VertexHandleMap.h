@@ -0,0 +1,364 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_VertexHandleMap_h
+#define TrenchBroom_VertexHandleMap_h
+
+#include "Utility/VecMath.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+using namespace TrenchBroom::VecMath;
+
+namespace TrenchBroom {
+    namespace Model {
+        // Entries are kept in a flat list for iteration and bucketed into a hashed uniform grid for lookups.
+        template <typename Element>
+        class VertexHandleMap {
+        public:
+            typedef std::vector<Element*> List;
+            typedef std::pair<Vec3f, List> Entry;
+            typedef std::vector<Entry> EntryList;
+            typedef typename EntryList::iterator iterator;
+            typedef typename EntryList::const_iterator const_iterator;
+        private:
+            typedef std::vector<size_t> IndexList;
+
+            struct CellKey {
+                int x, y, z;
+
+                CellKey() : x(0), y(0), z(0) {}
+                CellKey(const int i_x, const int i_y, const int i_z) : x(i_x), y(i_y), z(i_z) {}
+
+                inline bool operator==(const CellKey& rhs) const {
+                    return x == rhs.x && y == rhs.y && z == rhs.z;
+                }
+
+                inline bool operator<(const CellKey& rhs) const {
+                    if (x != rhs.x)
+                        return x < rhs.x;
+                    if (y != rhs.y)
+                        return y < rhs.y;
+                    return z < rhs.z;
+                }
+
+                inline size_t hash() const {
+                    return static_cast<size_t>(x) * 73856093u ^ static_cast<size_t>(y) * 19349663u ^ static_cast<size_t>(z) * 83492791u;
+                }
+            };
+
+            typedef std::vector<CellKey> CellKeyList;
+
+            struct Cell {
+                CellKey key;
+                IndexList entries;
+
+                Cell(const CellKey& i_key) : key(i_key) {}
+            };
+
+            typedef std::vector<Cell> Bucket;
+            typedef std::vector<Bucket> BucketList;
+
+            float m_cellSize;
+            EntryList m_entries;
+            BucketList m_buckets;
+            size_t m_cellCount;
+            BBoxf m_bounds;
+
+            inline int cellCoord(const float f) const {
+                return static_cast<int>(std::floor(f / m_cellSize));
+            }
+
+            inline CellKey cellKey(const Vec3f& position) const {
+                return CellKey(cellCoord(position.x()), cellCoord(position.y()), cellCoord(position.z()));
+            }
+
+            inline Bucket& bucket(const CellKey& key) {
+                return m_buckets[key.hash() & (m_buckets.size() - 1)];
+            }
+
+            inline const Bucket& bucket(const CellKey& key) const {
+                return m_buckets[key.hash() & (m_buckets.size() - 1)];
+            }
+
+            inline const Cell* findCell(const CellKey& key) const {
+                const Bucket& cells = bucket(key);
+                for (size_t i = 0; i < cells.size(); i++)
+                    if (cells[i].key == key)
+                        return &cells[i];
+                return NULL;
+            }
+
+            inline Cell& findOrCreateCell(const CellKey& key) {
+                Bucket& cells = bucket(key);
+                for (size_t i = 0; i < cells.size(); i++)
+                    if (cells[i].key == key)
+                        return cells[i];
+
+                if (m_cellCount >= m_buckets.size()) {
+                    rehash(2 * m_buckets.size());
+                    return findOrCreateCell(key);
+                }
+
+                cells.push_back(Cell(key));
+                m_cellCount++;
+                return cells.back();
+            }
+
+            inline void removeFromCell(const CellKey& key, const size_t index) {
+                Bucket& cells = bucket(key);
+                for (size_t i = 0; i < cells.size(); i++) {
+                    if (cells[i].key == key) {
+                        IndexList& entries = cells[i].entries;
+                        IndexList::iterator it = std::find(entries.begin(), entries.end(), index);
+                        assert(it != entries.end());
+                        entries.erase(it);
+                        if (entries.empty()) {
+                            cells[i] = cells.back();
+                            cells.pop_back();
+                            m_cellCount--;
+                        }
+                        return;
+                    }
+                }
+                assert(false);
+            }
+
+            inline void replaceInCell(const CellKey& key, const size_t oldIndex, const size_t newIndex) {
+                Bucket& cells = bucket(key);
+                for (size_t i = 0; i < cells.size(); i++) {
+                    if (cells[i].key == key) {
+                        IndexList& entries = cells[i].entries;
+                        std::replace(entries.begin(), entries.end(), oldIndex, newIndex);
+                        return;
+                    }
+                }
+                assert(false);
+            }
+
+            void rehash(const size_t bucketCount) {
+                BucketList buckets(bucketCount);
+                typename BucketList::iterator bIt, bEnd;
+                for (bIt = m_buckets.begin(), bEnd = m_buckets.end(); bIt != bEnd; ++bIt) {
+                    Bucket& cells = *bIt;
+                    for (size_t i = 0; i < cells.size(); i++)
+                        buckets[cells[i].key.hash() & (bucketCount - 1)].push_back(cells[i]);
+                }
+                m_buckets.swap(buckets);
+            }
+
+            inline void addCellsAround(const CellKey& key, const int extent, CellKeyList& result) const {
+                for (int x = key.x - extent; x <= key.x + extent; x++)
+                    for (int y = key.y - extent; y <= key.y + extent; y++)
+                        for (int z = key.z - extent; z <= key.z + extent; z++)
+                            result.push_back(CellKey(x, y, z));
+            }
+
+            inline bool clipRay(const Rayf& ray, const float radius, float& tMin, float& tMax) const {
+                const BBoxf bounds = m_bounds.expanded(radius);
+                for (size_t i = 0; i < 3; i++) {
+                    const float origin = ray.origin[i];
+                    const float direction = ray.direction[i];
+                    if (Math<float>::zero(direction)) {
+                        if (origin < bounds.min[i] || origin > bounds.max[i])
+                            return false;
+                    } else {
+                        float t1 = (bounds.min[i] - origin) / direction;
+                        float t2 = (bounds.max[i] - origin) / direction;
+                        if (t1 > t2)
+                            std::swap(t1, t2);
+                        tMin = std::max(tMin, t1);
+                        tMax = std::min(tMax, t2);
+                        if (tMin > tMax)
+                            return false;
+                    }
+                }
+                return true;
+            }
+        public:
+            VertexHandleMap(const float cellSize = 64.0f) :
+            m_cellSize(cellSize),
+            m_buckets(64),
+            m_cellCount(0) {
+                assert(m_cellSize > 0.0f);
+            }
+
+            inline iterator begin() {
+                return m_entries.begin();
+            }
+
+            inline iterator end() {
+                return m_entries.end();
+            }
+
+            inline const_iterator begin() const {
+                return m_entries.begin();
+            }
+
+            inline const_iterator end() const {
+                return m_entries.end();
+            }
+
+            inline bool empty() const {
+                return m_entries.empty();
+            }
+
+            inline size_t size() const {
+                return m_entries.size();
+            }
+
+            iterator find(const Vec3f& position) {
+                const EntryList& entries = m_entries;
+                const_iterator it = static_cast<const VertexHandleMap<Element>&>(*this).find(position);
+                return m_entries.begin() + (it - entries.begin());
+            }
+
+            const_iterator find(const Vec3f& position) const {
+                // the position may be within epsilon of a cell boundary
+                const float epsilon = Math<float>::AlmostZero;
+                const CellKey minKey = cellKey(position - Vec3f(epsilon, epsilon, epsilon));
+                const CellKey maxKey = cellKey(position + Vec3f(epsilon, epsilon, epsilon));
+
+                for (int x = minKey.x; x <= maxKey.x; x++) {
+                    for (int y = minKey.y; y <= maxKey.y; y++) {
+                        for (int z = minKey.z; z <= maxKey.z; z++) {
+                            const Cell* cell = findCell(CellKey(x, y, z));
+                            if (cell != NULL) {
+                                const IndexList& entries = cell->entries;
+                                for (size_t i = 0; i < entries.size(); i++) {
+                                    const size_t index = entries[i];
+                                    if (m_entries[index].first.equals(position, epsilon))
+                                        return m_entries.begin() + index;
+                                }
+                            }
+                        }
+                    }
+                }
+                return m_entries.end();
+            }
+
+            List& operator[](const Vec3f& position) {
+                iterator it = find(position);
+                if (it != m_entries.end())
+                    return it->second;
+
+                const size_t index = m_entries.size();
+                m_entries.push_back(Entry(position, List()));
+                findOrCreateCell(cellKey(position)).entries.push_back(index);
+
+                if (index == 0)
+                    m_bounds = BBoxf(position, position);
+                else
+                    m_bounds.mergeWith(position);
+                return m_entries.back().second;
+            }
+
+            // moves the last entry into the erased slot
+            void erase(iterator it) {
+                assert(it >= m_entries.begin() && it < m_entries.end());
+
+                const size_t index = static_cast<size_t>(it - m_entries.begin());
+                const size_t lastIndex = m_entries.size() - 1;
+                removeFromCell(cellKey(it->first), index);
+
+                if (index != lastIndex) {
+                    Entry& last = m_entries[lastIndex];
+                    replaceInCell(cellKey(last.first), lastIndex, index);
+                    it->first = last.first;
+                    it->second.swap(last.second);
+                }
+                m_entries.pop_back();
+            }
+
+            void clear() {
+                m_entries.clear();
+                m_buckets.clear();
+                m_buckets.resize(64);
+                m_cellCount = 0;
+            }
+
+            void findCandidates(const Rayf& ray, const float maxDistance, const float radius, Vec3f::List& result) const {
+                if (m_entries.empty())
+                    return;
+
+                float tMin = 0.0f;
+                float tMax = maxDistance;
+                if (!clipRay(ray, radius, tMin, tMax))
+                    return;
+
+                const Vec3f start = ray.pointAtDistance(tMin);
+                CellKey key = cellKey(start);
+                int cell[3] = { key.x, key.y, key.z };
+                int step[3];
+                float tNext[3];
+                float tDelta[3];
+
+                for (size_t i = 0; i < 3; i++) {
+                    const float direction = ray.direction[i];
+                    if (Math<float>::zero(direction)) {
+                        step[i] = 0;
+                        tNext[i] = std::numeric_limits<float>::max();
+                        tDelta[i] = std::numeric_limits<float>::max();
+                    } else {
+                        step[i] = direction > 0.0f ? 1 : -1;
+                        const float boundary = (cell[i] + (step[i] > 0 ? 1 : 0)) * m_cellSize;
+                        tNext[i] = tMin + (boundary - start[i]) / direction;
+                        tDelta[i] = m_cellSize / std::abs(direction);
+                    }
+                }
+
+                const int extent = static_cast<int>(std::ceil(radius / m_cellSize));
+                CellKeyList keys;
+                while (true) {
+                    addCellsAround(CellKey(cell[0], cell[1], cell[2]), extent, keys);
+
+                    size_t axis = 0;
+                    if (tNext[1] < tNext[axis])
+                        axis = 1;
+                    if (tNext[2] < tNext[axis])
+                        axis = 2;
+                    if (tNext[axis] > tMax)
+                        break;
+
+                    cell[axis] += step[axis];
+                    tNext[axis] += tDelta[axis];
+                }
+
+                std::sort(keys.begin(), keys.end());
+                typename CellKeyList::iterator keyEnd = std::unique(keys.begin(), keys.end());
+
+                typename CellKeyList::const_iterator kIt;
+                for (kIt = keys.begin(); kIt != keyEnd; ++kIt) {
+                    const Cell* found = findCell(*kIt);
+                    if (found != NULL) {
+                        const IndexList& entries = found->entries;
+                        for (size_t i = 0; i < entries.size(); i++)
+                            result.push_back(m_entries[entries[i]].first);
+                    }
+                }
+            }
+        };
+    }
+}
+
+#endif
@@ -83,6 +83,12 @@ namespace TrenchBroom {
                 return attr;
             }
             
+            // three signed bytes plus one byte of padding, glNormalPointer only reads the first three
+            static const Attribute& normal3b() {
+                static const Attribute attr = Attribute(4, GL_BYTE, Normal);
+                return attr;
+            }
+            
             static const Attribute& color4f() {
                 static const Attribute attr = Attribute(4, GL_FLOAT, Color);
                 return attr;
@@ -465,8 +471,8 @@ namespace TrenchBroom {
                 assert(m_attributes[0].valueType() == GL_FLOAT);
                 assert(m_attributes[0].size() == 3);
                 assert(m_attributes[1].attributeType() == Attribute::Normal);
-                assert(m_attributes[1].valueType() == GL_FLOAT);
-                assert(m_attributes[1].size() == 3);
+                assert(m_attributes[1].valueType() == GL_BYTE);
+                assert(m_attributes[1].size() == 4);
                 assert(m_attributes[2].attributeType() == Attribute::TexCoord0);
                 assert(m_attributes[2].valueType() == GL_FLOAT);
                 assert(m_attributes[2].size() == 2);
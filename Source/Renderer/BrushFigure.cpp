@@ -96,9 +96,9 @@ namespace TrenchBroom {
                 
                 if (!m_brushes.empty()) {
                     if (m_edgeMode == EMDefault)
-                        m_edgeRenderer = new EdgeRenderer(vbo, m_brushes, Model::EmptyFaceList, m_edgeColor);
+                        m_edgeRenderer = new EdgeRenderer(vbo, m_brushes, m_edgeColor);
                     else
-                        m_edgeRenderer = new EdgeRenderer(vbo, m_brushes, Model::EmptyFaceList);
+                        m_edgeRenderer = new EdgeRenderer(vbo, m_brushes);
                 }
                 m_edgeRendererValid = true;
             }
@@ -25,139 +25,315 @@
 #include "Model/EntityDefinition.h"
 #include "Model/Face.h"
 #include "Renderer/RenderContext.h"
+#include "Renderer/Vbo.h"
 #include "Renderer/VertexArray.h"
 #include "Renderer/Shader/ShaderManager.h"
 #include "Renderer/Shader/ShaderProgram.h"
 
+#include <algorithm>
+#include <cmath>
+
 namespace TrenchBroom {
     namespace Renderer {
-        unsigned int EdgeRenderer::vertexCount(const Model::BrushList& brushes, const Model::FaceList& faces) {
-            Model::BrushList::const_iterator brushIt, brushEnd;
-            Model::FaceList::const_iterator faceIt, faceEnd;
-            unsigned int vertexCount = 0;
-            
-            for (brushIt = brushes.begin(), brushEnd = brushes.end(); brushIt != brushEnd; ++brushIt) {
-                const Model::Brush& brush = **brushIt;
-                vertexCount += brush.edges().size();
+        typedef std::vector<GLuint> VertexIndexList;
+        typedef std::pair<GLuint, GLuint> EdgeKey;
+        
+        struct EdgeRecord {
+            EdgeKey key;
+            size_t brushIndex;
+            const Model::Face* left;
+            const Model::Face* right;
+            
+            EdgeRecord(const EdgeKey& i_key, size_t i_brushIndex, const Model::Face* i_left, const Model::Face* i_right) :
+            key(i_key),
+            brushIndex(i_brushIndex),
+            left(i_left),
+            right(i_right) {}
+            
+            inline bool operator<(const EdgeRecord& rhs) const {
+                if (key != rhs.key)
+                    return key < rhs.key;
+                return brushIndex < rhs.brushIndex;
+            }
+        };
+        
+        typedef std::vector<EdgeRecord> EdgeRecordList;
+        
+        static inline int quantize(const float f) {
+            return static_cast<int>(std::floor(static_cast<double>(f) / Math<double>::AlmostZero + 0.5));
+        }
+        
+        static inline bool sameVertex(const Vec3f& lhs, const Vec3f& rhs) {
+            return quantize(lhs.x()) == quantize(rhs.x()) && quantize(lhs.y()) == quantize(rhs.y()) && quantize(lhs.z()) == quantize(rhs.z());
+        }
+        
+        static inline size_t vertexHash(const Vec3f& position, const GLuint colorIndex) {
+            return (static_cast<size_t>(quantize(position.x())) * 73856093u ^
+                    static_cast<size_t>(quantize(position.y())) * 19349663u ^
+                    static_cast<size_t>(quantize(position.z())) * 83492791u ^
+                    static_cast<size_t>(colorIndex) * 2654435761u);
+        }
+        
+        // Returns the index of the vertex at the given position and with the given color, adding it if necessary.
+        // The slots form an open addressing hash table holding vertex indices plus one.
+        static GLuint weldVertex(const Vec3f& position, const GLuint colorIndex, Vec3f::List& positions, VertexIndexList& colorIndices, VertexIndexList& slots) {
+            if (2 * (positions.size() + 1) > slots.size()) {
+                VertexIndexList newSlots(std::max(static_cast<size_t>(64), 2 * slots.size()), 0);
+                const size_t mask = newSlots.size() - 1;
+                for (size_t i = 0; i < positions.size(); i++) {
+                    size_t slot = vertexHash(positions[i], colorIndices[i]) & mask;
+                    while (newSlots[slot] != 0)
+                        slot = (slot + 1) & mask;
+                    newSlots[slot] = static_cast<GLuint>(i + 1);
+                }
+                slots.swap(newSlots);
             }
             
-            for (faceIt = faces.begin(), faceEnd = faces.end(); faceIt != faceEnd; ++faceIt) {
-                const Model::Face& face = **faceIt;
-                vertexCount += face.edges().size();
+            const size_t mask = slots.size() - 1;
+            size_t slot = vertexHash(position, colorIndex) & mask;
+            while (slots[slot] != 0) {
+                const GLuint index = slots[slot] - 1;
+                if (colorIndices[index] == colorIndex && sameVertex(positions[index], position))
+                    return index;
+                slot = (slot + 1) & mask;
             }
             
-            return 2 * vertexCount;
+            positions.push_back(position);
+            colorIndices.push_back(colorIndex);
+            slots[slot] = static_cast<GLuint>(positions.size());
+            return static_cast<GLuint>(positions.size() - 1);
         }
         
-        void EdgeRenderer::writeEdgeData(Vbo& vbo, const Model::BrushList& brushes, const Model::FaceList& faces) {
-            m_vertexArray = new VertexArray(vbo, GL_LINES, vertexCount(brushes, faces),
-                                            Attribute::position3f());
-
-            Model::BrushList::const_iterator brushIt, brushEnd;
-            for (brushIt = brushes.begin(), brushEnd = brushes.end(); brushIt != brushEnd; ++brushIt) {
-                const Model::Brush& brush = **brushIt;
-                const Model::EdgeList& edges = brush.edges();
-                Model::EdgeList::const_iterator edgeIt, edgeEnd;
-                for (edgeIt = edges.begin(), edgeEnd = edges.end(); edgeIt != edgeEnd; ++edgeIt) {
-                    const Model::Edge& edge = **edgeIt;
-                    m_vertexArray->addAttribute(edge.start->position);
-                    m_vertexArray->addAttribute(edge.end->position);
+        static void weldEdges(const Model::EdgeList& edges, const size_t brushIndex, const GLuint colorIndex, Vec3f::List& positions, VertexIndexList& colorIndices, VertexIndexList& slots, EdgeRecordList& records) {
+            Model::EdgeList::const_iterator edgeIt, edgeEnd;
+            for (edgeIt = edges.begin(), edgeEnd = edges.end(); edgeIt != edgeEnd; ++edgeIt) {
+                const Model::Edge& edge = **edgeIt;
+                const GLuint start = weldVertex(edge.start->position, colorIndex, positions, colorIndices, slots);
+                const GLuint end = weldVertex(edge.end->position, colorIndex, positions, colorIndices, slots);
+                if (start != end) {
+                    const EdgeKey key = start < end ? EdgeKey(start, end) : EdgeKey(end, start);
+                    const Model::Face* left = edge.left != NULL ? edge.left->face : NULL;
+                    const Model::Face* right = edge.right != NULL ? edge.right->face : NULL;
+                    records.push_back(EdgeRecord(key, brushIndex, left, right));
+                }
+            }
+        }
+        
+        static GLuint colorIndex(const Color& color, std::vector<Color>& colors) {
+            for (size_t i = 0; i < colors.size(); i++)
+                if (colors[i] == color)
+                    return static_cast<GLuint>(i);
+            colors.push_back(color);
+            return static_cast<GLuint>(colors.size() - 1);
+        }
+        
+        static const Color& brushColor(const Model::Brush& brush, const Color& defaultColor) {
+            const Model::Entity* entity = brush.entity();
+            const Model::EntityDefinition* definition = entity != NULL ? entity->definition() : NULL;
+            return (entity != NULL && !entity->worldspawn() && definition != NULL && definition->type() == Model::EntityDefinition::BrushEntity) ? definition->color() : defaultColor;
+        }
+        
+        // Edge vertices with the same position and color are welded, and edges shared by adjacent faces or brushes are
+        // only drawn once. The render state of such an edge is combined from the states of all brushes that share it.
+        void EdgeRenderer::writeEdgeData(Vbo& vbo, const Model::BrushList& brushes, const Color* defaultColor) {
+            Vec3f::List positions;
+            VertexIndexList colorIndices;
+            VertexIndexList slots;
+            EdgeRecordList records;
+            std::vector<Color> colors;
+            
+            m_brushEntries.reserve(brushes.size());
+            for (size_t i = 0; i < brushes.size(); i++) {
+                const Model::Brush& brush = *brushes[i];
+                const GLuint index = defaultColor != NULL ? colorIndex(brushColor(brush, *defaultColor), colors) : 0;
+                weldEdges(brush.edges(), i, index, positions, colorIndices, slots, records);
+                m_brushEntries.push_back(BrushEntry(&brush, i));
+            }
+            std::sort(m_brushEntries.begin(), m_brushEntries.end());
+            m_brushStates.resize(brushes.size(), RenderState::Default);
+            
+            if (records.empty())
+                return;
+            
+            std::sort(records.begin(), records.end());
+            
+            IndexList brushEdgeCounts(brushes.size(), 0);
+            for (size_t i = 0; i < records.size(); i++) {
+                const EdgeRecord& record = records[i];
+                if (i == 0 || record.key != records[i - 1].key) {
+                    m_ownerOffsets.push_back(m_owners.size());
+                    m_edgeVertices.push_back(record.key.first);
+                    m_edgeVertices.push_back(record.key.second);
                 }
+                m_owners.push_back(EdgeOwner(record.brushIndex, record.left, record.right));
+                brushEdgeCounts[record.brushIndex]++;
             }
+            m_ownerOffsets.push_back(m_owners.size());
+            m_edgeStates.resize(m_ownerOffsets.size() - 1, RenderState::Default);
             
-            Model::FaceList::const_iterator faceIt, faceEnd;
-            for (faceIt = faces.begin(), faceEnd = faces.end(); faceIt != faceEnd; ++faceIt) {
-                const Model::Face& face = **faceIt;
-                const Model::EdgeList& edges = face.edges();
-                Model::EdgeList::const_iterator edgeIt, edgeEnd;
-                for (edgeIt = edges.begin(), edgeEnd = edges.end(); edgeIt != edgeEnd; ++edgeIt) {
-                    const Model::Edge& edge = **edgeIt;
-                    m_vertexArray->addAttribute(edge.start->position);
-                    m_vertexArray->addAttribute(edge.end->position);
+            m_brushEdgeOffsets.resize(brushes.size() + 1, 0);
+            for (size_t i = 0; i < brushes.size(); i++)
+                m_brushEdgeOffsets[i + 1] = m_brushEdgeOffsets[i] + brushEdgeCounts[i];
+            m_brushEdges.resize(m_owners.size());
+            IndexList brushEdgeIndices(m_brushEdgeOffsets.begin(), m_brushEdgeOffsets.end() - 1);
+            for (size_t i = 0; i < m_ownerOffsets.size() - 1; i++)
+                for (size_t j = m_ownerOffsets[i]; j < m_ownerOffsets[i + 1]; j++)
+                    m_brushEdges[brushEdgeIndices[m_owners[j].brushIndex]++] = i;
+            
+            if (defaultColor != NULL) {
+                m_vertexArray = new VertexArray(vbo, GL_LINES, positions.size(),
+                                                Attribute::position3f(),
+                                                Attribute::color4f());
+                for (size_t i = 0; i < positions.size(); i++) {
+                    m_vertexArray->addAttribute(positions[i]);
+                    m_vertexArray->addAttribute(colors[colorIndices[i]]);
                 }
+            } else {
+                m_vertexArray = new VertexArray(vbo, GL_LINES, positions.size(),
+                                                Attribute::position3f());
+                m_vertexArray->addAttributes(positions);
             }
+            
+            const size_t size = m_edgeVertices.size() * sizeof(GLuint);
+            m_indexVbo = new Vbo(GL_ELEMENT_ARRAY_BUFFER, size);
+            
+            SetVboState mapIndexVbo(*m_indexVbo, Vbo::VboMapped);
+            m_indexBlock = m_indexVbo->allocBlock(size);
+            writeIndices();
         }
         
-        void EdgeRenderer::writeEdgeData(Vbo& vbo, const Model::BrushList& brushes, const Model::FaceList& faces, const Color& defaultColor) {
-            m_vertexArray = new VertexArray(vbo, GL_LINES, vertexCount(brushes, faces),
-                                            Attribute::position3f(),
-                                            Attribute::color4f());
-
-            Model::BrushList::const_iterator brushIt, brushEnd;
-            for (brushIt = brushes.begin(), brushEnd = brushes.end(); brushIt != brushEnd; ++brushIt) {
-                const Model::Brush& brush = **brushIt;
-                const Model::Entity* entity = brush.entity();
-                const Model::EntityDefinition* definition = entity != NULL ? entity->definition() : NULL;
-                const Color& color = (entity != NULL && !entity->worldspawn() && definition != NULL && definition->type() == Model::EntityDefinition::BrushEntity) ? definition->color() : defaultColor;
-                
-                const Model::EdgeList& edges = brush.edges();
-                Model::EdgeList::const_iterator edgeIt, edgeEnd;
-                for (edgeIt = edges.begin(), edgeEnd = edges.end(); edgeIt != edgeEnd; ++edgeIt) {
-                    const Model::Edge& edge = **edgeIt;
-                    m_vertexArray->addAttribute(edge.start->position);
-                    m_vertexArray->addAttribute(color);
-                    m_vertexArray->addAttribute(edge.end->position);
-                    m_vertexArray->addAttribute(color);
+        // Orders the edges by their render states with a counting sort. The index buffer is small compared to the
+        // vertices, so it is rewritten as a whole whenever an edge changes its state.
+        void EdgeRenderer::writeIndices() {
+            m_stateOffsets.assign(StateCount + 1, 0);
+            for (size_t i = 0; i < m_edgeStates.size(); i++)
+                m_stateOffsets[m_edgeStates[i] + 1]++;
+            for (size_t i = 0; i < StateCount; i++)
+                m_stateOffsets[i + 1] += m_stateOffsets[i];
+            
+            IndexList nextEdges(m_stateOffsets.begin(), m_stateOffsets.end() - 1);
+            VertexIndexList indices(m_edgeVertices.size());
+            for (size_t i = 0; i < m_edgeStates.size(); i++) {
+                const size_t j = nextEdges[m_edgeStates[i]]++;
+                indices[2 * j] = m_edgeVertices[2 * i];
+                indices[2 * j + 1] = m_edgeVertices[2 * i + 1];
+            }
+            
+            m_indexBlock->uploadBuffer(reinterpret_cast<const unsigned char*>(&indices[0]), 0, indices.size() * sizeof(GLuint));
+            m_indicesValid = true;
+        }
+        
+        unsigned int EdgeRenderer::edgeState(const size_t edgeIndex) const {
+            unsigned int state = RenderState::Hidden;
+            for (size_t i = m_ownerOffsets[edgeIndex]; i < m_ownerOffsets[edgeIndex + 1]; i++) {
+                const EdgeOwner& owner = m_owners[i];
+                const unsigned int brushState = m_brushStates[owner.brushIndex];
+                state |= brushState;
+                if (brushState == RenderState::Default &&
+                    ((owner.left != NULL && owner.left->selected()) || (owner.right != NULL && owner.right->selected())))
+                    state |= RenderState::Selected;
+            }
+            assert(state < StateCount);
+            return state;
+        }
+        
+        // The edge states are only computed when rendering, when all brush states are known. This way, the faces of
+        // brushes that have been hidden since are never touched.
+        void EdgeRenderer::validateEditStates() {
+            if (m_changedBrushes.empty())
+                return;
+            
+            std::sort(m_changedBrushes.begin(), m_changedBrushes.end());
+            IndexList::iterator brushEnd = std::unique(m_changedBrushes.begin(), m_changedBrushes.end());
+            
+            IndexList::const_iterator brushIt;
+            for (brushIt = m_changedBrushes.begin(); brushIt != brushEnd; ++brushIt) {
+                const size_t brushIndex = *brushIt;
+                for (size_t i = m_brushEdgeOffsets[brushIndex]; i < m_brushEdgeOffsets[brushIndex + 1]; i++) {
+                    const size_t edgeIndex = m_brushEdges[i];
+                    const unsigned int state = edgeState(edgeIndex);
+                    if (m_edgeStates[edgeIndex] != state) {
+                        m_edgeStates[edgeIndex] = state;
+                        m_indicesValid = false;
+                    }
                 }
             }
-
-            Model::FaceList::const_iterator faceIt, faceEnd;
-            for (faceIt = faces.begin(), faceEnd = faces.end(); faceIt != faceEnd; ++faceIt) {
-                const Model::Face& face = **faceIt;
-                const Model::Brush* brush = face.brush();
-                const Model::Entity* entity = brush->entity();
-                const Model::EntityDefinition* definition = entity != NULL ? entity->definition() : NULL;
-                const Color& color = (entity != NULL && !entity->worldspawn() && definition != NULL && definition->type() == Model::EntityDefinition::BrushEntity) ? definition->color() : defaultColor;
+            m_changedBrushes.clear();
+        }
+        
+        void EdgeRenderer::render(RenderContext& context, const Color* color, const unsigned int states) {
+            if (m_vertexArray == NULL)
+                return;
+            
+            validateEditStates();
+            
+            SetVboState activateIndexVbo(*m_indexVbo, Vbo::VboActive);
+            if (!m_indicesValid)
+                writeIndices();
+            
+            ShaderManager& shaderManager = context.shaderManager();
+            ShaderProgram& edgeProgram = shaderManager.shaderProgram(color != NULL ? Shaders::EdgeShader : Shaders::ColoredEdgeShader);
+            if (edgeProgram.activate()) {
+                if (color != NULL)
+                    edgeProgram.setUniformVariable("Color", *color);
                 
-                const Model::EdgeList& edges = face.edges();
-                Model::EdgeList::const_iterator edgeIt, edgeEnd;
-                for (edgeIt = edges.begin(), edgeEnd = edges.end(); edgeIt != edgeEnd; ++edgeIt) {
-                    const Model::Edge& edge = **edgeIt;
-                    m_vertexArray->addAttribute(edge.start->position);
-                    m_vertexArray->addAttribute(color);
-                    m_vertexArray->addAttribute(edge.end->position);
-                    m_vertexArray->addAttribute(color);
+                // adjacent state ranges are drawn together
+                for (size_t state = RenderState::Default; state < StateCount; state++) {
+                    if ((state & states) == 0)
+                        continue;
+                    
+                    const size_t first = m_stateOffsets[state];
+                    while (state + 1 < StateCount && ((state + 1) & states) != 0)
+                        state++;
+                    const size_t count = m_stateOffsets[state + 1] - first;
+                    if (count > 0)
+                        m_vertexArray->renderElements(2 * first, 2 * count);
                 }
+                edgeProgram.deactivate();
             }
         }
 
-        EdgeRenderer::EdgeRenderer(Vbo& vbo, const Model::BrushList& brushes, const Model::FaceList& faces) :
-        m_vertexArray(NULL) {
-            writeEdgeData(vbo, brushes, faces);
+        EdgeRenderer::EdgeRenderer(Vbo& vbo, const Model::BrushList& brushes) :
+        m_vertexArray(NULL),
+        m_indexVbo(NULL),
+        m_indexBlock(NULL),
+        m_indicesValid(false) {
+            writeEdgeData(vbo, brushes, NULL);
         }
         
-        EdgeRenderer::EdgeRenderer(Vbo& vbo, const Model::BrushList& brushes, const Model::FaceList& faces, const Color& defaultColor) :
-        m_vertexArray(NULL) {
-            writeEdgeData(vbo, brushes, faces, defaultColor);
+        EdgeRenderer::EdgeRenderer(Vbo& vbo, const Model::BrushList& brushes, const Color& defaultColor) :
+        m_vertexArray(NULL),
+        m_indexVbo(NULL),
+        m_indexBlock(NULL),
+        m_indicesValid(false) {
+            writeEdgeData(vbo, brushes, &defaultColor);
         }
 
         EdgeRenderer::~EdgeRenderer() {
             delete m_vertexArray;
             m_vertexArray = NULL;
+            delete m_indexVbo;
+            m_indexVbo = NULL;
+            m_indexBlock = NULL;
         }
-
-
-        void EdgeRenderer::render(RenderContext& context) {
-            assert(m_vertexArray != NULL);
+        
+        void EdgeRenderer::setEditState(const Model::Brush& brush, const unsigned int state) {
+            BrushEntryList::const_iterator it = std::lower_bound(m_brushEntries.begin(), m_brushEntries.end(), BrushEntry(&brush, 0));
+            if (it == m_brushEntries.end() || it->first != &brush)
+                return;
             
-            ShaderManager& shaderManager = context.shaderManager();
-            ShaderProgram& coloredEdgeProgram = shaderManager.shaderProgram(Shaders::ColoredEdgeShader);
-            if (coloredEdgeProgram.activate()) {
-                m_vertexArray->render();
-                coloredEdgeProgram.deactivate();
-            }
+            const size_t brushIndex = it->second;
+            m_brushStates[brushIndex] = state;
+            if (m_vertexArray != NULL)
+                m_changedBrushes.push_back(brushIndex);
         }
-        
-        void EdgeRenderer::render(RenderContext& context, const Color& color) {
-            assert(m_vertexArray != NULL);
 
-            ShaderManager& shaderManager = context.shaderManager();
-            ShaderProgram& edgeProgram = shaderManager.shaderProgram(Shaders::EdgeShader);
-            if (edgeProgram.activate()) {
-                edgeProgram.setUniformVariable("Color", color);
-                m_vertexArray->render();
-                edgeProgram.deactivate();
-            }
+        void EdgeRenderer::render(RenderContext& context, const unsigned int states) {
+            render(context, NULL, states);
+        }
+        
+        void EdgeRenderer::render(RenderContext& context, const Color& color, const unsigned int states) {
+            render(context, &color, states);
         }
     }
 }
@@ -20,30 +20,85 @@
 #ifndef __TrenchBroom__EdgeRenderer__
 #define __TrenchBroom__EdgeRenderer__
 
+#include <GL/glew.h>
 #include "Model/BrushTypes.h"
 #include "Model/FaceTypes.h"
+#include "Renderer/EditStateArray.h"
 #include "Utility/Color.h"
 
+#include <vector>
+
 namespace TrenchBroom {
     namespace Renderer {
         class RenderContext;
         class Vbo;
+        class VboBlock;
         class VertexArray;
         
         class EdgeRenderer {
         protected:
+            struct EdgeOwner {
+                size_t brushIndex;
+                const Model::Face* left;
+                const Model::Face* right;
+                
+                EdgeOwner(size_t i_brushIndex, const Model::Face* i_left, const Model::Face* i_right) :
+                brushIndex(i_brushIndex),
+                left(i_left),
+                right(i_right) {}
+            };
+            
+            typedef std::vector<EdgeOwner> EdgeOwnerList;
+            typedef std::vector<size_t> IndexList;
+            typedef std::vector<GLuint> VertexIndexList;
+            typedef std::pair<const Model::Brush*, size_t> BrushEntry;
+            typedef std::vector<BrushEntry> BrushEntryList;
+            
+            static const size_t StateCount = RenderState::All + 1;
+            
+            // the welded edge vertices, and the two vertex indices and the render state of each unique edge
             VertexArray* m_vertexArray;
+            VertexIndexList m_edgeVertices;
+            std::vector<unsigned int> m_edgeStates;
+            
+            // The index buffer holds the edges ordered by their render state, so that the edges with one state
+            // form one range. Hidden edges are never drawn.
+            Vbo* m_indexVbo;
+            VboBlock* m_indexBlock;
+            IndexList m_stateOffsets;
+            bool m_indicesValid;
             
-            unsigned int vertexCount(const Model::BrushList& brushes, const Model::FaceList& faces);
-            void writeEdgeData(Vbo& vbo, const Model::BrushList& brushes, const Model::FaceList& faces);
-            void writeEdgeData(Vbo& vbo, const Model::BrushList& brushes, const Model::FaceList& faces, const Color& defaultColor);
+            // the brushes that own each edge, and the edges of each brush, in compressed row form
+            IndexList m_ownerOffsets;
+            EdgeOwnerList m_owners;
+            IndexList m_brushEdgeOffsets;
+            IndexList m_brushEdges;
+            
+            BrushEntryList m_brushEntries;
+            std::vector<unsigned int> m_brushStates;
+            IndexList m_changedBrushes;
+            
+            void writeEdgeData(Vbo& vbo, const Model::BrushList& brushes, const Color* defaultColor);
+            void writeIndices();
+            unsigned int edgeState(size_t edgeIndex) const;
+            void validateEditStates();
+            void render(RenderContext& context, const Color* color, unsigned int states);
+            
+            // prevent copying
+            EdgeRenderer(const EdgeRenderer& other);
+            void operator= (const EdgeRenderer& other);
         public:
-            EdgeRenderer(Vbo& vbo, const Model::BrushList& brushes, const Model::FaceList& faces);
-            EdgeRenderer(Vbo& vbo, const Model::BrushList& brushes, const Model::FaceList& faces, const Color& defaultColor);
+            EdgeRenderer(Vbo& vbo, const Model::BrushList& brushes);
+            EdgeRenderer(Vbo& vbo, const Model::BrushList& brushes, const Color& defaultColor);
             ~EdgeRenderer();
+            
+            // An edge is rendered in the states of all brushes that share it. The edges of selected faces are also
+            // rendered as selected.
+            void setEditState(const Model::Brush& brush, unsigned int state);
 
-            void render(RenderContext& context);
-            void render(RenderContext& context, const Color& color);
+            // only renders the edges with one of the given render states
+            void render(RenderContext& context, unsigned int states = RenderState::All);
+            void render(RenderContext& context, const Color& color, unsigned int states = RenderState::All);
         };
     }
 }
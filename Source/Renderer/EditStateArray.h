@@ -0,0 +1,129 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_EditStateArray_h
+#define TrenchBroom_EditStateArray_h
+
+#include <GL/glew.h>
+#include "Renderer/Vbo.h"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <vector>
+
+namespace TrenchBroom {
+    namespace Renderer {
+        namespace RenderState {
+            // Bit flags so that an edge shared by several brushes can carry all of their states at once.
+            static const unsigned int Hidden    = 0;
+            static const unsigned int Default   = 1;
+            static const unsigned int Selected  = 2;
+            static const unsigned int Locked    = 4;
+            static const unsigned int All       = Default | Selected | Locked;
+        }
+        
+        // A float attribute holding one render state per vertex. It lives in the same VBO as the geometry it
+        // belongs to, but it is written separately, so that changing the state of some vertices only uploads
+        // the changed range and leaves the geometry alone.
+        class EditStateArray {
+        private:
+            VboBlock* m_block;
+            std::vector<GLfloat> m_states;
+            size_t m_dirtyStart;
+            size_t m_dirtyEnd;
+            
+            inline void upload() {
+                if (m_dirtyStart >= m_dirtyEnd)
+                    return;
+                
+                const unsigned char* buffer = reinterpret_cast<const unsigned char*>(&m_states[m_dirtyStart]);
+                m_block->uploadBuffer(buffer, m_dirtyStart * sizeof(GLfloat), (m_dirtyEnd - m_dirtyStart) * sizeof(GLfloat));
+                m_dirtyStart = std::numeric_limits<size_t>::max();
+                m_dirtyEnd = 0;
+            }
+
+            // prevent copying
+            EditStateArray(const EditStateArray& other);
+            void operator= (const EditStateArray& other);
+        public:
+            EditStateArray(Vbo& vbo, size_t vertexCount, unsigned int state = RenderState::Default) :
+            m_block(NULL),
+            m_states(vertexCount, static_cast<GLfloat>(state)),
+            m_dirtyStart(0),
+            m_dirtyEnd(vertexCount) {
+                if (vertexCount > 0)
+                    m_block = vbo.allocBlock(vertexCount * sizeof(GLfloat));
+            }
+            
+            ~EditStateArray() {
+                if (m_block != NULL) {
+                    m_block->freeBlock();
+                    m_block = NULL;
+                }
+            }
+            
+            inline size_t size() const {
+                return m_states.size();
+            }
+            
+            inline unsigned int state(size_t index) const {
+                assert(index < m_states.size());
+                return static_cast<unsigned int>(m_states[index]);
+            }
+            
+            inline void setState(size_t index, size_t count, unsigned int state) {
+                assert(index + count <= m_states.size());
+                const GLfloat value = static_cast<GLfloat>(state);
+                bool changed = false;
+                for (size_t i = index; i < index + count; i++) {
+                    if (m_states[i] != value) {
+                        m_states[i] = value;
+                        changed = true;
+                    }
+                }
+                
+                if (changed) {
+                    m_dirtyStart = std::min(m_dirtyStart, index);
+                    m_dirtyEnd = std::max(m_dirtyEnd, index + count);
+                }
+            }
+            
+            // The VBO must be active. The states of the vertices starting at the given index are fed to the given
+            // attribute location.
+            inline void setup(GLint location, size_t firstVertex) {
+                if (m_block == NULL || location == -1)
+                    return;
+                
+                upload();
+                const size_t offset = m_block->address() + firstVertex * sizeof(GLfloat);
+                glEnableVertexAttribArray(static_cast<GLuint>(location));
+                glVertexAttribPointer(static_cast<GLuint>(location), 1, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<GLvoid*>(offset));
+            }
+            
+            inline void cleanup(GLint location) {
+                if (m_block == NULL || location == -1)
+                    return;
+                glDisableVertexAttribArray(static_cast<GLuint>(location));
+            }
+        };
+    }
+}
+
+#endif
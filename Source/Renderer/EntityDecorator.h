@@ -20,6 +20,8 @@
 #ifndef TrenchBroom_EntityDecorator_h
 #define TrenchBroom_EntityDecorator_h
 
+#include "Model/EntityTypes.h"
+
 #include <vector>
 
 namespace TrenchBroom {
@@ -45,6 +47,12 @@ namespace TrenchBroom {
             virtual ~EntityDecorator() {}
 
             virtual void invalidate() = 0;
+            
+            // the position, selection or visibility of the given entities has changed
+            virtual void invalidateEntities(const Model::EntityList& entities) {
+                invalidate();
+            }
+            
             virtual void render(Vbo& vbo, RenderContext& context) = 0;
         };
     }
@@ -34,6 +34,9 @@
 #include "Utility/Preferences.h"
 #include "Utility/VecMath.h"
 
+#include <algorithm>
+#include <iterator>
+
 using namespace TrenchBroom::VecMath;
 
 namespace TrenchBroom {
@@ -54,52 +57,117 @@ namespace TrenchBroom {
             vertices.push_back(target.center());
         }
 
-        void EntityLinkDecorator::buildLinks(RenderContext& context, Model::Entity& entity, size_t depth, Model::EntitySet& visitedEntities, Vec3f::List& selectedLinks, Vec3f::List& unselectedLinks, Vec3f::List& selectedKillLinks, Vec3f::List& unselectedKillLinks) const {
-            if (context.viewOptions().linkDisplayMode() == View::ViewOptions::LinkDisplayLocal && depth > 1)
+        static inline bool linkSelected(const Model::Entity& entity) {
+            return entity.selected() || entity.partiallySelected();
+        }
+        
+        void EntityLinkDecorator::buildLinks(RenderContext& context, Model::Entity& entity, EntityLinks& links) const {
+            links.clear();
+            if (!context.filter().entityVisible(entity))
                 return;
-
-            Model::EntitySet::iterator visitedIt = visitedEntities.lower_bound(&entity);
-            if (visitedIt != visitedEntities.end() && *visitedIt == &entity)
+            if (m_linkDisplayMode == View::ViewOptions::LinkDisplayContext && m_contextEntities.count(&entity) == 0)
                 return;
-
-            visitedEntities.insert(visitedIt, &entity);
-            const bool entityVisible = context.filter().entityVisible(entity);
-
+            
+            const bool entitySelected = linkSelected(entity);
             Model::EntityList::const_iterator entityIt, entityEnd;
             
             const Model::EntityList& linkTargets = entity.linkTargets();
             for (entityIt = linkTargets.begin(), entityEnd = linkTargets.end(); entityIt != entityEnd; ++entityIt) {
                 Model::Entity& target = **entityIt;
-                if (entityVisible && context.filter().entityVisible(target) &&
-                    (context.viewOptions().linkDisplayMode() != View::ViewOptions::LinkDisplayLocal || entity.selected() || entity.partiallySelected() || target.selected() || target.partiallySelected()))
-                    makeLink(target, entity, entity.selected() || entity.partiallySelected() || target.selected() || target.partiallySelected() ? selectedLinks : unselectedLinks);
-                if (context.viewOptions().linkDisplayMode() != View::ViewOptions::LinkDisplayLocal || depth == 0)
-                    buildLinks(context, target, depth + 1, visitedEntities, selectedLinks, unselectedLinks, selectedKillLinks, unselectedKillLinks);
-            }
-            
-            const Model::EntityList& linkSources = entity.linkSources();
-            for (entityIt = linkSources.begin(), entityEnd = linkSources.end(); entityIt != entityEnd; ++entityIt) {
-                Model::Entity& source = **entityIt;
-                if (context.viewOptions().linkDisplayMode() != View::ViewOptions::LinkDisplayLocal || depth <= 1)
-                    buildLinks(context, source, depth + 1, visitedEntities, selectedLinks, unselectedLinks, selectedKillLinks, unselectedKillLinks);
+                const bool selected = entitySelected || linkSelected(target);
+                if (context.filter().entityVisible(target) && (selected || m_linkDisplayMode != View::ViewOptions::LinkDisplayLocal))
+                    makeLink(target, entity, selected ? links.selectedLinks : links.unselectedLinks);
             }
             
             const Model::EntityList& killTargets = entity.killTargets();
             for (entityIt = killTargets.begin(), entityEnd = killTargets.end(); entityIt != entityEnd; ++entityIt) {
                 Model::Entity& target = **entityIt;
-                if (entityVisible && context.filter().entityVisible(target) &&
-                    (context.viewOptions().linkDisplayMode() != View::ViewOptions::LinkDisplayLocal || entity.selected() || entity.partiallySelected() || target.selected() || target.partiallySelected()))
-                    makeLink(target, entity, entity.selected() || entity.partiallySelected() || target.selected() || target.partiallySelected() ? selectedKillLinks : unselectedKillLinks);
-                if (context.viewOptions().linkDisplayMode() != View::ViewOptions::LinkDisplayLocal || depth == 0)
-                    buildLinks(context, target, depth + 1, visitedEntities, selectedLinks, unselectedLinks, selectedKillLinks, unselectedKillLinks);
+                const bool selected = entitySelected || linkSelected(target);
+                if (context.filter().entityVisible(target) && (selected || m_linkDisplayMode != View::ViewOptions::LinkDisplayLocal))
+                    makeLink(target, entity, selected ? links.selectedKillLinks : links.unselectedKillLinks);
             }
+        }
+        
+        void EntityLinkDecorator::validateContext(bool linksChanged) {
+            const Model::EntityList selectedEntities = document().editStateManager().allSelectedEntities();
+            Model::EntitySet selection(selectedEntities.begin(), selectedEntities.end());
+            if (!linksChanged && selection == m_contextSelection)
+                return;
             
-            const Model::EntityList& killSources = entity.killSources();
-            for (entityIt = killSources.begin(), entityEnd = killSources.end(); entityIt != entityEnd; ++entityIt) {
-                Model::Entity& source = **entityIt;
-                if (context.viewOptions().linkDisplayMode() != View::ViewOptions::LinkDisplayLocal || depth <= 1)
-                    buildLinks(context, source, depth + 1, visitedEntities, selectedLinks, unselectedLinks, selectedKillLinks, unselectedKillLinks);
+            Model::EntitySet contextEntities;
+            Model::EntityList queue(selectedEntities);
+            while (!queue.empty()) {
+                Model::Entity* entity = queue.back();
+                queue.pop_back();
+                if (!contextEntities.insert(entity).second)
+                    continue;
+                
+                queue.insert(queue.end(), entity->linkTargets().begin(), entity->linkTargets().end());
+                queue.insert(queue.end(), entity->linkSources().begin(), entity->linkSources().end());
+                queue.insert(queue.end(), entity->killTargets().begin(), entity->killTargets().end());
+                queue.insert(queue.end(), entity->killSources().begin(), entity->killSources().end());
             }
+            
+            // only the entities that entered or left the context must be rebuilt
+            std::set_symmetric_difference(contextEntities.begin(), contextEntities.end(),
+                                          m_contextEntities.begin(), m_contextEntities.end(),
+                                          std::inserter(m_invalidEntities, m_invalidEntities.end()));
+            m_contextEntities.swap(contextEntities);
+            m_contextSelection.swap(selection);
+        }
+        
+        bool EntityLinkDecorator::validateLinks(RenderContext& context) {
+            const Model::Map& map = document().map();
+            const View::ViewOptions::LinkDisplayMode linkDisplayMode = context.viewOptions().linkDisplayMode();
+            
+            bool changed = false;
+            if (!m_valid || linkDisplayMode != m_linkDisplayMode) {
+                m_links.clear();
+                m_invalidEntities.clear();
+                m_contextSelection.clear();
+                m_contextEntities.clear();
+                m_linkDisplayMode = linkDisplayMode;
+                changed = true;
+            }
+            
+            const bool linksChanged = changed || map.linkRevision() != m_linkRevision;
+            if (m_linkDisplayMode == View::ViewOptions::LinkDisplayContext)
+                validateContext(linksChanged);
+            if (!linksChanged && m_invalidEntities.empty())
+                return false;
+            
+            // the invalid entities are only used as keys here, they may have been removed from the map
+            m_pass++;
+            const Model::EntityList& entities = map.entities();
+            Model::EntityList::const_iterator entityIt, entityEnd;
+            for (entityIt = entities.begin(), entityEnd = entities.end(); entityIt != entityEnd; ++entityIt) {
+                Model::Entity& entity = **entityIt;
+                if (entity.linkTargets().empty() && entity.killTargets().empty())
+                    continue;
+                
+                std::pair<EntityLinksMap::iterator, bool> result = m_links.insert(EntityLinksMap::value_type(&entity, EntityLinks()));
+                EntityLinks& links = result.first->second;
+                links.pass = m_pass;
+                if (result.second || entity.linkRevision() > m_linkRevision || m_invalidEntities.count(&entity) > 0) {
+                    buildLinks(context, entity, links);
+                    changed = true;
+                }
+            }
+            
+            EntityLinksMap::iterator linksIt = m_links.begin();
+            while (linksIt != m_links.end()) {
+                if (linksIt->second.pass != m_pass) {
+                    m_links.erase(linksIt++);
+                    changed = true;
+                } else {
+                    ++linksIt;
+                }
+            }
+            
+            m_invalidEntities.clear();
+            m_linkRevision = map.linkRevision();
+            m_valid = true;
+            return changed;
         }
 
         EntityLinkDecorator::EntityLinkDecorator(const Model::MapDocument& document, const Color& color) :
@@ -109,29 +177,43 @@ namespace TrenchBroom {
         m_unselectedLinkArray(NULL),
         m_selectedKillLinkArray(NULL),
         m_unselectedKillLinkArray(NULL),
-        m_valid(false) {}
+        m_valid(false),
+        m_linkDisplayMode(View::ViewOptions::LinkDisplayNone),
+        m_linkRevision(0),
+        m_pass(0) {}
 
         EntityLinkDecorator::~EntityLinkDecorator() {
             clear();
         }
 
+        void EntityLinkDecorator::invalidateEntities(const Model::EntityList& entities) {
+            // links are stored with their sources
+            Model::EntityList::const_iterator it, end;
+            for (it = entities.begin(), end = entities.end(); it != end; ++it) {
+                Model::Entity* entity = *it;
+                m_invalidEntities.insert(entity);
+                m_invalidEntities.insert(entity->linkSources().begin(), entity->linkSources().end());
+                m_invalidEntities.insert(entity->killSources().begin(), entity->killSources().end());
+            }
+        }
+
         void EntityLinkDecorator::render(Vbo& vbo, RenderContext& context) {
             if (context.viewOptions().linkDisplayMode() == View::ViewOptions::LinkDisplayNone)
                 return;
 
             SetVboState activateVbo(vbo, Vbo::VboActive);
             
-            if (!m_valid) {
+            if (validateLinks(context)) {
                 clear();
                 
                 Vec3f::List selectedLinks, unselectedLinks, selectedKillLinks, unselectedKillLinks;
-                Model::EntitySet visitedEntities;
-
-                const Model::EntityList& entities = context.viewOptions().linkDisplayMode() == View::ViewOptions::LinkDisplayAll ? document().map().entities() : document().editStateManager().allSelectedEntities();
-                Model::EntityList::const_iterator it, end;
-                for (it = entities.begin(), end = entities.end(); it != end; ++it) {
-                    Model::Entity& entity = **it;
-                    buildLinks(context, entity, 0, visitedEntities, selectedLinks, unselectedLinks, selectedKillLinks, unselectedKillLinks);
+                EntityLinksMap::const_iterator it, end;
+                for (it = m_links.begin(), end = m_links.end(); it != end; ++it) {
+                    const EntityLinks& links = it->second;
+                    selectedLinks.insert(selectedLinks.end(), links.selectedLinks.begin(), links.selectedLinks.end());
+                    unselectedLinks.insert(unselectedLinks.end(), links.unselectedLinks.begin(), links.unselectedLinks.end());
+                    selectedKillLinks.insert(selectedKillLinks.end(), links.selectedKillLinks.begin(), links.selectedKillLinks.end());
+                    unselectedKillLinks.insert(unselectedKillLinks.end(), links.unselectedKillLinks.begin(), links.unselectedKillLinks.end());
                 }
                 
                 SetVboState mapVbo(vbo, Vbo::VboMapped);
@@ -154,8 +236,6 @@ namespace TrenchBroom {
                     m_unselectedKillLinkArray = new VertexArray(vbo, GL_LINES, static_cast<unsigned int>(unselectedKillLinks.size()), Attribute::position3f(), 0);
                     m_unselectedKillLinkArray->addAttributes(unselectedKillLinks);
                 }
-
-                m_valid = true;
             }
 
             if (m_selectedLinkArray == NULL && m_unselectedLinkArray == NULL)
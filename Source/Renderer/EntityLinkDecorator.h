@@ -26,6 +26,8 @@
 #include "Utility/Color.h"
 #include "View/ViewOptions.h"
 
+#include <map>
+
 namespace TrenchBroom {
     namespace Model {
         class MapDocument;
@@ -36,6 +38,26 @@ namespace TrenchBroom {
         
         class EntityLinkDecorator : public EntityDecorator {
         private:
+            // the outgoing links of an entity
+            struct EntityLinks {
+                Vec3f::List selectedLinks;
+                Vec3f::List unselectedLinks;
+                Vec3f::List selectedKillLinks;
+                Vec3f::List unselectedKillLinks;
+                unsigned int pass;
+                
+                EntityLinks() : pass(0) {}
+                
+                inline void clear() {
+                    selectedLinks.clear();
+                    unselectedLinks.clear();
+                    selectedKillLinks.clear();
+                    unselectedKillLinks.clear();
+                }
+            };
+            
+            typedef std::map<Model::Entity*, EntityLinks> EntityLinksMap;
+            
             Color m_color;
             VertexArray* m_selectedLinkArray;
             VertexArray* m_unselectedLinkArray;
@@ -43,9 +65,21 @@ namespace TrenchBroom {
             VertexArray* m_unselectedKillLinkArray;
             bool m_valid;
             
+            View::ViewOptions::LinkDisplayMode m_linkDisplayMode;
+            unsigned int m_linkRevision;
+            unsigned int m_pass;
+            EntityLinksMap m_links;
+            Model::EntitySet m_invalidEntities;
+            
+            // the entities connected to the selection, only used for LinkDisplayContext
+            Model::EntitySet m_contextSelection;
+            Model::EntitySet m_contextEntities;
+            
             void clear();
             void makeLink(Model::Entity& source, Model::Entity& target, Vec3f::List& vertices) const;
-            void buildLinks(RenderContext& context, Model::Entity& entity, size_t depth, Model::EntitySet& visitedEntities, Vec3f::List& selectedLinks, Vec3f::List& unselectedLinks, Vec3f::List& selectedKillLinks, Vec3f::List& unselectedKillLinks) const;
+            void buildLinks(RenderContext& context, Model::Entity& entity, EntityLinks& links) const;
+            void validateContext(bool linksChanged);
+            bool validateLinks(RenderContext& context);
         public:
             EntityLinkDecorator(const Model::MapDocument& document, const Color& color);
             ~EntityLinkDecorator();
@@ -53,6 +87,8 @@ namespace TrenchBroom {
             inline void invalidate() {
                 m_valid = false;
             }
+            
+            void invalidateEntities(const Model::EntityList& entities);
 
             void render(Vbo& vbo, RenderContext& context);
         };
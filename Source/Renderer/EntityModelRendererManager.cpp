@@ -46,7 +46,7 @@ namespace TrenchBroom {
             return Utility::toLower(key.str());
         }
 
-        EntityModelRenderer* EntityModelRendererManager::modelRenderer(const Model::ModelDefinition& modelDefinition, const StringList& searchPaths) {
+        EntityModelRenderer* EntityModelRendererManager::modelRenderer(const Model::ModelDefinition& modelDefinition, const StringList& searchPaths, bool background) {
             assert(m_palette != NULL);
             IO::FileManager fileManager;
             
@@ -63,6 +63,9 @@ namespace TrenchBroom {
             EntityModelRendererCache::iterator rendererIt = m_modelRenderers.find(key);
             if (rendererIt != m_modelRenderers.end())
                 return rendererIt->second;
+            
+            if (m_pendingModels.count(key) > 0)
+                return NULL;
 
             String modelName = Utility::toLower(modelDefinition.name().substr(1));
             String ext = Utility::toLower(fileManager.pathExtension(modelName));
@@ -71,6 +74,11 @@ namespace TrenchBroom {
                 unsigned int frameIndex = modelDefinition.frameIndex();
 
                 Model::AliasManager& aliasManager = *Model::AliasManager::sharedManager;
+                if (background && aliasManager.loadAlias(modelName, searchPaths, m_console) && aliasManager.loading(modelName, searchPaths)) {
+                    m_pendingModels[key] = PendingModel(modelName, searchPaths, false);
+                    return NULL;
+                }
+                
                 const Model::Alias* alias = aliasManager.alias(modelName, searchPaths, m_console);
 
                 if (alias != NULL && skinIndex < alias->skins().size() && frameIndex < alias->frames().size()) {
@@ -80,6 +88,11 @@ namespace TrenchBroom {
                 }
             } else if (ext == "bsp") {
                 Model::BspManager& bspManager = *Model::BspManager::sharedManager;
+                if (background && bspManager.loadBsp(modelName, searchPaths, m_console) && bspManager.loading(modelName, searchPaths)) {
+                    m_pendingModels[key] = PendingModel(modelName, searchPaths, true);
+                    return NULL;
+                }
+                
                 const Model::Bsp* bsp = bspManager.bsp(modelName, searchPaths, m_console);
                 if (bsp != NULL) {
                     Renderer::EntityModelRenderer* renderer = new BspModelRenderer(*bsp, *m_vbo, *m_palette);
@@ -111,7 +124,7 @@ namespace TrenchBroom {
             const Model::ModelDefinition* modelDefinition = entityDefinition.model();
             if (modelDefinition == NULL)
                 return NULL;
-            return modelRenderer(*modelDefinition, searchPaths);
+            return modelRenderer(*modelDefinition, searchPaths, false);
         }
 
         EntityModelRenderer* EntityModelRendererManager::modelRenderer(const Model::Entity& entity, const StringList& searchPaths) {
@@ -122,11 +135,40 @@ namespace TrenchBroom {
             const Model::ModelDefinition* modelDefinition = pointDefinition->model(entity.properties());
             if (modelDefinition == NULL)
                 return NULL;
-            return modelRenderer(*modelDefinition, searchPaths);
+            return modelRenderer(*modelDefinition, searchPaths, true);
         }
 
+        bool EntityModelRendererManager::loading(const Model::PointEntityDefinition& entityDefinition, const StringList& searchPaths) {
+            const Model::ModelDefinition* modelDefinition = entityDefinition.model();
+            if (modelDefinition == NULL)
+                return false;
+            return m_pendingModels.count(modelRendererKey(*modelDefinition, searchPaths)) > 0;
+        }
+
+        bool EntityModelRendererManager::collectLoadedModels() {
+            Model::AliasManager& aliasManager = *Model::AliasManager::sharedManager;
+            Model::BspManager& bspManager = *Model::BspManager::sharedManager;
+            aliasManager.collectLoadedAliases(m_console);
+            bspManager.collectLoadedBsps(m_console);
+            
+            bool loaded = false;
+            PendingModelMap::iterator it = m_pendingModels.begin();
+            while (it != m_pendingModels.end()) {
+                const PendingModel& pending = it->second;
+                bool loading = pending.bsp ? bspManager.loading(pending.name, pending.searchPaths) : aliasManager.loading(pending.name, pending.searchPaths);
+                if (!loading) {
+                    m_pendingModels.erase(it++);
+                    loaded = true;
+                } else {
+                    ++it;
+                }
+            }
+            return loaded;
+        }
+        
         void EntityModelRendererManager::clear() {
             clearMismatches();
+            m_pendingModels.clear();
             Utility::deleteAll(m_modelRenderers);
         }
         
@@ -47,16 +47,31 @@ namespace TrenchBroom {
             typedef std::map<String, EntityModelRenderer*> EntityModelRendererCache;
             typedef std::set<String> MismatchCache;
             
+            struct PendingModel {
+                String name;
+                StringList searchPaths;
+                bool bsp;
+                
+                PendingModel() : bsp(false) {}
+                PendingModel(const String& i_name, const StringList& i_searchPaths, bool i_bsp) :
+                name(i_name),
+                searchPaths(i_searchPaths),
+                bsp(i_bsp) {}
+            };
+            
+            typedef std::map<String, PendingModel> PendingModelMap;
+            
             const Palette* m_palette;
             Utility::Console& m_console;
             
             Vbo* m_vbo;
             EntityModelRendererCache m_modelRenderers;
             MismatchCache m_mismatches;
+            PendingModelMap m_pendingModels;
             bool m_valid;
 
             const String modelRendererKey(const Model::ModelDefinition& modelDefinition, const StringList& searchPaths);
-            EntityModelRenderer* modelRenderer(const Model::ModelDefinition& modelDefinition, const StringList& searchPaths);
+            EntityModelRenderer* modelRenderer(const Model::ModelDefinition& modelDefinition, const StringList& searchPaths, bool background);
 
             // prevent copying
             EntityModelRendererManager(const EntityModelRendererManager& other);
@@ -66,7 +81,13 @@ namespace TrenchBroom {
             ~EntityModelRendererManager();
             
             EntityModelRenderer* modelRenderer(const Model::PointEntityDefinition& entityDefinition, const StringList& searchPaths);
+            // returns NULL while the model is being loaded in the background
             EntityModelRenderer* modelRenderer(const Model::Entity& entity, const StringList& searchPaths);
+            // returns true if the model of the given definition has been requested in the background and is still loading
+            bool loading(const Model::PointEntityDefinition& entityDefinition, const StringList& searchPaths);
+            
+            // returns true if any of the models that were requested in the background have finished loading
+            bool collectLoadedModels();
             void clear();
             void clearMismatches();
             
@@ -19,17 +19,22 @@
 
 #include "FaceRenderer.h"
 
+#include "Model/Brush.h"
 #include "Model/Face.h"
+#include "Renderer/EditStateArray.h"
 #include "Renderer/RenderContext.h"
 #include "Renderer/Shader/ShaderManager.h"
 #include "Renderer/Shader/ShaderProgram.h"
 #include "Renderer/TextureRenderer.h"
 #include "Renderer/TextureRendererManager.h"
-#include "Renderer/VertexArray.h"
+#include "Renderer/IndexedVertexArray.h"
 #include "Utility/Grid.h"
 #include "Utility/Preferences.h"
+#include "Utility/Profiler.h"
 #include "Utility/VecMath.h"
 
+#include <algorithm>
+
 using namespace TrenchBroom::VecMath;
 
 namespace TrenchBroom {
@@ -41,33 +46,60 @@ namespace TrenchBroom {
             if (faceCollectionMap.empty())
                 return;
             
+            m_editStates = new EditStateArray(vbo, faceSorter.vertexCount());
+            size_t stateIndex = 0;
+            
             FaceCollectionMap::const_iterator it, end;
             for (it = faceCollectionMap.begin(), end = faceCollectionMap.end(); it != end; ++it) {
                 Model::Texture* texture = it->first;
                 TextureRenderer* textureRenderer = texture != NULL ? &textureRendererManager.renderer(texture) : NULL;
                 const FaceCollection& faceCollection = it->second;
                 const Model::FaceList& faces = faceCollection.polygons();
-                const size_t vertexCount = 3 * faceCollection.vertexCount() - 6 * faces.size();
-                VertexArray* vertexArray = new VertexArray(vbo, GL_TRIANGLES, vertexCount,
-                                                           Attribute::position3f(),
-                                                           Attribute::normal3f(),
-                                                           Attribute::texCoord02f(),
-                                                           0);
+                IndexedVertexArray* vertexArray = new IndexedVertexArray(vbo, GL_TRIANGLE_FAN, faceCollection.vertexCount(),
+                                                                         Attribute::position3f(),
+                                                                         Attribute::normal3b(),
+                                                                         Attribute::texCoord02f(),
+                                                                         0);
                 
+                const size_t batch = m_firstStates.size();
+                m_firstStates.push_back(stateIndex);
+                m_visibleFaceCounts.push_back(faces.size());
                 for (size_t i = 0; i < faces.size(); i++) {
                     Model::Face* face = faces[i];
-                    vertexArray->addAttributes(face->cachedVertices());
+                    const FaceVertex::List& vertices = face->cachedVertices();
+                    vertexArray->addAttributes(vertices);
+                    vertexArray->endPrimitive();
+                    
+                    m_faceEntries.push_back(FaceEntry(face->brush(), face, stateIndex, vertices.size(), batch));
+                    stateIndex += vertices.size();
                 }
                 
-                if (texture != NULL && alphaBlend(texture->name()))
-                    m_transparentVertexArrays.push_back(TextureVertexArray(textureRenderer, vertexArray));
-                else
-                    m_vertexArrays.push_back(TextureVertexArray(textureRenderer, vertexArray));
+                if (texture != NULL && alphaBlend(texture->name())) {
+                    m_transparentVertexArrays.push_back(TextureIndexedVertexArray(textureRenderer, vertexArray));
+                    m_transparentBatches.push_back(batch);
+                } else {
+                    m_vertexArrays.push_back(TextureIndexedVertexArray(textureRenderer, vertexArray));
+                    m_batches.push_back(batch);
+                }
             }
+            
+            assert(stateIndex == m_editStates->size());
+            std::sort(m_faceEntries.begin(), m_faceEntries.end(), CompareFaceEntries());
         }
 
-        void FaceRenderer::render(RenderContext& context, bool grayScale, const Color* tintColor) {
-            if (m_vertexArrays.empty() && m_transparentVertexArrays.empty())
+        // all vertices of a face always have the same state
+        void FaceRenderer::setFaceState(const FaceEntry& entry, const unsigned int state) {
+            const bool wasHidden = m_editStates->state(entry.index) == RenderState::Hidden;
+            const bool hidden = state == RenderState::Hidden;
+            m_editStates->setState(entry.index, entry.count, state);
+            if (wasHidden && !hidden)
+                m_visibleFaceCounts[entry.batch]++;
+            else if (!wasHidden && hidden)
+                m_visibleFaceCounts[entry.batch]--;
+        }
+        
+        void FaceRenderer::render(RenderContext& context, bool grayScale, const Color* tintColor, const Color* selectedColor, const Color* lockedColor, const bool opaque, const bool transparent) {
+            if ((!opaque || m_vertexArrays.empty()) && (!transparent || m_transparentVertexArrays.empty()))
                 return;
             
             Preferences::PreferenceManager& prefs = Preferences::PreferenceManager::preferences();
@@ -91,31 +123,44 @@ namespace TrenchBroom {
                 if (tintColor != NULL)
                     faceProgram.setUniformVariable("TintColor", *tintColor);
                 faceProgram.setUniformVariable("GrayScale", grayScale);
+                faceProgram.setUniformVariable("RenderSelected", selectedColor != NULL);
+                if (selectedColor != NULL)
+                    faceProgram.setUniformVariable("SelectedColor", *selectedColor);
+                if (lockedColor != NULL)
+                    faceProgram.setUniformVariable("LockedColor", *lockedColor);
                 faceProgram.setUniformVariable("CameraPosition", context.camera().position());
                 faceProgram.setUniformVariable("ShadeFaces", context.viewOptions().shadeFaces() );
                 faceProgram.setUniformVariable("UseFog", context.viewOptions().useFog() );
                 
-                renderOpaqueFaces(faceProgram, applyTexture);
-                glDepthMask(GL_FALSE);
-                faceProgram.setUniformVariable("Alpha", prefs.getFloat(Preferences::TransparentFaceAlpha));
-                renderTransparentFaces(faceProgram, applyTexture);
-                glDepthMask(GL_TRUE);
+                if (opaque)
+                    renderOpaqueFaces(faceProgram, applyTexture);
+                if (transparent) {
+                    glDepthMask(GL_FALSE);
+                    faceProgram.setUniformVariable("Alpha", prefs.getFloat(Preferences::TransparentFaceAlpha));
+                    renderTransparentFaces(faceProgram, applyTexture);
+                    glDepthMask(GL_TRUE);
+                }
 
                 faceProgram.deactivate();
             }
         }
 
         void FaceRenderer::renderOpaqueFaces(ShaderProgram& shader, const bool applyTexture) {
-            renderFaces(m_vertexArrays, shader, applyTexture);
+            renderFaces(m_vertexArrays, m_batches, shader, applyTexture);
         }
         
         void FaceRenderer::renderTransparentFaces(ShaderProgram& shader, const bool applyTexture) {
-            renderFaces(m_transparentVertexArrays, shader, applyTexture);
+            renderFaces(m_transparentVertexArrays, m_transparentBatches, shader, applyTexture);
         }
 
-        void FaceRenderer::renderFaces(const TextureVertexArrayList& vertexArrays, ShaderProgram& shader, const bool applyTexture) {
+        void FaceRenderer::renderFaces(const TextureIndexedVertexArrayList& vertexArrays, const IndexList& batches, ShaderProgram& shader, const bool applyTexture) {
+            const GLint editStateLocation = shader.attributeLocation("EditState");
             for (size_t i = 0; i < vertexArrays.size(); i++) {
-                const TextureVertexArray& textureVertexArray = vertexArrays[i];
+                const size_t batch = batches[i];
+                if (m_visibleFaceCounts[batch] == 0)
+                    continue;
+                
+                const TextureIndexedVertexArray& textureVertexArray = vertexArrays[i];
                 if (textureVertexArray.texture != NULL) {
                     textureVertexArray.texture->activate();
                     shader.setUniformVariable("ApplyTexture", applyTexture);
@@ -126,7 +171,11 @@ namespace TrenchBroom {
                     shader.setUniformVariable("Color", m_faceColor);
                 }
                 
+                m_editStates->setup(editStateLocation, m_firstStates[batch]);
                 textureVertexArray.vertexArray->render();
+                m_editStates->cleanup(editStateLocation);
+                PROFILE_COUNT("FaceRenderer draw calls", 1);
+                PROFILE_COUNT("FaceRenderer faces", textureVertexArray.vertexArray->primCount());
                 
                 if (textureVertexArray.texture != NULL)
                     textureVertexArray.texture->deactivate();
@@ -134,16 +183,45 @@ namespace TrenchBroom {
         }
 
         FaceRenderer::FaceRenderer(Vbo& vbo, TextureRendererManager& textureRendererManager, const Sorter& faceSorter, const Color& faceColor) :
-        m_faceColor(faceColor) {
+        m_faceColor(faceColor),
+        m_editStates(NULL) {
             writeFaceData(vbo, textureRendererManager, faceSorter);
         }
         
+        FaceRenderer::~FaceRenderer() {
+            delete m_editStates;
+            m_editStates = NULL;
+        }
+        
+        void FaceRenderer::setEditState(const Model::Brush& brush, const unsigned int state) {
+            const FaceEntry key(&brush, NULL, 0, 0, 0);
+            std::pair<FaceEntryList::const_iterator, FaceEntryList::const_iterator> range = std::equal_range(m_faceEntries.begin(), m_faceEntries.end(), key, CompareFaceEntryBrushes());
+            FaceEntryList::const_iterator it, end;
+            for (it = range.first, end = range.second; it != end; ++it)
+                setFaceState(*it, state);
+        }
+        
+        void FaceRenderer::setEditState(const Model::Face& face, const unsigned int state) {
+            const FaceEntry key(face.brush(), &face, 0, 0, 0);
+            FaceEntryList::const_iterator it = std::lower_bound(m_faceEntries.begin(), m_faceEntries.end(), key, CompareFaceEntries());
+            if (it != m_faceEntries.end() && it->face == &face)
+                setFaceState(*it, state);
+        }
+        
         void FaceRenderer::render(RenderContext& context, bool grayScale) {
-            render(context, grayScale, NULL);
+            render(context, grayScale, NULL, NULL, NULL, true, true);
         }
         
         void FaceRenderer::render(RenderContext& context, bool grayScale, const Color& tintColor) {
-            render(context, grayScale, &tintColor);
+            render(context, grayScale, &tintColor, NULL, NULL, true, true);
+        }
+        
+        void FaceRenderer::renderOpaque(RenderContext& context, const Color* selectedColor, const Color& lockedColor) {
+            render(context, false, NULL, selectedColor, &lockedColor, true, false);
+        }
+        
+        void FaceRenderer::renderTransparent(RenderContext& context, const Color* selectedColor, const Color& lockedColor) {
+            render(context, false, NULL, selectedColor, &lockedColor, false, true);
         }
     }
 }
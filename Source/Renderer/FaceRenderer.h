@@ -24,13 +24,18 @@
 #include "Renderer/TextureVertexArray.h"
 #include "Utility/Color.h"
 
+#include <functional>
+#include <vector>
+
 namespace TrenchBroom {
     namespace Model {
+        class Brush;
         class Face;
         class Texture;
     }
     
     namespace Renderer {
+        class EditStateArray;
         class RenderContext;
         class TextureRendererManager;
         class Vbo;
@@ -41,10 +46,52 @@ namespace TrenchBroom {
         protected:
             typedef Sorter::PolygonCollection FaceCollection;
             typedef Sorter::PolygonCollectionMap FaceCollectionMap;
+            
+            struct FaceEntry {
+                const Model::Brush* brush;
+                const Model::Face* face;
+                size_t index;
+                size_t count;
+                size_t batch;
+                
+                FaceEntry(const Model::Brush* i_brush, const Model::Face* i_face, size_t i_index, size_t i_count, size_t i_batch) :
+                brush(i_brush),
+                face(i_face),
+                index(i_index),
+                count(i_count),
+                batch(i_batch) {}
+            };
+            
+            typedef std::vector<FaceEntry> FaceEntryList;
+            typedef std::vector<size_t> IndexList;
+            
+            struct CompareFaceEntries {
+                inline bool operator()(const FaceEntry& lhs, const FaceEntry& rhs) const {
+                    if (lhs.brush != rhs.brush)
+                        return std::less<const Model::Brush*>()(lhs.brush, rhs.brush);
+                    return std::less<const Model::Face*>()(lhs.face, rhs.face);
+                }
+            };
+            
+            struct CompareFaceEntryBrushes {
+                inline bool operator()(const FaceEntry& lhs, const FaceEntry& rhs) const {
+                    return std::less<const Model::Brush*>()(lhs.brush, rhs.brush);
+                }
+            };
 
             Color m_faceColor;
-            TextureVertexArrayList m_vertexArrays;
-            TextureVertexArrayList m_transparentVertexArrays;
+            TextureIndexedVertexArrayList m_vertexArrays;
+            TextureIndexedVertexArrayList m_transparentVertexArrays;
+            
+            // the batch of each of the vertex arrays above; a batch is skipped when all of its faces are hidden
+            IndexList m_batches;
+            IndexList m_transparentBatches;
+            
+            // the render state of every face vertex, and the first state and number of visible faces of each batch
+            EditStateArray* m_editStates;
+            IndexList m_firstStates;
+            IndexList m_visibleFaceCounts;
+            FaceEntryList m_faceEntries;
             
             static String AlphaBlendedTextures[];
             
@@ -60,15 +107,30 @@ namespace TrenchBroom {
             }
             
             void writeFaceData(Vbo& vbo, TextureRendererManager& textureRendererManager, const Sorter& faceSorter);
-            void render(RenderContext& context, bool grayScale, const Color* tintColor);
+            void setFaceState(const FaceEntry& entry, unsigned int state);
+            void render(RenderContext& context, bool grayScale, const Color* tintColor, const Color* selectedColor, const Color* lockedColor, bool opaque, bool transparent);
             void renderOpaqueFaces(ShaderProgram& shader, const bool applyTexture);
             void renderTransparentFaces(ShaderProgram& shader, const bool applyTexture);
-            void renderFaces(const TextureVertexArrayList& vertexArrays, ShaderProgram& shader, const bool applyTexture);
+            void renderFaces(const TextureIndexedVertexArrayList& vertexArrays, const IndexList& batches, ShaderProgram& shader, const bool applyTexture);
+            
+            // prevent copying
+            FaceRenderer(const FaceRenderer& other);
+            void operator= (const FaceRenderer& other);
         public:
             FaceRenderer(Vbo& vbo, TextureRendererManager& textureRendererManager, const Sorter& faceSorter, const Color& faceColor);
+            ~FaceRenderer();
+            
+            // only updates the state buffer, the geometry is left as it is
+            void setEditState(const Model::Brush& brush, unsigned int state);
+            void setEditState(const Model::Face& face, unsigned int state);
             
             void render(RenderContext& context, bool grayScale);
             void render(RenderContext& context, bool grayScale, const Color& tintColor);
+            
+            // Selected faces are omitted if no selection color is given. The opaque and transparent faces are rendered
+            // separately so that the transparent faces of several renderers can be drawn after all of their opaque faces.
+            void renderOpaque(RenderContext& context, const Color* selectedColor, const Color& lockedColor);
+            void renderTransparent(RenderContext& context, const Color* selectedColor, const Color& lockedColor);
         };
     }
 }
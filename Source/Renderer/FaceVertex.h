@@ -31,20 +31,26 @@ namespace TrenchBroom {
 #if defined _WIN32
 #pragma pack(push,1)
 #endif
+        // The normal is packed into signed bytes and padded to four bytes so that the texture coordinates stay aligned.
         struct FaceVertex {
             typedef std::vector<FaceVertex> List;
             
             float px, py, pz;
-            float nx, ny, nz;
+            signed char nx, ny, nz, padding;
             float ts, tt;
             
+            inline static signed char packNormal(const float f) {
+                return static_cast<signed char>(Math<float>::round(f * 127.0f));
+            }
+            
             FaceVertex(const Vec3f& position, const Vec3f& normal, const Vec2f& texCoord) :
             px(position.x()),
             py(position.y()),
             pz(position.z()),
-            nx(normal.x()),
-            ny(normal.y()),
-            nz(normal.z()),
+            nx(packNormal(normal.x())),
+            ny(packNormal(normal.y())),
+            nz(packNormal(normal.z())),
+            padding(0),
             ts(texCoord.x()),
             tt(texCoord.y()) {}
             
@@ -85,6 +85,10 @@ namespace TrenchBroom {
                 
             }
 
+            inline size_t primCount() const {
+                return m_primCount;
+            }
+
             inline void render() {
                 if (m_primCount == 0)
                     return;
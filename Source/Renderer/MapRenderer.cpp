@@ -35,10 +35,12 @@
 #include "Model/Map.h"
 #include "Model/MapDocument.h"
 #include "Renderer/EdgeRenderer.h"
+#include "Renderer/EditStateArray.h"
 #include "Renderer/EntityRenderer.h"
 #include "Renderer/EntityRotationDecorator.h"
 #include "Renderer/EntityLinkDecorator.h"
 #include "Renderer/FaceRenderer.h"
+#include "Renderer/FaceVertex.h"
 #include "Renderer/PointHandleRenderer.h"
 #include "Renderer/PointTraceRenderer.h"
 #include "Renderer/RenderContext.h"
@@ -54,159 +56,174 @@
 #include "Utility/Grid.h"
 #include "Utility/List.h"
 #include "Utility/Preferences.h"
+#include "Utility/Profiler.h"
+
+#include <algorithm>
 
 namespace TrenchBroom {
     namespace Renderer {
         static const int IndexSize = sizeof(GLuint);
         static const int VertexSize = 3 * sizeof(GLfloat);
-        static const int NormalSize = 3 * sizeof(GLfloat);
         static const int ColorSize = 4;
-        static const int TexCoordSize = 2 * sizeof(GLfloat);
-        static const int FaceVertexSize = VertexSize + NormalSize + TexCoordSize;
+        static const int FaceVertexSize = sizeof(FaceVertex);
         static const int EdgeVertexSize = VertexSize;
+        static const int StateSize = sizeof(GLfloat);
         static const int EntityBoundsVertexSize = ColorSize + VertexSize;
 
-        void MapRenderer::rebuildGeometryData(RenderContext& context) {
-            if (!m_geometryDataValid) {
-                delete m_faceRenderer;
-                m_faceRenderer = NULL;
-                delete m_edgeRenderer;
-                m_edgeRenderer = NULL;
-            }
-            if (!m_selectedGeometryDataValid) {
-                delete m_selectedFaceRenderer;
-                m_selectedFaceRenderer = NULL;
-                delete m_selectedEdgeRenderer;
-                m_selectedEdgeRenderer = NULL;
+        static unsigned int brushState(const Model::Filter& filter, const Model::Brush& brush) {
+            const Model::Entity& entity = *brush.entity();
+            if (!filter.brushVisible(brush))
+                return RenderState::Hidden;
+            if (entity.selected() || brush.selected())
+                return RenderState::Selected;
+            if (entity.locked() || brush.locked())
+                return RenderState::Locked;
+            return RenderState::Default;
+        }
+        
+        static void setEditState(FaceRenderer* faceRenderer, EdgeRenderer* edgeRenderer, const Model::Brush& brush, const unsigned int state) {
+            if (faceRenderer != NULL) {
+                faceRenderer->setEditState(brush, state);
+                if (state == RenderState::Default && brush.partiallySelected()) {
+                    const Model::FaceList& faces = brush.faces();
+                    for (size_t i = 0; i < faces.size(); i++) {
+                        const Model::Face& face = *faces[i];
+                        if (face.selected())
+                            faceRenderer->setEditState(face, RenderState::Selected);
+                    }
+                }
             }
-            if (!m_lockedGeometryDataValid) {
-                delete m_lockedFaceRenderer;
-                m_lockedFaceRenderer = NULL;
-                delete m_lockedEdgeRenderer;
-                m_lockedEdgeRenderer = NULL;
+            if (edgeRenderer != NULL)
+                edgeRenderer->setEditState(brush, state);
+        }
+        
+        static void writeFaceAndEdgeData(Vbo& faceVbo, Vbo& edgeVbo, TextureRendererManager& textureRendererManager, const Model::BrushList& brushes, FaceRenderer*& faceRenderer, EdgeRenderer*& edgeRenderer) {
+            typedef TexturedPolygonSorter<Model::Texture, Model::Face*> FaceSorter;
+            
+            FaceSorter faceSorter;
+            Model::BrushList::const_iterator brushIt, brushEnd;
+            for (brushIt = brushes.begin(), brushEnd = brushes.end(); brushIt != brushEnd; ++brushIt) {
+                const Model::FaceList& faces = (*brushIt)->faces();
+                for (size_t i = 0; i < faces.size(); i++) {
+                    Model::Face* face = faces[i];
+                    faceSorter.addPolygon(face->texture(), face, face->vertices().size());
+                }
             }
             
-            FaceSorter unselectedFaceSorter;
-            FaceSorter selectedFaceSorter;
-            FaceSorter lockedFaceSorter;
+            Preferences::PreferenceManager& prefs = Preferences::PreferenceManager::preferences();
+            
+            // write face triangles, followed by their render states
+            faceVbo.activate();
+            faceVbo.map();
+            faceVbo.ensureFreeCapacity(faceSorter.vertexCount() * static_cast<size_t>(FaceVertexSize + StateSize));
+            if (!faceSorter.empty())
+                faceRenderer = new FaceRenderer(faceVbo, textureRendererManager, faceSorter, prefs.getColor(Preferences::FaceColor));
+            faceVbo.unmap();
+            faceVbo.deactivate();
             
-            Model::BrushList unselectedWorldBrushes;
-            Model::BrushList unselectedEntityBrushes;
-            Model::BrushList selectedBrushes;
-            Model::BrushList lockedBrushes;
-            Model::FaceList partiallySelectedBrushFaces;
+            // write edges
+            edgeVbo.activate();
+            edgeVbo.map();
+            if (!brushes.empty())
+                edgeRenderer = new EdgeRenderer(edgeVbo, brushes, prefs.getColor(Preferences::EdgeColor));
+            edgeVbo.unmap();
+            edgeVbo.deactivate();
+        }
+        
+        // All brushes are written regardless of their state, so that selecting, locking or hiding a brush only
+        // changes its render state and leaves the geometry alone.
+        void MapRenderer::rebuildGeometryData(RenderContext& context) {
+            PROFILE_SCOPE("MapRenderer::rebuildGeometryData");
+            
+            delete m_faceRenderer;
+            m_faceRenderer = NULL;
+            delete m_edgeRenderer;
+            m_edgeRenderer = NULL;
+            delete m_modifiedFaceRenderer;
+            m_modifiedFaceRenderer = NULL;
+            delete m_modifiedEdgeRenderer;
+            m_modifiedEdgeRenderer = NULL;
+            m_modifiedBrushes.clear();
+            
+            Model::BrushList worldBrushes;
+            Model::BrushList entityBrushes;
             
-            // collect all visible faces and brushes
             const Model::EntityList& entities = m_document.map().entities();
             for (size_t i = 0; i < entities.size(); i++) {
                 Model::Entity* entity = entities[i];
                 const Model::BrushList& brushes = entity->brushes();
-                for (size_t j = 0; j < brushes.size(); j++) {
-                    Model::Brush* brush = brushes[j];
-                    if (context.filter().brushVisible(*brush)) {
-                        if (entity->selected() || brush->selected()) {
-                            selectedBrushes.push_back(brush);
-                        } else if (entity->locked() || brush->locked()) {
-                            lockedBrushes.push_back(brush);
-                        } else {
-                            if (entity->worldspawn())
-                                unselectedWorldBrushes.push_back(brush);
-                            else
-                                unselectedEntityBrushes.push_back(brush);
-                            if (brush->partiallySelected()) {
-                                const Model::FaceList& faces = brush->faces();
-                                for (size_t k = 0; k < faces.size(); k++) {
-                                    Model::Face* face = faces[k];
-                                    if (face->selected()) {
-                                        partiallySelectedBrushFaces.push_back(face);
-                                    }
-                                }
-                            }
-                        }
-                        
-                        const Model::FaceList& faces = brush->faces();
-                        for (size_t k = 0; k < faces.size(); k++) {
-                            Model::Face* face = faces[k];
-                            Model::Texture* texture = face->texture();
-                            if (entity->selected() || brush->selected() || face->selected())
-                                selectedFaceSorter.addPolygon(texture, face, face->vertices().size());
-                            else if (entity->locked() || brush->locked())
-                                lockedFaceSorter.addPolygon(texture, face, face->vertices().size());
-                            else
-                                unselectedFaceSorter.addPolygon(texture, face, face->vertices().size());
-                        }
-                    }
-                }
+                Model::BrushList& target = entity->worldspawn() ? worldBrushes : entityBrushes;
+                target.insert(target.end(), brushes.begin(), brushes.end());
             }
             
-            // merge the collected brushes
-            Model::BrushList unselectedBrushes(unselectedWorldBrushes);
-            unselectedBrushes.insert(unselectedBrushes.end(), unselectedEntityBrushes.begin(), unselectedEntityBrushes.end());
-
-            // write face triangles
-            m_faceVbo->activate();
-            m_faceVbo->map();
-            
-            // make sure that the VBO is sufficiently large
-            size_t totalFaceVertexCount = unselectedFaceSorter.vertexCount() + selectedFaceSorter.vertexCount() + lockedFaceSorter.vertexCount();
-            size_t totalPolygonCount = unselectedFaceSorter.polygonCount() + selectedFaceSorter.polygonCount() + lockedFaceSorter.polygonCount();
-            size_t totalTriangleVertexCount = 3 * totalFaceVertexCount - 6 * totalPolygonCount;
-            m_faceVbo->ensureFreeCapacity(static_cast<unsigned int>(totalTriangleVertexCount) * FaceVertexSize);
+            Model::BrushList brushes(worldBrushes);
+            brushes.insert(brushes.end(), entityBrushes.begin(), entityBrushes.end());
+            m_brushCount = brushes.size();
             
-            Preferences::PreferenceManager& prefs = Preferences::PreferenceManager::preferences();
             TextureRendererManager& textureRendererManager = m_document.sharedResources().textureRendererManager();
-            const Color& faceColor = prefs.getColor(Preferences::FaceColor);
-
-            if (!m_geometryDataValid && !unselectedFaceSorter.empty()) {
-                assert(m_faceRenderer == NULL);
-                m_faceRenderer = new FaceRenderer(*m_faceVbo, textureRendererManager, unselectedFaceSorter, faceColor);
-            }
+            writeFaceAndEdgeData(*m_faceVbo, *m_edgeVbo, textureRendererManager, brushes, m_faceRenderer, m_edgeRenderer);
             
-            if (!m_selectedGeometryDataValid && !selectedFaceSorter.empty()) {
-                assert(m_selectedFaceRenderer == NULL);
-                m_selectedFaceRenderer = new FaceRenderer(*m_faceVbo, textureRendererManager, selectedFaceSorter, faceColor);
-            }
-            
-            if (!m_lockedGeometryDataValid && !lockedFaceSorter.empty()) {
-                assert(m_lockedFaceRenderer == NULL);
-                m_lockedFaceRenderer = new FaceRenderer(*m_faceVbo, textureRendererManager, lockedFaceSorter, faceColor);
-            }
-            
-            m_faceVbo->unmap();
-            m_faceVbo->deactivate();
+            m_geometryDataValid = true;
+            m_modifiedGeometryDataValid = true;
+            m_editStatesValid = false;
+        }
+        
+        void MapRenderer::rebuildModifiedGeometryData(RenderContext& context) {
+            PROFILE_SCOPE("MapRenderer::rebuildModifiedGeometryData");
             
-            // write edges
-            m_edgeVbo->activate();
-            m_edgeVbo->map();
+            delete m_modifiedFaceRenderer;
+            m_modifiedFaceRenderer = NULL;
+            delete m_modifiedEdgeRenderer;
+            m_modifiedEdgeRenderer = NULL;
             
-            const Color& edgeColor = prefs.getColor(Preferences::EdgeColor);
-
-            if (!m_geometryDataValid && !unselectedBrushes.empty()) {
-                assert(m_edgeRenderer == NULL);
-                m_edgeRenderer = new EdgeRenderer(*m_edgeVbo, unselectedBrushes, Model::EmptyFaceList, edgeColor);
-            }
+            const Model::BrushList brushes = Utility::makeList(m_modifiedBrushes);
+            TextureRendererManager& textureRendererManager = m_document.sharedResources().textureRendererManager();
+            writeFaceAndEdgeData(*m_faceVbo, *m_edgeVbo, textureRendererManager, brushes, m_modifiedFaceRenderer, m_modifiedEdgeRenderer);
             
-            if (!m_selectedGeometryDataValid && (!selectedBrushes.empty() || !partiallySelectedBrushFaces.empty())) {
-                assert(m_selectedEdgeRenderer == NULL);
-                m_selectedEdgeRenderer = new EdgeRenderer(*m_edgeVbo, selectedBrushes, partiallySelectedBrushFaces);
+            m_changedBrushes.insert(m_modifiedBrushes.begin(), m_modifiedBrushes.end());
+            m_modifiedGeometryDataValid = true;
+        }
+        
+        void MapRenderer::updateEditState(RenderContext& context, Model::Brush& brush) {
+            const unsigned int state = brushState(context.filter(), brush);
+            if (m_modifiedBrushes.count(&brush) > 0) {
+                setEditState(m_faceRenderer, m_edgeRenderer, brush, RenderState::Hidden);
+                setEditState(m_modifiedFaceRenderer, m_modifiedEdgeRenderer, brush, state);
+            } else {
+                setEditState(m_faceRenderer, m_edgeRenderer, brush, state);
             }
-            
-            if (!m_lockedGeometryDataValid && !lockedBrushes.empty()) {
-                assert(m_lockedEdgeRenderer == NULL);
-                m_lockedEdgeRenderer = new EdgeRenderer(*m_edgeVbo, lockedBrushes, Model::EmptyFaceList);
+        }
+        
+        void MapRenderer::updateEditStates(RenderContext& context) {
+            PROFILE_SCOPE("MapRenderer::updateEditStates");
+            
+            if (!m_editStatesValid) {
+                const Model::EntityList& entities = m_document.map().entities();
+                for (size_t i = 0; i < entities.size(); i++) {
+                    const Model::BrushList& brushes = entities[i]->brushes();
+                    for (size_t j = 0; j < brushes.size(); j++)
+                        updateEditState(context, *brushes[j]);
+                }
+                m_editStatesValid = true;
+            } else {
+                Model::BrushSet::const_iterator brushIt, brushEnd;
+                for (brushIt = m_changedBrushes.begin(), brushEnd = m_changedBrushes.end(); brushIt != brushEnd; ++brushIt)
+                    updateEditState(context, **brushIt);
             }
-            
-            m_edgeVbo->unmap();
-            m_edgeVbo->deactivate();
-            
-            m_geometryDataValid = true;
-            m_selectedGeometryDataValid = true;
-            m_lockedGeometryDataValid = true;
+            m_changedBrushes.clear();
         }
         
         void MapRenderer::validate(RenderContext& context) {
-            if (!m_geometryDataValid || !m_selectedGeometryDataValid || !m_lockedGeometryDataValid)
+            // once the modified brushes make up a good part of the map, it is cheaper to rebuild everything
+            if (m_modifiedBrushes.size() > m_brushCount / 4)
+                m_geometryDataValid = false;
+            
+            if (!m_geometryDataValid)
                 rebuildGeometryData(context);
+            if (!m_modifiedGeometryDataValid)
+                rebuildModifiedGeometryData(context);
+            if (!m_editStatesValid || !m_changedBrushes.empty())
+                updateEditStates(context);
         }
         
         void MapRenderer::invalidateDecorators() {
@@ -216,47 +233,63 @@ namespace TrenchBroom {
                 decorator.invalidate();
             }
         }
+        
+        void MapRenderer::invalidateDecorators(const Model::EntityList& entities) {
+            EntityDecorator::List::const_iterator decoratorIt, decoratorEnd;
+            for (decoratorIt = m_entityDecorators.begin(), decoratorEnd = m_entityDecorators.end(); decoratorIt != decoratorEnd; ++decoratorIt) {
+                EntityDecorator& decorator = **decoratorIt;
+                decorator.invalidateEntities(entities);
+            }
+        }
 
         void MapRenderer::renderFaces(RenderContext& context) {
             Preferences::PreferenceManager& prefs = Preferences::PreferenceManager::preferences();
+            const Color& selectedColor = m_overrideSelectionColors ? m_selectedFaceColor : prefs.getColor(Preferences::SelectedFaceColor);
+            const Color* renderSelectedColor = context.viewOptions().renderSelection() ? &selectedColor : NULL;
+            const Color& lockedColor = prefs.getColor(Preferences::LockedFaceColor);
             
+            // transparent faces must be drawn after all opaque faces, including those of the modified brushes
             m_faceVbo->activate();
             if (m_faceRenderer != NULL)
-                m_faceRenderer->render(context, false);
-            if (context.viewOptions().renderSelection() && m_selectedFaceRenderer != NULL) {
-                const Color& color = m_overrideSelectionColors ? m_selectedFaceColor : prefs.getColor(Preferences::SelectedFaceColor);
-                m_selectedFaceRenderer->render(context, false, color);
-            }
-            if (m_lockedFaceRenderer != NULL)
-                m_lockedFaceRenderer->render(context, true, prefs.getColor(Preferences::LockedFaceColor));
+                m_faceRenderer->renderOpaque(context, renderSelectedColor, lockedColor);
+            if (m_modifiedFaceRenderer != NULL)
+                m_modifiedFaceRenderer->renderOpaque(context, renderSelectedColor, lockedColor);
+            if (m_faceRenderer != NULL)
+                m_faceRenderer->renderTransparent(context, renderSelectedColor, lockedColor);
+            if (m_modifiedFaceRenderer != NULL)
+                m_modifiedFaceRenderer->renderTransparent(context, renderSelectedColor, lockedColor);
             m_faceVbo->deactivate();
         }
         
         void MapRenderer::renderEdges(RenderContext& context) {
             Preferences::PreferenceManager& prefs = Preferences::PreferenceManager::preferences();
+            EdgeRenderer* edgeRenderers[] = {m_edgeRenderer, m_modifiedEdgeRenderer};
             
             m_edgeVbo->activate();
             if (context.viewOptions().renderEdges()) {
-                if (m_edgeRenderer != NULL) {
-                    glSetEdgeOffset(0.02f);
-                    m_edgeRenderer->render(context);
-                }
-                if (m_lockedEdgeRenderer != NULL) {
-                    glSetEdgeOffset(0.02f);
-                    m_lockedEdgeRenderer->render(context, prefs.getColor(Preferences::LockedEdgeColor));
+                const Color& lockedEdgeColor = prefs.getColor(Preferences::LockedEdgeColor);
+                glSetEdgeOffset(0.02f);
+                for (size_t i = 0; i < 2; i++) {
+                    if (edgeRenderers[i] != NULL) {
+                        edgeRenderers[i]->render(context, RenderState::Default);
+                        edgeRenderers[i]->render(context, lockedEdgeColor, RenderState::Locked);
+                    }
                 }
             }
-            if (context.viewOptions().renderSelection() && m_selectedEdgeRenderer != NULL) {
+            if (context.viewOptions().renderSelection()) {
                 const Color& edgeColor = m_overrideSelectionColors ? m_selectedEdgeColor : prefs.getColor(Preferences::SelectedEdgeColor);
                 const Color& occludedEdgeColor = m_overrideSelectionColors ? m_occludedSelectedEdgeColor : prefs.getColor(Preferences::OccludedSelectedEdgeColor);
                 
-                
-                glDisable(GL_DEPTH_TEST);
-                glSetEdgeOffset(0.02f);
-                m_selectedEdgeRenderer->render(context, occludedEdgeColor);
-                glEnable(GL_DEPTH_TEST);
-                glSetEdgeOffset(0.025f);
-                m_selectedEdgeRenderer->render(context, edgeColor);
+                for (size_t i = 0; i < 2; i++) {
+                    if (edgeRenderers[i] != NULL) {
+                        glDisable(GL_DEPTH_TEST);
+                        glSetEdgeOffset(0.02f);
+                        edgeRenderers[i]->render(context, occludedEdgeColor, RenderState::Selected);
+                        glEnable(GL_DEPTH_TEST);
+                        glSetEdgeOffset(0.025f);
+                        edgeRenderers[i]->render(context, edgeColor, RenderState::Selected);
+                    }
+                }
             }
             m_edgeVbo->deactivate();
             glResetEdgeOffset();
@@ -278,18 +311,9 @@ namespace TrenchBroom {
             m_lockedEntityRenderer->addEntities(changeSet.entitiesTo(Model::EditState::Locked));
             m_lockedEntityRenderer->removeEntities(changeSet.entitiesFrom(Model::EditState::Locked));
             
-            if (changeSet.brushStateChangedFrom(Model::EditState::Default) ||
-                changeSet.brushStateChangedTo(Model::EditState::Default) ||
-                changeSet.faceSelectionChanged()) {
-                m_geometryDataValid = false;
-                invalidateDecorators();
-            }
-            
             if (changeSet.brushStateChangedFrom(Model::EditState::Selected) ||
                 changeSet.brushStateChangedTo(Model::EditState::Selected) ||
                 changeSet.faceSelectionChanged()) {
-                m_selectedGeometryDataValid = false;
-                
                 const Model::BrushList& selectedBrushes = changeSet.brushesTo(Model::EditState::Selected);
                 for (unsigned int i = 0; i < selectedBrushes.size(); i++) {
                     Model::Brush* brush = selectedBrushes[i];
@@ -311,11 +335,6 @@ namespace TrenchBroom {
                 }
             }
             
-            if (changeSet.entityStateChangedFrom(Model::EditState::Hidden) ||
-                changeSet.entityStateChangedTo(Model::EditState::Hidden)) {
-                invalidateDecorators();
-            }
-            
             if (changeSet.brushStateChangedFrom(Model::EditState::Hidden) ||
                 changeSet.brushStateChangedTo(Model::EditState::Hidden)) {
                 
@@ -334,36 +353,82 @@ namespace TrenchBroom {
                     if (!entity->worldspawn())
                         m_entityRenderer->addEntity(*entity);
                 }
+            }
+            
+            // only the render states of the affected brushes are updated
+            Model::EntitySet changedEntities;
+            for (Model::EditState::Type state = 0; state < Model::EditState::Count; state++) {
+                const Model::EntityList& entities = changeSet.entitiesTo(state);
+                changedEntities.insert(entities.begin(), entities.end());
+                Model::EntityList::const_iterator entityIt, entityEnd;
+                for (entityIt = entities.begin(), entityEnd = entities.end(); entityIt != entityEnd; ++entityIt) {
+                    const Model::BrushList& entityBrushes = (*entityIt)->brushes();
+                    m_changedBrushes.insert(entityBrushes.begin(), entityBrushes.end());
+                }
                 
-                invalidateDecorators();
+                const Model::BrushList& brushes = changeSet.brushesTo(state);
+                Model::BrushList::const_iterator brushIt, brushEnd;
+                for (brushIt = brushes.begin(), brushEnd = brushes.end(); brushIt != brushEnd; ++brushIt)
+                    changedEntities.insert((*brushIt)->entity());
+                m_changedBrushes.insert(brushes.begin(), brushes.end());
             }
             
-            if (changeSet.brushStateChangedFrom(Model::EditState::Locked) ||
-                changeSet.brushStateChangedTo(Model::EditState::Locked)) {
-                m_lockedGeometryDataValid = false;
+            for (size_t i = 0; i < 2; i++) {
+                const Model::FaceList& faces = changeSet.faces(i == 0);
+                Model::FaceList::const_iterator faceIt, faceEnd;
+                for (faceIt = faces.begin(), faceEnd = faces.end(); faceIt != faceEnd; ++faceIt)
+                    m_changedBrushes.insert((*faceIt)->brush());
             }
+            if (!changedEntities.empty())
+                invalidateDecorators(Utility::makeList(changedEntities));
         }
         
-        void MapRenderer::invalidateEntities() {
+        void MapRenderer::invalidateEntityBounds() {
             m_entityRenderer->invalidateBounds();
             m_selectedEntityRenderer->invalidateBounds();
             m_lockedEntityRenderer->invalidateBounds();
+        }
+        
+        void MapRenderer::invalidateEntities() {
+            invalidateEntityBounds();
             invalidateDecorators();
         }
         
         void MapRenderer::invalidateSelectedEntities() {
             m_selectedEntityRenderer->invalidateBounds();
-            invalidateDecorators();
+            invalidateDecorators(m_document.editStateManager().allSelectedEntities());
         }
         
         void MapRenderer::invalidateBrushes() {
             m_geometryDataValid = false;
-            m_selectedGeometryDataValid = false;
-            m_lockedGeometryDataValid = false;
         }
         
+        // The modified brushes only ever cover the current selection. Brushes that were modified while an earlier
+        // selection was active are folded back into the main renderers by rebuilding them, so that each drag only
+        // rewrites the brushes that are actually being dragged.
         void MapRenderer::invalidateSelectedBrushes() {
-            m_selectedGeometryDataValid = false;
+            Model::BrushSet brushes;
+            
+            Model::EditStateManager& editStateManager = m_document.editStateManager();
+            const Model::BrushList& selectedBrushes = editStateManager.selectedBrushes();
+            brushes.insert(selectedBrushes.begin(), selectedBrushes.end());
+            
+            const Model::EntityList& selectedEntities = editStateManager.selectedEntities();
+            Model::EntityList::const_iterator entityIt, entityEnd;
+            for (entityIt = selectedEntities.begin(), entityEnd = selectedEntities.end(); entityIt != entityEnd; ++entityIt) {
+                const Model::BrushList& entityBrushes = (*entityIt)->brushes();
+                brushes.insert(entityBrushes.begin(), entityBrushes.end());
+            }
+            
+            const Model::FaceList& selectedFaces = editStateManager.selectedFaces();
+            Model::FaceList::const_iterator faceIt, faceEnd;
+            for (faceIt = selectedFaces.begin(), faceEnd = selectedFaces.end(); faceIt != faceEnd; ++faceIt)
+                brushes.insert((*faceIt)->brush());
+            
+            if (!std::includes(brushes.begin(), brushes.end(), m_modifiedBrushes.begin(), m_modifiedBrushes.end(), m_modifiedBrushes.key_comp()))
+                m_geometryDataValid = false;
+            m_modifiedBrushes.insert(brushes.begin(), brushes.end());
+            m_modifiedGeometryDataValid = false;
         }
         
         void MapRenderer::invalidateAll() {
@@ -384,17 +449,17 @@ namespace TrenchBroom {
         void MapRenderer::clear() {
             delete m_faceRenderer;
             m_faceRenderer = NULL;
-            delete m_selectedFaceRenderer;
-            m_selectedFaceRenderer = NULL;
-            delete m_lockedFaceRenderer;
-            m_lockedFaceRenderer = NULL;
+            delete m_modifiedFaceRenderer;
+            m_modifiedFaceRenderer = NULL;
             
             delete m_edgeRenderer;
             m_edgeRenderer = NULL;
-            delete m_selectedEdgeRenderer;
-            m_selectedEdgeRenderer = NULL;
-            delete m_lockedEdgeRenderer;
-            m_lockedEdgeRenderer = NULL;
+            delete m_modifiedEdgeRenderer;
+            m_modifiedEdgeRenderer = NULL;
+            
+            m_modifiedBrushes.clear();
+            m_changedBrushes.clear();
+            m_brushCount = 0;
             
             m_entityRenderer->clear();
             m_selectedEntityRenderer->clear();
@@ -408,12 +473,10 @@ namespace TrenchBroom {
         m_document(document),
         m_faceVbo(NULL),
         m_faceRenderer(NULL),
-        m_selectedFaceRenderer(NULL),
-        m_lockedFaceRenderer(NULL),
+        m_modifiedFaceRenderer(NULL),
         m_edgeVbo(NULL),
         m_edgeRenderer(NULL),
-        m_selectedEdgeRenderer(NULL),
-        m_lockedEdgeRenderer(NULL),
+        m_modifiedEdgeRenderer(NULL),
         m_entityVbo(NULL),
         m_entityRenderer(NULL),
         m_selectedEntityRenderer(NULL),
@@ -423,8 +486,9 @@ namespace TrenchBroom {
         m_overrideSelectionColors(false),
         m_rendering(false),
         m_geometryDataValid(false),
-        m_selectedGeometryDataValid(false),
-        m_lockedGeometryDataValid(false) {
+        m_modifiedGeometryDataValid(false),
+        m_editStatesValid(false),
+        m_brushCount(0) {
             Preferences::PreferenceManager& prefs = Preferences::PreferenceManager::preferences();
 
             m_faceVbo = new Vbo(GL_ARRAY_BUFFER, 0xFFFF);
@@ -468,18 +532,14 @@ namespace TrenchBroom {
             m_entityRenderer = NULL;
             delete m_entityVbo;
             m_entityVbo = NULL;
-            delete m_lockedEdgeRenderer;
-            m_lockedEdgeRenderer = NULL;
-            delete m_selectedEdgeRenderer;
-            m_selectedEdgeRenderer = NULL;
+            delete m_modifiedEdgeRenderer;
+            m_modifiedEdgeRenderer = NULL;
             delete m_edgeRenderer;
             m_edgeRenderer = NULL;
             delete m_edgeVbo;
             m_edgeVbo = NULL;
-            delete m_lockedFaceRenderer;
-            m_lockedFaceRenderer = NULL;
-            delete m_selectedFaceRenderer;
-            m_selectedFaceRenderer = NULL;
+            delete m_modifiedFaceRenderer;
+            m_modifiedFaceRenderer = NULL;
             delete m_faceRenderer;
             m_faceRenderer = NULL;
             delete m_faceVbo;
@@ -502,18 +562,23 @@ namespace TrenchBroom {
                 case Controller::Command::ChangeEditState: {
                     const Controller::ChangeEditStateCommand& changeEditStateCommand = static_cast<const Controller::ChangeEditStateCommand&>(command);
                     changeEditState(changeEditStateCommand.changeSet());
-                    invalidateDecorators();
                     break;
                 }
                 case Controller::Command::ViewFilterChange: {
                     invalidateEntities();
-                    invalidateBrushes();
+                    m_editStatesValid = false;
                     break;
                 }
                 case Controller::Command::PreferenceChange: {
                     const Controller::PreferenceChangeEvent& preferenceChangeEvent = static_cast<const Controller::PreferenceChangeEvent&>(command);
                     if (preferenceChangeEvent.isPreferenceChanged(Preferences::QuakePath))
                         invalidateEntityModelRendererCache();
+                    if (preferenceChangeEvent.isPreferenceChanged(Preferences::GeometryDoublePrecisionPlanes))
+                        invalidateAll();
+                    break;
+                }
+                case Controller::Command::EntityModelsLoaded: {
+                    invalidateEntityModelRendererCache();
                     break;
                 }
                 case Controller::Command::SetFaceAttributes:
@@ -529,7 +594,8 @@ namespace TrenchBroom {
                     if (entityPropertyCommand.isEntityAffected(m_document.worldspawn()) &&
                         entityPropertyCommand.isPropertyAffected(Model::Entity::WadKey))
                             invalidateBrushes();
-                    invalidateEntities();
+                    invalidateEntityBounds();
+                    invalidateDecorators(entityPropertyCommand.entities());
                     invalidateSelectedEntityModelRendererCache();
                     break;
                 }
@@ -539,6 +605,7 @@ namespace TrenchBroom {
                         m_entityRenderer->addEntities(addObjectsCommand.addedEntities());
                     else
                         m_entityRenderer->removeEntities(addObjectsCommand.addedEntities());
+                    invalidateDecorators(addObjectsCommand.addedEntities());
                     if (addObjectsCommand.hasAddedBrushes())
                         invalidateBrushes();
                     break;
@@ -558,6 +625,7 @@ namespace TrenchBroom {
                         m_entityRenderer->removeEntities(removeObjectsCommand.removedEntities());
                     else
                         m_entityRenderer->addEntities(removeObjectsCommand.removedEntities());
+                    invalidateDecorators(removeObjectsCommand.removedEntities());
                     if (!removeObjectsCommand.removedBrushes().empty())
                         invalidateBrushes();
                     break;
@@ -588,6 +656,7 @@ namespace TrenchBroom {
             if (m_rendering)
                 return;
             m_rendering = true;
+            PROFILE_SCOPE("MapRenderer::render");
             
             validate(context);
             
@@ -64,23 +64,18 @@ namespace TrenchBroom {
         }
         
         class MapRenderer {
-        private:
-            typedef TexturedPolygonSorter<Model::Texture, Model::Face*> FaceSorter;
-            typedef FaceSorter::PolygonCollection FaceCollection;
-            typedef FaceSorter::PolygonCollectionMap FaceCollectionMap;
         private:
             Model::MapDocument& m_document;
             
-            // level geometry rendering
+            // level geometry rendering, brushes whose geometry has changed since the last full rebuild are
+            // hidden in the main renderers and rendered by the modified renderers instead
             Vbo* m_faceVbo;
             FaceRenderer* m_faceRenderer;
-            FaceRenderer* m_selectedFaceRenderer;
-            FaceRenderer* m_lockedFaceRenderer;
+            FaceRenderer* m_modifiedFaceRenderer;
             
             Vbo* m_edgeVbo;
             EdgeRenderer* m_edgeRenderer;
-            EdgeRenderer* m_selectedEdgeRenderer;
-            EdgeRenderer* m_lockedEdgeRenderer;
+            EdgeRenderer* m_modifiedEdgeRenderer;
             
             Vbo* m_entityVbo;
             EntityRenderer* m_entityRenderer;
@@ -99,10 +94,16 @@ namespace TrenchBroom {
             // state
             bool m_rendering;
             bool m_geometryDataValid;
-            bool m_selectedGeometryDataValid;
-            bool m_lockedGeometryDataValid;
+            bool m_modifiedGeometryDataValid;
+            bool m_editStatesValid;
+            size_t m_brushCount;
+            Model::BrushSet m_modifiedBrushes;
+            Model::BrushSet m_changedBrushes;
             
             void rebuildGeometryData(RenderContext& context);
+            void rebuildModifiedGeometryData(RenderContext& context);
+            void updateEditState(RenderContext& context, Model::Brush& brush);
+            void updateEditStates(RenderContext& context);
             
             void validate(RenderContext& context);
             
@@ -111,6 +112,7 @@ namespace TrenchBroom {
             void renderDecorators(RenderContext& context);
 
             void changeEditState(const Model::EditStateChangeSet& changeSet);
+            void invalidateEntityBounds();
             void invalidateEntities();
             void invalidateSelectedEntities();
             void invalidateBrushes();
@@ -119,6 +121,7 @@ namespace TrenchBroom {
             void invalidateEntityModelRendererCache();
             void invalidateSelectedEntityModelRendererCache();
             void invalidateDecorators();
+            void invalidateDecorators(const Model::EntityList& entities);
             void clear();
 
             // prevent copying
@@ -108,24 +108,27 @@ namespace TrenchBroom {
             glBindFramebuffer(GL_FRAMEBUFFER, 0);
         }
 
-        wxImage* OffscreenRenderer::getImage() {
-            assert(m_valid);
+        OffscreenRenderer& OffscreenRenderer::resolvedBuffers() {
+            if (m_readBuffers == NULL)
+                m_readBuffers = new OffscreenRenderer(false);
 
-            if (m_multisample && m_samples > 0) {
-                if (m_readBuffers == NULL)
-                    m_readBuffers = new OffscreenRenderer(false);
+            m_readBuffers->setDimensions(m_width, m_height);
+            m_readBuffers->preRender();
 
-                m_readBuffers->setDimensions(m_width, m_height);
-                m_readBuffers->preRender();
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, m_framebufferId);
+            glBlitFramebuffer(0, 0, static_cast<GLint>(m_width), static_cast<GLint>(m_height),
+                              0, 0, static_cast<GLint>(m_width), static_cast<GLint>(m_height),
+                              GL_COLOR_BUFFER_BIT, GL_LINEAR);
 
-                glBindFramebuffer(GL_READ_FRAMEBUFFER, m_framebufferId);
-                glBlitFramebuffer(0, 0, static_cast<GLint>(m_width), static_cast<GLint>(m_height),
-                                  0, 0, static_cast<GLint>(m_width), static_cast<GLint>(m_height),
-                                  GL_COLOR_BUFFER_BIT, GL_LINEAR);
+            m_readBuffers->postRender();
+            return *m_readBuffers;
+        }
 
-                m_readBuffers->postRender();
-                return m_readBuffers->getImage();
-            }
+        wxImage* OffscreenRenderer::getImage() {
+            assert(m_valid);
+
+            if (m_multisample && m_samples > 0)
+                return resolvedBuffers().getImage();
 
             glBindFramebuffer(GL_READ_FRAMEBUFFER, m_framebufferId);
 
@@ -164,5 +167,24 @@ namespace TrenchBroom {
 
             return new wxImage(static_cast<int>(m_width), static_cast<int>(m_height), imageData, alphaData);
         }
+
+        void OffscreenRenderer::readPixels(unsigned char* buffer) {
+            assert(m_valid);
+
+            if (m_multisample && m_samples > 0) {
+                resolvedBuffers().readPixels(buffer);
+                return;
+            }
+
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, m_framebufferId);
+
+            glPixelStorei(GL_PACK_ALIGNMENT, 1);
+            glPixelStorei(GL_PACK_ROW_LENGTH, 0);
+            glPixelStorei(GL_PACK_SKIP_ROWS, 0);
+            glPixelStorei(GL_PACK_SKIP_PIXELS, 0);
+
+            glReadPixels(0, 0, static_cast<GLint>(m_width), static_cast<GLint>(m_height), GL_RGBA, GL_UNSIGNED_BYTE, reinterpret_cast<GLvoid*>(buffer));
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+        }
     }
 }
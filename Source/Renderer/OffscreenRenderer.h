@@ -44,6 +44,8 @@ namespace TrenchBroom {
             GLint m_samples;
 
             OffscreenRenderer* m_readBuffers;
+
+            OffscreenRenderer& resolvedBuffers();
         public:
             OffscreenRenderer(bool multisample, GLint samples = 0);
             ~OffscreenRenderer();
@@ -60,6 +62,8 @@ namespace TrenchBroom {
             void postRender();
 
             wxImage* getImage();
+            // reads the rendered image as RGBA rows from bottom to top into the given buffer of width * height * 4 bytes
+            void readPixels(unsigned char* buffer);
         };
     }
 }
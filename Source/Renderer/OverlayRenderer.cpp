@@ -23,15 +23,118 @@
 #include "Renderer/CompassRenderer.h"
 #include "Renderer/RenderContext.h"
 #include "Renderer/Vbo.h"
+#include "Renderer/VertexArray.h"
+#include "Renderer/Shader/ShaderManager.h"
+#include "Renderer/Shader/ShaderProgram.h"
+#include "Renderer/Text/FontDescriptor.h"
+#include "Renderer/Text/FontManager.h"
+#include "Renderer/Text/TexturedFont.h"
+#include "Utility/Preferences.h"
+#include "Utility/Profiler.h"
+#include "Utility/String.h"
 #include "Utility/VecMath.h"
+#include "View/ViewOptions.h"
+
+#include <algorithm>
+#include <iomanip>
 
 using namespace TrenchBroom::VecMath;
 
 namespace TrenchBroom {
     namespace Renderer {
-        OverlayRenderer::OverlayRenderer() :
+        void OverlayRenderer::renderProfiler(RenderContext& context, const float viewWidth, const float viewHeight) {
+            const Utility::Profiler& profiler = Utility::Profiler::profiler();
+            const Utility::Profiler::EntryList& entries = profiler.lastFrame();
+            
+            StringList lines;
+            StringStream frameBuffer;
+            frameBuffer << std::fixed << std::setprecision(2) << "Frame: " << profiler.lastFrameTime() << " ms (average " << profiler.averageFrameTime() << " ms)";
+            lines.push_back(frameBuffer.str());
+            for (size_t i = 0; i < entries.size(); i++) {
+                const Utility::Profiler::Entry& entry = entries[i];
+                StringStream buffer;
+                buffer << std::fixed << std::setprecision(2) << entry.name << ": ";
+                if (entry.calls > 0)
+                    buffer << entry.calls << " calls, " << entry.time << " ms";
+                else
+                    buffer << entry.count;
+                lines.push_back(buffer.str());
+            }
+            
+            if (m_font == NULL) {
+                Preferences::PreferenceManager& prefs = Preferences::PreferenceManager::preferences();
+                const String& fontName = prefs.getString(Preferences::RendererFontName);
+                int fontSize = prefs.getInt(Preferences::RendererFontSize);
+                m_font = m_fontManager.font(Text::FontDescriptor(fontName, static_cast<unsigned int>(fontSize)));
+                assert(m_font != NULL);
+            }
+            
+            const float margin = 10.0f;
+            const float inset = 4.0f;
+            const float lineHeight = m_font->measure("X").y();
+            
+            Vec2f::List textVertices;
+            float width = 0.0f;
+            float y = viewHeight - margin - inset - lineHeight;
+            for (size_t i = 0; i < lines.size(); i++) {
+                const Vec2f::List lineVertices = m_font->quads(lines[i], false, Vec2f(margin + inset, y));
+                textVertices.insert(textVertices.end(), lineVertices.begin(), lineVertices.end());
+                width = std::max(width, m_font->measure(lines[i]).x());
+                y -= lineHeight;
+            }
+            
+            const float left = margin;
+            const float right = margin + width + 2.0f * inset;
+            const float top = viewHeight - margin;
+            const float bottom = y + lineHeight - inset;
+            
+            VertexArray backgroundArray(*m_vbo, GL_QUADS, 4,
+                                        Attribute::position3f());
+            VertexArray textArray(*m_vbo, GL_QUADS, textVertices.size() / 2,
+                                  Attribute::position3f(),
+                                  Attribute::texCoord02f());
+            
+            SetVboState mapVbo(*m_vbo, Vbo::VboMapped);
+            backgroundArray.addAttribute(Vec3f(left, bottom, 0.0f));
+            backgroundArray.addAttribute(Vec3f(left, top, 0.0f));
+            backgroundArray.addAttribute(Vec3f(right, top, 0.0f));
+            backgroundArray.addAttribute(Vec3f(right, bottom, 0.0f));
+            for (size_t i = 0; i < textVertices.size() / 2; i++) {
+                const Vec2f& vertex = textVertices[2 * i];
+                textArray.addAttribute(Vec3f(vertex.x(), vertex.y(), 0.0f));
+                textArray.addAttribute(textVertices[2 * i + 1]);
+            }
+            
+            const Mat4f projection = orthoMatrix(-1.0f, 1.0f, 0.0f, viewHeight, viewWidth, 0.0f);
+            Renderer::ApplyTransformation ortho(context.transformation(), projection, Mat4f::Identity);
+            
+            Preferences::PreferenceManager& prefs = Preferences::PreferenceManager::preferences();
+            ShaderProgram& backgroundShader = context.shaderManager().shaderProgram(Shaders::TextBackgroundShader);
+            ShaderProgram& textShader = context.shaderManager().shaderProgram(Shaders::TextShader);
+            
+            SetVboState activateVbo(*m_vbo, Vbo::VboActive);
+            glDisable(GL_DEPTH_TEST);
+            if (backgroundShader.activate()) {
+                backgroundShader.setUniformVariable("Color", prefs.getColor(Preferences::InfoOverlayBackgroundColor));
+                backgroundArray.render();
+                backgroundShader.deactivate();
+            }
+            if (textShader.activate()) {
+                textShader.setUniformVariable("Color", prefs.getColor(Preferences::InfoOverlayTextColor));
+                textShader.setUniformVariable("Texture", 0);
+                m_font->activate();
+                textArray.render();
+                m_font->deactivate();
+                textShader.deactivate();
+            }
+            glEnable(GL_DEPTH_TEST);
+        }
+        
+        OverlayRenderer::OverlayRenderer(Text::FontManager& fontManager) :
+        m_fontManager(fontManager),
         m_vbo(NULL),
-        m_compass(NULL) {}
+        m_compass(NULL),
+        m_font(NULL) {}
 
         OverlayRenderer::~OverlayRenderer() {
             delete m_compass;
@@ -48,14 +151,19 @@ namespace TrenchBroom {
 
             glClear(GL_DEPTH_BUFFER_BIT);
 
-            const Mat4f projection = orthoMatrix(0.0f, 1000.0f, -viewWidth / 2.0f, viewHeight / 2.0f, viewWidth / 2.0f, -viewHeight / 2.0f);
-            const Mat4f view = viewMatrix(Vec3f::PosY, Vec3f::PosZ) * translationMatrix(500.0f * Vec3f::PosY);
-            Renderer::ApplyTransformation ortho(context.transformation(), projection, view);
+            {
+                const Mat4f projection = orthoMatrix(0.0f, 1000.0f, -viewWidth / 2.0f, viewHeight / 2.0f, viewWidth / 2.0f, -viewHeight / 2.0f);
+                const Mat4f view = viewMatrix(Vec3f::PosY, Vec3f::PosZ) * translationMatrix(500.0f * Vec3f::PosY);
+                Renderer::ApplyTransformation ortho(context.transformation(), projection, view);
 
-            const Mat4f compassTransformation = translationMatrix(Vec3f(-viewWidth / 2.0f + 50.0f, 0.0f, -viewHeight / 2.0f + 50.0f)) * scalingMatrix(2.0f);
-            Renderer::ApplyModelMatrix applyCompassTranslate(context.transformation(), compassTransformation);
+                const Mat4f compassTransformation = translationMatrix(Vec3f(-viewWidth / 2.0f + 50.0f, 0.0f, -viewHeight / 2.0f + 50.0f)) * scalingMatrix(2.0f);
+                Renderer::ApplyModelMatrix applyCompassTranslate(context.transformation(), compassTransformation);
 
-            m_compass->render(*m_vbo, context);
+                m_compass->render(*m_vbo, context);
+            }
+            
+            if (context.viewOptions().showProfiler())
+                renderProfiler(context, viewWidth, viewHeight);
         }
     }
 }
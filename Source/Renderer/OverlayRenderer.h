@@ -24,16 +24,25 @@
 
 namespace TrenchBroom {
     namespace Renderer {
+        namespace Text {
+            class FontManager;
+            class TexturedFont;
+        }
+        
         class CompassRenderer;
         class RenderContext;
         class Vbo;
         
         class OverlayRenderer {
         private:
+            Text::FontManager& m_fontManager;
             Vbo* m_vbo;
             CompassRenderer* m_compass;
+            Text::TexturedFont* m_font;
+            
+            void renderProfiler(RenderContext& context, const float viewWidth, const float viewHeight);
         public:
-            OverlayRenderer();
+            OverlayRenderer(Text::FontManager& fontManager);
             ~OverlayRenderer();
             
             void render(RenderContext& context, const float viewWidth, const float viewHeight);
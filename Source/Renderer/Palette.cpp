@@ -53,5 +53,15 @@ namespace TrenchBroom {
         Palette::~Palette() {
             delete[] m_data;
         }
+
+        unsigned int Palette::checksum() const {
+            // FNV-1a
+            unsigned int hash = 2166136261u;
+            for (size_t i = 0; i < m_size; i++) {
+                hash ^= static_cast<unsigned int>(m_data[i]);
+                hash *= 16777619u;
+            }
+            return hash;
+        }
     }
 }
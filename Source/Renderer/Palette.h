@@ -37,6 +37,8 @@ namespace TrenchBroom {
             ~Palette();
             
             void operator= (Palette other);
+
+            unsigned int checksum() const;
             
             inline void indexedToRgb(const unsigned char* indexedImage, unsigned char* rgbImage, size_t pixelCount, Color& averageColor) const {
                 double avg[3];
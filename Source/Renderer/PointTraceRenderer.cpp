@@ -43,6 +43,8 @@ namespace TrenchBroom {
 
                 SetVboState mapVbo(vbo, Vbo::VboMapped);
                 m_vertexArray->addAttributes(m_points);
+                // the vertex array keeps the points from now on
+                Vec3f::List().swap(m_points);
             }
             
             ActivateShader shader(context.shaderManager(), Shaders::HandleShader);
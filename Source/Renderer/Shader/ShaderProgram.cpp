@@ -87,6 +87,7 @@ namespace TrenchBroom {
 
             if (m_needsLinking) {
                 m_uniformVariables.clear();
+                m_attributes.clear();
 
                 glLinkProgram(m_programId);
 
@@ -121,6 +122,20 @@ namespace TrenchBroom {
             glUseProgram(0);
         }
 
+        GLint ShaderProgram::attributeLocation(const String& name) {
+            assert(checkActive());
+            AttributeMap::iterator it = m_attributes.find(name);
+            if (it == m_attributes.end()) {
+                GLint index = glGetAttribLocation(m_programId, name.c_str());
+                if (index == -1)
+                    m_console.warn("Location of attribute '%s' could not be found in %s", name.c_str(), m_name.c_str());
+                m_attributes[name] = index;
+                return index;
+            }
+            
+            return it->second;
+        }
+
         bool ShaderProgram::setUniformVariable(const String& name, const bool value) {
             return setUniformVariable(name, static_cast<int>(value));
         }
@@ -43,10 +43,12 @@ namespace TrenchBroom {
         class ShaderProgram {
         private:
             typedef std::map<String, GLint> UniformVariableMap;
+            typedef std::map<String, GLint> AttributeMap;
             
             String m_name;
             GLuint m_programId;
             UniformVariableMap m_uniformVariables;
+            AttributeMap m_attributes;
             bool m_needsLinking;
             Utility::Console& m_console;
             
@@ -67,6 +69,8 @@ namespace TrenchBroom {
             bool activate();
             void deactivate();
             
+            GLint attributeLocation(const String& name);
+            
             bool setUniformVariable(const String& name, bool value);
             bool setUniformVariable(const String& name, int value);
             bool setUniformVariable(const String& name, float value);
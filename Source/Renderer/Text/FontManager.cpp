@@ -37,8 +37,33 @@ namespace TrenchBroom {
                 }
             }
 
+            FT_Face FontManager::face(const String& name) {
+                FaceCache::iterator it = m_faces.lower_bound(name);
+                if (it != m_faces.end() && it->first == name)
+                    return it->second;
+
+                IO::FileManager fileManager;
+                String fontPath = fileManager.resolveFontPath(name);
+
+                FT_Face face;
+                FT_Error error = FT_New_Face(m_library, fontPath.c_str(), 0, &face);
+                if (error != 0) {
+                    m_console.error("Error loading font '%s' (FT error: %i)", name.c_str(), error);
+                    return NULL;
+                }
+
+                m_faces.insert(it, std::pair<String, FT_Face>(name, face));
+                return face;
+            }
+
             FontManager::~FontManager() {
                 Utility::deleteAll(m_cache);
+
+                FaceCache::iterator it, end;
+                for (it = m_faces.begin(), end = m_faces.end(); it != end; ++it)
+                    FT_Done_Face(it->second);
+                m_faces.clear();
+
                 if (m_library != NULL) {
                     FT_Done_FreeType(m_library);
                     m_library = NULL;
@@ -50,36 +75,33 @@ namespace TrenchBroom {
                 if (it != m_cache.end() && it->first.compare(fontDescriptor) == 0)
                     return it->second;
 
-                IO::FileManager fileManager;
-                String fontPath = fileManager.resolveFontPath(fontDescriptor.name());
-
-                FT_Face face;
-                FT_Error error = FT_New_Face(m_library, fontPath.c_str(), 0, &face);
-                if (error != 0) {
-                    m_console.error("Error loading font '%s', size %i (FT error: %i)", fontDescriptor.name().c_str(), fontDescriptor.size(), error);
+                FT_Face fontFace = face(fontDescriptor.name());
+                if (fontFace == NULL)
                     return NULL;
-                }
 
-                FT_Set_Pixel_Sizes(face, 0, fontDescriptor.size());
-                // FT_Set_Char_Size(face, 0, fontDescriptor.size() * 64, 72, 72);
-
-                TexturedFont* font = new TexturedFont(face);
+                TexturedFont* font = new TexturedFont(fontFace, fontDescriptor.size());
                 m_cache.insert(it, std::pair<FontDescriptor, TexturedFont*>(fontDescriptor, font));
-                FT_Done_Face(face);
 
                 return font;
             }
 
             FontDescriptor FontManager::selectFontSize(const FontDescriptor& fontDescriptor, const String& string, const float maxWidth, unsigned int minFontSize) {
-                FontDescriptor actualDescriptor = fontDescriptor;
-                TexturedFont* actualFont = font(actualDescriptor);
-                Vec2f actualBounds = actualFont->measure(string);
-                while (actualBounds.x() > maxWidth && actualDescriptor.size() > minFontSize) {
-                    actualDescriptor = FontDescriptor(actualDescriptor.name(), actualDescriptor.size() - 1);
-                    actualFont = font(actualDescriptor);
-                    actualBounds = actualFont->measure(string);
+                TexturedFont* actualFont = font(fontDescriptor);
+                if (actualFont == NULL || fontDescriptor.size() <= minFontSize || actualFont->measure(string).x() <= maxWidth)
+                    return fontDescriptor;
+
+                // the width grows with the font size, and measuring a size does not rasterize its glyphs
+                unsigned int minSize = minFontSize;
+                unsigned int maxSize = fontDescriptor.size() - 1;
+                while (minSize < maxSize) {
+                    const unsigned int size = minSize + (maxSize - minSize + 1) / 2;
+                    actualFont = font(FontDescriptor(fontDescriptor.name(), size));
+                    if (actualFont->measure(string).x() <= maxWidth)
+                        minSize = size;
+                    else
+                        maxSize = size - 1;
                 }
-                return actualDescriptor;
+                return FontDescriptor(fontDescriptor.name(), minSize);
             }
         }
     }
@@ -40,16 +40,21 @@ namespace TrenchBroom {
             class FontManager {
             private:
                 typedef std::map<FontDescriptor, TexturedFont*> FontCache;
+                typedef std::map<String, FT_Face> FaceCache;
 
                 Utility::Console& m_console;
                 FT_Library m_library;
                 FontCache m_cache;
+                FaceCache m_faces;
+
+                FT_Face face(const String& name);
             public:
                 FontManager(Utility::Console& console);
                 ~FontManager();
 
                 TexturedFont* font(const FontDescriptor& fontDescriptor);
 
+                // returns the largest size that fits the string into the given width, but no smaller than the given minimum
                 FontDescriptor selectFontSize(const FontDescriptor& fontDescriptor, const String& string, const float maxWidth, unsigned int minFontSize);
             };
         }
@@ -27,28 +27,22 @@
 namespace TrenchBroom {
     namespace Renderer {
         namespace Text {
-            TexturedFont::TexturedFont(FT_Face face, const unsigned char minChar, const unsigned char maxChar) :
-            m_minChar(minChar),
-            m_maxChar(maxChar),
-            m_lineHeight(0),
-            m_textureId(0),
-            m_textureLength(0),
-            m_bitmap(NULL) {
-                FT_GlyphSlot glyph = face->glyph;
+            void TexturedFont::rasterize() {
+                FT_Set_Pixel_Sizes(m_face, 0, m_size);
+                FT_GlyphSlot glyph = m_face->glyph;
 
                 int maxWidth = 0;
                 int maxAscend = 0;
                 int maxDescend = 0;
 
                 for (unsigned char c = m_minChar; c <= m_maxChar; c++) {
-                    FT_Error error = FT_Load_Char(face, static_cast<FT_ULong>(c), FT_LOAD_RENDER);
+                    FT_Error error = FT_Load_Char(m_face, static_cast<FT_ULong>(c), FT_LOAD_RENDER);
                     if (error != 0)
                         continue;
 
                     maxWidth = std::max(maxWidth, glyph->bitmap_left + glyph->bitmap.width);
                     maxAscend = std::max(maxAscend, glyph->bitmap_top);
                     maxDescend = std::max(maxDescend, glyph->bitmap.rows - glyph->bitmap_top);
-                    m_lineHeight = std::max(m_lineHeight, static_cast<int>(glyph->metrics.height >> 6));
                 }
 
                 const int cellSize = std::max(maxWidth, maxAscend + maxDescend);
@@ -63,11 +57,9 @@ namespace TrenchBroom {
                 int x = Border;
                 int y = Border;
                 for (unsigned char c = m_minChar; c <= m_maxChar; c++) {
-                    FT_Error error = FT_Load_Char(face, static_cast<FT_ULong>(c), FT_LOAD_RENDER);
-                    if (error != 0) {
-                        m_chars.push_back(Char(0, 0, 0, 0, 0));
+                    FT_Error error = FT_Load_Char(m_face, static_cast<FT_ULong>(c), FT_LOAD_RENDER);
+                    if (error != 0)
                         continue;
-                    }
 
                     if (x + cellSize + Border > m_textureLength) {
                         x = Border;
@@ -76,17 +68,39 @@ namespace TrenchBroom {
 
                     m_bitmap->drawGlyph(x, y, maxAscend, glyph);
 
-                    const int cx = x;
-                    const int cy = y;
-                    const int cw = cellSize;
-                    const int ch = cellSize;
-                    const int ca = static_cast<int>(glyph->advance.x >> 6);
-
-                    m_chars.push_back(Char(cx, cy, cw, ch, ca));
+                    Char& ch = m_chars[static_cast<size_t>(c - m_minChar)];
+                    ch.x = x;
+                    ch.y = y;
+                    ch.w = cellSize;
+                    ch.h = cellSize;
                     x += cellSize + Border;
                 }
             }
 
+            TexturedFont::TexturedFont(FT_Face face, const unsigned int size, const unsigned char minChar, const unsigned char maxChar) :
+            m_face(face),
+            m_size(size),
+            m_minChar(minChar),
+            m_maxChar(maxChar),
+            m_lineHeight(0),
+            m_textureId(0),
+            m_textureLength(0),
+            m_bitmap(NULL) {
+                FT_Set_Pixel_Sizes(m_face, 0, m_size);
+                FT_GlyphSlot glyph = m_face->glyph;
+
+                for (unsigned char c = m_minChar; c <= m_maxChar; c++) {
+                    FT_Error error = FT_Load_Char(m_face, static_cast<FT_ULong>(c), FT_LOAD_DEFAULT);
+                    if (error != 0) {
+                        m_chars.push_back(Char(0, 0, 0, 0, 0));
+                        continue;
+                    }
+
+                    m_lineHeight = std::max(m_lineHeight, static_cast<int>(glyph->metrics.height >> 6));
+                    m_chars.push_back(Char(0, 0, 0, 0, static_cast<int>(glyph->advance.x >> 6)));
+                }
+            }
+
             TexturedFont::~TexturedFont() {
                 if (m_textureId > 0) {
                     glDeleteTextures(1, &m_textureId);
@@ -98,6 +112,9 @@ namespace TrenchBroom {
             }
 
             Vec2f::List TexturedFont::quads(const String& string, bool clockwise, const Vec2f& offset) {
+                if (m_textureLength == 0)
+                    rasterize();
+
                 Vec2f::List result;
 
                 int x = static_cast<int>(Math<float>::round(offset.x()));
@@ -151,6 +168,8 @@ namespace TrenchBroom {
 
             void TexturedFont::activate() {
                 if (m_textureId == 0) {
+                    if (m_textureLength == 0)
+                        rasterize();
                     assert(m_bitmap != NULL);
                     glGenTextures(1, &m_textureId);
                     glBindTexture(GL_TEXTURE_2D, m_textureId);
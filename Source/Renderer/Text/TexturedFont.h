@@ -90,6 +90,8 @@ namespace TrenchBroom {
                 typedef std::vector<Char> CharList;
                 CharList m_chars;
 
+                FT_Face m_face;
+                unsigned int m_size;
                 unsigned char m_minChar;
                 unsigned char m_maxChar;
                 int m_lineHeight;
@@ -97,8 +99,12 @@ namespace TrenchBroom {
                 GLuint m_textureId;
                 int m_textureLength;
                 TextureBitmap* m_bitmap;
+
+                void rasterize();
             public:
-                TexturedFont(FT_Face face, const unsigned char minChar = ' ', const unsigned char maxChar = '~');
+                // Only loads the glyph metrics, which is all that measuring needs. The glyphs are rasterized when the
+                // font is first rendered. The face is owned by the caller and may be shared between font sizes.
+                TexturedFont(FT_Face face, const unsigned int size, const unsigned char minChar = ' ', const unsigned char maxChar = '~');
                 ~TexturedFont();
 
                 Vec2f::List quads(const String& string, bool clockwise, const Vec2f& offset = Vec2f());
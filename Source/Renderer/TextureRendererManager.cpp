@@ -29,29 +29,24 @@
 
 namespace TrenchBroom {
     namespace Renderer {
-        TextureRendererCollection::TextureRendererCollection(Model::TextureCollection& textureCollection, const Palette& palette) {
-            typedef std::pair<TextureRendererMap::iterator, bool> InsertResult;
+        TextureRendererCollection::TextureRendererCollection(Model::TextureCollection& textureCollection, const Palette& palette) :
+        m_loader(textureCollection.loader()),
+        m_palette(palette) {}
+        
+        TextureRenderer* TextureRendererCollection::renderer(Model::Texture& texture) {
+            TextureRendererMap::iterator it = m_textures.lower_bound(&texture);
+            if (it != m_textures.end() && it->first == &texture)
+                return it->second;
 
+            TextureRenderer* textureRenderer = NULL;
             Color averageColor;
-            Model::TextureCollection::LoaderPtr loader = textureCollection.loader();
+            unsigned char* textureImage = m_loader->load(texture, m_palette, averageColor);
+            if (textureImage != NULL)
+                textureRenderer = new TextureRenderer(textureImage, averageColor, texture.width(), texture.height());
 
-            const Model::TextureList& textures = textureCollection.textures();
-            for (unsigned int i = 0; i < textures.size(); i++) {
-                Model::Texture& texture = *textures[i];
-                unsigned char* textureImage = loader->load(texture, palette, averageColor);
-                if (textureImage != NULL) {
-                    TextureRenderer* textureRenderer = new TextureRenderer(textureImage, averageColor, texture.width(), texture.height());
-                    InsertResult result = m_textures.insert(TextureRendererEntry(&texture, textureRenderer));
-                    assert(result.second);
-                }
-            }
-        }
-        
-        TextureRenderer* TextureRendererCollection::renderer(Model::Texture& texture) const {
-            TextureRendererMap::const_iterator it = m_textures.find(&texture);
-            if (it == m_textures.end())
-                return NULL;
-            return it->second;
+            // textures that cannot be loaded are remembered, too
+            m_textures.insert(it, TextureRendererEntry(&texture, textureRenderer));
+            return textureRenderer;
         }
 
         TextureRendererCollection::~TextureRendererCollection() {
@@ -21,6 +21,7 @@
 #define __TrenchBroom__TextureRendererManager__
 
 #include "Model/Texture.h"
+#include "Model/TextureManager.h"
 
 #include <map>
 
@@ -40,12 +41,15 @@ namespace TrenchBroom {
             typedef std::map<Model::Texture*, TextureRenderer*> TextureRendererMap;
             typedef std::pair<Model::Texture*, TextureRenderer*> TextureRendererEntry;
             
+            Model::TextureCollection::LoaderPtr m_loader;
+            const Palette& m_palette;
             TextureRendererMap m_textures;
         public:
             TextureRendererCollection(Model::TextureCollection& textureCollection, const Palette& palette);
             ~TextureRendererCollection();
             
-            TextureRenderer* renderer(Model::Texture& texture) const;
+            // decodes the texture on first use
+            TextureRenderer* renderer(Model::Texture& texture);
         };
         
         class TextureRendererManager {
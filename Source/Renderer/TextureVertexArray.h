@@ -20,36 +20,41 @@
 #ifndef TrenchBroom_TextureVertexArray_h
 #define TrenchBroom_TextureVertexArray_h
 
+#include "Renderer/IndexedVertexArray.h"
 #include "Renderer/VertexArray.h"
 
 namespace TrenchBroom {
     namespace Renderer {
         class TextureRenderer;
         
-        class TextureVertexArray {
+        template <class ArrayType>
+        class TextureArray {
         public:
             TextureRenderer* texture;
-            mutable VertexArray* vertexArray;
+            mutable ArrayType* vertexArray;
             
-            TextureVertexArray(TextureRenderer* i_texture, VertexArray* i_vertexArray) :
+            TextureArray(TextureRenderer* i_texture, ArrayType* i_vertexArray) :
             texture(i_texture),
             vertexArray(i_vertexArray) {}
             
-            TextureVertexArray(const TextureVertexArray& other) :
+            TextureArray(const TextureArray& other) :
             texture(other.texture),
             vertexArray(other.vertexArray) {
                 other.vertexArray = NULL;
             }
             
-            TextureVertexArray() : texture(NULL) {}
+            TextureArray() : texture(NULL), vertexArray(NULL) {}
             
-            ~TextureVertexArray() {
+            ~TextureArray() {
                 delete vertexArray;
                 vertexArray = NULL;
             }
         };
         
+        typedef TextureArray<VertexArray> TextureVertexArray;
         typedef std::vector<TextureVertexArray> TextureVertexArrayList;
+        typedef TextureArray<IndexedVertexArray> TextureIndexedVertexArray;
+        typedef std::vector<TextureIndexedVertexArray> TextureIndexedVertexArrayList;
     }
 }
 
@@ -0,0 +1,142 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ThumbnailAtlas.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace TrenchBroom {
+    namespace Renderer {
+        void ThumbnailAtlas::addPage() {
+            const std::vector<unsigned char> empty(m_pageSize * m_pageSize * 4, 0);
+
+            Page page;
+            page.rowX = page.rowY = page.rowHeight = 0;
+            glGenTextures(1, &page.textureId);
+            glBindTexture(GL_TEXTURE_2D, page.textureId);
+            glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, static_cast<GLsizei>(m_pageSize), static_cast<GLsizei>(m_pageSize), 0, GL_RGBA, GL_UNSIGNED_BYTE, &empty[0]);
+            glBindTexture(GL_TEXTURE_2D, 0);
+
+            m_pages.push_back(page);
+        }
+
+        bool ThumbnailAtlas::allocate(const unsigned int width, const unsigned int height, size_t& page, unsigned int& x, unsigned int& y) {
+            const unsigned int paddedWidth = width + 2 * Padding;
+            const unsigned int paddedHeight = height + 2 * Padding;
+            if (paddedWidth > m_pageSize || paddedHeight > m_pageSize)
+                return false;
+
+            if (m_pages.empty())
+                addPage();
+
+            Page* current = &m_pages.back();
+            if (current->rowX + paddedWidth > m_pageSize) {
+                current->rowX = 0;
+                current->rowY += current->rowHeight;
+                current->rowHeight = 0;
+            }
+            if (current->rowY + paddedHeight > m_pageSize) {
+                addPage();
+                current = &m_pages.back();
+            }
+
+            page = m_pages.size() - 1;
+            x = current->rowX + Padding;
+            y = current->rowY + Padding;
+
+            current->rowX += paddedWidth;
+            current->rowHeight = std::max(current->rowHeight, paddedHeight);
+            return true;
+        }
+
+        ThumbnailAtlas::ThumbnailAtlas(const unsigned int pageSize) :
+        m_pageSize(pageSize) {}
+
+        ThumbnailAtlas::~ThumbnailAtlas() {
+            clear();
+        }
+
+        const ThumbnailAtlas::Slot* ThumbnailAtlas::slot(const String& key) const {
+            SlotMap::const_iterator it = m_slots.find(key);
+            if (it == m_slots.end())
+                return NULL;
+            return &it->second;
+        }
+
+        const ThumbnailAtlas::Slot* ThumbnailAtlas::insert(const String& key, const unsigned int width, const unsigned int height, const unsigned char* rgbaImage) {
+            assert(width > 0 && height > 0);
+
+            size_t page;
+            unsigned int x, y;
+            SlotMap::iterator it = m_slots.find(key);
+            if (it != m_slots.end() && it->second.width == width && it->second.height == height) {
+                // overwrite the image in place
+                page = it->second.page;
+                x = it->second.x;
+                y = it->second.y;
+            } else if (!allocate(width, height, page, x, y)) {
+                return NULL;
+            }
+
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+            glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+            glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
+            glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
+
+            glBindTexture(GL_TEXTURE_2D, m_pages[page].textureId);
+            glTexSubImage2D(GL_TEXTURE_2D, 0, static_cast<GLint>(x), static_cast<GLint>(y), static_cast<GLsizei>(width), static_cast<GLsizei>(height), GL_RGBA, GL_UNSIGNED_BYTE, rgbaImage);
+            glBindTexture(GL_TEXTURE_2D, 0);
+
+            const float pageSize = static_cast<float>(m_pageSize);
+            Slot& slot = m_slots[key];
+            slot.page = page;
+            slot.x = x;
+            slot.y = y;
+            slot.width = width;
+            slot.height = height;
+            slot.s0 = x / pageSize;
+            slot.t0 = y / pageSize;
+            slot.s1 = (x + width) / pageSize;
+            slot.t1 = (y + height) / pageSize;
+            return &slot;
+        }
+
+        void ThumbnailAtlas::activate(const size_t page) {
+            assert(page < m_pages.size());
+            glBindTexture(GL_TEXTURE_2D, m_pages[page].textureId);
+        }
+
+        void ThumbnailAtlas::deactivate() {
+            glBindTexture(GL_TEXTURE_2D, 0);
+        }
+
+        void ThumbnailAtlas::clear() {
+            PageList::iterator it, end;
+            for (it = m_pages.begin(), end = m_pages.end(); it != end; ++it)
+                glDeleteTextures(1, &it->textureId);
+            m_pages.clear();
+            m_slots.clear();
+        }
+    }
+}
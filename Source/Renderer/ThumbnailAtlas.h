@@ -0,0 +1,82 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __TrenchBroom__ThumbnailAtlas__
+#define __TrenchBroom__ThumbnailAtlas__
+
+#include "GL/glew.h"
+#include "Utility/String.h"
+
+#include <map>
+#include <vector>
+
+namespace TrenchBroom {
+    namespace Renderer {
+        // Packs small RGBA images into the rows of a few large textures so that many of them can be drawn with
+        // one texture binding. Slots are only freed when the atlas is cleared.
+        class ThumbnailAtlas {
+        public:
+            struct Slot {
+                size_t page;
+                unsigned int x;
+                unsigned int y;
+                unsigned int width;
+                unsigned int height;
+                float s0, t0, s1, t1;
+            };
+        private:
+            struct Page {
+                GLuint textureId;
+                unsigned int rowX;
+                unsigned int rowY;
+                unsigned int rowHeight;
+            };
+
+            typedef std::vector<Page> PageList;
+            typedef std::map<String, Slot> SlotMap;
+
+            // leaves a transparent border around each slot so that linear filtering does not pick up its neighbours
+            static const unsigned int Padding = 1;
+
+            unsigned int m_pageSize;
+            PageList m_pages;
+            SlotMap m_slots;
+
+            void addPage();
+            bool allocate(unsigned int width, unsigned int height, size_t& page, unsigned int& x, unsigned int& y);
+        public:
+            ThumbnailAtlas(unsigned int pageSize = 1024);
+            ~ThumbnailAtlas();
+
+            const Slot* slot(const String& key) const;
+            // returns NULL if the image is larger than a page
+            const Slot* insert(const String& key, unsigned int width, unsigned int height, const unsigned char* rgbaImage);
+
+            inline size_t pageCount() const {
+                return m_pages.size();
+            }
+
+            void activate(size_t page);
+            void deactivate();
+            void clear();
+        };
+    }
+}
+
+#endif /* defined(__TrenchBroom__ThumbnailAtlas__) */
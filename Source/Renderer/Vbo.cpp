@@ -18,6 +18,9 @@
  */
 
 #include "Vbo.h"
+
+#include "Utility/Profiler.h"
+
 #include <algorithm>
 
 namespace TrenchBroom {
@@ -91,14 +94,69 @@ namespace TrenchBroom {
 #endif
         }
         
+        size_t Vbo::grownCapacity(size_t capacity) const {
+            const size_t usedCapacity = m_totalCapacity - m_freeCapacity;
+            size_t newCapacity = std::max(m_totalCapacity, static_cast<size_t>(1));
+            while (capacity > newCapacity - usedCapacity)
+                newCapacity *= 2;
+            return newCapacity;
+        }
+        
+        void Vbo::copyBlocks(GLuint sourceVboId, const MemBlock::List& memBlocks) {
+            assert(m_state == VboActive);
+            
+            MemBlock::List::const_iterator it, end;
+            if (GLEW_VERSION_3_1 || GLEW_ARB_copy_buffer) {
+                glBindBuffer(GL_COPY_READ_BUFFER, sourceVboId);
+                glBindBuffer(GL_COPY_WRITE_BUFFER, m_vboId);
+                for (it = memBlocks.begin(), end = memBlocks.end(); it != end; ++it) {
+                    const MemBlock& memBlock = *it;
+                    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+                                        static_cast<GLintptr>(memBlock.start), static_cast<GLintptr>(memBlock.start),
+                                        static_cast<GLsizeiptr>(memBlock.length));
+                    PROFILE_COUNT("Vbo bytes copied", memBlock.length);
+                }
+                glBindBuffer(GL_COPY_READ_BUFFER, 0);
+                glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+            } else {
+                // the buffer is mapped write only, so the old contents must be read back explicitly
+                size_t totalLength = 0;
+                for (it = memBlocks.begin(), end = memBlocks.end(); it != end; ++it)
+                    totalLength += it->length;
+                
+                std::vector<unsigned char> temp(totalLength);
+                size_t offset = 0;
+                glBindBuffer(m_type, sourceVboId);
+                for (it = memBlocks.begin(), end = memBlocks.end(); it != end; ++it) {
+                    const MemBlock& memBlock = *it;
+                    glGetBufferSubData(m_type, static_cast<GLintptr>(memBlock.start), static_cast<GLsizeiptr>(memBlock.length), &temp[offset]);
+                    offset += memBlock.length;
+                }
+                
+                offset = 0;
+                glBindBuffer(m_type, m_vboId);
+                for (it = memBlocks.begin(), end = memBlocks.end(); it != end; ++it) {
+                    const MemBlock& memBlock = *it;
+                    glBufferSubData(m_type, static_cast<GLintptr>(memBlock.start), static_cast<GLsizeiptr>(memBlock.length), &temp[offset]);
+                    offset += memBlock.length;
+                }
+                PROFILE_COUNT("Vbo bytes copied", 2 * totalLength);
+            }
+            
+            GLenum error = glGetError();
+            if (error != GL_NO_ERROR)
+                throw VboException(*this, "Vbo contents could not be copied", error);
+        }
+        
         void Vbo::resizeVbo(size_t newCapacity) {
+            PROFILE_COUNT("Vbo resizes", 1);
+            assert(newCapacity > m_totalCapacity);
             VboState oldState = m_state;
             
-            unsigned char* temp = NULL;
+            // the used blocks keep their addresses, so only the runs of used blocks need to be copied
             MemBlock::List memBlocks;
             if (m_vboId != 0 && m_freeCapacity < m_totalCapacity) {
                 VboBlock* currentBlock = m_first;
-                size_t totalLength = 0;
                 
                 while (currentBlock != NULL) {
                     while (currentBlock != NULL && currentBlock->free())
@@ -111,23 +169,8 @@ namespace TrenchBroom {
                             currentBlock = currentBlock->m_next;
                         }
                         memBlocks.push_back(MemBlock(start, length));
-                        totalLength += length;
                     }
                 }
-                
-                if (m_state < VboActive)
-                    activate();
-                if (m_state < VboMapped)
-                    map();
-
-                temp = new unsigned char[totalLength];
-                size_t offset = 0;
-                MemBlock::List::const_iterator it, end;
-                for (it = memBlocks.begin(), end = memBlocks.end(); it != end; ++it) {
-                    const MemBlock& memBlock = *it;
-                    memcpy(temp + offset, m_buffer + memBlock.start, memBlock.length);
-                    offset += memBlock.length;
-                }
             }
             
             size_t addedCapacity = newCapacity - m_totalCapacity;
@@ -148,32 +191,19 @@ namespace TrenchBroom {
                     unmap();
                 if (m_state == VboActive)
                     deactivate();
-                glDeleteBuffers(1, &m_vboId);
+                
+                // activating creates a new buffer with the new capacity
+                GLuint oldVboId = m_vboId;
                 m_vboId = 0;
-            }
-            
-            if (temp != NULL) {
-                assert(!memBlocks.empty());
+                activate();
+                if (!memBlocks.empty())
+                    copyBlocks(oldVboId, memBlocks);
+                glBindBuffer(m_type, m_vboId);
+                glDeleteBuffers(1, &oldVboId);
                 
-                if (m_state < VboActive)
-                    activate();
-                if (m_state < VboMapped)
+                if (oldState == VboMapped)
                     map();
-                
-                size_t offset = 0;
-                MemBlock::List::const_iterator it, end;
-                for (it = memBlocks.begin(), end = memBlocks.end(); it != end; ++it) {
-                    const MemBlock& memBlock = *it;
-                    memcpy(m_buffer + memBlock.start, temp + offset, memBlock.length);
-                }
-                
-                delete [] temp;
-                temp = NULL;
-                memBlocks.clear();
-                
-                if (oldState < VboMapped)
-                    unmap();
-                if (oldState < VboActive)
+                else if (oldState == VboInactive)
                     deactivate();
             } else {
                 if (oldState > VboInactive && m_state < VboActive)
@@ -318,11 +348,12 @@ namespace TrenchBroom {
         void Vbo::ensureFreeCapacity(size_t capacity) {
             pack();
             if (m_freeCapacity < capacity)
-                resizeVbo(m_totalCapacity + (capacity - m_freeCapacity));
+                resizeVbo(grownCapacity(capacity));
         }
 
         VboBlock* Vbo::allocBlock(size_t capacity) {
             assert(capacity > 0);
+            PROFILE_COUNT("Vbo allocations", 1);
             
 #ifdef _DEBUG_VBO
             checkBlockChain();
@@ -334,16 +365,8 @@ namespace TrenchBroom {
                 SetVboState mapVbo(*this, VboMapped);
                 pack();
 
-                if (capacity > m_freeCapacity) {
-                    const size_t usedCapacity = m_totalCapacity - m_freeCapacity;
-                    size_t newCapacity = m_totalCapacity;
-                    size_t newFreeCapacity = m_freeCapacity;
-                    while (capacity > newFreeCapacity) {
-                        newCapacity *= 2;
-                        newFreeCapacity = newCapacity - usedCapacity;
-                    }
-                    resizeVbo(newCapacity);
-                }
+                if (capacity > m_freeCapacity)
+                    resizeVbo(grownCapacity(capacity));
                 
                 index = findFreeBlock(0, capacity);
                 assert(index < m_freeBlocks.size());
@@ -387,6 +410,7 @@ namespace TrenchBroom {
             block.m_free = true;
             
             if (previous != NULL && previous->free() && next != NULL && next->free()) {
+                PROFILE_COUNT("Vbo coalesced blocks", 2);
                 resizeBlock(*previous, previous->capacity() + block.capacity() + next->capacity());
                 if (m_last == next) m_last = previous;
                 removeFreeBlock(*next);
@@ -397,6 +421,7 @@ namespace TrenchBroom {
             }
             
             if (previous != NULL && previous->free()) {
+                PROFILE_COUNT("Vbo coalesced blocks", 1);
                 resizeBlock(*previous, previous->capacity() + block.capacity());
                 if (m_last == &block) m_last = previous;
                 previous->insertBetween(previous->m_previous, next);
@@ -405,6 +430,7 @@ namespace TrenchBroom {
             }
             
             if (next != NULL && next->free()) {
+                PROFILE_COUNT("Vbo coalesced blocks", 1);
                 if (m_last == next) m_last = &block;
                 removeFreeBlock(*next);
                 block.m_capacity += next->capacity();
@@ -488,6 +514,12 @@ namespace TrenchBroom {
         }
 #endif
         
+        size_t Vbo::largestFreeBlockCapacity() const {
+            if (m_freeBlocks.empty())
+                return 0;
+            return m_freeBlocks.back()->capacity();
+        }
+        
         bool Vbo::ownsBlock(VboBlock& block) {
             return &block.m_vbo == this;
         }
@@ -74,6 +74,8 @@ namespace TrenchBroom {
             size_t findFreeBlock(size_t address, size_t capacity);
             void insertFreeBlock(VboBlock& block);
             void removeFreeBlock(VboBlock& block);
+            size_t grownCapacity(size_t capacity) const;
+            void copyBlocks(GLuint sourceVboId, const MemBlock::List& memBlocks);
             void resizeVbo(size_t newCapacity);
             void resizeBlock(VboBlock& block, size_t newCapacity);
             VboBlock* packBlock(VboBlock& block);
@@ -98,6 +100,21 @@ namespace TrenchBroom {
                 return m_state;
             }
             
+            inline size_t totalCapacity() const {
+                return m_totalCapacity;
+            }
+            
+            inline size_t freeCapacity() const {
+                return m_freeCapacity;
+            }
+            
+            // adjacent free blocks are always coalesced, so this is a measure of fragmentation
+            inline size_t freeBlockCount() const {
+                return m_freeBlocks.size();
+            }
+            
+            size_t largestFreeBlockCapacity() const;
+            
             void ensureFreeCapacity(size_t capacity);
             VboBlock* allocBlock(size_t capacity);
             VboBlock* freeBlock(VboBlock& block);
@@ -225,6 +242,17 @@ namespace TrenchBroom {
                 return offset + 4;
             }
 
+            // Unlike the write functions, this also works if the VBO is only active and not mapped.
+            inline size_t uploadBuffer(const unsigned char* buffer, size_t offset, size_t length) {
+                assert(offset + length <= m_capacity);
+                assert(m_vbo.m_state > Vbo::VboInactive);
+                if (m_vbo.m_state == Vbo::VboMapped)
+                    memcpy(m_vbo.m_buffer + m_address + offset, buffer, length);
+                else
+                    glBufferSubData(m_vbo.m_type, static_cast<GLintptr>(m_address + offset), static_cast<GLsizeiptr>(length), buffer);
+                return offset + length;
+            }
+
             template<class T>
             inline size_t writeVec(const T& vec, size_t offset) {
                 assert(offset + sizeof(T) <= m_capacity);
@@ -62,6 +62,13 @@ namespace TrenchBroom {
                 glDrawArrays(m_primType, 0, static_cast<GLsizei>(m_vertexCount));
                 cleanup();
             }
+
+            // the element array buffer holding the indices must be bound
+            inline void renderElements(size_t firstIndex, size_t indexCount) {
+                setup();
+                glDrawElements(m_primType, static_cast<GLsizei>(indexCount), GL_UNSIGNED_INT, reinterpret_cast<GLvoid*>(firstIndex * sizeof(GLuint)));
+                cleanup();
+            }
         };
     }
 }
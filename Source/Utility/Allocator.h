@@ -31,9 +31,28 @@
 
 namespace TrenchBroom {
     namespace Utility {
-        template <class T, size_t PoolSize = 64, size_t BlocksPerChunk = 256>
+        // The pools are shared by all threads and are not locked unless the pooled type provides a lock policy with
+        // static lock and unlock functions.
+        class NoAllocatorLock {
+        public:
+            static inline void lock() {}
+            static inline void unlock() {}
+        };
+
+        template <class T, size_t PoolSize = 64, size_t BlocksPerChunk = 256, class Lock = NoAllocatorLock>
         class Allocator {
         private:
+            class ScopedLock {
+            public:
+                ScopedLock() {
+                    Lock::lock();
+                }
+
+                ~ScopedLock() {
+                    Lock::unlock();
+                }
+            };
+
             class Chunk {
             private:
                 unsigned char m_firstFreeBlock;
@@ -117,6 +136,7 @@ namespace TrenchBroom {
 #ifdef _ENABLE_ALLOCATOR
             inline void* operator new(size_t size) {
                 assert(size == sizeof(T));
+                ScopedLock lock;
 
                 if (!pool().empty()) {
                     T* t = pool().top();
@@ -148,6 +168,7 @@ namespace TrenchBroom {
             }
 
             inline void operator delete(void* block) {
+                ScopedLock lock;
                 T* t = reinterpret_cast<T*>(block);
 
                 size_t poolSize = PoolSize;
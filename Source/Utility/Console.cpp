@@ -26,65 +26,287 @@
 #endif
 
 #include <cstdarg>
-#include <fstream>
+#include <wx/app.h>
 #include <wx/datetime.h>
 #include <wx/wx.h>
 
 namespace TrenchBroom {
     namespace Utility {
-        void Console::logToDebug(const LogMessage& message) {
-            // wxLogDebug(message.string().c_str());
+        void Console::LogFileWriter::write(const LogMessageList& messages) {
+#if defined __APPLE__
+            LogMessageList::const_iterator it, end;
+            for (it = messages.begin(), end = messages.end(); it != end; ++it)
+                NSLogWrapper(it->string());
+#else
+            if (!m_stream.is_open())
+                return;
+            
+            const unsigned long processId = wxGetProcessId();
+            LogMessageList::const_iterator it, end;
+            for (it = messages.begin(), end = messages.end(); it != end; ++it)
+                m_stream << processId << " " << it->time().FormatISOCombined(' ') << ": " << it->string() << '\n';
+            m_stream.flush();
+#endif
         }
-
-        void Console::logToConsole(const LogMessage& message) {
-            long start = m_textCtrl->GetLastPosition();
-            m_textCtrl->AppendText(message.string());
-            m_textCtrl->AppendText("\n");
-            long end = m_textCtrl->GetLastPosition();
-            switch (message.level()) {
-                case LLDebug:
-                    m_textCtrl->SetStyle(start, end, wxTextAttr(*wxLIGHT_GREY, *wxBLACK)); // SetDefaultStyle doesn't work on OS X / Cocoa
-                    break;
-                case LLInfo:
-                    m_textCtrl->SetStyle(start, end, wxTextAttr(*wxWHITE, *wxBLACK)); // SetDefaultStyle doesn't work on OS X / Cocoa
-                    break;
-                case LLWarn:
-                    m_textCtrl->SetStyle(start, end, wxTextAttr(*wxYELLOW, *wxBLACK)); // SetDefaultStyle doesn't work on OS X / Cocoa
-                    break;
-                case LLError:
-                    m_textCtrl->SetStyle(start, end, wxTextAttr(*wxRED, *wxBLACK)); // SetDefaultStyle doesn't work on OS X / Cocoa
-                    break;
+        
+        void Console::LogFileWriter::flush() {
+            LogMessageList messages;
+            {
+                wxMutexLocker lock(m_mutex);
+                messages.swap(m_queue);
             }
+            if (!messages.empty())
+                write(messages);
         }
-
-        void Console::logToFile(const LogMessage& message) {
-#if defined __APPLE__
-            NSLogWrapper(message.string());
-#else
+        
+        wxThread::ExitCode Console::LogFileWriter::Entry() {
+            while (true) {
+                LogMessageList messages;
+                bool stopping = false;
+                bool summaryDue = false;
+                {
+                    wxMutexLocker lock(m_mutex);
+                    while (m_queue.empty() && !m_stopping && !summaryDue) {
+                        if (!m_summaryPending)
+                            m_condition.Wait();
+                        else if (m_condition.WaitTimeout(SummaryDelay) == wxCOND_TIMEOUT)
+                            summaryDue = true;
+                    }
+                    messages.swap(m_queue);
+                    stopping = m_stopping;
+                    if (summaryDue)
+                        m_summaryPending = false;
+                }
+                
+                if (!messages.empty())
+                    write(messages);
+                
+                if (stopping) {
+                    // the summaries are written before the last messages are drained
+                    m_console.writeSummaries();
+                    flush();
+                    return (wxThread::ExitCode)0;
+                }
+                
+                // the console appends the summaries to the queue, which wakes this thread up again
+                if (summaryDue)
+                    m_console.writeSummaries();
+            }
+        }
+        
+        Console::LogFileWriter::LogFileWriter(Console& console) :
+        wxThread(wxTHREAD_JOINABLE),
+        m_console(console),
+        m_condition(m_mutex),
+        m_summaryPending(false),
+        m_stopping(false),
+        m_running(false) {
+#if !defined __APPLE__
             IO::FileManager fileManager;
             const String logDirectory = fileManager.logDirectory();
-            if (logDirectory.empty())
-                return;
-            if (!fileManager.exists(logDirectory))
-                fileManager.makeDirectory(logDirectory);
-            const String logFilePath = fileManager.appendPath(logDirectory, "TrenchBroom.log");
-            std::fstream logStream(logFilePath.c_str(), std::ios::out | std::ios::app);
-            if (logStream.is_open()) {
-                wxDateTime now = wxDateTime::Now();
-                logStream << wxGetProcessId() << " " << now.FormatISOCombined(' ') << ": " << message.string() << std::endl;
+            if (!logDirectory.empty()) {
+                if (!fileManager.exists(logDirectory))
+                    fileManager.makeDirectory(logDirectory);
+                const String logFilePath = fileManager.appendPath(logDirectory, "TrenchBroom.log");
+                m_stream.open(logFilePath.c_str(), std::ios::out | std::ios::app);
             }
 #endif
+            m_running = Create() == wxTHREAD_NO_ERROR && Run() == wxTHREAD_NO_ERROR;
         }
-
-        void Console::setTextCtrl(wxTextCtrl* textCtrl) {
-            m_textCtrl = textCtrl;
-            if (m_textCtrl != NULL) {
-                for (unsigned int i = 0; i < m_buffer.size(); i++) {
-                    const LogMessage& message = m_buffer[i];
-                    logToConsole(message);
+        
+        Console::LogFileWriter::~LogFileWriter() {
+            stop();
+        }
+        
+        void Console::LogFileWriter::append(const LogMessage& message) {
+            if (!m_running) {
+                write(LogMessageList(1, message));
+                return;
+            }
+            
+            wxMutexLocker lock(m_mutex);
+            m_queue.push_back(message);
+            m_condition.Signal();
+        }
+        
+        void Console::LogFileWriter::scheduleSummary() {
+            if (!m_running)
+                return;
+            
+            wxMutexLocker lock(m_mutex);
+            if (!m_summaryPending) {
+                m_summaryPending = true;
+                m_condition.Signal();
+            }
+        }
+        
+        void Console::LogFileWriter::stop() {
+            if (m_running) {
+                {
+                    wxMutexLocker lock(m_mutex);
+                    m_stopping = true;
+                    m_condition.Signal();
                 }
-                m_buffer.clear();
+                Wait();
+                m_running = false;
+            } else {
+                m_console.writeSummaries();
             }
+            flush();
+        }
+        
+        void Console::LogViewWriter::execute() {
+            LogMessageList messages;
+            wxTextCtrl* textCtrl = NULL;
+            {
+                wxCriticalSectionLocker lock(m_lock);
+                m_flushPending = false;
+                if (m_textCtrl == NULL)
+                    return;
+                textCtrl = m_textCtrl;
+                messages.swap(m_queue);
+            }
+            
+            size_t i = 0;
+            while (i < messages.size()) {
+                const LogLevel level = messages[i].level();
+                StringStream buffer;
+                while (i < messages.size() && messages[i].level() == level)
+                    buffer << messages[i++].string() << "\n";
+                
+                long start = textCtrl->GetLastPosition();
+                textCtrl->AppendText(buffer.str());
+                long end = textCtrl->GetLastPosition();
+                switch (level) {
+                    case LLDebug:
+                        textCtrl->SetStyle(start, end, wxTextAttr(*wxLIGHT_GREY, *wxBLACK)); // SetDefaultStyle doesn't work on OS X / Cocoa
+                        break;
+                    case LLInfo:
+                        textCtrl->SetStyle(start, end, wxTextAttr(*wxWHITE, *wxBLACK)); // SetDefaultStyle doesn't work on OS X / Cocoa
+                        break;
+                    case LLWarn:
+                        textCtrl->SetStyle(start, end, wxTextAttr(*wxYELLOW, *wxBLACK)); // SetDefaultStyle doesn't work on OS X / Cocoa
+                        break;
+                    case LLError:
+                        textCtrl->SetStyle(start, end, wxTextAttr(*wxRED, *wxBLACK)); // SetDefaultStyle doesn't work on OS X / Cocoa
+                        break;
+                }
+            }
+        }
+        
+        Console::LogViewWriter::LogViewWriter() :
+        m_textCtrl(NULL),
+        m_flushPending(false),
+        m_windowStart(0),
+        m_windowCount(0),
+        m_suppressedCount(0) {}
+        
+        void Console::LogViewWriter::setTextCtrl(wxTextCtrl* textCtrl) {
+            wxCriticalSectionLocker lock(m_lock);
+            m_textCtrl = textCtrl;
+        }
+        
+        void Console::LogViewWriter::appendSuppressedCount() {
+            if (m_suppressedCount > 0) {
+                StringStream buffer;
+                buffer << "Suppressed " << m_suppressedCount << (m_suppressedCount == 1 ? " message" : " messages");
+                m_queue.push_back(LogMessage(LLWarn, buffer.str()));
+                m_suppressedCount = 0;
+            }
+        }
+        
+        bool Console::LogViewWriter::scheduleFlush() {
+            if (m_textCtrl == NULL || m_flushPending)
+                return false;
+            m_flushPending = true;
+            return true;
+        }
+        
+        bool Console::LogViewWriter::append(const LogMessage& message, bool& suppressed) {
+            wxCriticalSectionLocker lock(m_lock);
+
+            const wxLongLong now = wxGetLocalTimeMillis();
+            if (now - m_windowStart >= 1000) {
+                appendSuppressedCount();
+                m_windowStart = now;
+                m_windowCount = 0;
+            }
+
+            // errors are never dropped
+            suppressed = message.level() != LLError && m_windowCount >= MaxMessagesPerSecond;
+            if (suppressed) {
+                m_suppressedCount++;
+                return false;
+            }
+            m_windowCount++;
+            m_queue.push_back(message);
+            return scheduleFlush();
+        }
+        
+        bool Console::LogViewWriter::flushSuppressedCount() {
+            wxCriticalSectionLocker lock(m_lock);
+            if (m_suppressedCount == 0)
+                return false;
+            
+            appendSuppressedCount();
+            m_windowStart = wxGetLocalTimeMillis();
+            m_windowCount = 0;
+            return scheduleFlush();
+        }
+        
+        void Console::logToDebug(const LogMessage& message) {
+            // wxLogDebug(message.string().c_str());
+        }
+
+        void Console::flushView() {
+            if (wxTheApp != NULL)
+                wxTheApp->QueueEvent(new ExecutableEvent(ExecutableEvent::Executable::Ptr(m_viewWriter)));
+        }
+        
+        void Console::write(const LogMessage& message) {
+            m_fileWriter->append(message);
+            bool suppressed = false;
+            if (m_viewWriter->append(message, suppressed))
+                flushView();
+            if (suppressed)
+                m_fileWriter->scheduleSummary();
+        }
+        
+        void Console::writeRepeatCount() {
+            if (m_repeatCount > 0) {
+                StringStream buffer;
+                buffer << "Last message repeated " << m_repeatCount << (m_repeatCount == 1 ? " time" : " times");
+                write(LogMessage(m_lastMessage.level(), buffer.str()));
+                m_repeatCount = 0;
+            }
+        }
+        
+        // Called by the file writer once no message has arrived for a while, and when it stops.
+        void Console::writeSummaries() {
+            wxCriticalSectionLocker lock(m_lock);
+            writeRepeatCount();
+            if (m_viewWriter->flushSuppressedCount())
+                flushView();
+        }
+        
+        Console::Console() :
+        m_fileWriter(NULL),
+        m_viewWriter(new LogViewWriter()),
+        m_repeatCount(0) {
+            m_fileWriter = new LogFileWriter(*this);
+        }
+        
+        Console::~Console() {
+            m_viewWriter->setTextCtrl(NULL);
+            // writes the pending summaries and the remaining messages
+            delete m_fileWriter;
+            m_fileWriter = NULL;
+        }
+        
+        void Console::setTextCtrl(wxTextCtrl* textCtrl) {
+            m_viewWriter->setTextCtrl(textCtrl);
+            if (textCtrl != NULL)
+                (*m_viewWriter)();
         }
 
         void Console::log(const LogMessage& message) {
@@ -92,11 +314,16 @@ namespace TrenchBroom {
                 return;
 
             logToDebug(message);
-            logToFile(message);
-            if (m_textCtrl != NULL)
-                logToConsole(message);
-            else
-                m_buffer.push_back(message);
+            
+            wxCriticalSectionLocker lock(m_lock);
+            if (message == m_lastMessage) {
+                if (m_repeatCount++ == 0)
+                    m_fileWriter->scheduleSummary();
+                return;
+            }
+            writeRepeatCount();
+            m_lastMessage = message;
+            write(message);
         }
 
         void Console::debug(const String& message) {
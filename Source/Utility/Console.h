@@ -20,10 +20,16 @@
 #ifndef __TrenchBroom__Console__
 #define __TrenchBroom__Console__
 
+#include "Utility/ExecutableEvent.h"
+#include "Utility/SharedPointer.h"
 #include "Utility/String.h"
 
+#include <wx/datetime.h>
+#include <wx/longlong.h>
 #include <wx/textctrl.h>
+#include <wx/thread.h>
 
+#include <fstream>
 #include <vector>
 
 namespace TrenchBroom {
@@ -41,9 +47,14 @@ namespace TrenchBroom {
             protected:
                 LogLevel m_level;
                 String m_string;
+                wxDateTime m_time;
             public:
+                LogMessage() :
+                m_level(LLDebug) {}
+
                 LogMessage(const LogLevel level, const String& string) :
-                m_level(level) {
+                m_level(level),
+                m_time(wxDateTime::Now()) {
                     String trimmed = Utility::trim(string);
                     StringStream buffer;
                     bool previousWasNewline = false;
@@ -70,23 +81,96 @@ namespace TrenchBroom {
                 inline const String& string() const {
                     return m_string;
                 }
+
+                inline const wxDateTime& time() const {
+                    return m_time;
+                }
+
+                inline bool operator==(const LogMessage& other) const {
+                    return m_level == other.m_level && m_string == other.m_string;
+                }
             };
             
             typedef std::vector<LogMessage> LogMessageList;
 
-            LogMessageList m_buffer;
-            
-            wxTextCtrl* m_textCtrl;
-            
+            // Writes the log file from a background thread. The file is opened once and flushed once per batch. The
+            // thread sleeps until a message arrives, or until no message has arrived for a while after the console
+            // has held back a summary of repeated or suppressed messages.
+            class LogFileWriter : public wxThread {
+            private:
+                static const unsigned long SummaryDelay = 1000;
+
+                Console& m_console;
+                wxMutex m_mutex;
+                wxCondition m_condition;
+                LogMessageList m_queue;
+                bool m_summaryPending;
+                bool m_stopping;
+                std::ofstream m_stream;
+                bool m_running;
+
+                void write(const LogMessageList& messages);
+                void flush();
+                ExitCode Entry();
+            public:
+                LogFileWriter(Console& console);
+                ~LogFileWriter();
+
+                void append(const LogMessage& message);
+                void scheduleSummary();
+                void stop();
+            };
+
+            friend class LogFileWriter;
+
+            // Appends to the text control on the main thread, one styled range per run of messages with the same level.
+            // Only the view is rate limited, the log file receives every message.
+            class LogViewWriter : public ExecutableEvent::Executable {
+            private:
+                static const unsigned int MaxMessagesPerSecond = 200;
+
+                wxCriticalSection m_lock;
+                wxTextCtrl* m_textCtrl;
+                LogMessageList m_queue;
+                bool m_flushPending;
+                wxLongLong m_windowStart;
+                unsigned int m_windowCount;
+                unsigned int m_suppressedCount;
+
+                void appendSuppressedCount();
+                bool scheduleFlush();
+            protected:
+                void execute();
+            public:
+                typedef std::tr1::shared_ptr<LogViewWriter> Ptr;
+
+                LogViewWriter();
+
+                void setTextCtrl(wxTextCtrl* textCtrl);
+                // return true if the caller must schedule a flush on the main thread
+                bool append(const LogMessage& message, bool& suppressed);
+                bool flushSuppressedCount();
+            };
+
+            wxCriticalSection m_lock;
+            LogFileWriter* m_fileWriter;
+            LogViewWriter::Ptr m_viewWriter;
+
+            LogMessage m_lastMessage;
+            unsigned int m_repeatCount;
+
             void logToDebug(const LogMessage& message);
-            void logToConsole(const LogMessage& message);
-            void logToFile(const LogMessage& message);
+            void flushView();
+            void write(const LogMessage& message);
+            void writeRepeatCount();
+            void writeSummaries();
         public:
-            Console() : m_textCtrl(NULL) {}
+            Console();
+            virtual ~Console();
             
             void setTextCtrl(wxTextCtrl* textCtrl);
             
-            void log(const LogMessage& message);
+            virtual void log(const LogMessage& message);
             
             void debug(const String& message);
             void debug(const char* format, ...);
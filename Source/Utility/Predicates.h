@@ -0,0 +1,191 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_Predicates_h
+#define TrenchBroom_Predicates_h
+
+#include "Utility/Vec.h"
+
+#include <cmath>
+#include <cstddef>
+
+namespace TrenchBroom {
+    namespace VecMath {
+        /*
+         * Plane tests evaluated in double precision directly from the three points that define a plane, instead of
+         * from the rounded float plane computed from them. The sign of orientation is not reliable for points close
+         * to the plane, orientationSign returns the exact sign using the adaptive method by Shewchuk, "Adaptive
+         * Precision Floating-Point Arithmetic and Fast Robust Geometric Predicates". This requires that doubles are
+         * rounded to 53 bits, which is not the case for x87 code.
+         */
+        class Predicates {
+        private:
+            // x + y == a + b exactly, where x is the rounded sum
+            static void twoSum(const double a, const double b, double& x, double& y) {
+                x = a + b;
+                const double bVirtual = x - a;
+                const double aVirtual = x - bVirtual;
+                y = (a - aVirtual) + (b - bVirtual);
+            }
+            
+            // x + y == a * b exactly, where x is the rounded product
+            static void twoProduct(const double a, const double b, double& x, double& y) {
+                static const double Splitter = 134217729.0; // 2^27 + 1
+                
+                x = a * b;
+                const double aScaled = Splitter * a;
+                const double aHigh = aScaled - (aScaled - a);
+                const double aLow = a - aHigh;
+                const double bScaled = Splitter * b;
+                const double bHigh = bScaled - (bScaled - b);
+                const double bLow = b - bHigh;
+                y = aLow * bLow - (((x - aHigh * bHigh) - aLow * bHigh) - aHigh * bLow);
+            }
+            
+            /*
+             * Adds b to the expansion e, a sum of non-overlapping components ordered by increasing magnitude, and
+             * returns the new length of e. Zero components are dropped, so the last component has the sign of the sum.
+             */
+            static size_t growExpansion(double* e, const size_t length, const double b) {
+                double q = b;
+                size_t result = 0;
+                for (size_t i = 0; i < length; i++) {
+                    double sum, error;
+                    twoSum(q, e[i], sum, error);
+                    q = sum;
+                    if (error != 0.0)
+                        e[result++] = error;
+                }
+                if (q != 0.0)
+                    e[result++] = q;
+                return result;
+            }
+            
+            // adds a * b * c exactly, the product of two floats is exact in double precision
+            static size_t addProduct(double* e, size_t length, const double a, const double b, const double c) {
+                double x, y;
+                twoProduct(a * b, c, x, y);
+                length = growExpansion(e, length, y);
+                return growExpansion(e, length, x);
+            }
+            
+            // adds sign * det(a, b, c), where a, b and c are the rows of the matrix
+            static size_t addDeterminant(double* e, size_t length, const Vec3f& a, const Vec3f& b, const Vec3f& c, const double sign) {
+                length = addProduct(e, length,  sign * a.x(), b.y(), c.z());
+                length = addProduct(e, length, -sign * a.x(), b.z(), c.y());
+                length = addProduct(e, length,  sign * a.y(), b.z(), c.x());
+                length = addProduct(e, length, -sign * a.y(), b.x(), c.z());
+                length = addProduct(e, length,  sign * a.z(), b.x(), c.y());
+                return addProduct(e, length, -sign * a.z(), b.y(), c.x());
+            }
+            
+            static int exactOrientationSign(const Vec3f& p1, const Vec3f& p2, const Vec3f& p3, const Vec3f& q) {
+                // det(p3 - p1, p2 - p1, q - p1) expands to the following four determinants, each with six products
+                double e[48];
+                size_t length = 0;
+                length = addDeterminant(e, length, p3, p2, q,  1.0);
+                length = addDeterminant(e, length, p1, p2, q, -1.0);
+                length = addDeterminant(e, length, p3, p1, q, -1.0);
+                length = addDeterminant(e, length, p3, p2, p1, -1.0);
+                
+                if (length == 0)
+                    return 0;
+                return e[length - 1] > 0.0 ? 1 : -1;
+            }
+        public:
+            /*
+             * Returns ((p3 - p1) x (p2 - p1)) . (q - p1), which is positive if q is above the plane through the given
+             * points as oriented by Plane::setPoints.
+             */
+            static double orientation(const Vec3f& p1, const Vec3f& p2, const Vec3f& p3, const Vec3f& q) {
+                const double ux = static_cast<double>(p3.x()) - p1.x();
+                const double uy = static_cast<double>(p3.y()) - p1.y();
+                const double uz = static_cast<double>(p3.z()) - p1.z();
+                const double vx = static_cast<double>(p2.x()) - p1.x();
+                const double vy = static_cast<double>(p2.y()) - p1.y();
+                const double vz = static_cast<double>(p2.z()) - p1.z();
+                const double wx = static_cast<double>(q.x()) - p1.x();
+                const double wy = static_cast<double>(q.y()) - p1.y();
+                const double wz = static_cast<double>(q.z()) - p1.z();
+
+                return ux * (vy * wz - vz * wy) + uy * (vz * wx - vx * wz) + uz * (vx * wy - vy * wx);
+            }
+
+            // the exact sign of orientation, which is only computed exactly if the double precision result is too close
+            // to zero to be certain of its sign
+            static int orientationSign(const Vec3f& p1, const Vec3f& p2, const Vec3f& p3, const Vec3f& q) {
+                static const double Epsilon = 1.1102230246251565e-16; // 2^-53
+                static const double ErrorBound = (7.0 + 56.0 * Epsilon) * Epsilon;
+                
+                const double ux = static_cast<double>(p3.x()) - p1.x();
+                const double uy = static_cast<double>(p3.y()) - p1.y();
+                const double uz = static_cast<double>(p3.z()) - p1.z();
+                const double vx = static_cast<double>(p2.x()) - p1.x();
+                const double vy = static_cast<double>(p2.y()) - p1.y();
+                const double vz = static_cast<double>(p2.z()) - p1.z();
+                const double wx = static_cast<double>(q.x()) - p1.x();
+                const double wy = static_cast<double>(q.y()) - p1.y();
+                const double wz = static_cast<double>(q.z()) - p1.z();
+                
+                const double vywz = vy * wz;
+                const double vzwy = vz * wy;
+                const double vzwx = vz * wx;
+                const double vxwz = vx * wz;
+                const double vxwy = vx * wy;
+                const double vywx = vy * wx;
+                
+                const double result = ux * (vywz - vzwy) + uy * (vzwx - vxwz) + uz * (vxwy - vywx);
+                const double permanent = (std::abs(vywz) + std::abs(vzwy)) * std::abs(ux) +
+                                         (std::abs(vzwx) + std::abs(vxwz)) * std::abs(uy) +
+                                         (std::abs(vxwy) + std::abs(vywx)) * std::abs(uz);
+                
+                if (result > ErrorBound * permanent)
+                    return 1;
+                if (-result > ErrorBound * permanent)
+                    return -1;
+                return exactOrientationSign(p1, p2, p3, q);
+            }
+
+            // the length of the normal (p3 - p1) x (p2 - p1) of the plane through the given points
+            static double normalLength(const Vec3f& p1, const Vec3f& p2, const Vec3f& p3) {
+                const double ux = static_cast<double>(p3.x()) - p1.x();
+                const double uy = static_cast<double>(p3.y()) - p1.y();
+                const double uz = static_cast<double>(p3.z()) - p1.z();
+                const double vx = static_cast<double>(p2.x()) - p1.x();
+                const double vy = static_cast<double>(p2.y()) - p1.y();
+                const double vz = static_cast<double>(p2.z()) - p1.z();
+
+                const double nx = uy * vz - uz * vy;
+                const double ny = uz * vx - ux * vz;
+                const double nz = ux * vy - uy * vx;
+                return std::sqrt(nx * nx + ny * ny + nz * nz);
+            }
+
+            // the signed distance of q to the plane through the given points
+            static double pointDistance(const Vec3f& p1, const Vec3f& p2, const Vec3f& p3, const Vec3f& q) {
+                const double length = normalLength(p1, p2, p3);
+                if (length == 0.0)
+                    return 0.0;
+                return orientation(p1, p2, p3, q) / length;
+            }
+        };
+    }
+}
+
+#endif
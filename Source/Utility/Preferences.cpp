@@ -160,6 +160,8 @@ namespace TrenchBroom {
         const int               RendererInstancingModeForceOn       = 1;
         const int               RendererInstancingModeForceOff      = 2;
 
+        const Preference<bool>  GeometryDoublePrecisionPlanes = Preference<bool>(                "Geometry/Double precision planes",                             false);
+
         const Preference<KeyboardShortcut>  CameraMoveForward = Preference<KeyboardShortcut>(   "Controls/Camera/Move Forward",     KeyboardShortcut(View::CommandIds::Menu::ViewMoveCameraForward, 'W', KeyboardShortcut::SCAny, "Move Camera Forward"));
         const Preference<KeyboardShortcut>  CameraMoveBackward = Preference<KeyboardShortcut>(  "Controls/Camera/Move Backward",    KeyboardShortcut(View::CommandIds::Menu::ViewMoveCameraForward, 'S', KeyboardShortcut::SCAny, "Move Camera Backward"));
         const Preference<KeyboardShortcut>  CameraMoveLeft = Preference<KeyboardShortcut>(      "Controls/Camera/Move Left",        KeyboardShortcut(View::CommandIds::Menu::ViewMoveCameraForward, 'A', KeyboardShortcut::SCAny, "Move Camera Left"));
@@ -448,6 +450,12 @@ namespace TrenchBroom {
             viewMenu->addActionItem(KeyboardShortcut(View::CommandIds::Menu::ViewSwitchToEntityTab, '1', KeyboardShortcut::SCAny, "Switch to Entity Inspector"));
             viewMenu->addActionItem(KeyboardShortcut(View::CommandIds::Menu::ViewSwitchToFaceTab, '2', KeyboardShortcut::SCAny, "Switch to Face Inspector"));
             viewMenu->addActionItem(KeyboardShortcut(View::CommandIds::Menu::ViewSwitchToViewTab, '3', KeyboardShortcut::SCAny, "Switch to View Inspector"));
+#if defined _PROFILE
+            viewMenu->addSeparator();
+            viewMenu->addCheckItem(KeyboardShortcut(View::CommandIds::Menu::ViewToggleShowProfiler, KeyboardShortcut::SCAny, "Show Profiler"));
+            viewMenu->addCheckItem(KeyboardShortcut(View::CommandIds::Menu::ViewToggleRecordProfilerTrace, KeyboardShortcut::SCAny, "Record Profiler Trace"));
+            viewMenu->addActionItem(KeyboardShortcut(View::CommandIds::Menu::ViewSaveProfilerTrace, KeyboardShortcut::SCAny, "Save Profiler Trace..."));
+#endif
             return menus;
         }
 
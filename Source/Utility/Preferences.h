@@ -365,6 +365,8 @@ namespace TrenchBroom {
         extern const int                RendererInstancingModeForceOn;
         extern const int                RendererInstancingModeForceOff;
 
+        extern const Preference<bool>   GeometryDoublePrecisionPlanes;
+
         extern const Preference<KeyboardShortcut>   CameraMoveForward;
         extern const Preference<KeyboardShortcut>   CameraMoveBackward;
         extern const Preference<KeyboardShortcut>   CameraMoveLeft;
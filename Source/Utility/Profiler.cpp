@@ -0,0 +1,120 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Profiler.h"
+
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+
+namespace TrenchBroom {
+    namespace Utility {
+        Profiler::Entry& Profiler::entry(const char* name) {
+            for (size_t i = 0; i < m_frame.size(); i++) {
+                Entry& entry = m_frame[i];
+                if (entry.name == name || std::strcmp(entry.name, name) == 0)
+                    return entry;
+            }
+            m_frame.push_back(Entry(name));
+            return m_frame.back();
+        }
+
+        void Profiler::addTraceEvent(const TraceEvent& event) {
+            // keep the most recent events
+            if (m_traceEvents.size() >= MaxTraceEvents)
+                m_traceEvents.erase(m_traceEvents.begin(), m_traceEvents.begin() + MaxTraceEvents / 2);
+            m_traceEvents.push_back(event);
+        }
+
+        Profiler::Profiler() :
+        m_frameStart(0.0),
+        m_lastFrameTime(0.0),
+        m_averageFrameTime(0.0),
+        m_tracing(false) {
+            m_clock.Start();
+        }
+
+        void Profiler::addTime(const char* name, const double start, const double end) {
+            Entry& scope = entry(name);
+            scope.calls++;
+            scope.time += (end - start) / 1000.0;
+            if (m_tracing)
+                addTraceEvent(TraceEvent(name, 'X', start, end - start));
+        }
+
+        void Profiler::count(const char* name, const size_t count) {
+            entry(name).count += count;
+        }
+
+        void Profiler::endFrame() {
+            const double now = time();
+            m_lastFrameTime = (now - m_frameStart) / 1000.0;
+            if (m_averageFrameTime == 0.0)
+                m_averageFrameTime = m_lastFrameTime;
+            else
+                m_averageFrameTime = 0.9 * m_averageFrameTime + 0.1 * m_lastFrameTime;
+
+            if (m_tracing) {
+                addTraceEvent(TraceEvent("Frame", 'X', m_frameStart, now - m_frameStart));
+                for (size_t i = 0; i < m_frame.size(); i++)
+                    if (m_frame[i].count > 0)
+                        addTraceEvent(TraceEvent(m_frame[i].name, 'C', now, static_cast<double>(m_frame[i].count)));
+            }
+
+            // keep the entries so that the order of the names stays stable from frame to frame
+            m_lastFrame = m_frame;
+            for (size_t i = 0; i < m_frame.size(); i++) {
+                Entry& entry = m_frame[i];
+                entry.calls = 0;
+                entry.count = 0;
+                entry.time = 0.0;
+            }
+            m_frameStart = now;
+        }
+
+        void Profiler::setTracing(const bool tracing) {
+            m_tracing = tracing;
+            if (!m_tracing)
+                m_traceEvents.clear();
+        }
+
+        bool Profiler::writeTrace(const String& path) const {
+            std::ofstream stream(path.c_str(), std::ios::out | std::ios::trunc);
+            if (!stream.is_open())
+                return false;
+
+            // timestamps, durations and counts are written as whole numbers
+            stream << std::fixed << std::setprecision(0);
+            stream << "{\"traceEvents\":[";
+            for (size_t i = 0; i < m_traceEvents.size(); i++) {
+                const TraceEvent& event = m_traceEvents[i];
+                if (i > 0)
+                    stream << ",";
+                stream << "\n{\"name\":\"" << event.name << "\",\"ph\":\"" << event.phase << "\",\"ts\":" << event.timestamp << ",\"pid\":1,\"tid\":1";
+                if (event.phase == 'X')
+                    stream << ",\"dur\":" << event.value;
+                else
+                    stream << ",\"args\":{\"value\":" << event.value << "}";
+                stream << "}";
+            }
+            stream << "\n]}\n";
+            return stream.good();
+        }
+    }
+}
@@ -0,0 +1,145 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __TrenchBroom__Profiler__
+#define __TrenchBroom__Profiler__
+
+#include "Utility/String.h"
+
+#include <wx/stopwatch.h>
+
+#include <vector>
+
+namespace TrenchBroom {
+    namespace Utility {
+        // Aggregates scoped timings and counters per frame and optionally records them as a Chrome trace. Names must
+        // be string literals. Not synchronized, only use it from the main thread.
+        class Profiler {
+        public:
+            struct Entry {
+                const char* name;
+                size_t calls;
+                size_t count;
+                double time;
+
+                Entry(const char* i_name) :
+                name(i_name),
+                calls(0),
+                count(0),
+                time(0.0) {}
+            };
+
+            typedef std::vector<Entry> EntryList;
+        private:
+            struct TraceEvent {
+                const char* name;
+                char phase;
+                double timestamp;
+                double value;
+
+                TraceEvent(const char* i_name, const char i_phase, const double i_timestamp, const double i_value) :
+                name(i_name),
+                phase(i_phase),
+                timestamp(i_timestamp),
+                value(i_value) {}
+            };
+
+            typedef std::vector<TraceEvent> TraceEventList;
+
+            static const size_t MaxTraceEvents = 1 << 20;
+
+            wxStopWatch m_clock;
+            EntryList m_frame;
+            EntryList m_lastFrame;
+            double m_frameStart;
+            double m_lastFrameTime;
+            double m_averageFrameTime;
+            bool m_tracing;
+            TraceEventList m_traceEvents;
+
+            Entry& entry(const char* name);
+            void addTraceEvent(const TraceEvent& event);
+        public:
+            inline static Profiler& profiler() {
+                static Profiler profiler;
+                return profiler;
+            }
+
+            Profiler();
+
+            // microseconds since the profiler was created
+            inline double time() const {
+                return m_clock.TimeInMicro().ToDouble();
+            }
+
+            void addTime(const char* name, const double start, const double end);
+            void count(const char* name, const size_t count);
+            void endFrame();
+
+            inline const EntryList& lastFrame() const {
+                return m_lastFrame;
+            }
+
+            // milliseconds
+            inline double lastFrameTime() const {
+                return m_lastFrameTime;
+            }
+
+            inline double averageFrameTime() const {
+                return m_averageFrameTime;
+            }
+
+            inline bool tracing() const {
+                return m_tracing;
+            }
+
+            void setTracing(const bool tracing);
+            bool writeTrace(const String& path) const;
+        };
+
+        class ProfileScope {
+        private:
+            const char* m_name;
+            double m_start;
+        public:
+            ProfileScope(const char* name) :
+            m_name(name),
+            m_start(Profiler::profiler().time()) {}
+
+            ~ProfileScope() {
+                Profiler& profiler = Profiler::profiler();
+                profiler.addTime(m_name, m_start, profiler.time());
+            }
+        };
+    }
+}
+
+#if defined _PROFILE
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#define PROFILE_SCOPE(name) TrenchBroom::Utility::ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+#define PROFILE_COUNT(name, value) TrenchBroom::Utility::Profiler::profiler().count(name, value)
+#define PROFILE_END_FRAME() TrenchBroom::Utility::Profiler::profiler().endFrame()
+#else
+#define PROFILE_SCOPE(name)
+#define PROFILE_COUNT(name, value)
+#define PROFILE_END_FRAME()
+#endif
+
+#endif /* defined(__TrenchBroom__Profiler__) */
@@ -26,11 +26,13 @@
 #include <wx/fs_mem.h>
 
 #include "IO/FileManager.h"
-#include "IO/Pak.h"
+#include "IO/GameFileSystem.h"
 #include "Model/Alias.h"
 #include "Model/Bsp.h"
+#include "Model/BrushGeometry.h"
 #include "Model/MapDocument.h"
 #include "Utility/DocManager.h"
+#include "Utility/Preferences.h"
 #include "View/AboutDialog.h"
 #include "View/CommandIds.h"
 #include "View/EditorFrame.h"
@@ -212,10 +214,13 @@ bool AbstractApp::OnInit() {
     m_preferencesFrame = NULL;
 
     // initialize globals
-    TrenchBroom::IO::PakManager::sharedManager = new TrenchBroom::IO::PakManager();
+    TrenchBroom::IO::GameFileSystemManager::sharedManager = new TrenchBroom::IO::GameFileSystemManager();
     TrenchBroom::Model::AliasManager::sharedManager = new TrenchBroom::Model::AliasManager();
     TrenchBroom::Model::BspManager::sharedManager = new TrenchBroom::Model::BspManager();
 
+    TrenchBroom::Preferences::PreferenceManager& prefs = TrenchBroom::Preferences::PreferenceManager::preferences();
+    TrenchBroom::Model::BrushGeometry::doublePrecisionPlanes = prefs.getBool(TrenchBroom::Preferences::GeometryDoublePrecisionPlanes);
+
 	m_docManager = new DocManager();
     m_docManager->FileHistoryLoad(*wxConfig::Get());
 
@@ -256,8 +261,8 @@ int AbstractApp::OnExit() {
     wxDELETE(m_docManager);
     wxDELETE(m_helpController);
 
-    delete TrenchBroom::IO::PakManager::sharedManager;
-    TrenchBroom::IO::PakManager::sharedManager = NULL;
+    delete TrenchBroom::IO::GameFileSystemManager::sharedManager;
+    TrenchBroom::IO::GameFileSystemManager::sharedManager = NULL;
     delete TrenchBroom::Model::AliasManager::sharedManager;
     TrenchBroom::Model::AliasManager::sharedManager = NULL;
     delete TrenchBroom::Model::BspManager::sharedManager;
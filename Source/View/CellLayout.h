@@ -88,7 +88,7 @@ namespace TrenchBroom {
             }
 
             inline bool intersectsY(float y, float height) const {
-                return bottom() >= y || top() <= y + height;
+                return bottom() >= y && top() <= y + height;
             }
         };
 
@@ -190,6 +190,7 @@ namespace TrenchBroom {
             float m_minCellHeight;
             float m_maxCellHeight;
             LayoutBounds m_bounds;
+            size_t m_firstCellIndex;
 
             CellList m_cells;
 
@@ -198,7 +199,7 @@ namespace TrenchBroom {
                     m_cells[i].updateLayout(m_maxUpScale, m_minCellWidth, m_maxCellWidth, m_minCellHeight, m_maxCellHeight);
             }
         public:
-            LayoutRow(float x, float y, float cellMargin, float maxWidth, unsigned int maxCells, float maxUpScale, float minCellWidth, float maxCellWidth, float minCellHeight, float maxCellHeight) :
+            LayoutRow(float x, float y, float cellMargin, float maxWidth, unsigned int maxCells, float maxUpScale, float minCellWidth, float maxCellWidth, float minCellHeight, float maxCellHeight, size_t firstCellIndex) :
             m_cellMargin(cellMargin),
             m_maxWidth(maxWidth),
             m_maxCells(maxCells),
@@ -207,7 +208,8 @@ namespace TrenchBroom {
             m_maxCellWidth(maxCellWidth),
             m_minCellHeight(minCellHeight),
             m_maxCellHeight(maxCellHeight),
-            m_bounds(x, y, 0.0f, 0.0f) {}
+            m_bounds(x, y, 0.0f, 0.0f),
+            m_firstCellIndex(firstCellIndex) {}
 
             inline const Cell& operator[] (const size_t index) const {
                 assert(index >= 0 && index < m_cells.size());
@@ -249,6 +251,11 @@ namespace TrenchBroom {
                 return m_cells;
             }
 
+            // the index of the given cell among all cells of the layout, in the order in which they were added
+            inline size_t cellIndex(const size_t index) const {
+                return m_firstCellIndex + index;
+            }
+
             inline bool cellAt(float x, float y, const Cell** result) const {
                 for (unsigned int i = 0; i < m_cells.size(); i++) {
                     const Cell& cell = m_cells[i];
@@ -295,6 +302,8 @@ namespace TrenchBroom {
             float m_maxCellHeight;
             LayoutBounds m_titleBounds;
             LayoutBounds m_contentBounds;
+            size_t m_firstCellIndex;
+            size_t m_cellCount;
 
             RowList m_rows;
             float m_maxWidth;
@@ -304,7 +313,7 @@ namespace TrenchBroom {
                 return m_rows[index];
             }
 
-            LayoutGroup(GroupType item, float x, float y, float cellMargin, float rowMargin, float titleHeight, float width, unsigned int maxCellsPerRow, float maxUpScale, float minCellWidth, float maxCellWidth, float minCellHeight, float maxCellHeight) :
+            LayoutGroup(GroupType item, float x, float y, float cellMargin, float rowMargin, float titleHeight, float width, unsigned int maxCellsPerRow, float maxUpScale, float minCellWidth, float maxCellWidth, float minCellHeight, float maxCellHeight, size_t firstCellIndex) :
             m_item(item),
             m_cellMargin(cellMargin),
             m_rowMargin(rowMargin),
@@ -315,9 +324,11 @@ namespace TrenchBroom {
             m_minCellHeight(minCellHeight),
             m_maxCellHeight(maxCellHeight),
             m_titleBounds(0.0f, y, width + 2.0f * x, titleHeight),
-            m_contentBounds(x, y + titleHeight + m_rowMargin, width, 0.0f) {}
+            m_contentBounds(x, y + titleHeight + m_rowMargin, width, 0.0f),
+            m_firstCellIndex(firstCellIndex),
+            m_cellCount(0) {}
 
-            LayoutGroup(float x, float y, float cellMargin, float rowMargin, float width, unsigned int maxCellsPerRow, float maxUpScale, float minCellWidth, float maxCellWidth, float minCellHeight, float maxCellHeight) :
+            LayoutGroup(float x, float y, float cellMargin, float rowMargin, float width, unsigned int maxCellsPerRow, float maxUpScale, float minCellWidth, float maxCellWidth, float minCellHeight, float maxCellHeight, size_t firstCellIndex) :
             m_cellMargin(cellMargin),
             m_rowMargin(rowMargin),
             m_maxCellsPerRow(maxCellsPerRow),
@@ -327,19 +338,21 @@ namespace TrenchBroom {
             m_minCellHeight(minCellHeight),
             m_maxCellHeight(maxCellHeight),
             m_titleBounds(x, y, width, 0.0f),
-            m_contentBounds(x, y, width, 0.0f) {}
+            m_contentBounds(x, y, width, 0.0f),
+            m_firstCellIndex(firstCellIndex),
+            m_cellCount(0) {}
 
             void addItem(CellType item, float itemWidth, float itemHeight, float titleWidth, float titleHeight) {
                 if (m_rows.empty()) {
                     float y = m_contentBounds.top();
-                    m_rows.push_back(Row(m_contentBounds.left(), y, m_cellMargin, m_contentBounds.width(), m_maxCellsPerRow, m_maxUpScale, m_minCellWidth, m_maxCellWidth, m_minCellHeight, m_maxCellHeight));
+                    m_rows.push_back(Row(m_contentBounds.left(), y, m_cellMargin, m_contentBounds.width(), m_maxCellsPerRow, m_maxUpScale, m_minCellWidth, m_maxCellWidth, m_minCellHeight, m_maxCellHeight, m_firstCellIndex + m_cellCount));
                 }
 
                 const LayoutBounds oldBounds = m_rows.back().bounds();
                 const float oldRowHeight = m_rows.back().bounds().height();
                 if (!m_rows.back().addItem(item, itemWidth, itemHeight, titleWidth, titleHeight)) {
                     float y = oldBounds.bottom() + m_rowMargin;
-                    m_rows.push_back(Row(m_contentBounds.left(), y, m_cellMargin, m_contentBounds.width(), m_maxCellsPerRow, m_maxUpScale, m_minCellWidth, m_maxCellWidth, m_minCellHeight, m_maxCellHeight));
+                    m_rows.push_back(Row(m_contentBounds.left(), y, m_cellMargin, m_contentBounds.width(), m_maxCellsPerRow, m_maxUpScale, m_minCellWidth, m_maxCellWidth, m_minCellHeight, m_maxCellHeight, m_firstCellIndex + m_cellCount));
 
                     bool added = (m_rows.back().addItem(item, itemWidth, itemHeight, titleWidth, titleHeight));
                     assert(added);
@@ -350,17 +363,23 @@ namespace TrenchBroom {
                     const float newRowHeight = m_rows.back().bounds().height();
                     m_contentBounds = LayoutBounds(m_contentBounds.left(), m_contentBounds.top(), m_contentBounds.width(), m_contentBounds.height() + (newRowHeight - oldRowHeight));
                 }
+                m_cellCount++;
             }
 
+            // returns the first row whose bottom is below the given position, the rows are sorted by their position
             size_t indexOfRowAt(float y) const {
-                for (size_t i = 0; i < m_rows.size(); i++) {
-                    const Row& row = m_rows[i];
-                    const LayoutBounds& rowBounds = row.bounds();
-                    if (y < rowBounds.bottom())
-                        return i;
+                size_t first = 0;
+                size_t count = m_rows.size();
+                while (count > 0) {
+                    const size_t step = count / 2;
+                    if (m_rows[first + step].bounds().bottom() <= y) {
+                        first += step + 1;
+                        count -= step + 1;
+                    } else {
+                        count = step;
+                    }
                 }
-                
-                return m_rows.size();
+                return first;
             }
             
             bool rowAt(float y, const Row** result) const {
@@ -373,18 +392,14 @@ namespace TrenchBroom {
             }
             
             bool cellAt(float x, float y, const typename Row::Cell** result) const {
-                for (unsigned int i = 0; i < m_rows.size(); i++) {
-                    const Row& row = m_rows[i];
-                    const LayoutBounds& rowBounds = row.bounds();
-                    if (y > rowBounds.bottom())
-                        continue;
-                    else if (y < rowBounds.top())
-                        break;
-                    if (row.cellAt(x, y, result))
-                        return true;
-                }
+                const size_t index = indexOfRowAt(y);
+                if (index == m_rows.size())
+                    return false;
 
-                return false;
+                const Row& row = m_rows[index];
+                if (y < row.bounds().top())
+                    return false;
+                return row.cellAt(x, y, result);
             }
 
             bool hitTest(float x, float y) const {
@@ -446,12 +461,16 @@ namespace TrenchBroom {
             GroupList m_groups;
             bool m_valid;
             float m_height;
+            size_t m_cellCount;
+            unsigned int m_generation;
 
             void validate() {
                 if (m_width <= 0.0f)
                     return;
 
                 m_height = 2.0f * m_outerMargin;
+                m_cellCount = 0;
+                m_generation++;
                 m_valid = true;
                 if (!m_groups.empty()) {
                     GroupList copy = m_groups;
@@ -494,7 +513,9 @@ namespace TrenchBroom {
             m_minCellWidth(100.0f),
             m_maxCellWidth(100.0f),
             m_minCellHeight(100.0f),
-            m_maxCellHeight(100.0f) {
+            m_maxCellHeight(100.0f),
+            m_cellCount(0),
+            m_generation(0) {
                 invalidate();
             }
 
@@ -536,8 +557,9 @@ namespace TrenchBroom {
                     m_height += m_groupMargin;
                 }
 
-                m_groups.push_back(Group(groupItem, m_outerMargin, y, m_cellMargin, m_rowMargin, titleHeight, m_width - 2.0f * m_outerMargin, m_maxCellsPerRow, m_maxUpScale, m_minCellWidth, m_maxCellWidth, m_minCellHeight, m_maxCellHeight));
+                m_groups.push_back(Group(groupItem, m_outerMargin, y, m_cellMargin, m_rowMargin, titleHeight, m_width - 2.0f * m_outerMargin, m_maxCellsPerRow, m_maxUpScale, m_minCellWidth, m_maxCellWidth, m_minCellHeight, m_maxCellHeight, m_cellCount));
                 m_height += m_groups.back().bounds().height();
+                m_generation++;
             }
 
             void addItem(const CellType item, float itemWidth, float itemHeight, float titleWidth, float titleHeight) {
@@ -545,7 +567,7 @@ namespace TrenchBroom {
                     validate();
 
                 if (m_groups.empty()) {
-                    m_groups.push_back(Group(m_outerMargin, m_outerMargin, m_cellMargin, m_rowMargin, m_width - 2.0f * m_outerMargin, m_maxCellsPerRow, m_maxUpScale, m_minCellWidth, m_maxCellWidth, m_minCellHeight, m_maxCellHeight));
+                    m_groups.push_back(Group(m_outerMargin, m_outerMargin, m_cellMargin, m_rowMargin, m_width - 2.0f * m_outerMargin, m_maxCellsPerRow, m_maxUpScale, m_minCellWidth, m_maxCellWidth, m_minCellHeight, m_maxCellHeight, m_cellCount));
                     m_height += titleHeight;
                     if (titleHeight > 0.0f)
                         m_height += m_rowMargin;
@@ -556,10 +578,14 @@ namespace TrenchBroom {
                 const float newGroupHeight = m_groups.back().bounds().height();
 
                 m_height += (newGroupHeight - oldGroupHeight);
+                m_cellCount++;
+                m_generation++;
             }
 
             inline void clear() {
                 m_groups.clear();
+                m_cellCount = 0;
+                m_generation++;
                 invalidate();
             }
 
@@ -661,6 +687,19 @@ namespace TrenchBroom {
                 m_valid = false;
             }
 
+            inline size_t cellCount() {
+                if (!m_valid)
+                    validate();
+                return m_cellCount;
+            }
+
+            // changes whenever a cell is added or moved
+            inline unsigned int generation() {
+                if (!m_valid)
+                    validate();
+                return m_generation;
+            }
+
             inline void setWidth(float width) {
                 if (m_width == width)
                     return;
@@ -724,7 +763,7 @@ namespace TrenchBroom {
             }
             
             inline float outerMargin() const {
-                return m_outerMargin();
+                return m_outerMargin;
             }
             
             inline float groupMargin() const {
@@ -736,7 +775,7 @@ namespace TrenchBroom {
             }
             
             inline float cellMargin() const {
-                return m_cellMargin();
+                return m_cellMargin;
             }
         };
     }
@@ -126,6 +126,9 @@ namespace TrenchBroom {
                 static const int EditFaceActions                    = Lowest + 100;
                 static const int EditPrintFilePositions             = Lowest + 101;
                 static const int EditToggleAxisRestriction          = Lowest + 102;
+                static const int ViewToggleShowProfiler             = Lowest + 103;
+                static const int ViewToggleRecordProfilerTrace      = Lowest + 104;
+                static const int ViewSaveProfilerTrace              = Lowest + 105;
                 static const int Highest                            = Lowest + 199;
             }
             
@@ -177,6 +180,7 @@ namespace TrenchBroom {
                 static const int InvertAltMoveAxisCheckBoxId        = Lowest +  16;
                 static const int MoveCameraInCursorDirCheckBoxId    = Lowest +  14;
                 static const int TextureBrowserIconSideChoiceId     = Lowest +  15;
+                static const int DoublePrecisionPlanesCheckBoxId    = Lowest +  17;
                 static const int Highest                            = Lowest +  99;
             }
 
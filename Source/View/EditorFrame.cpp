@@ -27,6 +27,8 @@
 #include "Model/EditStateManager.h"
 #include "Model/Entity.h"
 #include "Model/MapDocument.h"
+#include "Renderer/EntityModelRendererManager.h"
+#include "Renderer/SharedResources.h"
 #include "Utility/Console.h"
 #include "Utility/List.h"
 #include "View/CommandIds.h"
@@ -287,6 +289,14 @@ namespace TrenchBroom {
                 updateNavBar();
                 m_focusMapCanvasOnIdle--;
             }
+            
+            if (m_documentViewHolder.valid()) {
+                Renderer::EntityModelRendererManager& modelRendererManager = m_documentViewHolder.document().sharedResources().modelRendererManager();
+                if (modelRendererManager.collectLoadedModels()) {
+                    Controller::Command command(Controller::Command::EntityModelsLoaded);
+                    m_documentViewHolder.view().OnUpdate(NULL, &command);
+                }
+            }
 
             // FIXME: Workaround for a bug in Ubuntu GTK where menus are not updated
             // This will be fixed in wxWidgets 2.9.5: http://trac.wxwidgets.org/ticket/14302
@@ -36,6 +36,7 @@
 #include "Controller/SetFaceAttributesCommand.h"
 #include "Controller/SnapVerticesCommand.h"
 #include "Controller/TransformObjectsCommand.h"
+#include "IO/BinaryMapParser.h"
 #include "IO/ByteBuffer.h"
 #include "IO/MapParser.h"
 #include "IO/MapWriter.h"
@@ -60,6 +61,7 @@
 #include "Utility/Grid.h"
 #include "Utility/List.h"
 #include "Utility/Preferences.h"
+#include "Utility/Profiler.h"
 #include "View/AbstractApp.h"
 #include "View/CameraAnimation.h"
 #include "View/CommandIds.h"
@@ -74,6 +76,7 @@
 
 #include <wx/clipbrd.h>
 #include <wx/dataobj.h>
+#include <wx/filedlg.h>
 #include <wx/tokenzr.h>
 
 namespace TrenchBroom {
@@ -194,6 +197,9 @@ namespace TrenchBroom {
         EVT_MENU(CommandIds::Menu::ViewSwitchToEntityTab, EditorView::OnViewSwitchToEntityInspector)
         EVT_MENU(CommandIds::Menu::ViewSwitchToFaceTab, EditorView::OnViewSwitchToFaceInspector)
         EVT_MENU(CommandIds::Menu::ViewSwitchToViewTab, EditorView::OnViewSwitchToViewInspector)
+        EVT_MENU(CommandIds::Menu::ViewToggleShowProfiler, EditorView::OnViewToggleShowProfiler)
+        EVT_MENU(CommandIds::Menu::ViewToggleRecordProfilerTrace, EditorView::OnViewToggleRecordProfilerTrace)
+        EVT_MENU(CommandIds::Menu::ViewSaveProfilerTrace, EditorView::OnViewSaveProfilerTrace)
 
         EVT_UPDATE_UI(wxID_SAVE, EditorView::OnUpdateMenuItem)
         EVT_UPDATE_UI(wxID_UNDO, EditorView::OnUpdateMenuItem)
@@ -222,6 +228,43 @@ namespace TrenchBroom {
             mapDocument().GetCommandProcessor()->Submit(command, store);
         }
 
+        static const wxDataFormat& binaryClipboardFormat() {
+            static const wxDataFormat format(wxT("TrenchBroom Map Objects"));
+            return format;
+        }
+
+        // the clipboard must be open; the binary format is preferred, the text format is read if it is not available
+        bool EditorView::parseClipboard(Model::EntityList& entities, Model::BrushList& brushes, Model::FaceList& faces) {
+            const BBoxf& worldBounds = mapDocument().map().worldBounds();
+            const bool forceIntegerFacePoints = mapDocument().map().forceIntegerFacePoints();
+
+            if (wxTheClipboard->IsSupported(binaryClipboardFormat())) {
+                wxCustomDataObject binaryData(binaryClipboardFormat());
+                if (wxTheClipboard->GetData(binaryData) && binaryData.GetSize() > 0) {
+                    const char* data = static_cast<const char*>(binaryData.GetData());
+                    IO::BinaryMapParser binaryParser(data, binaryData.GetSize());
+                    if (binaryParser.parseFaces(worldBounds, forceIntegerFacePoints, faces) ||
+                        binaryParser.parseEntities(worldBounds, forceIntegerFacePoints, entities))
+                        return true;
+                }
+            }
+
+            if (wxTheClipboard->IsSupported(wxDF_TEXT)) {
+                wxTextDataObject textData;
+                String text;
+
+                if (wxTheClipboard->GetData(textData))
+                    text = textData.GetText();
+
+                IO::MapParser mapParser(text, console());
+                return (mapParser.parseFaces(worldBounds, forceIntegerFacePoints, faces) ||
+                        mapParser.parseEntities(worldBounds, forceIntegerFacePoints, entities) ||
+                        mapParser.parseBrushes(worldBounds, forceIntegerFacePoints, brushes));
+            }
+
+            return false;
+        }
+
         void EditorView::pasteObjects(const Model::EntityList& entities, const Model::BrushList& brushes, const Vec3f& delta) {
             assert(entities.empty() != brushes.empty());
 
@@ -647,6 +690,8 @@ namespace TrenchBroom {
                         const Controller::PreferenceChangeEvent& preferenceChangeEvent = *static_cast<const Controller::PreferenceChangeEvent*>(command);
                         if (preferenceChangeEvent.isPreferenceChanged(Preferences::QuakePath))
                             mapDocument().invalidateSearchPaths();
+                        if (preferenceChangeEvent.isPreferenceChanged(Preferences::GeometryDoublePrecisionPlanes))
+                            mapDocument().rebuildBrushGeometries();
                         break;
                     }
                     case Controller::Command::RebuildBrushGeometry:
@@ -843,15 +888,24 @@ namespace TrenchBroom {
 
                 if (wxTheClipboard->Open()) {
                     StringStream clipboardData;
+                    IO::ByteBuffer binaryClipboardData;
                     IO::MapWriter mapWriter;
                     if (editStateManager.selectionMode() == Model::EditStateManager::SMFaces) {
                         mapWriter.writeFacesToStream(editStateManager.selectedFaces(), clipboardData);
-                        wxTheClipboard->SetData(new wxTextDataObject(clipboardData.str()));
+                        mapWriter.writeFacesToBuffer(editStateManager.selectedFaces(), binaryClipboardData);
                     } else {
                         mapWriter.writeObjectsToStream(editStateManager.selectedEntities(), editStateManager.selectedBrushes(), clipboardData);
-                        wxTheClipboard->SetData(new wxTextDataObject(clipboardData.str()));
+                        mapWriter.writeObjectsToBuffer(editStateManager.selectedEntities(), editStateManager.selectedBrushes(), binaryClipboardData);
                     }
 
+                    // the text format remains available for pasting into other applications
+                    wxCustomDataObject* binaryData = new wxCustomDataObject(binaryClipboardFormat());
+                    binaryData->SetData(binaryClipboardData.size(), binaryClipboardData.get());
+                    wxDataObjectComposite* data = new wxDataObjectComposite();
+                    data->Add(binaryData, true);
+                    data->Add(new wxTextDataObject(clipboardData.str()));
+                    wxTheClipboard->SetData(data);
+
                     wxTheClipboard->Close();
                 }
             }
@@ -862,24 +916,15 @@ namespace TrenchBroom {
                 textCtrl->Paste();
             } else {
                 if (wxTheClipboard->Open()) {
-                    if (wxTheClipboard->IsSupported(wxDF_TEXT)) {
-                        Model::EntityList entities;
-                        Model::BrushList brushes;
-                        Model::FaceList faces;
-
-                        wxTextDataObject textData;
-                        String text;
-
-                        if (wxTheClipboard->GetData(textData))
-                            text = textData.GetText();
-
-                        IO::MapParser mapParser(text, console());
-                        if (mapParser.parseFaces(mapDocument().map().worldBounds(), mapDocument().map().forceIntegerFacePoints(), faces)) {
-                            assert(!faces.empty());
+                    Model::EntityList entities;
+                    Model::BrushList brushes;
+                    Model::FaceList faces;
 
+                    if (parseClipboard(entities, brushes, faces)) {
+                        if (!faces.empty()) {
                             Model::Face& face = *faces.back();
                             Model::TextureManager& textureManager = mapDocument().textureManager();
-                            Model::Texture* texture = textureManager.texture(face.textureName());
+                            Model::Texture* texture = textureManager.texture(face.textureNameId());
                             face.setTexture(texture);
 
                             const Model::FaceList& selectedFaces = mapDocument().editStateManager().selectedFaces();
@@ -895,8 +940,8 @@ namespace TrenchBroom {
                             } else {
                                 mapDocument().console().warn("Could not paste faces because no faces are selected");
                             }
-                        } else if (mapParser.parseEntities(mapDocument().map().worldBounds(), mapDocument().map().forceIntegerFacePoints(), entities) ||
-                                   mapParser.parseBrushes(mapDocument().map().worldBounds(), mapDocument().map().forceIntegerFacePoints(), brushes)) {
+                            Utility::deleteAll(faces);
+                        } else {
                             assert(entities.empty() != brushes.empty());
 
                             const BBoxf objectsBounds = Model::MapObject::bounds(entities, brushes);
@@ -929,9 +974,9 @@ namespace TrenchBroom {
                             }
 
                             pasteObjects(entities, brushes, delta);
-                        } else {
-                            mapDocument().console().warn("Unable to parse clipboard contents");
                         }
+                    } else {
+                        mapDocument().console().warn("Unable to parse clipboard contents");
                     }
                     wxTheClipboard->Close();
                 }
@@ -943,25 +988,17 @@ namespace TrenchBroom {
                 textCtrl->Paste();
             } else {
                 if (wxTheClipboard->Open()) {
-                    if (wxTheClipboard->IsSupported(wxDF_TEXT)) {
-                        Model::EntityList entities;
-                        Model::BrushList brushes;
+                    Model::EntityList entities;
+                    Model::BrushList brushes;
+                    Model::FaceList faces;
 
-                        wxTextDataObject textData;
-                        String text;
+                    if (parseClipboard(entities, brushes, faces) && faces.empty()) {
+                        assert(entities.empty() != brushes.empty());
 
-                        if (wxTheClipboard->GetData(textData))
-                            text = textData.GetText();
-
-                        IO::MapParser mapParser(text, console());
-                        if (mapParser.parseEntities(mapDocument().map().worldBounds(), mapDocument().map().forceIntegerFacePoints(), entities) ||
-                            mapParser.parseBrushes(mapDocument().map().worldBounds(), mapDocument().map().forceIntegerFacePoints(), brushes)) {
-                            assert(entities.empty() != brushes.empty());
-
-                            pasteObjects(entities, brushes, Vec3f::Null);
-                        } else {
-                            mapDocument().console().warn("Unable to parse clipboard contents");
-                        }
+                        pasteObjects(entities, brushes, Vec3f::Null);
+                    } else {
+                        Utility::deleteAll(faces);
+                        mapDocument().console().warn("Unable to parse clipboard contents");
                     }
                     wxTheClipboard->Close();
                 }
@@ -1728,6 +1765,27 @@ namespace TrenchBroom {
             inspector().switchToInspector(2);
         }
 
+        void EditorView::OnViewToggleShowProfiler(wxCommandEvent& event) {
+            viewOptions().setShowProfiler(!viewOptions().showProfiler());
+            editorFrame().mapCanvas().Refresh();
+        }
+
+        void EditorView::OnViewToggleRecordProfilerTrace(wxCommandEvent& event) {
+            Utility::Profiler& profiler = Utility::Profiler::profiler();
+            profiler.setTracing(!profiler.tracing());
+        }
+
+        void EditorView::OnViewSaveProfilerTrace(wxCommandEvent& event) {
+            wxFileDialog saveDialog(NULL, wxT("Save profiler trace"), wxT(""), wxT("trace.json"), wxT("JSON files (*.json)|*.json"), wxFD_SAVE | wxFD_OVERWRITE_PROMPT);
+            if (saveDialog.ShowModal() == wxID_OK) {
+                const String path = saveDialog.GetPath().ToStdString();
+                if (Utility::Profiler::profiler().writeTrace(path))
+                    console().info("Saved profiler trace to %s", path.c_str());
+                else
+                    console().error("Could not save profiler trace to %s", path.c_str());
+            }
+        }
+
         void EditorView::OnUpdateMenuItem(wxUpdateUIEvent& event) {
             AbstractApp* app = static_cast<AbstractApp*>(wxTheApp);
             if (app->preferencesFrame() != NULL) {
@@ -1795,7 +1853,7 @@ namespace TrenchBroom {
                     } else {
                         bool canPaste = false;
                         if (wxTheClipboard->Open()) {
-                            canPaste = wxTheClipboard->IsSupported(wxDF_TEXT);
+                            canPaste = wxTheClipboard->IsSupported(binaryClipboardFormat()) || wxTheClipboard->IsSupported(wxDF_TEXT);
                             wxTheClipboard->Close();
                         }
                         event.Enable(canPaste);
@@ -1807,7 +1865,7 @@ namespace TrenchBroom {
                     } else {
                         bool canPaste = false;
                         if (wxTheClipboard->Open()) {
-                            canPaste = wxTheClipboard->IsSupported(wxDF_TEXT);
+                            canPaste = wxTheClipboard->IsSupported(binaryClipboardFormat()) || wxTheClipboard->IsSupported(wxDF_TEXT);
                             wxTheClipboard->Close();
                         }
                         event.Enable(canPaste);
@@ -1987,6 +2045,17 @@ namespace TrenchBroom {
                 case CommandIds::Menu::ViewSwitchToViewTab:
                     event.Enable(true);
                     break;
+                case CommandIds::Menu::ViewToggleShowProfiler:
+                    event.Enable(true);
+                    event.Check(viewOptions().showProfiler());
+                    break;
+                case CommandIds::Menu::ViewToggleRecordProfilerTrace:
+                    event.Enable(true);
+                    event.Check(Utility::Profiler::profiler().tracing());
+                    break;
+                case CommandIds::Menu::ViewSaveProfilerTrace:
+                    event.Enable(Utility::Profiler::profiler().tracing());
+                    break;
             }
         }
 
@@ -22,6 +22,7 @@
 
 #include "Model/BrushTypes.h"
 #include "Model/EntityTypes.h"
+#include "Model/FaceTypes.h"
 #include "Model/TextureTypes.h"
 #include "Utility/VecMath.h"
 #include "View/Animation.h"
@@ -80,6 +81,7 @@ namespace TrenchBroom {
             Vec3f moveDelta(Direction direction, bool snapToGrid);
             
             void submit(wxCommand* command, bool store = true);
+            bool parseClipboard(Model::EntityList& entities, Model::BrushList& brushes, Model::FaceList& faces);
             void pasteObjects(const Model::EntityList& entities, const Model::BrushList& brushes, const Vec3f& delta);
             void moveTextures(Direction direction, bool snapToGrid);
             void rotateTextures(bool clockwise, bool snapToGrid);
@@ -230,6 +232,9 @@ namespace TrenchBroom {
             void OnViewSwitchToEntityInspector(wxCommandEvent& event);
             void OnViewSwitchToFaceInspector(wxCommandEvent& event);
             void OnViewSwitchToViewInspector(wxCommandEvent& event);
+            void OnViewToggleShowProfiler(wxCommandEvent& event);
+            void OnViewToggleRecordProfilerTrace(wxCommandEvent& event);
+            void OnViewSaveProfilerTrace(wxCommandEvent& event);
             
             void OnUpdateMenuItem(wxUpdateUIEvent& event);
             
@@ -98,6 +98,11 @@ namespace TrenchBroom {
             }
         }
         
+        void EntityBrowser::modelsLoaded() {
+            if (m_canvas != NULL && m_canvas->pendingModels())
+                reload();
+        }
+        
         void EntityBrowser::OnSortOrderChanged(wxCommandEvent& event) {
             Model::EntityDefinitionManager::SortOrder sortOrder = event.GetSelection() == 0 ? Model::EntityDefinitionManager::Name : Model::EntityDefinitionManager::Usage;
             m_canvas->setSortOrder(sortOrder);
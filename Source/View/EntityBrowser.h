@@ -49,6 +49,7 @@ namespace TrenchBroom {
             EntityBrowser(wxWindow* parent, wxWindowID windowId, DocumentViewHolder& documentViewHolder);
             
             void reload();
+            void modelsLoaded();
             
             void OnSortOrderChanged(wxCommandEvent& event);
             void OnGroupButtonToggled(wxCommandEvent& event);
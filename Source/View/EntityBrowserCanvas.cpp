@@ -20,10 +20,13 @@
 #include "EntityBrowserCanvas.h"
 
 #include "IO/FileManager.h"
+#include "IO/GameFileSystem.h"
+#include "Model/EntityDefinition.h"
 #include "Model/MapDocument.h"
 #include "Renderer/ApplyMatrix.h"
 #include "Renderer/EntityModelRenderer.h"
 #include "Renderer/EntityModelRendererManager.h"
+#include "Renderer/Palette.h"
 #include "Renderer/RenderUtils.h"
 #include "Renderer/SharedResources.h"
 #include "Renderer/Vbo.h"
@@ -36,6 +39,8 @@
 #include "View/DocumentViewHolder.h"
 #include "View/EditorView.h"
 
+#include <algorithm>
+#include <cmath>
 #include <map>
 
 namespace TrenchBroom {
@@ -50,6 +55,8 @@ namespace TrenchBroom {
                 Renderer::EntityModelRendererManager& modelRendererManager = m_documentViewHolder.document().sharedResources().modelRendererManager();
                 const StringList& searchPaths = m_documentViewHolder.document().searchPaths();
                 Renderer::EntityModelRenderer* modelRenderer = modelRendererManager.modelRenderer(*definition, searchPaths);
+                const bool modelPending = modelRenderer == NULL && modelRendererManager.loading(*definition, searchPaths);
+                m_pendingModels |= modelPending;
 
                 BBoxf rotatedBounds;
                 if (modelRenderer != NULL) {
@@ -63,7 +70,7 @@ namespace TrenchBroom {
                 }
 
                 Vec3f size = rotatedBounds.size();
-                layout.addItem(EntityCellData(definition, modelRenderer, actualFont, rotatedBounds), size.y(), size.z(), actualSize.x(), font.size() + 2.0f);
+                layout.addItem(EntityCellData(definition, modelRenderer, modelPending, actualFont, rotatedBounds), size.y(), size.z(), actualSize.x(), font.size() + 2.0f);
             }
         }
 
@@ -104,6 +111,131 @@ namespace TrenchBroom {
             renderer.render(entityModelProgram);
         }
 
+        void EntityBrowserCanvas::renderThumbnail(const Layout::Group::Row::Cell& cell, const unsigned int width, const unsigned int height) {
+            Preferences::PreferenceManager& prefs = Preferences::PreferenceManager::preferences();
+            Renderer::EntityModelRendererManager& modelRendererManager = m_documentViewHolder.document().sharedResources().modelRendererManager();
+
+            Renderer::ShaderManager& shaderManager = m_documentViewHolder.document().sharedResources().shaderManager();
+            Renderer::ShaderProgram& boundsProgram = shaderManager.shaderProgram(Renderer::Shaders::EdgeShader);
+            Renderer::ShaderProgram& entityModelProgram = shaderManager.shaderProgram(Renderer::Shaders::EntityModelShader);
+
+            m_offscreenRenderer.setDimensions(width, height);
+            m_offscreenRenderer.preRender(); // Scampie's Vista machine crashes here
+
+            const float viewLeft      = 0.0f;
+            const float viewTop       = 0.0f;
+            const float viewRight     = static_cast<float>(width);
+            const float viewBottom    = static_cast<float>(height);
+
+            const Mat4f projection = orthoMatrix(-1024.0f, 1024.0f, viewLeft, viewTop, viewRight, viewBottom);
+            const Mat4f view = viewMatrix(Vec3f::NegX, Vec3f::PosZ) * translationMatrix(Vec3f(256.0f, 0.0f, 0.0f));
+            Renderer::Transformation transformation(projection, view);
+
+            glViewport(0, 0, static_cast<GLsizei>(width), static_cast<GLsizei>(height));
+            glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            glEnable(GL_DEPTH_TEST);
+
+            Renderer::EntityModelRenderer* modelRenderer = cell.item().modelRenderer;
+            if (modelRenderer == NULL) {
+                boundsProgram.activate();
+                Model::PointEntityDefinition* definition = cell.item().entityDefinition;
+                renderEntityBounds(transformation, boundsProgram, *definition, cell.item().bounds, Vec3f::Null, cell.scale());
+                boundsProgram.deactivate();
+            } else {
+                modelRendererManager.activate();
+                entityModelProgram.activate();
+                entityModelProgram.setUniformVariable("ApplyTinting", false);
+                entityModelProgram.setUniformVariable("Brightness", prefs.getFloat(Preferences::RendererBrightness));
+                entityModelProgram.setUniformVariable("GrayScale", false);
+                renderEntityModel(transformation, entityModelProgram, *modelRenderer, cell.item().bounds, Vec3f::Null, cell.scale());
+                entityModelProgram.deactivate();
+                modelRendererManager.deactivate();
+            }
+
+            glDisable(GL_DEPTH_TEST);
+        }
+
+        String EntityBrowserCanvas::thumbnailKey(const Layout::Group::Row::Cell& cell, const unsigned int width, const unsigned int height) const {
+            const Model::PointEntityDefinition& definition = *cell.item().entityDefinition;
+
+            StringStream key;
+            key << definition.name() << " " << width << "x" << height;
+            key << " " << definition.bounds().min.asString() << " " << definition.bounds().max.asString();
+            key << " " << definition.color().asString();
+
+            const Model::ModelDefinition* modelDefinition = definition.model();
+            if (modelDefinition != NULL && cell.item().modelRenderer != NULL)
+                key << " " << modelDefinition->name() << " " << modelDefinition->skinIndex() << " " << modelDefinition->frameIndex();
+            return key.str();
+        }
+
+        const Renderer::ThumbnailAtlas::Slot* EntityBrowserCanvas::thumbnail(const Layout::Group::Row::Cell& cell) {
+            const LayoutBounds& bounds = cell.itemBounds();
+            const unsigned int width = std::max(1u, static_cast<unsigned int>(std::ceil(bounds.width())));
+            const unsigned int height = std::max(1u, static_cast<unsigned int>(std::ceil(bounds.height())));
+            const String key = thumbnailKey(cell, width, height);
+
+            const Renderer::ThumbnailAtlas::Slot* slot = m_thumbnailAtlas->slot(key);
+            if (slot != NULL)
+                return slot;
+
+            // the placeholder for a model that is still loading must not be saved to the cache
+            if (cell.item().modelPending) {
+                std::vector<unsigned char> pixels(width * height * 4);
+                renderThumbnail(cell, width, height);
+                m_offscreenRenderer.readPixels(&pixels[0]);
+                m_offscreenRenderer.postRender();
+                return m_thumbnailAtlas->insert(key, width, height, &pixels[0]);
+            }
+
+            IO::EntityThumbnailCache::Thumbnail& thumbnail = m_thumbnails[key];
+            if (thumbnail.pixels.empty()) {
+                renderThumbnail(cell, width, height);
+                thumbnail.width = width;
+                thumbnail.height = height;
+                thumbnail.pixels.resize(width * height * 4);
+                m_offscreenRenderer.readPixels(&thumbnail.pixels[0]);
+                m_offscreenRenderer.postRender();
+                m_thumbnailsChanged = true;
+            }
+
+            return m_thumbnailAtlas->insert(key, thumbnail.width, thumbnail.height, &thumbnail.pixels[0]);
+        }
+
+        void EntityBrowserCanvas::loadThumbnails() {
+            Preferences::PreferenceManager& prefs = Preferences::PreferenceManager::preferences();
+            Model::MapDocument& document = m_documentViewHolder.document();
+            const StringList& searchPaths = document.searchPaths();
+
+            m_thumbnailBrightness = prefs.getFloat(Preferences::RendererBrightness);
+            m_thumbnailCacheName = Utility::join(searchPaths, "\n");
+
+            // the thumbnails must be rendered again if the palette or any of the game files have changed
+            StringStream key;
+            key << document.sharedResources().palette().checksum();
+            const time_t modificationTime = IO::GameFileSystemManager::sharedManager->fileSystem(searchPaths).modificationTime();
+            key << " " << static_cast<unsigned int>(modificationTime & 0xFFFFFFFF) << " " << static_cast<unsigned int>((modificationTime >> 16) >> 16);
+            key << " " << m_thumbnailBrightness;
+            m_thumbnailCacheKey = key.str();
+
+            m_thumbnails.clear();
+            IO::EntityThumbnailCache cache;
+            cache.read(m_thumbnailCacheName, m_thumbnailCacheKey, m_thumbnails);
+
+            m_thumbnailsValid = true;
+            m_thumbnailsChanged = false;
+        }
+
+        void EntityBrowserCanvas::saveThumbnails() {
+            if (!m_thumbnailsChanged)
+                return;
+
+            IO::EntityThumbnailCache cache;
+            cache.write(m_thumbnailCacheName, m_thumbnailCacheKey, m_thumbnails);
+            m_thumbnailsChanged = false;
+        }
+
         void EntityBrowserCanvas::doInitLayout(Layout& layout) {
             layout.setOuterMargin(5.0f);
             layout.setGroupMargin(5.0f);
@@ -124,6 +256,7 @@ namespace TrenchBroom {
 
             Renderer::Text::FontDescriptor font(fontName, static_cast<unsigned int>(fontSize));
             IO::FileManager fileManager;
+            m_pendingModels = false;
 
             if (m_group) {
                 Model::EntityDefinitionManager::EntityDefinitionGroups groups = definitionManager.groups(Model::EntityDefinition::PointEntity, m_sortOrder);
@@ -149,11 +282,17 @@ namespace TrenchBroom {
         }
 
         void EntityBrowserCanvas::doClear() {
+            // the definitions or models may have changed, the atlas is rebuilt when the canvas is rendered next
+            saveThumbnails();
+            m_thumbnails.clear();
+            m_thumbnailsValid = false;
         }
 
         void EntityBrowserCanvas::doRender(Layout& layout, float y, float height) {
             if (m_vbo == NULL)
                 m_vbo = new Renderer::Vbo(GL_ARRAY_BUFFER, 0xFFFF);
+            if (m_thumbnailAtlas == NULL)
+                m_thumbnailAtlas = new Renderer::ThumbnailAtlas();
 
             Renderer::ShaderManager& shaderManager = m_documentViewHolder.document().sharedResources().shaderManager();
             Renderer::Text::FontManager& fontManager = m_documentViewHolder.document().sharedResources().fontManager();
@@ -162,25 +301,22 @@ namespace TrenchBroom {
             Renderer::Text::FontDescriptor defaultDescriptor(prefs.getString(Preferences::RendererFontName),
                                                              static_cast<unsigned int>(prefs.getInt(Preferences::TextureBrowserFontSize)));
 
-            Renderer::EntityModelRendererManager& modelRendererManager = m_documentViewHolder.document().sharedResources().modelRendererManager();
-
-            glEnable(GL_BLEND);
-            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-            glEnable(GL_DEPTH_TEST);
-
-            const float viewLeft      = static_cast<float>(GetClientRect().GetLeft());
-            const float viewTop       = static_cast<float>(GetClientRect().GetBottom());
-            const float viewRight     = static_cast<float>(GetClientRect().GetRight());
-            const float viewBottom    = static_cast<float>(GetClientRect().GetTop());
+            if (!m_thumbnailsValid || prefs.getFloat(Preferences::RendererBrightness) != m_thumbnailBrightness) {
+                saveThumbnails();
+                m_thumbnailAtlas->clear();
+                loadThumbnails();
+            }
 
-            const Mat4f projection = orthoMatrix(-1024.0f, 1024.0f, viewLeft, viewTop, viewRight, viewBottom);
-            Renderer::Transformation transformation(projection, viewMatrix(Vec3f::NegX, Vec3f::PosZ) * translationMatrix(Vec3f(256.0f, 0.0f, 0.0f)));
+            // thumbnails are rendered into the offscreen buffer, which changes the viewport
+            GLint viewport[4];
+            glGetIntegerv(GL_VIEWPORT, viewport);
 
             size_t visibleGroupCount = 0;
-            size_t visibleItemCount = 0;
 
             typedef std::map<Renderer::Text::FontDescriptor, Vec2f::List> StringMap;
+            typedef std::vector<Vec2f::List> ThumbnailVertices;
             StringMap stringVertices;
+            ThumbnailVertices thumbnailVertices;
 
             for (unsigned int i = 0; i < layout.size(); i++) {
                 const Layout::Group& group = layout[i];
@@ -198,85 +334,86 @@ namespace TrenchBroom {
                         vertices.insert(vertices.end(), titleVertices.begin(), titleVertices.end());
                     }
 
-                    for (unsigned int j = 0; j < group.size(); j++) {
+                    for (size_t j = group.indexOfRowAt(y); j < group.size(); j++) {
                         const Layout::Group::Row& row = group[j];
-                        if (row.intersectsY(y, height)) {
-                            for (unsigned int k = 0; k < row.size(); k++) {
-                                visibleItemCount++;
-
-                                const Layout::Group::Row::Cell& cell = row[k];
-                                const LayoutBounds titleBounds = cell.titleBounds();
-                                const Vec2f offset(titleBounds.left(), height - (titleBounds.top() - y) - titleBounds.height());
-
-                                Renderer::Text::TexturedFont* font = fontManager.font(cell.item().fontDescriptor);
-                                Vec2f::List titleVertices = font->quads(cell.item().entityDefinition->name(), false, offset);
-                                Vec2f::List& vertices = stringVertices[cell.item().fontDescriptor];
-                                vertices.insert(vertices.end(), titleVertices.begin(), titleVertices.end());
+                        if (row.bounds().top() > y + height)
+                            break;
+                        for (unsigned int k = 0; k < row.size(); k++) {
+                            const Layout::Group::Row::Cell& cell = row[k];
+                            const LayoutBounds titleBounds = cell.titleBounds();
+                            const Vec2f offset(titleBounds.left(), height - (titleBounds.top() - y) - titleBounds.height());
+
+                            Renderer::Text::TexturedFont* font = fontManager.font(cell.item().fontDescriptor);
+                            Vec2f::List titleVertices = font->quads(cell.item().entityDefinition->name(), false, offset);
+                            Vec2f::List& vertices = stringVertices[cell.item().fontDescriptor];
+                            vertices.insert(vertices.end(), titleVertices.begin(), titleVertices.end());
+
+                            const Renderer::ThumbnailAtlas::Slot* slot = thumbnail(cell);
+                            if (slot != NULL) {
+                                if (thumbnailVertices.size() <= slot->page)
+                                    thumbnailVertices.resize(slot->page + 1);
+
+                                // align the quads with the pixel grid so that the thumbnails are not resampled
+                                const LayoutBounds& itemBounds = cell.itemBounds();
+                                const float left = std::floor(itemBounds.left() + 0.5f);
+                                const float bottom = std::floor(height - (itemBounds.bottom() - y) + 0.5f);
+                                const float right = left + static_cast<float>(slot->width);
+                                const float top = bottom + static_cast<float>(slot->height);
+
+                                Vec2f::List& quads = thumbnailVertices[slot->page];
+                                quads.push_back(Vec2f(left, bottom));
+                                quads.push_back(Vec2f(slot->s0, slot->t0));
+                                quads.push_back(Vec2f(left, top));
+                                quads.push_back(Vec2f(slot->s0, slot->t1));
+                                quads.push_back(Vec2f(right, top));
+                                quads.push_back(Vec2f(slot->s1, slot->t1));
+                                quads.push_back(Vec2f(right, bottom));
+                                quads.push_back(Vec2f(slot->s1, slot->t0));
                             }
                         }
                     }
                 }
             }
 
-            { // render bounds
-                Renderer::ActivateShader shader(shaderManager, Renderer::Shaders::EdgeShader);
-                for (unsigned int i = 0; i < layout.size(); i++) {
-                    const Layout::Group& group = layout[i];
-                    if (group.intersectsY(y, height)) {
-                        for (unsigned int j = 0; j < group.size(); j++) {
-                            const Layout::Group::Row& row = group[j];
-                            if (row.intersectsY(y, height)) {
-                                for (unsigned int k = 0; k < row.size(); k++) {
-                                    const Layout::Group::Row::Cell& cell = row[k];
-                                    Model::PointEntityDefinition* definition = cell.item().entityDefinition;
-                                    Renderer::EntityModelRenderer* modelRenderer = cell.item().modelRenderer;
-                                    if (modelRenderer == NULL)
-                                        renderEntityBounds(transformation,
-                                                           shader.currentShader(),
-                                                           *definition,
-                                                           cell.item().bounds, Vec3f(0.0f, cell.itemBounds().left(), height - (cell.itemBounds().bottom() - y)),
-                                                           cell.scale());
-                                }
-                            }
-                        }
-                    }
-                }
-            }
+            glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+            glEnable(GL_BLEND);
+            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+            glDisable(GL_DEPTH_TEST);
+
+            const float viewLeft      = static_cast<float>(GetClientRect().GetLeft());
+            const float viewTop       = static_cast<float>(GetClientRect().GetBottom());
+            const float viewRight     = static_cast<float>(GetClientRect().GetRight());
+            const float viewBottom    = static_cast<float>(GetClientRect().GetTop());
+
+            const Mat4f projection = orthoMatrix(-1024.0f, 1024.0f, viewLeft, viewTop, viewRight, viewBottom);
+            Renderer::Transformation transformation(projection, viewMatrix(Vec3f::NegZ, Vec3f::PosY) * translationMatrix(Vec3f(0.0f, 0.0f, -1.0f)));
+
+            for (size_t i = 0; i < thumbnailVertices.size(); i++) { // render thumbnails
+                const Vec2f::List& vertices = thumbnailVertices[i];
+                if (vertices.empty())
+                    continue;
+
+                unsigned int vertexCount = static_cast<unsigned int>(vertices.size() / 2);
+                Renderer::VertexArray vertexArray(*m_vbo, GL_QUADS, vertexCount,
+                                                  Renderer::Attribute::position2f(),
+                                                  Renderer::Attribute::texCoord02f(), 0);
+
+                Renderer::SetVboState mapVbo(*m_vbo, Renderer::Vbo::VboMapped);
+                vertexArray.addAttributes(vertices);
 
-            { // render models
-                Renderer::ActivateShader shader(shaderManager, Renderer::Shaders::EntityModelShader);
+                // the brightness has already been applied when the thumbnails were rendered
+                Renderer::SetVboState activateVbo(*m_vbo, Renderer::Vbo::VboActive);
+                Renderer::ActivateShader shader(shaderManager, Renderer::Shaders::TextureBrowserShader);
                 shader.setUniformVariable("ApplyTinting", false);
-                shader.setUniformVariable("Brightness", prefs.getFloat(Preferences::RendererBrightness));
+                shader.setUniformVariable("Brightness", 1.0f);
                 shader.setUniformVariable("GrayScale", false);
+                shader.setUniformVariable("Texture", 0);
 
-                modelRendererManager.activate();
-                for (unsigned int i = 0; i < layout.size(); i++) {
-                    const Layout::Group& group = layout[i];
-                    if (group.intersectsY(y, height)) {
-                        for (unsigned int j = 0; j < group.size(); j++) {
-                            const Layout::Group::Row& row = group[j];
-                            if (row.intersectsY(y, height)) {
-                                for (unsigned int k = 0; k < row.size(); k++) {
-                                    const Layout::Group::Row::Cell& cell = row[k];
-                                    Renderer::EntityModelRenderer* modelRenderer = cell.item().modelRenderer;
-                                    if (modelRenderer != NULL)
-                                        renderEntityModel(transformation,
-                                                          shader.currentShader(),
-                                                          *modelRenderer,
-                                                          cell.item().bounds,
-                                                          Vec3f(0.0f, cell.itemBounds().left(), height - (cell.itemBounds().bottom() - y)),
-                                                          cell.scale());
-                                }
-                            }
-                        }
-                    }
-                }
-                modelRendererManager.deactivate();
+                m_thumbnailAtlas->activate(i);
+                vertexArray.render();
+                m_thumbnailAtlas->deactivate();
             }
 
-            glDisable(GL_DEPTH_TEST);
-            transformation = Renderer::Transformation(projection, viewMatrix(Vec3f::NegZ, Vec3f::PosY) * translationMatrix(Vec3f(0.0f, 0.0f, -1.0f)));
-
             if (visibleGroupCount > 0) { // render group title background
                 unsigned int vertexCount = static_cast<unsigned int>(4 * visibleGroupCount);
                 Renderer::VertexArray vertexArray(*m_vbo, GL_QUADS, vertexCount,
@@ -339,46 +476,7 @@ namespace TrenchBroom {
 
             unsigned int width = static_cast<unsigned int>(bounds.width());
             unsigned int height = static_cast<unsigned int>(bounds.height());
-
-            Preferences::PreferenceManager& prefs = Preferences::PreferenceManager::preferences();
-            Renderer::EntityModelRendererManager& modelRendererManager = m_documentViewHolder.document().sharedResources().modelRendererManager();
-
-            Renderer::ShaderManager& shaderManager = m_documentViewHolder.document().sharedResources().shaderManager();
-            Renderer::ShaderProgram& boundsProgram = shaderManager.shaderProgram(Renderer::Shaders::EdgeShader);
-            Renderer::ShaderProgram& entityModelProgram = shaderManager.shaderProgram(Renderer::Shaders::EntityModelShader);
-
-            m_offscreenRenderer.setDimensions(width, height);
-            m_offscreenRenderer.preRender(); // Scampie's Vista machine crashes here
-
-            const float viewLeft      = 0.0f;
-            const float viewTop       = 0.0f;
-            const float viewRight     = bounds.width();
-            const float viewBottom    = bounds.height();
-
-            const Mat4f projection = orthoMatrix(-1024.0f, 1024.0f, viewLeft, viewTop, viewRight, viewBottom);
-            const Mat4f view = viewMatrix(Vec3f::NegX, Vec3f::PosZ) * translationMatrix(Vec3f(256.0f, 0.0f, 0.0f));
-            Renderer::Transformation transformation(projection, view);
-
-            glViewport(0, 0, static_cast<GLsizei>(width), static_cast<GLsizei>(height));
-            glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
-            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-            glEnable(GL_DEPTH_TEST);
-
-            Renderer::EntityModelRenderer* modelRenderer = cell.item().modelRenderer;
-            if (modelRenderer == NULL) {
-                boundsProgram.activate();
-                Model::PointEntityDefinition* definition = cell.item().entityDefinition;
-                renderEntityBounds(transformation, boundsProgram, *definition, cell.item().bounds, Vec3f::Null, cell.scale());
-                boundsProgram.deactivate();
-            } else {
-                modelRendererManager.activate();
-                entityModelProgram.activate();
-                entityModelProgram.setUniformVariable("ApplyTinting", false);
-                entityModelProgram.setUniformVariable("Brightness", prefs.getFloat(Preferences::RendererBrightness));
-                renderEntityModel(transformation, entityModelProgram, *modelRenderer, cell.item().bounds, Vec3f::Null, cell.scale());
-                entityModelProgram.deactivate();
-                modelRendererManager.deactivate();
-            }
+            renderThumbnail(cell, width, height);
 
             glPixelStorei(GL_PACK_ALIGNMENT, 1);
             glPixelStorei(GL_PACK_ROW_LENGTH, 0);
@@ -400,6 +498,11 @@ namespace TrenchBroom {
         m_documentViewHolder(documentViewHolder),
         m_offscreenRenderer(m_documentViewHolder.document().sharedResources().multisample(), m_documentViewHolder.document().sharedResources().samples()),
         m_vbo(NULL),
+        m_thumbnailAtlas(NULL),
+        m_thumbnailBrightness(1.0f),
+        m_thumbnailsValid(false),
+        m_thumbnailsChanged(false),
+        m_pendingModels(false),
         m_group(false),
         m_hideUnused(false),
         m_sortOrder(Model::EntityDefinitionManager::Name) {
@@ -410,6 +513,8 @@ namespace TrenchBroom {
 
         EntityBrowserCanvas::~EntityBrowserCanvas() {
             clear();
+            delete m_thumbnailAtlas;
+            m_thumbnailAtlas = NULL;
             delete m_vbo;
             m_vbo = NULL;
         }
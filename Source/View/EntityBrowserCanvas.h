@@ -20,8 +20,10 @@
 #ifndef __TrenchBroom__EntityBrowserCanvas__
 #define __TrenchBroom__EntityBrowserCanvas__
 
+#include "IO/EntityThumbnailCache.h"
 #include "Model/EntityDefinitionManager.h"
 #include "Renderer/OffscreenRenderer.h"
+#include "Renderer/ThumbnailAtlas.h"
 #include "Renderer/Shader/Shader.h"
 #include "Utility/String.h"
 #include "Utility/VecMath.h"
@@ -49,12 +51,14 @@ namespace TrenchBroom {
         public:
             Model::PointEntityDefinition* entityDefinition;
             Renderer::EntityModelRenderer* modelRenderer;
+            bool modelPending;
             Renderer::Text::FontDescriptor fontDescriptor;
             BBoxf bounds;
 
-            EntityCellData(Model::PointEntityDefinition* i_entityDefinition, Renderer::EntityModelRenderer* i_modelRenderer, const Renderer::Text::FontDescriptor& i_fontDescriptor, const BBoxf& i_bounds) :
+            EntityCellData(Model::PointEntityDefinition* i_entityDefinition, Renderer::EntityModelRenderer* i_modelRenderer, bool i_modelPending, const Renderer::Text::FontDescriptor& i_fontDescriptor, const BBoxf& i_bounds) :
             entityDefinition(i_entityDefinition),
             modelRenderer(i_modelRenderer),
+            modelPending(i_modelPending),
             fontDescriptor(i_fontDescriptor),
             bounds(i_bounds) {}
         };
@@ -66,6 +70,17 @@ namespace TrenchBroom {
             Renderer::Vbo* m_vbo;
             Quatf m_rotation;
 
+            // every definition is rendered once into the atlas, scrolling only draws textured quads
+            Renderer::ThumbnailAtlas* m_thumbnailAtlas;
+            IO::EntityThumbnailCache::ThumbnailMap m_thumbnails;
+            String m_thumbnailCacheName;
+            String m_thumbnailCacheKey;
+            float m_thumbnailBrightness;
+            bool m_thumbnailsValid;
+            bool m_thumbnailsChanged;
+            // set if a cell shows the bounds of a model that is still loading in the background
+            bool m_pendingModels;
+
             bool m_group;
             bool m_hideUnused;
             Model::EntityDefinitionManager::SortOrder m_sortOrder;
@@ -74,6 +89,12 @@ namespace TrenchBroom {
             void addEntityToLayout(Layout& layout, Model::PointEntityDefinition* definition, const Renderer::Text::FontDescriptor& font);
             void renderEntityBounds(Renderer::Transformation& transformation, Renderer::ShaderProgram& boundsProgram, const Model::PointEntityDefinition& definition, const BBoxf& rotatedBounds, const Vec3f& offset, float scaling);
             void renderEntityModel(Renderer::Transformation& transformation, Renderer::ShaderProgram& entityModelProgram, Renderer::EntityModelRenderer& renderer, const BBoxf& rotatedBounds, const Vec3f& offset, float scaling);
+            void renderThumbnail(const Layout::Group::Row::Cell& cell, unsigned int width, unsigned int height);
+
+            String thumbnailKey(const Layout::Group::Row::Cell& cell, unsigned int width, unsigned int height) const;
+            const Renderer::ThumbnailAtlas::Slot* thumbnail(const Layout::Group::Row::Cell& cell);
+            void loadThumbnails();
+            void saveThumbnails();
 
             virtual void doInitLayout(Layout& layout);
             virtual void doReloadLayout(Layout& layout);
@@ -86,6 +107,10 @@ namespace TrenchBroom {
             EntityBrowserCanvas(wxWindow* parent, wxWindowID windowId, wxScrollBar* scrollBar, DocumentViewHolder& documentViewHolder);
             ~EntityBrowserCanvas();
 
+            inline bool pendingModels() const {
+                return m_pendingModels;
+            }
+
             inline void setSortOrder(Model::EntityDefinitionManager::SortOrder sortOrder) {
                 if (sortOrder == m_sortOrder)
                     return;
@@ -30,6 +30,7 @@
 
 #include "TrenchBroomApp.h"
 #include "Controller/PreferenceChangeEvent.h"
+#include "Model/BrushGeometry.h"
 #include "Utility/Preferences.h"
 #include "Utility/String.h"
 #include "View/CommandIds.h"
@@ -43,6 +44,7 @@ namespace TrenchBroom {
 
         BEGIN_EVENT_TABLE(GeneralPreferencePane, wxPanel)
         EVT_BUTTON(CommandIds::GeneralPreferencePane::ChooseQuakePathButtonId, GeneralPreferencePane::OnChooseQuakePathClicked)
+        EVT_CHECKBOX(CommandIds::GeneralPreferencePane::DoublePrecisionPlanesCheckBoxId, GeneralPreferencePane::OnDoublePrecisionPlanesChanged)
 
         EVT_COMMAND_SCROLL(CommandIds::GeneralPreferencePane::BrightnessSliderId, GeneralPreferencePane::OnViewSliderChanged)
         EVT_COMMAND_SCROLL(CommandIds::GeneralPreferencePane::GridAlphaSliderId, GeneralPreferencePane::OnViewSliderChanged)
@@ -69,6 +71,7 @@ namespace TrenchBroom {
             Preferences::PreferenceManager& prefs = Preferences::PreferenceManager::preferences();
 
             m_quakePathValueLabel->SetLabel(prefs.getString(Preferences::QuakePath));
+            m_doublePrecisionPlanesCheckBox->SetValue(prefs.getBool(Preferences::GeometryDoublePrecisionPlanes));
 
             m_brightnessSlider->SetValue(static_cast<int>(prefs.getFloat(Preferences::RendererBrightness) * 40.0f));
             m_gridAlphaSlider->SetValue(static_cast<int>(prefs.getFloat(Preferences::GridAlpha) * m_gridAlphaSlider->GetMax()));
@@ -135,6 +138,27 @@ namespace TrenchBroom {
             return quakeBox;
         }
 
+        wxWindow* GeneralPreferencePane::createGeometryPreferences() {
+            wxStaticBox* geometryBox = new wxStaticBox(this, wxID_ANY, wxT("Brush Geometry"));
+
+            wxStaticText* planesLabel = new wxStaticText(geometryBox, wxID_ANY, wxT("Face Planes"));
+            m_doublePrecisionPlanesCheckBox = new wxCheckBox(geometryBox, CommandIds::GeneralPreferencePane::DoublePrecisionPlanesCheckBoxId, wxT("Compute in double precision"));
+
+            wxFlexGridSizer* innerSizer = new wxFlexGridSizer(2, LayoutConstants::ControlHorizontalMargin, LayoutConstants::ControlVerticalMargin);
+            innerSizer->AddGrowableCol(1);
+            innerSizer->Add(planesLabel, 0, wxALIGN_CENTER_VERTICAL);
+            innerSizer->Add(m_doublePrecisionPlanesCheckBox, 0, wxALIGN_CENTER_VERTICAL);
+            innerSizer->SetItemMinSize(planesLabel, GeneralPreferencePaneLayout::MinimumLabelWidth, wxDefaultSize.y);
+
+            wxSizer* outerSizer = new wxBoxSizer(wxVERTICAL);
+            outerSizer->AddSpacer(LayoutConstants::StaticBoxTopMargin);
+            outerSizer->Add(innerSizer, 0, wxEXPAND | wxLEFT | wxRIGHT, LayoutConstants::StaticBoxSideMargin);
+            outerSizer->AddSpacer(LayoutConstants::StaticBoxBottomMargin);
+
+            geometryBox->SetSizerAndFit(outerSizer);
+            return geometryBox;
+        }
+
         wxWindow* GeneralPreferencePane::createViewPreferences() {
             wxStaticBox* viewBox = new wxStaticBox(this, wxID_ANY, wxT("View"));
 
@@ -264,12 +288,15 @@ namespace TrenchBroom {
         GeneralPreferencePane::GeneralPreferencePane(wxWindow* parent) :
         PreferencePane(parent) {
             wxWindow* quakePreferences = createQuakePreferences();
+            wxWindow* geometryPreferences = createGeometryPreferences();
             wxWindow* viewPreferences = createViewPreferences();
             wxWindow* mousePreferences = createMousePreferences();
 
             wxSizer* innerSizer = new wxBoxSizer(wxVERTICAL);
             innerSizer->Add(quakePreferences, 0, wxEXPAND);
             innerSizer->AddSpacer(LayoutConstants::ControlVerticalMargin);
+            innerSizer->Add(geometryPreferences, 0, wxEXPAND);
+            innerSizer->AddSpacer(LayoutConstants::ControlVerticalMargin);
             innerSizer->Add(viewPreferences, 0, wxEXPAND);
             innerSizer->AddSpacer(LayoutConstants::ControlVerticalMargin);
             innerSizer->Add(mousePreferences, 0, wxEXPAND);
@@ -297,6 +324,17 @@ namespace TrenchBroom {
             }
         }
 
+        void GeneralPreferencePane::OnDoublePrecisionPlanesChanged(wxCommandEvent& event) {
+            bool doublePrecisionPlanes = event.GetInt() != 0;
+
+            Preferences::PreferenceManager& prefs = Preferences::PreferenceManager::preferences();
+            prefs.setBool(Preferences::GeometryDoublePrecisionPlanes, doublePrecisionPlanes);
+            Model::BrushGeometry::doublePrecisionPlanes = doublePrecisionPlanes;
+
+            Controller::PreferenceChangeEvent preferenceChangeEvent(Preferences::GeometryDoublePrecisionPlanes);
+            static_cast<TrenchBroomApp*>(wxTheApp)->UpdateAllViews(NULL, &preferenceChangeEvent);
+        }
+
         void GeneralPreferencePane::OnViewSliderChanged(wxScrollEvent& event) {
             wxSlider* sender = static_cast<wxSlider*>(event.GetEventObject());
             int value = sender->GetValue();
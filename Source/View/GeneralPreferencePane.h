@@ -36,6 +36,7 @@ namespace TrenchBroom {
         class GeneralPreferencePane : public PreferencePane {
         private:
             wxStaticText* m_quakePathValueLabel;
+            wxCheckBox* m_doublePrecisionPlanesCheckBox;
             wxSlider* m_brightnessSlider;
             wxSlider* m_gridAlphaSlider;
             wxChoice* m_gridModeChoice;
@@ -55,6 +56,7 @@ namespace TrenchBroom {
             void updateControls();
             
             wxWindow* createQuakePreferences();
+            wxWindow* createGeometryPreferences();
             wxWindow* createViewPreferences();
             wxWindow* createMousePreferences();
         public:
@@ -63,6 +65,7 @@ namespace TrenchBroom {
             bool validate();
 
             void OnChooseQuakePathClicked(wxCommandEvent& event);
+            void OnDoublePrecisionPlanesChanged(wxCommandEvent& event);
             void OnViewSliderChanged(wxScrollEvent& event);
             void OnGridModeChoice(wxCommandEvent& event);
             void OnInstancingModeChoice(wxCommandEvent& event);
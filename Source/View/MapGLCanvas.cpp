@@ -33,6 +33,7 @@
 #include "Model/Filter.h"
 #include "Utility/Console.h"
 #include "Utility/Preferences.h"
+#include "Utility/Profiler.h"
 #include "Utility/VecMath.h"
 #include "View/DocumentViewHolder.h"
 #include "View/EditorFrame.h"
@@ -230,7 +231,7 @@ namespace TrenchBroom {
 
                 // render overlays
                 if (m_overlayRenderer == NULL)
-                    m_overlayRenderer = new Renderer::OverlayRenderer();
+                    m_overlayRenderer = new Renderer::OverlayRenderer(m_documentViewHolder.document().sharedResources().fontManager());
                 m_overlayRenderer->render(renderContext, GetClientSize().x, GetClientSize().y);
 
                 // render focus rectangle
@@ -290,6 +291,7 @@ namespace TrenchBroom {
                 }
 
 				SwapBuffers();
+                PROFILE_END_FRAME();
 			} else {
 				view.console().error("Unable to set current OpenGL context");
 			}
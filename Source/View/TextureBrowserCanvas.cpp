@@ -46,6 +46,43 @@ using namespace TrenchBroom::VecMath;
 
 namespace TrenchBroom {
     namespace View {
+        void TextureBrowserCanvas::validateTextureQuads(Layout& layout) {
+            if (m_textureQuads != NULL && m_textureQuadsGeneration == layout.generation())
+                return;
+
+            delete m_textureQuads;
+            m_textureQuads = NULL;
+            m_textureQuadsGeneration = layout.generation();
+
+            const size_t cellCount = layout.cellCount();
+            if (cellCount == 0)
+                return;
+
+            // the quads are kept in layout coordinates with the y axis flipped and moved into view when rendering
+            m_textureQuads = new Renderer::VertexArray(*m_vbo, GL_QUADS, 4 * cellCount,
+                                                       Renderer::Attribute::position2f(),
+                                                       Renderer::Attribute::texCoord02f(), 0);
+
+            Renderer::SetVboState mapVbo(*m_vbo, Renderer::Vbo::VboMapped);
+            for (unsigned int i = 0; i < layout.size(); i++) {
+                const Layout::Group& group = layout[i];
+                for (unsigned int j = 0; j < group.size(); j++) {
+                    const Layout::Group::Row& row = group[j];
+                    for (unsigned int k = 0; k < row.size(); k++) {
+                        const LayoutBounds& bounds = row[k].itemBounds();
+                        m_textureQuads->addAttribute(Vec2f(bounds.left(), -bounds.top()));
+                        m_textureQuads->addAttribute(Vec2f(0.0f, 0.0f));
+                        m_textureQuads->addAttribute(Vec2f(bounds.left(), -bounds.bottom()));
+                        m_textureQuads->addAttribute(Vec2f(0.0f, 1.0f));
+                        m_textureQuads->addAttribute(Vec2f(bounds.right(), -bounds.bottom()));
+                        m_textureQuads->addAttribute(Vec2f(1.0f, 1.0f));
+                        m_textureQuads->addAttribute(Vec2f(bounds.right(), -bounds.top()));
+                        m_textureQuads->addAttribute(Vec2f(1.0f, 0.0f));
+                    }
+                }
+            }
+        }
+
         void TextureBrowserCanvas::addTextureToLayout(Layout& layout, Model::Texture* texture, const Renderer::Text::FontDescriptor& font) {
             if ((!m_hideUnused || texture->usageCount() > 0) && (m_filterText.empty() || Utility::containsString(texture->name(), m_filterText, false))) {
                 Renderer::Text::FontManager& fontManager =  m_documentViewHolder.document().sharedResources().fontManager();
@@ -58,9 +95,7 @@ namespace TrenchBroom {
                 const unsigned int scaledTextureWidth = static_cast<unsigned int>(Math<float>::round(scaleFactor * static_cast<float>(texture->width())));
                 const unsigned int scaledTextureHeight = static_cast<unsigned int>(Math<float>::round(scaleFactor * static_cast<float>(texture->height())));
 
-                Renderer::TextureRendererManager& textureRendererManager = m_documentViewHolder.document().sharedResources().textureRendererManager();
-                Renderer::TextureRenderer& textureRenderer = textureRendererManager.renderer(texture);
-                layout.addItem(TextureCellData(texture, &textureRenderer, actualFont), scaledTextureWidth, scaledTextureHeight, actualSize.x(), font.size() + 2.0f);
+                layout.addItem(TextureCellData(texture, actualFont), scaledTextureWidth, scaledTextureHeight, actualSize.x(), font.size() + 2.0f);
             }
         }
 
@@ -156,21 +191,21 @@ namespace TrenchBroom {
                         vertices.insert(vertices.end(), titleVertices.begin(), titleVertices.end());
                     }
 
-                    for (unsigned int j = 0; j < group.size(); j++) {
+                    for (size_t j = group.indexOfRowAt(y); j < group.size(); j++) {
                         const Layout::Group::Row& row = group[j];
-                        if (row.intersectsY(y, height)) {
-                            for (unsigned int k = 0; k < row.size(); k++) {
-                                visibleItemCount++;
-
-                                const Layout::Group::Row::Cell& cell = row[k];
-                                const LayoutBounds titleBounds = cell.titleBounds();
-                                const Vec2f offset(titleBounds.left() + 2.0f, height - (titleBounds.top() - y) - titleBounds.height());
-
-                                Renderer::Text::TexturedFont* font = fontManager.font(cell.item().fontDescriptor);
-                                Vec2f::List titleVertices = font->quads(cell.item().texture->name(), false, offset);
-                                Vec2f::List& vertices = stringVertices[cell.item().fontDescriptor];
-                                vertices.insert(vertices.end(), titleVertices.begin(), titleVertices.end());
-                            }
+                        if (row.bounds().top() > y + height)
+                            break;
+                        for (unsigned int k = 0; k < row.size(); k++) {
+                            visibleItemCount++;
+
+                            const Layout::Group::Row::Cell& cell = row[k];
+                            const LayoutBounds titleBounds = cell.titleBounds();
+                            const Vec2f offset(titleBounds.left() + 2.0f, height - (titleBounds.top() - y) - titleBounds.height());
+
+                            Renderer::Text::TexturedFont* font = fontManager.font(cell.item().fontDescriptor);
+                            Vec2f::List titleVertices = font->quads(cell.item().texture->name(), false, offset);
+                            Vec2f::List& vertices = stringVertices[cell.item().fontDescriptor];
+                            vertices.insert(vertices.end(), titleVertices.begin(), titleVertices.end());
                         }
                     }
                 }
@@ -186,28 +221,28 @@ namespace TrenchBroom {
                 for (unsigned int i = 0; i < layout.size(); i++) {
                     const Layout::Group& group = layout[i];
                     if (group.intersectsY(y, height)) {
-                        for (unsigned int j = 0; j < group.size(); j++) {
+                        for (size_t j = group.indexOfRowAt(y); j < group.size(); j++) {
                             const Layout::Group::Row& row = group[j];
-                            if (row.intersectsY(y, height)) {
-                                for (unsigned int k = 0; k < row.size(); k++) {
-                                    const Layout::Group::Row::Cell& cell = row[k];
-
-                                    bool selected = cell.item().texture == m_selectedTexture;
-                                    bool inUse = cell.item().texture->usageCount() > 0;
-                                    bool overridden = cell.item().texture->overridden();
-
-                                    if (selected || inUse || overridden) {
-                                        const Color& color = selected ? prefs.getColor(Preferences::SelectedTextureColor) : (inUse ? prefs.getColor(Preferences::UsedTextureColor) : prefs.getColor(Preferences::OverriddenTextureColor));
-
-                                        vertexArray.addAttribute(Vec2f(cell.itemBounds().left() - 1.5f, height - (cell.itemBounds().top() - 1.5f - y)));
-                                        vertexArray.addAttribute(color);
-                                        vertexArray.addAttribute(Vec2f(cell.itemBounds().left() - 1.5f, height - (cell.itemBounds().bottom() + 1.5f - y)));
-                                        vertexArray.addAttribute(color);
-                                        vertexArray.addAttribute(Vec2f(cell.itemBounds().right() + 1.5f, height - (cell.itemBounds().bottom() + 1.5f - y)));
-                                        vertexArray.addAttribute(color);
-                                        vertexArray.addAttribute(Vec2f(cell.itemBounds().right() + 1.5f, height - (cell.itemBounds().top() - 1.5f - y)));
-                                        vertexArray.addAttribute(color);
-                                    }
+                            if (row.bounds().top() > y + height)
+                                break;
+                            for (unsigned int k = 0; k < row.size(); k++) {
+                                const Layout::Group::Row::Cell& cell = row[k];
+
+                                bool selected = cell.item().texture == m_selectedTexture;
+                                bool inUse = cell.item().texture->usageCount() > 0;
+                                bool overridden = cell.item().texture->overridden();
+
+                                if (selected || inUse || overridden) {
+                                    const Color& color = selected ? prefs.getColor(Preferences::SelectedTextureColor) : (inUse ? prefs.getColor(Preferences::UsedTextureColor) : prefs.getColor(Preferences::OverriddenTextureColor));
+
+                                    vertexArray.addAttribute(Vec2f(cell.itemBounds().left() - 1.5f, height - (cell.itemBounds().top() - 1.5f - y)));
+                                    vertexArray.addAttribute(color);
+                                    vertexArray.addAttribute(Vec2f(cell.itemBounds().left() - 1.5f, height - (cell.itemBounds().bottom() + 1.5f - y)));
+                                    vertexArray.addAttribute(color);
+                                    vertexArray.addAttribute(Vec2f(cell.itemBounds().right() + 1.5f, height - (cell.itemBounds().bottom() + 1.5f - y)));
+                                    vertexArray.addAttribute(color);
+                                    vertexArray.addAttribute(Vec2f(cell.itemBounds().right() + 1.5f, height - (cell.itemBounds().top() - 1.5f - y)));
+                                    vertexArray.addAttribute(color);
                                 }
                             }
                         }
@@ -219,37 +254,37 @@ namespace TrenchBroom {
                 vertexArray.render();
             }
 
-            { // render textures
+            validateTextureQuads(layout);
+            if (m_textureQuads != NULL) { // render textures
+                Renderer::TextureRendererManager& textureRendererManager = m_documentViewHolder.document().sharedResources().textureRendererManager();
+
+                Renderer::SetVboState activateVbo(*m_vbo, Renderer::Vbo::VboActive);
+                Renderer::ApplyModelMatrix scroll(transformation, translationMatrix(Vec3f(0.0f, height + y, 0.0f)));
                 Renderer::ActivateShader shader(shaderManager, Renderer::Shaders::TextureBrowserShader);
                 shader.setUniformVariable("ApplyTinting", false);
                 shader.setUniformVariable("Brightness", prefs.getFloat(Preferences::RendererBrightness));
+
+                m_textureQuads->setup();
                 for (unsigned int i = 0; i < layout.size(); i++) {
                     const Layout::Group& group = layout[i];
                     if (group.intersectsY(y, height)) {
-                        for (unsigned int j = 0; j < group.size(); j++) {
+                        for (size_t j = group.indexOfRowAt(y); j < group.size(); j++) {
                             const Layout::Group::Row& row = group[j];
-                            if (row.intersectsY(y, height)) {
-                                for (unsigned int k = 0; k < row.size(); k++) {
-                                    const Layout::Group::Row::Cell& cell = row[k];
-                                    shader.setUniformVariable("GrayScale", cell.item().texture->overridden());
-                                    shader.setUniformVariable("Texture", 0);
-                                    cell.item().textureRenderer->activate();
-                                    glBegin(GL_QUADS);
-                                    glTexCoord2f(0.0f, 0.0f);
-                                    glVertex2f(cell.itemBounds().left(), height - (cell.itemBounds().top() - y));
-                                    glTexCoord2f(0.0f, 1.0f);
-                                    glVertex2f(cell.itemBounds().left(), height - (cell.itemBounds().bottom() - y));
-                                    glTexCoord2f(1.0f, 1.0f);
-                                    glVertex2f(cell.itemBounds().right(), height - (cell.itemBounds().bottom() - y));
-                                    glTexCoord2f(1.0f, 0.0f);
-                                    glVertex2f(cell.itemBounds().right(), height - (cell.itemBounds().top() - y));
-                                    glEnd();
-                                    cell.item().textureRenderer->deactivate();
-                                }
+                            if (row.bounds().top() > y + height)
+                                break;
+                            for (unsigned int k = 0; k < row.size(); k++) {
+                                const Layout::Group::Row::Cell& cell = row[k];
+                                Renderer::TextureRenderer& textureRenderer = textureRendererManager.renderer(cell.item().texture);
+                                shader.setUniformVariable("GrayScale", cell.item().texture->overridden());
+                                shader.setUniformVariable("Texture", 0);
+                                textureRenderer.activate();
+                                m_textureQuads->renderPrimitives(4 * row.cellIndex(k), 4);
+                                textureRenderer.deactivate();
                             }
                         }
                     }
                 }
+                m_textureQuads->cleanup();
             }
 
             if (visibleGroupCount > 0) { // render group title background
@@ -336,11 +371,15 @@ namespace TrenchBroom {
         m_group(false),
         m_hideUnused(false),
         m_sortOrder(Model::TextureSortOrder::Name),
-        m_vbo() {}
+        m_vbo(NULL),
+        m_textureQuads(NULL),
+        m_textureQuadsGeneration(0) {}
 
         TextureBrowserCanvas::~TextureBrowserCanvas() {
             clear();
             m_selectedTexture = NULL;
+            delete m_textureQuads;
+            m_textureQuads = NULL;
             delete m_vbo;
             m_vbo = NULL;
         }
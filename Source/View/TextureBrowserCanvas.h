@@ -37,8 +37,8 @@ namespace TrenchBroom {
         
         class Shader;
         class ShaderProgram;
-        class TextureRenderer;
         class Vbo;
+        class VertexArray;
     }
     
     namespace Utility {
@@ -53,12 +53,10 @@ namespace TrenchBroom {
         class TextureCellData {
         public:
             Model::Texture* texture;
-            Renderer::TextureRenderer* textureRenderer;
             Renderer::Text::FontDescriptor fontDescriptor;
             
-            TextureCellData(Model::Texture* i_texture, Renderer::TextureRenderer* i_textureRenderer, const Renderer::Text::FontDescriptor& i_fontDescriptor) :
+            TextureCellData(Model::Texture* i_texture, const Renderer::Text::FontDescriptor& i_fontDescriptor) :
             texture(i_texture),
-            textureRenderer(i_textureRenderer),
             fontDescriptor(i_fontDescriptor) {}
         };
         
@@ -72,7 +70,10 @@ namespace TrenchBroom {
             Model::TextureSortOrder::Type m_sortOrder;
             String m_filterText;
             Renderer::Vbo* m_vbo;
+            Renderer::VertexArray* m_textureQuads;
+            unsigned int m_textureQuadsGeneration;
             
+            void validateTextureQuads(Layout& layout);
             void addTextureToLayout(Layout& layout, Model::Texture* texture, const Renderer::Text::FontDescriptor& font);
             virtual void doInitLayout(Layout& layout);
             virtual void doReloadLayout(Layout& layout);
@@ -39,6 +39,7 @@ namespace TrenchBroom {
             } LinkDisplayMode;
         private:
             String m_filterPattern;
+            unsigned int m_filterGeneration;
             bool m_showEntities;
             bool m_showEntityModels;
             bool m_showEntityBounds;
@@ -56,9 +57,16 @@ namespace TrenchBroom {
             bool m_shadeFaces;
             bool m_useFog;
             LinkDisplayMode m_linkDisplayMode;
+            bool m_showProfiler;
+
+            static unsigned int nextFilterGeneration() {
+                static unsigned int currentGeneration = 0;
+                return ++currentGeneration;
+            }
         public:
             ViewOptions() :
             m_filterPattern(""),
+            m_filterGeneration(nextFilterGeneration()),
             m_showEntities(true),
             m_showEntityModels(true),
             m_showEntityBounds(true),
@@ -75,14 +83,24 @@ namespace TrenchBroom {
             m_renderSelection(true),
             m_shadeFaces(true),
             m_useFog(false),
-            m_linkDisplayMode(LinkDisplayLocal) {}
+            m_linkDisplayMode(LinkDisplayLocal),
+            m_showProfiler(false) {}
 
             inline const String& filterPattern() const {
                 return m_filterPattern;
             }
 
             inline void setFilterPattern(const String& filterPattern) {
-                m_filterPattern = Utility::trim(filterPattern);
+                const String trimmedPattern = Utility::trim(filterPattern);
+                if (trimmedPattern == m_filterPattern)
+                    return;
+                m_filterPattern = trimmedPattern;
+                m_filterGeneration = nextFilterGeneration();
+            }
+            
+            // changes whenever the filter pattern changes, and is never shared by two view options
+            inline unsigned int filterGeneration() const {
+                return m_filterGeneration;
             }
 
             inline bool showEntities() const {
@@ -220,6 +238,14 @@ namespace TrenchBroom {
             inline void setLinkDisplayMode(LinkDisplayMode linkDisplayMode) {
                 m_linkDisplayMode = linkDisplayMode;
             }
+
+            inline bool showProfiler() const {
+                return m_showProfiler;
+            }
+
+            inline void setShowProfiler(bool showProfiler) {
+                m_showProfiler = showProfiler;
+            }
         };
     }
 }
@@ -0,0 +1,269 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_BinaryMapParserTest_h
+#define TrenchBroom_BinaryMapParserTest_h
+
+#include "TestSuite.h"
+#include "IO/BinaryMapParser.h"
+#include "IO/ByteBuffer.h"
+#include "IO/MapWriter.h"
+#include "Model/Brush.h"
+#include "Model/BrushGeometry.h"
+#include "Model/Entity.h"
+#include "Model/Face.h"
+#include "Utility/List.h"
+#include "Utility/VecMath.h"
+
+#include <cassert>
+#include <cstring>
+
+using namespace TrenchBroom::VecMath;
+
+namespace TrenchBroom {
+    namespace IO {
+        class BinaryMapParserTest : public TestSuite<BinaryMapParserTest> {
+        private:
+            BBoxf m_worldBounds;
+            
+            // a worldspawn entity containing a cube with one chamfered edge, the chamfer's points are not integer
+            Model::Entity* createWorldspawn() {
+                Model::Entity* worldspawn = new Model::Entity(m_worldBounds);
+                worldspawn->setProperty(Model::Entity::ClassnameKey, Model::Entity::WorldspawnClassname);
+                worldspawn->setProperty(String("message"), String("binary"));
+                
+                Model::Brush* brush = new Model::Brush(m_worldBounds, false, BBoxf(Vec3f(0.0f, 0.0f, 0.0f), Vec3f(64.0f, 64.0f, 64.0f)), NULL);
+                Model::Face* chamfer = new Model::Face(m_worldBounds, false, Vec3f(64.0f, 32.5f, 0.0f), Vec3f(64.0f, 32.5f, 64.0f), Vec3f(32.5f, 64.0f, 0.0f), "chamfer");
+                chamfer->setXOffset(3.0f);
+                chamfer->setYOffset(-5.0f);
+                chamfer->setRotation(22.5f);
+                chamfer->setXScale(0.5f);
+                chamfer->setYScale(2.0f);
+                const bool clipped = brush->clip(*chamfer);
+                assert(clipped);
+                
+                worldspawn->addBrush(*brush);
+                return worldspawn;
+            }
+            
+            static bool containsVertex(const Model::VertexList& vertices, const Vec3f& position) {
+                for (size_t i = 0; i < vertices.size(); i++)
+                    if (vertices[i]->position.equals(position))
+                        return true;
+                return false;
+            }
+            
+            static void assertFacesEqual(const Model::Face& expected, const Model::Face& actual) {
+                for (size_t i = 0; i < 3; i++)
+                    assert(actual.point(i) == expected.point(i));
+                assert(actual.textureName() == expected.textureName());
+                assert(actual.xOffset() == expected.xOffset());
+                assert(actual.yOffset() == expected.yOffset());
+                assert(actual.rotation() == expected.rotation());
+                assert(actual.xScale() == expected.xScale());
+                assert(actual.yScale() == expected.yScale());
+            }
+        protected:
+            void registerTestCases() {
+                registerTestCase(&BinaryMapParserTest::testObjectsRoundTrip);
+                registerTestCase(&BinaryMapParserTest::testFacesRoundTrip);
+                registerTestCase(&BinaryMapParserTest::testForceIntegerFacePoints);
+                registerTestCase(&BinaryMapParserTest::testInvalidTopology);
+                registerTestCase(&BinaryMapParserTest::testTruncatedBuffer);
+            }
+        public:
+            BinaryMapParserTest() :
+            m_worldBounds(Vec3f(-8192.0f, -8192.0f, -8192.0f), Vec3f(8192.0f, 8192.0f, 8192.0f)) {}
+            
+            void testObjectsRoundTrip() {
+                Model::Entity* worldspawn = createWorldspawn();
+                const Model::Brush& brush = *worldspawn->brushes().front();
+                
+                ByteBuffer buffer;
+                MapWriter writer;
+                writer.writeObjectsToBuffer(Model::EmptyEntityList, worldspawn->brushes(), buffer);
+                
+                Model::EntityList entities;
+                BinaryMapParser parser(buffer.get(), buffer.size());
+                const bool success = parser.parseEntities(m_worldBounds, false, entities);
+                assert(success);
+                assert(entities.size() == 1);
+                
+                const Model::Entity& entity = *entities.front();
+                assert(entity.worldspawn());
+                assert(*entity.propertyForKey("message") == "binary");
+                assert(entity.brushes().size() == 1);
+                
+                const Model::Brush& parsed = *entity.brushes().front();
+                assert(parsed.faces().size() == brush.faces().size());
+                for (size_t i = 0; i < brush.faces().size(); i++)
+                    assertFacesEqual(*brush.faces()[i], *parsed.faces()[i]);
+                
+                // the stored topology must match the geometry built from the faces
+                assert(parsed.closed());
+                assert(parsed.vertices().size() == brush.vertices().size());
+                assert(parsed.edges().size() == brush.edges().size());
+                for (size_t i = 0; i < brush.vertices().size(); i++)
+                    assert(parsed.vertices()[i]->position == brush.vertices()[i]->position);
+                
+                Model::Brush rebuilt(m_worldBounds, false, parsed);
+                for (size_t i = 0; i < rebuilt.vertices().size(); i++)
+                    assert(containsVertex(parsed.vertices(), rebuilt.vertices()[i]->position));
+                for (size_t i = 0; i < parsed.faces().size(); i++)
+                    assert(parsed.faces()[i]->vertices().size() == brush.faces()[i]->vertices().size());
+                
+                // the face contents are not accepted as objects and vice versa
+                BinaryMapParser faceParser(buffer.get(), buffer.size());
+                Model::FaceList faces;
+                const bool parsedFaces = faceParser.parseFaces(m_worldBounds, false, faces);
+                assert(!parsedFaces);
+                assert(faces.empty());
+                
+                Utility::deleteAll(entities);
+                delete worldspawn;
+            }
+            
+            void testFacesRoundTrip() {
+                Model::Entity* worldspawn = createWorldspawn();
+                const Model::FaceList& faces = worldspawn->brushes().front()->faces();
+                
+                ByteBuffer buffer;
+                MapWriter writer;
+                writer.writeFacesToBuffer(faces, buffer);
+                
+                Model::FaceList parsedFaces;
+                BinaryMapParser parser(buffer.get(), buffer.size());
+                const bool success = parser.parseFaces(m_worldBounds, false, parsedFaces);
+                assert(success);
+                assert(parsedFaces.size() == faces.size());
+                for (size_t i = 0; i < faces.size(); i++)
+                    assertFacesEqual(*faces[i], *parsedFaces[i]);
+                
+                BinaryMapParser entityParser(buffer.get(), buffer.size());
+                Model::EntityList entities;
+                const bool parsedEntities = entityParser.parseEntities(m_worldBounds, false, entities);
+                assert(!parsedEntities);
+                assert(entities.empty());
+                
+                Utility::deleteAll(parsedFaces);
+                delete worldspawn;
+            }
+            
+            void testForceIntegerFacePoints() {
+                Model::Entity* worldspawn = createWorldspawn();
+                
+                ByteBuffer buffer;
+                MapWriter writer;
+                writer.writeObjectsToBuffer(Model::EmptyEntityList, worldspawn->brushes(), buffer);
+                
+                // the stored topology does not match the rounded face points, so the geometry is rebuilt
+                Model::EntityList entities;
+                BinaryMapParser parser(buffer.get(), buffer.size());
+                const bool success = parser.parseEntities(m_worldBounds, true, entities);
+                assert(success);
+                assert(entities.size() == 1 && entities.front()->brushes().size() == 1);
+                
+                const Model::Brush& parsed = *entities.front()->brushes().front();
+                Model::Brush rebuilt(m_worldBounds, true, parsed);
+                assert(parsed.vertices().size() == rebuilt.vertices().size());
+                for (size_t i = 0; i < rebuilt.vertices().size(); i++)
+                    assert(containsVertex(parsed.vertices(), rebuilt.vertices()[i]->position));
+                
+                const Model::FaceList& faces = parsed.faces();
+                for (size_t i = 0; i < faces.size(); i++)
+                    for (size_t j = 0; j < 3; j++)
+                        assert(faces[i]->point(j) == faces[i]->point(j).rounded());
+                
+                Utility::deleteAll(entities);
+                delete worldspawn;
+            }
+            
+            // the brush is written last, so its topology is at the end of the buffer
+            void testInvalidTopology() {
+                Model::Entity* worldspawn = createWorldspawn();
+                const Model::Brush& brush = *worldspawn->brushes().front();
+                
+                ByteBuffer buffer;
+                MapWriter writer;
+                writer.writeObjectsToBuffer(Model::EmptyEntityList, worldspawn->brushes(), buffer);
+                
+                size_t sideEdgesSize = 0;
+                for (size_t i = 0; i < brush.faces().size(); i++)
+                    sideEdgesSize += sizeof(unsigned int) * (1 + brush.faces()[i]->side()->edges.size());
+                const size_t edgesSize = sizeof(unsigned int) * (1 + 4 * brush.edges().size());
+                const size_t lastVertexOffset = buffer.size() - sideEdgesSize - edgesSize - 3 * sizeof(float);
+                const size_t lastEdgeIndexOffset = buffer.size() - sizeof(unsigned int);
+                
+                // an edge index out of range
+                ByteBuffer invalidEdge(buffer.get(), buffer.size());
+                const unsigned int edgeIndex = static_cast<unsigned int>(brush.edges().size());
+                std::memcpy(invalidEdge.get() + lastEdgeIndexOffset, &edgeIndex, sizeof(unsigned int));
+                
+                // a vertex moved off the planes of its faces
+                ByteBuffer invalidVertex(buffer.get(), buffer.size());
+                const Vec3f movedPosition = brush.vertices().back()->position + Vec3f(16.0f, 16.0f, 16.0f);
+                for (size_t i = 0; i < 3; i++) {
+                    const float coordinate = movedPosition[i];
+                    std::memcpy(invalidVertex.get() + lastVertexOffset + i * sizeof(float), &coordinate, sizeof(float));
+                }
+                
+                ByteBuffer* buffers[] = { &invalidEdge, &invalidVertex };
+                for (size_t i = 0; i < 2; i++) {
+                    // the faces are valid, so the brush is kept and its geometry is rebuilt from them
+                    Model::EntityList entities;
+                    BinaryMapParser parser(buffers[i]->get(), buffers[i]->size());
+                    const bool success = parser.parseEntities(m_worldBounds, false, entities);
+                    assert(success);
+                    assert(entities.size() == 1 && entities.front()->brushes().size() == 1);
+                    
+                    const Model::Brush& parsed = *entities.front()->brushes().front();
+                    assert(parsed.closed());
+                    assert(parsed.vertices().size() == brush.vertices().size());
+                    for (size_t j = 0; j < brush.vertices().size(); j++)
+                        assert(containsVertex(parsed.vertices(), brush.vertices()[j]->position));
+                    assert(!containsVertex(parsed.vertices(), movedPosition));
+                    
+                    Utility::deleteAll(entities);
+                }
+                
+                delete worldspawn;
+            }
+            
+            void testTruncatedBuffer() {
+                Model::Entity* worldspawn = createWorldspawn();
+                
+                ByteBuffer buffer;
+                MapWriter writer;
+                writer.writeObjectsToBuffer(Model::EmptyEntityList, worldspawn->brushes(), buffer);
+                
+                for (size_t size = 0; size < buffer.size(); size++) {
+                    Model::EntityList entities;
+                    BinaryMapParser parser(buffer.get(), size);
+                    const bool success = parser.parseEntities(m_worldBounds, false, entities);
+                    assert(!success);
+                    assert(entities.empty());
+                }
+                
+                delete worldspawn;
+            }
+        };
+    }
+}
+
+#endif
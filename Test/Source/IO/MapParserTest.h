@@ -0,0 +1,260 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_MapParserTest_h
+#define TrenchBroom_MapParserTest_h
+
+#include "TestSuite.h"
+#include "IO/MapParser.h"
+#include "Model/Brush.h"
+#include "Model/Entity.h"
+#include "Model/Map.h"
+#include "Utility/Console.h"
+#include "Utility/String.h"
+#include "Utility/VecMath.h"
+
+#include <cassert>
+
+using namespace TrenchBroom::VecMath;
+
+namespace TrenchBroom {
+    namespace IO {
+        class MapParserTest : public TestSuite<MapParserTest> {
+        private:
+            // collects the warnings instead of writing them to the log
+            class WarningConsole : public Utility::Console {
+            public:
+                StringList warnings;
+
+                void log(const LogMessage& message) {
+                    if (message.level() == LLWarn)
+                        warnings.push_back(message.string());
+                }
+            };
+
+            BBoxf m_worldBounds;
+
+            // a brush of eight lines
+            static String cube(int x) {
+                StringStream str;
+                str << "{\n";
+                str << "( " << x      << " 0 0 ) ( " << x      << " 64 0 ) ( " << x      << " 0 64 ) tex 0 0 0 1 1\n";
+                str << "( " << x + 64 << " 0 0 ) ( " << x + 64 << " 0 64 ) ( " << x + 64 << " 64 0 ) tex 0 0 0 1 1\n";
+                str << "( " << x      << " 0 0 ) ( " << x      << " 0 64 ) ( " << x + 64 << " 0 0 ) tex 0 0 0 1 1\n";
+                str << "( " << x      << " 64 0 ) ( " << x + 64 << " 64 0 ) ( " << x      << " 64 64 ) tex 0 0 0 1 1\n";
+                str << "( " << x      << " 0 0 ) ( " << x + 64 << " 0 0 ) ( " << x      << " 64 0 ) tex 0 0 0 1 1\n";
+                str << "( " << x      << " 0 64 ) ( " << x      << " 64 64 ) ( " << x + 64 << " 0 64 ) tex 0 0 0 1 1\n";
+                str << "}\n";
+                return str.str();
+            }
+
+            static bool containsWarning(const StringList& warnings, const String& prefix) {
+                for (size_t i = 0; i < warnings.size(); i++)
+                    if (Utility::startsWith(warnings[i], prefix))
+                        return true;
+                return false;
+            }
+        protected:
+            void registerTestCases() {
+                registerTestCase(&MapParserTest::testSplitMissingClosingBrace);
+                registerTestCase(&MapParserTest::testSplitQuotedBraces);
+                registerTestCase(&MapParserTest::testSplitCommentedBraces);
+                registerTestCase(&MapParserTest::testParseBrushBlock);
+                registerTestCase(&MapParserTest::testSkipMalformedBrush);
+                registerTestCase(&MapParserTest::testSkipMalformedEntity);
+            }
+        public:
+            MapParserTest() :
+            m_worldBounds(Vec3f(-8192.0f, -8192.0f, -8192.0f), Vec3f(8192.0f, 8192.0f, 8192.0f)) {}
+
+            void testSplitMissingClosingBrace() {
+                // the first brush and the first entity lack their closing braces
+                const String str =
+                "{\n"
+                "\"classname\" \"worldspawn\"\n"
+                "{\n"
+                "( 0 0 0 ) ( 0 64 0 ) ( 0 0 64 ) tex 0 0 0 1 1\n"
+                + cube(128) +
+                "{\n"
+                "\"classname\" \"info_null\"\n"
+                "}\n"
+                "{\n"
+                "\"classname\" \"light\"\n";
+
+                MapEntityBlock::List entities;
+                MapBrushBlock::List brushes;
+                MapParser::splitEntityBlocks(str.c_str(), str.c_str() + str.size(), entities, brushes);
+
+                assert(brushes.size() == 2);
+                assert(brushes[0].line == 3 && brushes[0].endLine == 5);
+                assert(brushes[1].line == 5 && brushes[1].endLine == 12);
+
+                assert(entities.size() == 3);
+                assert(!entities[0].closed);
+                assert(entities[0].line == 1 && entities[0].endLine == 13);
+                assert(entities[0].firstBrush == 0 && entities[0].brushCount == 2);
+                assert(entities[1].closed);
+                assert(entities[1].line == 13 && entities[1].brushCount == 0);
+                assert(!entities[2].closed);
+                assert(entities[2].line == 16 && entities[2].end == str.c_str() + str.size());
+            }
+
+            void testSplitQuotedBraces() {
+                const String str =
+                "{\n"
+                "\"classname\" \"worldspawn\"\n"
+                "\"message\" \"} { \"\n"
+                "\"wad\" \"{\n}\"\n"
+                + cube(0) +
+                "}\n"
+                "{\n"
+                "\"classname\" \"info_null\"\n"
+                "}\n";
+
+                MapEntityBlock::List entities;
+                MapBrushBlock::List brushes;
+                MapParser::splitEntityBlocks(str.c_str(), str.c_str() + str.size(), entities, brushes);
+
+                assert(brushes.size() == 1);
+                assert(brushes[0].line == 6 && brushes[0].endLine == 13);
+
+                assert(entities.size() == 2);
+                assert(entities[0].closed && entities[0].brushCount == 1);
+                assert(entities[0].line == 1 && entities[0].endLine == 14);
+                assert(entities[1].closed && entities[1].line == 15);
+            }
+
+            void testSplitCommentedBraces() {
+                const String str =
+                "// { a comment\n"
+                "{\n"
+                "\"classname\" \"worldspawn\" // }\n"
+                "// } {\n"
+                + cube(0) +
+                "// {\n"
+                "}\n";
+
+                MapEntityBlock::List entities;
+                MapBrushBlock::List brushes;
+                MapParser::splitEntityBlocks(str.c_str(), str.c_str() + str.size(), entities, brushes);
+
+                assert(brushes.size() == 1);
+                assert(brushes[0].line == 5 && brushes[0].endLine == 12);
+
+                assert(entities.size() == 1);
+                assert(entities[0].closed && entities[0].brushCount == 1);
+                assert(entities[0].line == 2 && entities[0].endLine == 14);
+            }
+
+            void testParseBrushBlock() {
+                const String str =
+                "{\n"
+                "\"classname\" \"worldspawn\"\n"
+                "{\n"
+                "( 0 0 0 ) ( 0 64 0 ) ( 0 0 64 ) tex 0 0\n"
+                "}\n"
+                + cube(128) +
+                "}\n";
+
+                MapEntityBlock::List entities;
+                MapBrushBlock::List brushes;
+                MapParser::splitEntityBlocks(str.c_str(), str.c_str() + str.size(), entities, brushes);
+                assert(brushes.size() == 2);
+
+                WarningConsole console;
+                for (size_t i = 0; i < brushes.size(); i++)
+                    MapBrushBlockParser::parseBlock(brushes[i], console);
+
+                assert(!brushes[0].error.empty());
+                assert(brushes[0].error.find("line 5") != String::npos);
+
+                assert(brushes[1].error.empty());
+                assert(brushes[1].record.faces.size() == 6);
+                assert(brushes[1].record.firstLine == 6 && brushes[1].record.lineCount == 7);
+                assert(brushes[1].record.faces[0].line == 7);
+                assert(console.warnings.empty());
+            }
+
+            void testSkipMalformedBrush() {
+                const String str =
+                "{\n"
+                "\"classname\" \"worldspawn\"\n"
+                + cube(0) +
+                "{\n"
+                "( 0 0 0 ) ( 0 64 0 ) ( 0 0 64 ) tex 0 0\n"
+                "}\n"
+                + cube(128) +
+                "\"message\" \"kept\"\n"
+                "}\n";
+
+                WarningConsole console;
+                Model::Map map(m_worldBounds, false);
+                MapParser parser(str, console);
+                parser.parseMap(map, NULL);
+
+                assert(console.warnings.size() == 1);
+                assert(containsWarning(console.warnings, "Skipping brush at line 11:"));
+
+                const Model::EntityList& entities = map.entities();
+                assert(entities.size() == 1);
+                const Model::Entity& worldspawn = *entities.front();
+                assert(worldspawn.worldspawn());
+                assert(*worldspawn.propertyForKey("message") == "kept");
+
+                const Model::BrushList& brushes = worldspawn.brushes();
+                assert(brushes.size() == 2);
+                assert(brushes[0]->fileLine() == 3 && brushes[1]->fileLine() == 14);
+                for (size_t i = 0; i < brushes.size(); i++)
+                    assert(brushes[i]->closed() && brushes[i]->vertices().size() == 8);
+            }
+
+            void testSkipMalformedEntity() {
+                const String str =
+                "{\n"
+                "\"classname\" \"worldspawn\"\n"
+                + cube(0) +
+                "}\n"
+                "{\n"
+                "\"classname\" \"info_null\"\n"
+                "\"origin\" 12\n"
+                "}\n"
+                "{\n"
+                "\"classname\" \"info_player_start\"\n"
+                "\"origin\" \"0 0 0\"\n"
+                "}\n";
+
+                WarningConsole console;
+                Model::Map map(m_worldBounds, false);
+                MapParser parser(str, console);
+                parser.parseMap(map, NULL);
+
+                assert(console.warnings.size() == 1);
+                assert(containsWarning(console.warnings, "Skipping entity at line 12:"));
+
+                const Model::EntityList& entities = map.entities();
+                assert(entities.size() == 2);
+                assert(entities[0]->worldspawn() && entities[0]->brushes().size() == 1);
+                assert(*entities[1]->classname() == "info_player_start");
+                assert(entities[1]->fileLine() == 16);
+            }
+        };
+    }
+}
+
+#endif
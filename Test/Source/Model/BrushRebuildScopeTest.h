@@ -0,0 +1,215 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_BrushRebuildScopeTest_h
+#define TrenchBroom_BrushRebuildScopeTest_h
+
+#include "TestSuite.h"
+#include "Model/Brush.h"
+#include "Model/BrushRebuildScope.h"
+#include "Model/Entity.h"
+#include "Model/Face.h"
+#include "Model/Map.h"
+#include "Model/MapExceptions.h"
+#include "Utility/VecMath.h"
+
+#include <cassert>
+
+using namespace TrenchBroom::VecMath;
+
+namespace TrenchBroom {
+    namespace Model {
+        class BrushRebuildScopeTest : public TestSuite<BrushRebuildScopeTest> {
+        private:
+            // enough brushes to build them on several threads
+            static const size_t BrushCount = 200;
+
+            BBoxf m_worldBounds;
+
+            Entity* createEntity(Map& map) {
+                Entity* entity = new Entity(m_worldBounds);
+                map.addEntity(*entity);
+                for (size_t i = 0; i < BrushCount; i++) {
+                    const float x = static_cast<float>(i) * 16.0f - 2048.0f;
+                    Brush* brush = new Brush(m_worldBounds, false, BBoxf(Vec3f(x, 0.0f, 0.0f), Vec3f(x + 16.0f, 16.0f, 16.0f)), NULL);
+                    entity->addBrush(*brush);
+                }
+                return entity;
+            }
+
+            void translate(const BrushList& brushes, const Vec3f& delta) {
+                const Mat4f pointTransform = translationMatrix(delta);
+                BrushList::const_iterator it, end;
+                for (it = brushes.begin(), end = brushes.end(); it != end; ++it)
+                    (*it)->transform(pointTransform, Mat4f::Identity, false, false);
+            }
+
+            void assertTranslated(const BrushList& brushes, const Vec3f& delta) {
+                for (size_t i = 0; i < brushes.size(); i++) {
+                    const float x = static_cast<float>(i) * 16.0f - 2048.0f;
+                    const BBoxf& bounds = brushes[i]->bounds();
+                    assert(bounds.min.equals(Vec3f(x, 0.0f, 0.0f) + delta));
+                    assert(bounds.max.equals(Vec3f(x + 16.0f, 16.0f, 16.0f) + delta));
+                    assert(brushes[i]->vertices().size() == 8);
+                }
+            }
+        protected:
+            void registerTestCases() {
+                registerTestCase(&BrushRebuildScopeTest::testRebuild);
+                registerTestCase(&BrushRebuildScopeTest::testNestedScopes);
+                registerTestCase(&BrushRebuildScopeTest::testRebuildFailure);
+                registerTestCase(&BrushRebuildScopeTest::testDeleteDeferredBrush);
+                registerTestCase(&BrushRebuildScopeTest::testDeferredConstruction);
+            }
+        public:
+            BrushRebuildScopeTest() :
+            m_worldBounds(Vec3f(-8192.0f, -8192.0f, -8192.0f), Vec3f(8192.0f, 8192.0f, 8192.0f)) {}
+
+            void testRebuild() {
+                Map map(m_worldBounds, false);
+                Entity* entity = createEntity(map);
+                const BrushList brushes = entity->brushes();
+                const Vec3f delta(8.0f, 16.0f, -32.0f);
+
+                {
+                    BrushRebuildScope rebuildScope(map);
+                    assert(map.rebuildScope() == &rebuildScope);
+                    translate(brushes, delta);
+                    rebuildScope.rebuild();
+                    assertTranslated(brushes, delta);
+                }
+                assert(map.rebuildScope() == NULL);
+
+                // without a scope, the geometry is rebuilt immediately
+                translate(brushes, delta * -1.0f);
+                assertTranslated(brushes, Vec3f::Null);
+            }
+
+            void testNestedScopes() {
+                Map map(m_worldBounds, false);
+                Entity* entity = createEntity(map);
+                const BrushList brushes = entity->brushes();
+                const Vec3f delta(0.0f, 0.0f, 64.0f);
+
+                BrushRebuildScope outerScope(map);
+                {
+                    // the inner scope leaves the brushes to the outer one
+                    BrushRebuildScope innerScope(map);
+                    assert(map.rebuildScope() == &outerScope);
+                    translate(brushes, delta);
+                    innerScope.rebuild();
+                }
+                assert(map.rebuildScope() == &outerScope);
+
+                outerScope.rebuild();
+                assertTranslated(brushes, delta);
+            }
+
+            void testRebuildFailure() {
+                Map map(m_worldBounds, false);
+                Entity* entity = createEntity(map);
+                const BrushList brushes = entity->brushes();
+                const Vec3f delta(16.0f, 0.0f, 0.0f);
+                Brush* emptyBrush = brushes[BrushCount / 2];
+
+                BrushRebuildScope rebuildScope(map);
+                translate(brushes, delta);
+
+                // the plane x + y = -4096 cuts away the entire brush
+                FaceList faces;
+                const FaceList& emptyFaces = emptyBrush->faces();
+                for (size_t i = 0; i < emptyFaces.size(); i++)
+                    faces.push_back(new Face(m_worldBounds, false, *emptyFaces[i]));
+                faces.push_back(new Face(m_worldBounds, false, Vec3f(-2048.0f, -2048.0f, 0.0f), Vec3f(-2048.0f, -2048.0f, 64.0f), Vec3f(-2080.0f, -2016.0f, 0.0f), ""));
+                emptyBrush->restore(faces);
+
+                bool thrown = false;
+                try {
+                    rebuildScope.rebuild();
+                } catch (GeometryException&) {
+                    thrown = true;
+                }
+                assert(thrown);
+
+                // the other brushes are built regardless
+                for (size_t i = 0; i < brushes.size(); i++) {
+                    if (brushes[i] == emptyBrush)
+                        continue;
+                    const float x = static_cast<float>(i) * 16.0f - 2048.0f;
+                    assert(brushes[i]->bounds().min.equals(Vec3f(x, 0.0f, 0.0f) + delta));
+                    assert(brushes[i]->vertices().size() == 8);
+                }
+
+                // nothing is left to build
+                rebuildScope.rebuild();
+
+                entity->removeBrush(*emptyBrush);
+                delete emptyBrush;
+            }
+
+            void testDeleteDeferredBrush() {
+                Map map(m_worldBounds, false);
+                Entity* entity = createEntity(map);
+                BrushList brushes = entity->brushes();
+                const Vec3f delta(0.0f, -16.0f, 0.0f);
+
+                BrushRebuildScope rebuildScope(map);
+                translate(brushes, delta);
+
+                Brush* brush = brushes.back();
+                brushes.pop_back();
+                entity->removeBrush(*brush);
+                delete brush;
+
+                rebuildScope.rebuild();
+                assertTranslated(brushes, delta);
+            }
+
+            void testDeferredConstruction() {
+                Map map(m_worldBounds, false);
+                BrushRebuildScope rebuildScope(map);
+
+                // like the map parser, the brushes are added before their entity is added to the map
+                Entity* entity = new Entity(m_worldBounds);
+                for (size_t i = 0; i < BrushCount; i++) {
+                    const float x = static_cast<float>(i) * 16.0f - 2048.0f;
+                    const Brush box(m_worldBounds, false, BBoxf(Vec3f(x, 0.0f, 0.0f), Vec3f(x + 16.0f, 16.0f, 16.0f)), NULL);
+                    FaceList faces;
+                    for (size_t j = 0; j < box.faces().size(); j++)
+                        faces.push_back(new Face(m_worldBounds, false, *box.faces()[j]));
+                    Brush* brush = new Brush(m_worldBounds, false, faces, rebuildScope);
+                    entity->addBrush(*brush);
+                    assert(!brush->hasGeometry());
+                }
+                map.addEntity(*entity);
+
+                // switching to integer face points only defers the brushes again
+                map.setForceIntegerFacePoints(true);
+                const BrushList brushes = entity->brushes();
+                for (size_t i = 0; i < brushes.size(); i++)
+                    assert(!brushes[i]->hasGeometry());
+
+                rebuildScope.rebuild();
+                assertTranslated(brushes, Vec3f::Null);
+            }
+        };
+    }
+}
+
+#endif
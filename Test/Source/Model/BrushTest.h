@@ -0,0 +1,171 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_BrushTest_h
+#define TrenchBroom_BrushTest_h
+
+#include "TestSuite.h"
+#include "Model/Brush.h"
+#include "Model/BrushGeometry.h"
+#include "Model/Face.h"
+#include "Utility/VecMath.h"
+
+#include <cassert>
+
+using namespace TrenchBroom::VecMath;
+
+namespace TrenchBroom {
+    namespace Model {
+        class BrushTest : public TestSuite<BrushTest> {
+        private:
+            BBoxf m_worldBounds;
+            
+            static Face* findFace(const Brush& brush, const Vec3f& normal) {
+                const FaceList& faces = brush.faces();
+                for (size_t i = 0; i < faces.size(); i++)
+                    if (faces[i]->boundary().normal.equals(normal))
+                        return faces[i];
+                return NULL;
+            }
+            
+            // a 64 unit cube with the vertical edge at x = y = 64 cut off by the plane x + y = 96
+            Brush* createChamferedCube() {
+                Brush* brush = new Brush(m_worldBounds, false, BBoxf(Vec3f(0.0f, 0.0f, 0.0f), Vec3f(64.0f, 64.0f, 64.0f)), NULL);
+                Face* chamfer = new Face(m_worldBounds, false, Vec3f(64.0f, 32.0f, 0.0f), Vec3f(64.0f, 32.0f, 64.0f), Vec3f(32.0f, 64.0f, 0.0f), "");
+                const bool clipped = brush->clip(*chamfer);
+                assert(clipped);
+                assert(brush->faces().size() == 7);
+                return brush;
+            }
+        protected:
+            void registerTestCases() {
+                registerTestCase(&BrushTest::testCanMoveBoundaryInward);
+                registerTestCase(&BrushTest::testCanMoveBoundaryOutward);
+                registerTestCase(&BrushTest::testCanMoveChamferInward);
+                registerTestCase(&BrushTest::testCanMoveChamferOutward);
+                registerTestCase(&BrushTest::testDoublePrecisionPlanes);
+                registerTestCase(&BrushTest::testDoublePrecisionPlaneNearVertex);
+            }
+        public:
+            BrushTest() :
+            m_worldBounds(Vec3f(-128.0f, -128.0f, -128.0f), Vec3f(128.0f, 128.0f, 128.0f)) {}
+            
+            void testCanMoveBoundaryInward() {
+                Brush brush(m_worldBounds, false, BBoxf(Vec3f(0.0f, 0.0f, 0.0f), Vec3f(64.0f, 64.0f, 64.0f)), NULL);
+                Face* top = findFace(brush, Vec3f::PosZ);
+                assert(top != NULL);
+                
+                assert(brush.canMoveBoundary(*top, Vec3f(0.0f, 0.0f, -32.0f)));
+                assert(brush.canMoveBoundary(*top, Vec3f(0.0f, 0.0f, -63.0f)));
+                assert(!brush.canMoveBoundary(*top, Vec3f(0.0f, 0.0f, -64.0f)));
+                assert(!brush.canMoveBoundary(*top, Vec3f(0.0f, 0.0f, -80.0f)));
+                
+                // only the offset along the normal matters
+                assert(brush.canMoveBoundary(*top, Vec3f(100.0f, 0.0f, -32.0f)));
+            }
+            
+            void testCanMoveBoundaryOutward() {
+                Brush brush(m_worldBounds, false, BBoxf(Vec3f(0.0f, 0.0f, 0.0f), Vec3f(64.0f, 64.0f, 64.0f)), NULL);
+                Face* top = findFace(brush, Vec3f::PosZ);
+                assert(top != NULL);
+                
+                assert(brush.canMoveBoundary(*top, Vec3f(0.0f, 0.0f, 32.0f)));
+                assert(brush.canMoveBoundary(*top, Vec3f(0.0f, 0.0f, 64.0f)));
+                assert(!brush.canMoveBoundary(*top, Vec3f(0.0f, 0.0f, 65.0f)));
+            }
+            
+            void testCanMoveChamferInward() {
+                Brush* brush = createChamferedCube();
+                Face* chamfer = findFace(*brush, Vec3f(1.0f, 1.0f, 0.0f).normalized());
+                assert(chamfer != NULL);
+                
+                // at x + y = 64, the faces at x = 64 and y = 64 would lose all their vertices
+                assert(brush->canMoveBoundary(*chamfer, Vec3f(-8.0f, -8.0f, 0.0f)));
+                assert(!brush->canMoveBoundary(*chamfer, Vec3f(-16.0f, -16.0f, 0.0f)));
+                
+                brush->moveBoundary(*chamfer, Vec3f(-8.0f, -8.0f, 0.0f), false);
+                assert(brush->faces().size() == 7);
+                delete brush;
+            }
+            
+            void testCanMoveChamferOutward() {
+                Brush* brush = createChamferedCube();
+                Face* chamfer = findFace(*brush, Vec3f(1.0f, 1.0f, 0.0f).normalized());
+                assert(chamfer != NULL);
+                
+                // at x + y = 128, the chamfer only touches the corner of the cube and would be dropped
+                assert(brush->canMoveBoundary(*chamfer, Vec3f(8.0f, 8.0f, 0.0f)));
+                assert(!brush->canMoveBoundary(*chamfer, Vec3f(16.0f, 16.0f, 0.0f)));
+                assert(!brush->canMoveBoundary(*chamfer, Vec3f(20.0f, 20.0f, 0.0f)));
+                
+                brush->moveBoundary(*chamfer, Vec3f(8.0f, 8.0f, 0.0f), false);
+                assert(brush->faces().size() == 7);
+                delete brush;
+            }
+            
+            void testDoublePrecisionPlanes() {
+                BrushGeometry::doublePrecisionPlanes = true;
+                Brush* brush = createChamferedCube();
+                
+                assert(brush->vertices().size() == 10);
+                assert(brush->edges().size() == 15);
+                
+                const VertexList& vertices = brush->vertices();
+                for (size_t i = 0; i < vertices.size(); i++) {
+                    const Vec3f& position = vertices[i]->position;
+                    assert(position.x() + position.y() <= 96.0f);
+                    assert(position.z() == 0.0f || position.z() == 64.0f);
+                }
+                
+                Face* chamfer = findFace(*brush, Vec3f(1.0f, 1.0f, 0.0f).normalized());
+                assert(chamfer != NULL);
+                assert(chamfer->vertices().size() == 4);
+                
+                delete brush;
+                BrushGeometry::doublePrecisionPlanes = false;
+            }
+            
+            void testDoublePrecisionPlaneNearVertex() {
+                BrushGeometry::doublePrecisionPlanes = true;
+                BrushGeometry geometry(BBoxf(Vec3f(0.0f, 0.0f, 0.0f), Vec3f(64.0f, 64.0f, 64.0f)));
+                
+                // the plane x + y = 128 - 2^-17 cuts off the vertical edge at x = y = 64, but the split vertices would
+                // be corrected onto that edge, so the edge is kept and the face is redundant
+                const float near = 63.5f - 1.0f / 131072.0f;
+                Face face(m_worldBounds, false, Vec3f(64.5f, near, 0.0f), Vec3f(64.5f, near, 64.0f), Vec3f(near, 64.5f, 0.0f), "");
+                FaceSet droppedFaces;
+                const BrushGeometry::CutResult result = geometry.addFace(face, droppedFaces);
+                assert(result == BrushGeometry::Redundant);
+                assert(geometry.vertices.size() == 8);
+                assert(geometry.edges.size() == 12);
+                
+                const VertexList& vertices = geometry.vertices;
+                for (size_t i = 0; i < vertices.size(); i++) {
+                    const Vec3f& position = vertices[i]->position;
+                    assert(position.x() == 0.0f || position.x() == 64.0f);
+                    assert(position.y() == 0.0f || position.y() == 64.0f);
+                }
+                
+                BrushGeometry::doublePrecisionPlanes = false;
+            }
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,95 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_MapTest_h
+#define TrenchBroom_MapTest_h
+
+#include "TestSuite.h"
+#include "Model/Entity.h"
+#include "Model/Map.h"
+#include "Utility/VecMath.h"
+
+#include <cassert>
+
+using namespace TrenchBroom::VecMath;
+
+namespace TrenchBroom {
+    namespace Model {
+        class MapTest : public TestSuite<MapTest> {
+        protected:
+            void registerTestCases() {
+                registerTestCase(&MapTest::testRemoveLinkSource);
+                registerTestCase(&MapTest::testRemoveLinkTarget);
+            }
+        public:
+            void testRemoveLinkSource() {
+                const BBoxf worldBounds(Vec3f(-8192.0f, -8192.0f, -8192.0f), Vec3f(8192.0f, 8192.0f, 8192.0f));
+                Map map(worldBounds, false);
+
+                Entity* source = new Entity(worldBounds);
+                source->setProperty(Entity::TargetKey, String("door"));
+                Entity* target = new Entity(worldBounds);
+                target->setProperty(Entity::TargetnameKey, String("door"));
+                map.addEntity(*source);
+                map.addEntity(*target);
+                assert(source->linkTargets().size() == 1 && source->linkTargets().front() == target);
+
+                unsigned int revision = map.linkRevision();
+                map.removeEntity(*source);
+                assert(map.linkRevision() > revision);
+                assert(target->linkSources().empty());
+
+                // undo
+                revision = map.linkRevision();
+                map.addEntity(*source);
+                assert(map.linkRevision() > revision);
+                assert(source->linkRevision() > revision);
+                assert(source->linkTargets().size() == 1 && source->linkTargets().front() == target);
+                assert(target->linkSources().size() == 1 && target->linkSources().front() == source);
+            }
+
+            void testRemoveLinkTarget() {
+                const BBoxf worldBounds(Vec3f(-8192.0f, -8192.0f, -8192.0f), Vec3f(8192.0f, 8192.0f, 8192.0f));
+                Map map(worldBounds, false);
+
+                Entity* source = new Entity(worldBounds);
+                source->setProperty(Entity::TargetKey, String("door"));
+                Entity* target = new Entity(worldBounds);
+                target->setProperty(Entity::TargetnameKey, String("door"));
+                map.addEntity(*source);
+                map.addEntity(*target);
+
+                unsigned int revision = map.linkRevision();
+                map.removeEntity(*target);
+                assert(map.linkRevision() > revision);
+                assert(source->linkRevision() > revision);
+                assert(source->linkTargets().empty());
+
+                // undo
+                revision = map.linkRevision();
+                map.addEntity(*target);
+                assert(map.linkRevision() > revision);
+                assert(source->linkRevision() > revision);
+                assert(source->linkTargets().size() == 1 && source->linkTargets().front() == target);
+            }
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,209 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_PointFileTest_h
+#define TrenchBroom_PointFileTest_h
+
+#include "TestSuite.h"
+#include "Model/PointFile.h"
+#include "Utility/VecMath.h"
+
+#include <cassert>
+#include <cstdio>
+#include <fstream>
+
+using namespace TrenchBroom::VecMath;
+
+namespace TrenchBroom {
+    namespace Model {
+        class PointFileTest : public TestSuite<PointFileTest> {
+        private:
+            static const String MapPath;
+            static const String PointFilePath;
+            
+            static void writePoints(const Vec3f::List& points) {
+                std::ofstream stream(PointFilePath.c_str());
+                for (size_t i = 0; i < points.size(); i++)
+                    stream << points[i].x() << " " << points[i].y() << " " << points[i].z() << "\n";
+            }
+            
+            static void addSamples(const Vec3f& start, const Vec3f& end, size_t count, Vec3f::List& points) {
+                for (size_t i = 0; i < count; i++)
+                    points.push_back(start + (end - start) * (static_cast<float>(i) / count));
+            }
+        protected:
+            void registerTestCases() {
+                registerTestCase(&PointFileTest::testParse);
+                registerTestCase(&PointFileTest::testSimplifyStraightTrace);
+                registerTestCase(&PointFileTest::testSimplifyKeepsCorners);
+                registerTestCase(&PointFileTest::testSimplifyKeepsReversal);
+                registerTestCase(&PointFileTest::testSimplifyLongTrace);
+                registerTestCase(&PointFileTest::testStepping);
+                registerTestCase(&PointFileTest::testSeek);
+            }
+        public:
+            void testParse() {
+                std::ofstream stream(PointFilePath.c_str());
+                stream << "0 0 0\n  1e2 -0.5 +3\r\n100 -0.5 3\n100.0 200 3.0E0 garbage";
+                stream.close();
+                
+                PointFile pointFile(MapPath);
+                const Vec3f::List& points = pointFile.points();
+                assert(points.size() == 3);
+                assert(points[0] == Vec3f(0.0f, 0.0f, 0.0f));
+                assert(points[1] == Vec3f(100.0f, -0.5f, 3.0f));
+                assert(points[2] == Vec3f(100.0f, 200.0f, 3.0f));
+                std::remove(PointFilePath.c_str());
+            }
+            
+            void testSimplifyStraightTrace() {
+                // samples along a line with a deviation within the tolerance
+                Vec3f::List points;
+                for (size_t i = 0; i < 128; i++)
+                    points.push_back(Vec3f(i * 8.0f, (i % 2) * 0.5f, 0.0f));
+                points.push_back(Vec3f(1024.0f, 0.0f, 0.0f));
+                writePoints(points);
+                
+                PointFile pointFile(MapPath);
+                assert(pointFile.points().size() == 2);
+                assert(pointFile.points().front() == Vec3f(0.0f, 0.0f, 0.0f));
+                assert(pointFile.points().back() == Vec3f(1024.0f, 0.0f, 0.0f));
+                assert(pointFile.length() == 1024.0f);
+                std::remove(PointFilePath.c_str());
+            }
+            
+            void testSimplifyKeepsCorners() {
+                Vec3f::List points;
+                addSamples(Vec3f(0.0f, 0.0f, 0.0f), Vec3f(512.0f, 0.0f, 0.0f), 64, points);
+                addSamples(Vec3f(512.0f, 0.0f, 0.0f), Vec3f(512.0f, 512.0f, 0.0f), 64, points);
+                addSamples(Vec3f(512.0f, 512.0f, 0.0f), Vec3f(512.0f, 512.0f, 256.0f), 32, points);
+                points.push_back(Vec3f(512.0f, 512.0f, 256.0f));
+                writePoints(points);
+                
+                PointFile pointFile(MapPath);
+                const Vec3f::List& simplified = pointFile.points();
+                assert(simplified.size() == 4);
+                assert(simplified[1] == Vec3f(512.0f, 0.0f, 0.0f));
+                assert(simplified[2] == Vec3f(512.0f, 512.0f, 0.0f));
+                assert(pointFile.length() == 1280.0f);
+                std::remove(PointFilePath.c_str());
+            }
+            
+            void testSimplifyKeepsReversal() {
+                // every point lies on the line through the ends, but the trace doubles back
+                Vec3f::List points;
+                addSamples(Vec3f(0.0f, 0.0f, 0.0f), Vec3f(256.0f, 0.0f, 0.0f), 32, points);
+                addSamples(Vec3f(256.0f, 0.0f, 0.0f), Vec3f(64.0f, 0.0f, 0.0f), 24, points);
+                points.push_back(Vec3f(64.0f, 0.0f, 0.0f));
+                writePoints(points);
+                
+                PointFile pointFile(MapPath);
+                const Vec3f::List& simplified = pointFile.points();
+                assert(simplified.size() == 3);
+                assert(simplified[1] == Vec3f(256.0f, 0.0f, 0.0f));
+                assert(pointFile.length() == 448.0f);
+                std::remove(PointFilePath.c_str());
+            }
+            
+            void testSimplifyLongTrace() {
+                // longer than the ranges the trace is split into before simplifying
+                Vec3f::List points;
+                addSamples(Vec3f(0.0f, 0.0f, 0.0f), Vec3f(3000.0f, 0.0f, 0.0f), 3000, points);
+                addSamples(Vec3f(3000.0f, 0.0f, 0.0f), Vec3f(3000.0f, 0.0f, 2000.0f), 2000, points);
+                points.push_back(Vec3f(3000.0f, 0.0f, 2000.0f));
+                writePoints(points);
+                
+                PointFile pointFile(MapPath);
+                const Vec3f::List& simplified = pointFile.points();
+                assert(simplified.size() == 3);
+                assert(simplified[1] == Vec3f(3000.0f, 0.0f, 0.0f));
+                std::remove(PointFilePath.c_str());
+            }
+            
+            void testStepping() {
+                Vec3f::List points;
+                points.push_back(Vec3f(0.0f, 0.0f, 0.0f));
+                points.push_back(Vec3f(200.0f, 0.0f, 0.0f));
+                points.push_back(Vec3f(200.0f, 100.0f, 0.0f));
+                writePoints(points);
+                
+                // the first segment is 200 units long, so it has stops at 0, 64 and 128, and the second has one stop
+                PointFile pointFile(MapPath);
+                assert(pointFile.currentPoint() == Vec3f(0.0f, 0.0f, 0.0f));
+                assert(!pointFile.hasPreviousPoint());
+                assert(pointFile.nextPoint() == Vec3f(64.0f, 0.0f, 0.0f));
+                assert(pointFile.nextPoint() == Vec3f(128.0f, 0.0f, 0.0f));
+                assert(pointFile.direction() == Vec3f::PosX);
+                assert(pointFile.nextPoint() == Vec3f(200.0f, 0.0f, 0.0f));
+                assert(pointFile.direction() == Vec3f::PosY);
+                assert(pointFile.nextPoint() == Vec3f(200.0f, 100.0f, 0.0f));
+                assert(!pointFile.hasNextPoint());
+                assert(pointFile.direction() == Vec3f::PosY);
+                
+                assert(pointFile.previousPoint() == Vec3f(200.0f, 0.0f, 0.0f));
+                assert(pointFile.previousPoint() == Vec3f(128.0f, 0.0f, 0.0f));
+                assert(pointFile.currentDistance() == 128.0f);
+                assert(pointFile.previousPoint() == Vec3f(64.0f, 0.0f, 0.0f));
+                assert(pointFile.previousPoint() == Vec3f(0.0f, 0.0f, 0.0f));
+                assert(!pointFile.hasPreviousPoint());
+                std::remove(PointFilePath.c_str());
+            }
+            
+            void testSeek() {
+                Vec3f::List points;
+                points.push_back(Vec3f(0.0f, 0.0f, 0.0f));
+                points.push_back(Vec3f(200.0f, 0.0f, 0.0f));
+                points.push_back(Vec3f(200.0f, 100.0f, 0.0f));
+                writePoints(points);
+                
+                PointFile pointFile(MapPath);
+                pointFile.seek(150.0f);
+                assert(pointFile.currentPoint() == Vec3f(128.0f, 0.0f, 0.0f));
+                assert(pointFile.currentDistance() == 128.0f);
+                
+                // the last stop of a segment is not past its end
+                pointFile.seek(199.0f);
+                assert(pointFile.currentPoint() == Vec3f(128.0f, 0.0f, 0.0f));
+                
+                pointFile.seek(250.0f);
+                assert(pointFile.currentPoint() == Vec3f(200.0f, 0.0f, 0.0f));
+                assert(pointFile.nextPoint() == Vec3f(200.0f, 100.0f, 0.0f));
+                
+                pointFile.seek(1000.0f);
+                assert(pointFile.currentPoint() == Vec3f(200.0f, 100.0f, 0.0f));
+                assert(!pointFile.hasNextPoint());
+                
+                pointFile.seek(-10.0f);
+                assert(pointFile.currentPoint() == Vec3f(0.0f, 0.0f, 0.0f));
+                assert(!pointFile.hasPreviousPoint());
+                
+                assert(pointFile.pointAtDistance(-10.0f) == Vec3f(0.0f, 0.0f, 0.0f));
+                assert(pointFile.pointAtDistance(150.0f) == Vec3f(150.0f, 0.0f, 0.0f));
+                assert(pointFile.pointAtDistance(250.0f) == Vec3f(200.0f, 50.0f, 0.0f));
+                assert(pointFile.pointAtDistance(1000.0f) == Vec3f(200.0f, 100.0f, 0.0f));
+                std::remove(PointFilePath.c_str());
+            }
+        };
+        
+        const String PointFileTest::MapPath = "PointFileTest.map";
+        const String PointFileTest::PointFilePath = "PointFileTest.pts";
+    }
+}
+
+#endif
@@ -0,0 +1,150 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_VertexHandleMapTest_h
+#define TrenchBroom_VertexHandleMapTest_h
+
+#include "TestSuite.h"
+#include "Model/VertexHandleMap.h"
+#include "Utility/VecMath.h"
+
+#include <algorithm>
+#include <cassert>
+
+using namespace TrenchBroom::VecMath;
+
+namespace TrenchBroom {
+    namespace Model {
+        class VertexHandleMapTest : public TestSuite<VertexHandleMapTest> {
+        private:
+            typedef VertexHandleMap<int> Map;
+            
+            static bool contains(const Vec3f::List& positions, const Vec3f& position) {
+                for (size_t i = 0; i < positions.size(); i++)
+                    if (positions[i].equals(position))
+                        return true;
+                return false;
+            }
+        protected:
+            void registerTestCases() {
+                registerTestCase(&VertexHandleMapTest::testFindAcrossCellBoundary);
+                registerTestCase(&VertexHandleMapTest::testErase);
+                registerTestCase(&VertexHandleMapTest::testRehash);
+                registerTestCase(&VertexHandleMapTest::testFindCandidates);
+            }
+        public:
+            void testFindAcrossCellBoundary() {
+                Map map(64.0f);
+                int a, b;
+                
+                map[Vec3f(64.0f, 0.0f, 0.0f)].push_back(&a);
+                map[Vec3f(64.0f - Math<float>::AlmostZero / 2.0f, 0.0f, 0.0f)].push_back(&b);
+                assert(map.size() == 1);
+                
+                Map::const_iterator it = map.find(Vec3f(64.0f, 0.0f, 0.0f));
+                assert(it != map.end());
+                assert(it->second.size() == 2);
+                
+                assert(map.find(Vec3f(63.0f, 0.0f, 0.0f)) == map.end());
+            }
+            
+            void testErase() {
+                Map map(16.0f);
+                int a, b, c;
+                
+                map[Vec3f(0.0f, 0.0f, 0.0f)].push_back(&a);
+                map[Vec3f(8.0f, 0.0f, 0.0f)].push_back(&b);
+                map[Vec3f(32.0f, 0.0f, 0.0f)].push_back(&c);
+                
+                // the last entry moves into the erased slot and must still be found in its cell
+                map.erase(map.find(Vec3f(0.0f, 0.0f, 0.0f)));
+                assert(map.size() == 2);
+                assert(map.find(Vec3f(0.0f, 0.0f, 0.0f)) == map.end());
+                
+                Map::iterator it = map.find(Vec3f(32.0f, 0.0f, 0.0f));
+                assert(it != map.end() && it->second.front() == &c);
+                it = map.find(Vec3f(8.0f, 0.0f, 0.0f));
+                assert(it != map.end() && it->second.front() == &b);
+                
+                map.erase(it);
+                map.erase(map.find(Vec3f(32.0f, 0.0f, 0.0f)));
+                assert(map.empty());
+            }
+            
+            void testRehash() {
+                Map map(1.0f);
+                int a;
+                
+                // more cells than initial buckets
+                for (int x = 0; x < 10; x++)
+                    for (int y = 0; y < 10; y++)
+                        for (int z = 0; z < 3; z++)
+                            map[Vec3f(static_cast<float>(x), static_cast<float>(y), static_cast<float>(z))].push_back(&a);
+                assert(map.size() == 300);
+                
+                for (int x = 0; x < 10; x++)
+                    for (int y = 0; y < 10; y++)
+                        for (int z = 0; z < 3; z++)
+                            assert(map.find(Vec3f(static_cast<float>(x), static_cast<float>(y), static_cast<float>(z))) != map.end());
+            }
+            
+            void testFindCandidates() {
+                Map map(16.0f);
+                int a;
+                
+                Vec3f::List positions;
+                for (int x = -8; x <= 8; x++)
+                    for (int y = -8; y <= 8; y++)
+                        positions.push_back(Vec3f(x * 12.0f, y * 12.0f, 5.0f));
+                for (size_t i = 0; i < positions.size(); i++)
+                    map[positions[i]].push_back(&a);
+                
+                const Rayf ray(Vec3f(-200.0f, -150.0f, 5.0f), Vec3f(1.0f, 0.7f, 0.0f).normalized());
+                const float radius = 3.0f;
+                Vec3f::List candidates;
+                map.findCandidates(ray, 1000.0f, radius, candidates);
+                
+                // the candidates may contain handles further away, but never miss one within the radius
+                size_t hits = 0;
+                for (size_t i = 0; i < positions.size(); i++) {
+                    float distance;
+                    if (ray.squaredDistanceToPoint(positions[i], distance) <= radius * radius) {
+                        assert(contains(candidates, positions[i]));
+                        hits++;
+                    }
+                }
+                assert(hits > 0);
+                assert(candidates.size() < positions.size());
+                
+                // a handle within the radius, but in a cell next to those the ray passes through
+                map[Vec3f(40.0f, 17.0f, 5.0f)].push_back(&a);
+                candidates.clear();
+                map.findCandidates(Rayf(Vec3f(-100.0f, 15.0f, 5.0f), Vec3f(1.0f, 0.0f, 0.0f)), 1000.0f, radius, candidates);
+                assert(contains(candidates, Vec3f(40.0f, 17.0f, 5.0f)));
+                
+                // a ray that misses the handles' bounds yields nothing
+                candidates.clear();
+                map.findCandidates(Rayf(Vec3f(0.0f, 0.0f, 100.0f), Vec3f(1.0f, 0.0f, 0.0f)), 1000.0f, radius, candidates);
+                assert(candidates.empty());
+            }
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,243 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_VboTest_h
+#define TrenchBroom_VboTest_h
+
+#include "TestSuite.h"
+#include "Renderer/Vbo.h"
+
+#include <cassert>
+#include <map>
+#include <vector>
+
+namespace TrenchBroom {
+    namespace Renderer {
+        // A software implementation of the buffer object functions used by Vbo. They are installed into GLEW's
+        // function pointers, so the tests don't need a GL context. glGetError is replaced in GLStubs.cpp.
+        class SoftwareGL {
+        public:
+            typedef std::vector<unsigned char> Buffer;
+        private:
+            typedef std::map<GLuint, Buffer> BufferMap;
+            typedef std::map<GLenum, GLuint> BindingMap;
+            
+            struct State {
+                BufferMap buffers;
+                BindingMap bindings;
+                GLuint nextId;
+                
+                State() :
+                nextId(1) {}
+            };
+            
+            static State& state() {
+                static State instance;
+                return instance;
+            }
+            
+            static Buffer& bound(GLenum target) {
+                State& s = state();
+                assert(s.bindings[target] != 0);
+                return s.buffers[s.bindings[target]];
+            }
+            
+            static void GLAPIENTRY genBuffers(GLsizei n, GLuint* ids) {
+                for (GLsizei i = 0; i < n; i++) {
+                    ids[i] = state().nextId++;
+                    state().buffers[ids[i]] = Buffer();
+                }
+            }
+            
+            static void GLAPIENTRY deleteBuffers(GLsizei n, const GLuint* ids) {
+                for (GLsizei i = 0; i < n; i++)
+                    state().buffers.erase(ids[i]);
+            }
+            
+            static void GLAPIENTRY bindBuffer(GLenum target, GLuint id) {
+                state().bindings[target] = id;
+            }
+            
+            static void GLAPIENTRY bufferData(GLenum target, GLsizeiptr size, const GLvoid* data, GLenum usage) {
+                Buffer& buffer = bound(target);
+                buffer.assign(static_cast<size_t>(size), 0);
+                if (data != NULL)
+                    memcpy(&buffer[0], data, static_cast<size_t>(size));
+            }
+            
+            static void GLAPIENTRY bufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const GLvoid* data) {
+                Buffer& buffer = bound(target);
+                assert(static_cast<size_t>(offset + size) <= buffer.size());
+                memcpy(&buffer[static_cast<size_t>(offset)], data, static_cast<size_t>(size));
+            }
+            
+            static void GLAPIENTRY getBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, GLvoid* data) {
+                Buffer& buffer = bound(target);
+                assert(static_cast<size_t>(offset + size) <= buffer.size());
+                memcpy(data, &buffer[static_cast<size_t>(offset)], static_cast<size_t>(size));
+            }
+            
+            static void GLAPIENTRY copyBufferSubData(GLenum readTarget, GLenum writeTarget, GLintptr readOffset, GLintptr writeOffset, GLsizeiptr size) {
+                Buffer& source = bound(readTarget);
+                Buffer& destination = bound(writeTarget);
+                assert(static_cast<size_t>(readOffset + size) <= source.size());
+                assert(static_cast<size_t>(writeOffset + size) <= destination.size());
+                memmove(&destination[static_cast<size_t>(writeOffset)], &source[static_cast<size_t>(readOffset)], static_cast<size_t>(size));
+            }
+            
+            static GLvoid* GLAPIENTRY mapBuffer(GLenum target, GLenum access) {
+                return &bound(target)[0];
+            }
+            
+            static GLboolean GLAPIENTRY unmapBuffer(GLenum target) {
+                return GL_TRUE;
+            }
+        public:
+            // Whether Vbo copies buffer contents with glCopyBufferSubData or through client memory depends on the
+            // copy buffer extension.
+            static void install(bool copyBuffer) {
+                __glewGenBuffers = genBuffers;
+                __glewDeleteBuffers = deleteBuffers;
+                __glewBindBuffer = bindBuffer;
+                __glewBufferData = bufferData;
+                __glewBufferSubData = bufferSubData;
+                __glewGetBufferSubData = getBufferSubData;
+                __glewCopyBufferSubData = copyBufferSubData;
+                __glewMapBuffer = mapBuffer;
+                __glewUnmapBuffer = unmapBuffer;
+                __GLEW_VERSION_3_1 = GL_FALSE;
+                __GLEW_ARB_copy_buffer = copyBuffer ? GL_TRUE : GL_FALSE;
+            }
+            
+            // the contents of the buffer that is currently bound to the given target
+            static const Buffer& buffer(GLenum target) {
+                return bound(target);
+            }
+            
+            static size_t bufferCount() {
+                return state().buffers.size();
+            }
+        };
+        
+        class VboTest : public TestSuite<VboTest> {
+        private:
+            static void writePattern(VboBlock& block, unsigned char seed) {
+                for (size_t i = 0; i < block.capacity(); i++)
+                    block.writeByte(static_cast<unsigned char>(seed + i), i);
+            }
+            
+            static bool hasPattern(const VboBlock& block, unsigned char seed) {
+                const SoftwareGL::Buffer& buffer = SoftwareGL::buffer(GL_ARRAY_BUFFER);
+                for (size_t i = 0; i < block.capacity(); i++)
+                    if (buffer[block.address() + i] != static_cast<unsigned char>(seed + i))
+                        return false;
+                return true;
+            }
+            
+            void testResize(bool copyBuffer) {
+                SoftwareGL::install(copyBuffer);
+                const size_t bufferCount = SoftwareGL::bufferCount();
+                {
+                    Vbo vbo(GL_ARRAY_BUFFER, 24);
+                    SetVboState mapVbo(vbo, Vbo::VboMapped);
+                    
+                    VboBlock* first = vbo.allocBlock(8);
+                    VboBlock* second = vbo.allocBlock(8);
+                    VboBlock* third = vbo.allocBlock(8);
+                    writePattern(*first, 1);
+                    writePattern(*second, 50);
+                    writePattern(*third, 100);
+                    
+                    // packs the buffer and grows it to make room
+                    vbo.freeBlock(*second);
+                    VboBlock* fourth = vbo.allocBlock(24);
+                    writePattern(*fourth, 150);
+                    
+                    assert(vbo.totalCapacity() == 48);
+                    assert(first->address() == 0 && hasPattern(*first, 1));
+                    assert(third->address() == 8 && hasPattern(*third, 100));
+                    assert(fourth->address() == 16 && hasPattern(*fourth, 150));
+                    assert(SoftwareGL::buffer(GL_ARRAY_BUFFER).size() == 48);
+                }
+                
+                // the old buffer is deleted when the VBO grows, and the new one when the VBO is destroyed
+                assert(SoftwareGL::bufferCount() == bufferCount);
+            }
+        protected:
+            void registerTestCases() {
+                registerTestCase(&VboTest::testGrownCapacity);
+                registerTestCase(&VboTest::testPack);
+                registerTestCase(&VboTest::testResizeWithCopyBuffer);
+                registerTestCase(&VboTest::testResizeWithClientCopy);
+            }
+        public:
+            void testGrownCapacity() {
+                SoftwareGL::install(true);
+                Vbo vbo(GL_ARRAY_BUFFER, 16);
+                SetVboState mapVbo(vbo, Vbo::VboMapped);
+                
+                vbo.ensureFreeCapacity(16);
+                assert(vbo.totalCapacity() == 16);
+                vbo.ensureFreeCapacity(17);
+                assert(vbo.totalCapacity() == 32);
+                
+                // the capacity doubles until the request fits next to the used blocks
+                vbo.allocBlock(24);
+                vbo.ensureFreeCapacity(100);
+                assert(vbo.totalCapacity() == 128);
+                assert(vbo.freeCapacity() == 104);
+            }
+            
+            void testPack() {
+                SoftwareGL::install(true);
+                Vbo vbo(GL_ARRAY_BUFFER, 32);
+                SetVboState mapVbo(vbo, Vbo::VboMapped);
+                
+                VboBlock* first = vbo.allocBlock(8);
+                VboBlock* second = vbo.allocBlock(8);
+                VboBlock* third = vbo.allocBlock(8);
+                VboBlock* fourth = vbo.allocBlock(8);
+                writePattern(*first, 1);
+                writePattern(*second, 50);
+                writePattern(*third, 100);
+                writePattern(*fourth, 150);
+                
+                vbo.freeBlock(*first);
+                vbo.freeBlock(*third);
+                assert(vbo.freeBlockCount() == 2);
+                
+                vbo.pack();
+                assert(vbo.freeBlockCount() == 1);
+                assert(vbo.largestFreeBlockCapacity() == 16);
+                assert(second->address() == 0 && hasPattern(*second, 50));
+                assert(fourth->address() == 8 && hasPattern(*fourth, 150));
+            }
+            
+            void testResizeWithCopyBuffer() {
+                testResize(true);
+            }
+            
+            void testResizeWithClientCopy() {
+                testResize(false);
+            }
+        };
+    }
+}
+
+#endif
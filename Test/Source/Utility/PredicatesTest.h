@@ -0,0 +1,131 @@
+/*
+ Copyright (C) 2010-2012 Kristian Duske
+ 
+ This file is part of TrenchBroom.
+ 
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+ 
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+ 
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_PredicatesTest_h
+#define TrenchBroom_PredicatesTest_h
+
+#include "TestSuite.h"
+#include "Utility/Predicates.h"
+#include "Utility/VecMath.h"
+
+#include <cassert>
+
+namespace TrenchBroom {
+    namespace VecMath {
+        class PredicatesTest : public TestSuite<PredicatesTest> {
+        protected:
+            void registerTestCases() {
+                registerTestCase(&PredicatesTest::testOrientationMatchesPlane);
+                registerTestCase(&PredicatesTest::testOrientationOnPlane);
+                registerTestCase(&PredicatesTest::testPointDistance);
+                registerTestCase(&PredicatesTest::testDegeneratePoints);
+                registerTestCase(&PredicatesTest::testOrientationSign);
+            }
+        public:
+            void testOrientationMatchesPlane() {
+                const Vec3f p1(64.0f, 32.0f, 0.0f);
+                const Vec3f p2(64.0f, 32.0f, 64.0f);
+                const Vec3f p3(32.0f, 64.0f, 0.0f);
+                
+                Planef plane;
+                assert(plane.setPoints(p1, p2, p3));
+                
+                assert(Predicates::orientation(p1, p2, p3, p1 + plane.normal) > 0.0);
+                assert(Predicates::orientation(p1, p2, p3, p1 - plane.normal) < 0.0);
+                assert(Predicates::orientation(p1, p2, p3, Vec3f(64.0f, 64.0f, 17.0f)) > 0.0);
+                assert(Predicates::orientation(p1, p2, p3, Vec3f(0.0f, 0.0f, -5.0f)) < 0.0);
+            }
+            
+            void testOrientationOnPlane() {
+                // far from the origin, where the rounded float plane no longer contains these points exactly
+                const Vec3f p1(8192.0f, 8192.0f, 1.0f);
+                const Vec3f p2(8193.0f, 8192.0f, 3.0f);
+                const Vec3f p3(8192.0f, 8193.0f, 5.0f);
+                
+                // integer combinations of the plane's spanning vectors
+                assert(Predicates::orientation(p1, p2, p3, Vec3f(8195.0f, 8197.0f, 27.0f)) == 0.0);
+                assert(Predicates::orientation(p1, p2, p3, Vec3f(8180.0f, 8200.0f, 9.0f)) == 0.0);
+                
+                assert(Predicates::orientation(p1, p2, p3, Vec3f(8195.0f, 8197.0f, 28.0f)) != 0.0);
+                assert(Predicates::orientation(p1, p2, p3, Vec3f(8195.0f, 8197.0f, 28.0f)) ==
+                       -Predicates::orientation(p1, p2, p3, Vec3f(8195.0f, 8197.0f, 26.0f)));
+            }
+            
+            void testPointDistance() {
+                const Vec3f p1(0.0f, 0.0f, 16.0f);
+                const Vec3f p2(0.0f, 64.0f, 16.0f);
+                const Vec3f p3(64.0f, 0.0f, 16.0f);
+                
+                Planef plane;
+                assert(plane.setPoints(p1, p2, p3));
+                assert(plane.normal.equals(Vec3f::PosZ));
+                
+                assert(Predicates::normalLength(p1, p2, p3) == 64.0 * 64.0);
+                assert(Predicates::pointDistance(p1, p2, p3, Vec3f(13.0f, -7.0f, 26.0f)) == 10.0);
+                assert(Predicates::pointDistance(p1, p2, p3, Vec3f(13.0f, -7.0f, 6.0f)) == -10.0);
+                assert(Predicates::pointDistance(p1, p2, p3, Vec3f(1000.0f, 1000.0f, 16.0f)) == 0.0);
+            }
+            
+            void testDegeneratePoints() {
+                const Vec3f p1(0.0f, 0.0f, 0.0f);
+                const Vec3f p2(16.0f, 16.0f, 16.0f);
+                const Vec3f p3(32.0f, 32.0f, 32.0f);
+                
+                assert(Predicates::normalLength(p1, p2, p3) == 0.0);
+                assert(Predicates::orientation(p1, p2, p3, Vec3f(5.0f, -3.0f, 7.0f)) == 0.0);
+                assert(Predicates::pointDistance(p1, p2, p3, Vec3f(5.0f, -3.0f, 7.0f)) == 0.0);
+                assert(Predicates::orientationSign(p1, p2, p3, Vec3f(5.0f, -3.0f, 7.0f)) == 0);
+            }
+            
+            void testOrientationSign() {
+                // q = p2 + p3 - p1 lies on the plane, but the products of these coordinates are rounded in double
+                // precision, so that orientation does not return zero
+                const Vec3f p1(0.0f, 0.0f, 0.0f);
+                const Vec3f p2(1.22790766f, 1.25643575f, 1.57207143f);
+                const Vec3f p3(1.75275278f, 1.9950515f, 1.44066846f);
+                const Vec3f q(2.98066044f, 3.25148726f, 3.0127399f);
+                assert(q == p2 + p3 - p1);
+                assert(Predicates::orientation(p1, p2, p3, q) != 0.0);
+                
+                assert(Predicates::orientationSign(p1, p2, p3, q) == 0);
+                assert(Predicates::orientationSign(p2, p1, p3, q) == 0);
+                assert(Predicates::orientationSign(q, p2, p3, p1) == 0);
+                
+                // the neighbouring floats lie on either side of the plane, floats in [2, 4) are 2^-22 apart
+                const Vec3f normal = crossed(p3 - p1, p2 - p1);
+                const float ulp = 1.0f / 4194304.0f;
+                for (size_t i = 0; i < 3; i++) {
+                    Vec3f above = q;
+                    Vec3f below = q;
+                    const float step = normal[i] > 0.0f ? ulp : -ulp;
+                    above[i] = q[i] + step;
+                    below[i] = q[i] - step;
+                    assert(Predicates::orientationSign(p1, p2, p3, above) == 1);
+                    assert(Predicates::orientationSign(p1, p2, p3, below) == -1);
+                    
+                    // swapping two points flips the sign
+                    assert(Predicates::orientationSign(p2, p1, p3, above) == -1);
+                    assert(Predicates::orientationSign(p1, p3, p2, below) == 1);
+                }
+            }
+        };
+    }
+}
+
+#endif
@@ -20,9 +20,18 @@
 #include <iostream>
 
 #include "TestSuite.h"
+#include "IO/BinaryMapParserTest.h"
+#include "IO/MapParserTest.h"
+#include "Model/BrushRebuildScopeTest.h"
+#include "Model/BrushTest.h"
+#include "Model/MapTest.h"
+#include "Model/PointFileTest.h"
+#include "Model/VertexHandleMapTest.h"
+#include "Renderer/VboTest.h"
 #include "Utility/FindIntegerPlanePointsTest.h"
 #include "Utility/MatTest.h"
 #include "Utility/PlaneTest.h"
+#include "Utility/PredicatesTest.h"
 #include "Utility/VecTest.h"
 
 int main(int argc, const char * argv[]) {
@@ -37,6 +46,33 @@ int main(int argc, const char * argv[]) {
     VecMath::PlaneTest planeTest;
     planeTest.run();
     
+    VecMath::PredicatesTest predicatesTest;
+    predicatesTest.run();
+    
+    IO::BinaryMapParserTest binaryMapParserTest;
+    binaryMapParserTest.run();
+    
+    IO::MapParserTest mapParserTest;
+    mapParserTest.run();
+    
+    Model::BrushTest brushTest;
+    brushTest.run();
+    
+    Model::BrushRebuildScopeTest brushRebuildScopeTest;
+    brushRebuildScopeTest.run();
+    
+    Model::MapTest mapTest;
+    mapTest.run();
+    
+    Model::PointFileTest pointFileTest;
+    pointFileTest.run();
+    
+    Model::VertexHandleMapTest vertexHandleMapTest;
+    vertexHandleMapTest.run();
+    
+    Renderer::VboTest vboTest;
+    vboTest.run();
+    
     /*
     VecMath::FindIntegerPlanePointsTest planePointsTest;
     planePointsTest.run();
@@ -63,6 +63,10 @@ namespace TrenchBroom {
             return appDirectory();
         }
 
+        String WinFileManager::cacheDirectory() {
+            return appendPath(appDirectory(), "Cache");
+        }
+
         String WinFileManager::resourceDirectory() {
 			return appendPath(appDirectory(), "Resources");
 		}
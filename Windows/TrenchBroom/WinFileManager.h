@@ -39,6 +39,7 @@ namespace TrenchBroom {
             String appDirectory();
         public:
             String logDirectory();
+            String cacheDirectory();
             String resourceDirectory();
             String resolveFontPath(const String& fontName);
 